@@ -54,6 +54,7 @@ i386_init (Elf *elf __attribute__ ((unused)),
   HOOK (eh, register_info);
   HOOK (eh, auxv_info);
   HOOK (eh, disasm);
+  HOOK (eh, disasm_decode);
   HOOK (eh, abi_cfi);
   /* gcc/config/ #define DWARF_FRAME_REGISTERS.  For i386 it is 17, why?  */
   eh->frame_nregs = 9;
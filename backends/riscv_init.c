@@ -60,6 +60,7 @@ riscv_init (Elf *elf,
   HOOK (eh, register_info);
   HOOK (eh, abi_cfi);
   HOOK (eh, disasm);
+  HOOK (eh, disasm_decode);
   /* gcc/config/ #define DWARF_FRAME_REGISTERS.  */
   eh->frame_nregs = 66;
   HOOK (eh, check_special_symbol);
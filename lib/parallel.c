@@ -0,0 +1,112 @@
+/* Run the tools' work on several threads.
+   Copyright (C) 2026 Red Hat, Inc.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "atomics.h"
+#include "libeu.h"
+#include "parallel.h"
+
+
+unsigned int
+default_jobs (void)
+{
+#ifdef HAVE_SCHED_GETAFFINITY
+  cpu_set_t mask;
+  if (sched_getaffinity (0, sizeof mask, &mask) == 0)
+    return CPU_COUNT (&mask);
+#endif
+  long int cpus = sysconf (_SC_NPROCESSORS_ONLN);
+  return cpus > 0 ? cpus : 1;
+}
+
+
+unsigned int
+parse_jobs (const char *arg)
+{
+  char *endp;
+  unsigned long int jobs = strtoul (arg, &endp, 10);
+  if (*arg == '\0' || *endp != '\0' || jobs > 1024)
+    return 0;
+
+  return jobs == 0 ? default_jobs () : jobs;
+}
+
+
+struct parallel
+{
+  void (*work) (void *arg, size_t i);
+  void *arg;
+  size_t n;
+  atomic_size_t next;
+};
+
+static void *
+worker (void *p)
+{
+  struct parallel *par = p;
+  size_t i;
+  while ((i = atomic_fetch_add_explicit (&par->next, 1,
+					 memory_order_relaxed)) < par->n)
+    par->work (par->arg, i);
+  return NULL;
+}
+
+void
+run_parallel (unsigned int jobs, size_t n,
+	      void (*work) (void *arg, size_t i), void *arg)
+{
+  struct parallel par = { .work = work, .arg = arg, .n = n };
+  atomic_init (&par.next, 0);
+
+  if (jobs > n)
+    jobs = n;
+
+  pthread_t *threads = NULL;
+  unsigned int started = 0;
+  if (jobs > 1)
+    {
+      threads = xmalloc ((jobs - 1) * sizeof threads[0]);
+      /* If no more threads can be created, do with fewer.  */
+      while (started < jobs - 1
+	     && pthread_create (&threads[started], NULL, worker, &par) == 0)
+	++started;
+    }
+
+  worker (&par);
+
+  for (unsigned int i = 0; i < started; ++i)
+    pthread_join (threads[i], NULL);
+  free (threads);
+}
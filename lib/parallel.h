@@ -0,0 +1,55 @@
+/* Run the tools' work on several threads.
+   Copyright (C) 2026 Red Hat, Inc.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H 1
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Return the number of CPUs this process can run on, at least one.  */
+unsigned int default_jobs (void);
+
+/* Parse ARG as the argument of a -j option: a number of threads, or
+   zero for as many as there are CPUs to run on.  Returns zero if ARG
+   is not a valid number.  */
+unsigned int parse_jobs (const char *arg);
+
+/* Call WORK (ARG, I) once for every I from zero to N - 1, on up to JOBS
+   threads including the calling one.  The calls are started in order
+   of I, but they run concurrently and can finish in any order.  */
+void run_parallel (unsigned int jobs, size_t n,
+		   void (*work) (void *arg, size_t i), void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PARALLEL_H */
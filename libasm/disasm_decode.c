@@ -0,0 +1,52 @@
+/* Decode one instruction into a structure.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include "libasmP.h"
+#include "libeblP.h"
+
+
+int
+disasm_decode (DisasmCtx_t *ctx, const uint8_t **startp, const uint8_t *end,
+	       GElf_Addr addr, DisasmInsn_t *insn)
+{
+  if (ctx == NULL)
+    return -1;
+
+  if (ctx->ebl->disasm_decode == NULL)
+    {
+      __libasm_seterrno (ASM_E_ENOSUP);
+      return -1;
+    }
+
+  return ctx->ebl->disasm_decode (ctx->ebl, startp, end, addr, insn);
+}
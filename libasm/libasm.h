@@ -63,6 +63,69 @@ typedef int (*DisasmGetSymCB_t) (GElf_Addr, Elf32_Word, GElf_Addr, char **,
 typedef int (*DisasmOutputCB_t) (char *, size_t, void *);
 
 
+/* Maximum number of operands of a decoded instruction.  */
+#define DISASM_MAX_OPERANDS 5
+
+/* Kinds of operands of a decoded instruction.  */
+enum
+  {
+    DISASM_OP_NONE = 0,
+    /* A register.  The value is the register number if the backend
+       provides it, otherwise -1.  */
+    DISASM_OP_REG,
+    /* An immediate.  The value is the encoded immediate, sign-extended.  */
+    DISASM_OP_IMM,
+    /* A memory reference.  The value is the displacement, or the
+       address for absolute and PC-relative references.  */
+    DISASM_OP_MEM,
+    /* A branch target.  The value is its address.  */
+    DISASM_OP_TARGET
+  };
+
+/* Properties of a decoded instruction.  */
+enum
+  {
+    /* The bytes do not form a known instruction.  */
+    DISASM_INSN_INVALID = 1 << 0,
+    /* Transfers control to another address.  */
+    DISASM_INSN_JUMP = 1 << 1,
+    /* Calls a function.  */
+    DISASM_INSN_CALL = 1 << 2,
+    /* Returns from a function.  */
+    DISASM_INSN_RETURN = 1 << 3,
+    /* The jump is only taken under some condition.  */
+    DISASM_INSN_COND = 1 << 4,
+    /* The jump or call target is computed at run time.  */
+    DISASM_INSN_INDIRECT = 1 << 5
+  };
+
+/* One decoded instruction.  The operands are in the order the
+   disassembler prints them.  */
+typedef struct
+{
+  /* Address and size of the instruction.  */
+  GElf_Addr addr;
+  unsigned int length;
+  /* Bitmask of DISASM_INSN_* values.  */
+  unsigned int flags;
+  /* The branch target, if the instruction has a DISASM_OP_TARGET
+     operand.  */
+  GElf_Addr target;
+  /* The mnemonic as the disassembler prints it.  */
+  char mnemonic[16];
+  unsigned int noperands;
+  struct
+  {
+    /* One of the DISASM_OP_* values.  */
+    int kind;
+    /* Number of instruction bytes which encode the value, zero if it
+       is not encoded directly.  */
+    unsigned int size;
+    int64_t value;
+  } operands[DISASM_MAX_OPERANDS];
+} DisasmInsn_t;
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -196,6 +259,16 @@ extern int disasm_cb (DisasmCtx_t *ctx, const uint8_t **startp,
 		      const uint8_t *end, GElf_Addr addr, const char *fmt,
 		      DisasmOutputCB_t outcb, void *outcbarg, void *symcbarg);
 
+/* Decode the instruction at *STARTP, which is at address ADDR, into
+   INSN and advance *STARTP past it.  If INSN is NULL only *STARTP is
+   advanced, which is the fastest way to find instruction boundaries.
+   Return zero on success, -1 if no complete instruction starts before
+   END or the backend cannot decode, and a positive error code if
+   decoding failed otherwise.  */
+extern int disasm_decode (DisasmCtx_t *ctx, const uint8_t **startp,
+			  const uint8_t *end, GElf_Addr addr,
+			  DisasmInsn_t *insn);
+
 #ifdef __cplusplus
 }
 #endif
@@ -502,3 +502,204 @@ bpf_disasm (Ebl *ebl, const uint8_t **startp, const uint8_t *end,
  done:
   return retval;
 }
+
+
+/* Names for the structured decoding, indexed by the operation bits.  */
+static const char alu_string[14][5] = {
+  "add", "sub", "mul", "div", "or", "and", "lsh", "rsh",
+  "neg", "mod", "xor", "mov", "arsh", "end"
+};
+
+static const char jmp_string[14][5] = {
+  "ja", "jeq", "jgt", "jge", "jset", "jne", "jsgt", "jsge",
+  "call", "exit", "jlt", "jle", "jslt", "jsle"
+};
+
+static const char size_string[4][3] = {
+  [BPF_W >> 3] = "w", [BPF_H >> 3] = "h", [BPF_B >> 3] = "b",
+  [BPF_DW >> 3] = "dw"
+};
+
+static void
+add_operand (DisasmInsn_t *insn, int kind, unsigned int size, int64_t value)
+{
+  insn->operands[insn->noperands].kind = kind;
+  insn->operands[insn->noperands].size = size;
+  insn->operands[insn->noperands].value = value;
+  ++insn->noperands;
+}
+
+int
+bpf_disasm_decode (Ebl *ebl, const uint8_t **startp, const uint8_t *end,
+		   GElf_Addr addr, DisasmInsn_t *insn)
+{
+  const bool need_bswap = MY_ELFDATA != ebl->data;
+  const uint8_t *start = *startp;
+  struct bpf_insn i, i2 = { .code = 0 };
+
+  if (start + sizeof(struct bpf_insn) > end)
+    return -1;
+  memcpy(&i, start, sizeof(struct bpf_insn));
+
+  size_t length = sizeof(struct bpf_insn);
+  if (i.code == (BPF_LD | BPF_IMM | BPF_DW))
+    {
+      if (start + 2 * sizeof(struct bpf_insn) > end)
+	return -1;
+      memcpy(&i2, start + sizeof(struct bpf_insn), sizeof(struct bpf_insn));
+      length *= 2;
+    }
+  *startp = start + length;
+  if (insn == NULL)
+    return 0;
+
+  if (need_bswap)
+    {
+      bswap_bpf_insn (&i);
+      if (length > sizeof(struct bpf_insn))
+	bswap_bpf_insn (&i2);
+    }
+
+  unsigned code = i.code;
+  unsigned op = (code & 0xf0) >> 4;
+  bool src_x = (code & BPF_X) != 0;
+  const char *mne = NULL;
+  const char *suffix = "";
+
+  insn->addr = addr;
+  insn->length = length;
+  insn->flags = 0;
+  insn->target = 0;
+  insn->noperands = 0;
+
+  switch (BPF_CLASS(code))
+    {
+    case BPF_ALU:
+    case BPF_ALU64:
+      if (op > (BPF_END >> 4)
+	  || (op == (BPF_NEG >> 4) && src_x)
+	  || (op == (BPF_END >> 4) && BPF_CLASS(code) == BPF_ALU64))
+	break;
+      if (op == (BPF_END >> 4))
+	{
+	  mne = src_x ? "be" : "le";
+	  add_operand (insn, DISASM_OP_REG, 0, i.dst_reg);
+	  add_operand (insn, DISASM_OP_IMM, 4, i.imm);
+	  break;
+	}
+      mne = alu_string[op];
+      if (BPF_CLASS(code) == BPF_ALU)
+	suffix = "32";
+      add_operand (insn, DISASM_OP_REG, 0, i.dst_reg);
+      if (op == (BPF_NEG >> 4))
+	break;
+      if (src_x)
+	add_operand (insn, DISASM_OP_REG, 0, i.src_reg);
+      else
+	add_operand (insn, DISASM_OP_IMM, 4, i.imm);
+      break;
+
+    case BPF_JMP:
+      if (op > (BPF_JSLE >> 4))
+	break;
+      if (code == (BPF_JMP | BPF_CALL))
+	{
+	  /* The immediate is the number of a helper function.  */
+	  mne = "call";
+	  insn->flags = DISASM_INSN_CALL;
+	  add_operand (insn, DISASM_OP_IMM, 4, i.imm);
+	  break;
+	}
+      if (code == (BPF_JMP | BPF_EXIT))
+	{
+	  mne = "exit";
+	  insn->flags = DISASM_INSN_RETURN;
+	  break;
+	}
+      if (code == (BPF_JMP | BPF_JA))
+	insn->flags = DISASM_INSN_JUMP;
+      else if (op == (BPF_JA >> 4) || op == (BPF_CALL >> 4)
+	       || op == (BPF_EXIT >> 4))
+	break;
+      else
+	{
+	  insn->flags = DISASM_INSN_JUMP | DISASM_INSN_COND;
+	  add_operand (insn, DISASM_OP_REG, 0, i.dst_reg);
+	  if (src_x)
+	    add_operand (insn, DISASM_OP_REG, 0, i.src_reg);
+	  else
+	    add_operand (insn, DISASM_OP_IMM, 4, i.imm);
+	}
+      mne = jmp_string[op];
+      insn->target = addr + (i.off + 1) * sizeof(struct bpf_insn);
+      add_operand (insn, DISASM_OP_TARGET, 2, insn->target);
+      break;
+
+    case BPF_LD:
+      if (code == (BPF_LD | BPF_IMM | BPF_DW))
+	{
+	  mne = "lddw";
+	  add_operand (insn, DISASM_OP_REG, 0, i.dst_reg);
+	  add_operand (insn, DISASM_OP_IMM, 8,
+		       (uint32_t) i.imm | ((uint64_t) i2.imm << 32));
+	  break;
+	}
+      if ((code & 0x18) == BPF_DW)
+	break;
+      if ((code & 0xe0) == BPF_ABS)
+	mne = "ldabs";
+      else if ((code & 0xe0) == BPF_IND)
+	{
+	  mne = "ldind";
+	  add_operand (insn, DISASM_OP_REG, 0, i.src_reg);
+	}
+      else
+	break;
+      suffix = size_string[(code & 0x18) >> 3];
+      add_operand (insn, DISASM_OP_MEM, 4, i.imm);
+      break;
+
+    case BPF_LDX:
+      if ((code & 0xe0) != BPF_MEM)
+	break;
+      mne = "ldx";
+      suffix = size_string[(code & 0x18) >> 3];
+      add_operand (insn, DISASM_OP_REG, 0, i.dst_reg);
+      add_operand (insn, DISASM_OP_MEM, 2, i.off);
+      break;
+
+    case BPF_ST:
+      if ((code & 0xe0) != BPF_MEM)
+	break;
+      mne = "st";
+      suffix = size_string[(code & 0x18) >> 3];
+      add_operand (insn, DISASM_OP_MEM, 2, i.off);
+      add_operand (insn, DISASM_OP_IMM, 4, i.imm);
+      break;
+
+    case BPF_STX:
+      if ((code & 0xe0) == BPF_MEM)
+	mne = "stx";
+      else if ((code & 0xe0) == BPF_XADD
+	       && ((code & 0x18) == BPF_W || (code & 0x18) == BPF_DW))
+	mne = "xadd";
+      else
+	break;
+      suffix = size_string[(code & 0x18) >> 3];
+      add_operand (insn, DISASM_OP_MEM, 2, i.off);
+      add_operand (insn, DISASM_OP_REG, 0, i.src_reg);
+      break;
+
+    default:
+      break;
+    }
+
+  if (mne == NULL)
+    {
+      mne = "invalid";
+      insn->flags = DISASM_INSN_INVALID;
+      insn->noperands = 0;
+    }
+  snprintf (insn->mnemonic, sizeof (insn->mnemonic), "%s%s", mne, suffix);
+  return 0;
+}
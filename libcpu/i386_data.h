@@ -160,6 +160,9 @@ general_mod$r_m (struct output_data *d)
   if (r != 0)
     return r;
 
+  if (d->decode)
+    return 0;
+
   int prefixes = *d->prefixes;
   const uint8_t *data = &d->data[d->opoff1 / 8];
   char *bufp = d->bufp;
@@ -457,6 +460,8 @@ generic_abs (struct output_data *d, const char *absstring
   if (*d->param_start + abslen > d->end)
     return -1;
   *d->param_start += abslen;
+  if (d->decode)
+    return 0;
 #ifndef X86_64
   uint32_t absval;
 # define ABSPRIFMT PRIx32
@@ -589,6 +594,8 @@ FCT_disp8 (struct output_data *d)
   if (*d->param_start >= d->end)
     return -1;
   int32_t offset = *(const int8_t *) (*d->param_start)++;
+  if (d->decode)
+    return 0;
 
   size_t *bufcntp = d->bufcntp;
   size_t avail = d->bufsize - *bufcntp;
@@ -698,6 +705,8 @@ FCT_imm (struct output_data *d)
       if (*d->param_start + 2 > d->end)
 	return -1;
       uint16_t word = read_2ubyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
       needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx16, word);
     }
   else
@@ -705,6 +714,8 @@ FCT_imm (struct output_data *d)
       if (*d->param_start + 4 > d->end)
 	return -1;
       int32_t word = read_4sbyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
 #ifdef X86_64
       if (*d->prefixes & has_rex_w)
 	needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx64,
@@ -731,6 +742,8 @@ FCT_imm$w (struct output_data *d)
   if (*d->param_start>= d->end)
     return -1;
   uint_fast8_t word = *(*d->param_start)++;
+  if (d->decode)
+    return 0;
   int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIxFAST8, word);
   if ((size_t) needed > avail)
     return (size_t) needed - avail;
@@ -755,6 +768,8 @@ FCT_imm64$w (struct output_data *d)
       if (*d->param_start + 8 > d->end)
 	return -1;
       uint64_t word = read_8ubyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
       needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx64, word);
     }
   else
@@ -762,6 +777,8 @@ FCT_imm64$w (struct output_data *d)
       if (*d->param_start + 4 > d->end)
 	return -1;
       int32_t word = read_4sbyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
       needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx32, word);
     }
   if ((size_t) needed > avail)
@@ -780,6 +797,8 @@ FCT_imms (struct output_data *d)
   if (*d->param_start>= d->end)
     return -1;
   int8_t byte = *(*d->param_start)++;
+  if (d->decode)
+    return 0;
 #ifdef X86_64
   int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx64,
 			 (int64_t) byte);
@@ -808,6 +827,8 @@ FCT_imm$s (struct output_data *d)
       if (*d->param_start + 4 > d->end)
 	return -1;
       int32_t word = read_4sbyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
 #ifdef X86_64
       int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx64,
 			     (int64_t) word);
@@ -823,6 +844,8 @@ FCT_imm$s (struct output_data *d)
       if (*d->param_start + 2 > d->end)
 	return -1;
       uint16_t word = read_2ubyte_unaligned_inc (*d->param_start);
+      if (d->decode)
+	return 0;
       int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx16, word);
       if ((size_t) needed > avail)
 	return (size_t) needed - avail;
@@ -838,6 +861,8 @@ FCT_imm16 (struct output_data *d)
   if (*d->param_start + 2 > d->end)
     return -1;
   uint16_t word = read_2ubyte_unaligned_inc (*d->param_start);
+  if (d->decode)
+    return 0;
   size_t *bufcntp = d->bufcntp;
   size_t avail = d->bufsize - *bufcntp;
   int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx16, word);
@@ -856,6 +881,8 @@ FCT_imms8 (struct output_data *d)
   if (*d->param_start >= d->end)
     return -1;
   int_fast8_t byte = *(*d->param_start)++;
+  if (d->decode)
+    return 0;
   int needed;
 #ifdef X86_64
   if (*d->prefixes & has_rex_w)
@@ -880,6 +907,8 @@ FCT_imm8 (struct output_data *d)
   if (*d->param_start >= d->end)
     return -1;
   uint_fast8_t byte = *(*d->param_start)++;
+  if (d->decode)
+    return 0;
   int needed = snprintf (&d->bufp[*bufcntp], avail, "$0x%" PRIx32,
 			 (uint32_t) byte);
   if ((size_t) needed > avail)
@@ -897,6 +926,8 @@ FCT_rel (struct output_data *d)
   if (*d->param_start + 4 > d->end)
     return -1;
   int32_t rel = read_4sbyte_unaligned_inc (*d->param_start);
+  if (d->decode)
+    return 0;
 #ifdef X86_64
   int needed = snprintf (&d->bufp[*bufcntp], avail, "0x%" PRIx64,
 			 (uint64_t) (d->addr + rel
@@ -1339,6 +1370,8 @@ FCT_sel (struct output_data *d)
   if (*d->param_start + 2 >= d->end)
     return -1;
   *d->param_start += 2;
+  if (d->decode)
+    return 0;
   uint16_t absval = read_2ubyte_unaligned (&d->data[5]);
 
   size_t *bufcntp = d->bufcntp;
@@ -36,6 +36,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <gelf.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -134,9 +135,10 @@ enum
 #define prefix_lock	0xf0
 
 
-static const uint8_t known_prefixes[] =
+/* Map each byte to the index of the prefix it is, or zero.  */
+static const uint8_t known_prefixes[256] =
   {
-#define newpref(pref) [idx_##pref] = prefix_##pref
+#define newpref(pref) [prefix_##pref] = idx_##pref
     newpref (cs),
     newpref (ds),
     newpref (es),
@@ -150,7 +152,6 @@ static const uint8_t known_prefixes[] =
     newpref (lock)
 #undef newpref
   };
-#define nknown_prefixes (sizeof (known_prefixes) / sizeof (known_prefixes[0]))
 
 
 #if 0
@@ -264,6 +265,8 @@ struct output_data
       addr_rel_always
     } symaddr_use;
   GElf_Addr symaddr;
+  /* Only check and skip the operands, their text is not used.  */
+  bool decode;
 };
 
 
@@ -298,11 +301,184 @@ struct output_data
   } while (0)
 
 
-int
-i386_disasm (Ebl *ebl __attribute__((unused)),
-	     const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
-	     const char *fmt, DisasmOutputCB_t outcb, DisasmGetSymCB_t symcb,
-	     void *outcbarg, void *symcbarg)
+/* Return whether the operand function FCT prints the operand encoded
+   in the ModR/M byte, a register or a memory reference.  */
+static bool
+modrm_operand_p (opfct_t fct)
+{
+  return (fct == FCT_mod$r_m || fct == FCT_mod$r_m$w || fct == FCT_mod$8r_m
+	  || fct == FCT_mod$16r_m || fct == FCT_mod$64r_m
+	  || fct == FCT_MOD$R_M || fct == FCT_Mod$R_m
+#ifndef X86_64
+	  || fct == FCT_moda$r_m
+#endif
+	  );
+}
+
+
+/* Return the displacement of the memory operand in the ModR/M byte
+   D->opoff1 refers to and store its size in *SIZEP.  */
+static int64_t
+modrm_disp (const struct output_data *d, unsigned int *sizep)
+{
+  const uint8_t *data = &d->data[d->opoff1 / 8];
+  uint_fast8_t modrm = data[0];
+
+#ifndef X86_64
+  if ((*d->prefixes & has_addr16) != 0)
+    {
+      if ((modrm & 0xc7) == 6 || (modrm & 0xc0) == 0x80)
+	{
+	  *sizep = 2;
+	  return read_2sbyte_unaligned (&data[1]);
+	}
+      *sizep = (modrm & 0xc0) == 0x40;
+      return *sizep ? *(const int8_t *) &data[1] : 0;
+    }
+#endif
+
+  /* Skip the SIB byte.  */
+  const uint8_t *disp = &data[1];
+  bool sib_nobase = false;
+  if ((modrm & 7) == 4)
+    sib_nobase = (*disp++ & 7) == 5;
+
+  if ((modrm & 0xc7) == 5 || (modrm & 0xc0) == 0x80
+      || ((modrm & 0xc0) == 0 && sib_nobase))
+    {
+      *sizep = 4;
+      return read_4sbyte_unaligned (disp);
+    }
+  *sizep = (modrm & 0xc0) == 0x40;
+  return *sizep ? *(const int8_t *) disp : 0;
+}
+
+
+/* Add the operand FCT just printed for D to INSN.  The parameter
+   bytes FCT consumed start at START.  If the operand is a memory
+   reference relative to the end of the instruction store its index
+   in *PCRELP.  */
+static void
+decode_operand (DisasmInsn_t *insn, opfct_t fct, struct output_data *d,
+		const uint8_t *start, int *pcrelp __attribute__ ((unused)))
+{
+  if (fct == FCT_string || insn->noperands == DISASM_MAX_OPERANDS)
+    return;
+
+  unsigned int size = *d->param_start - start;
+  int kind;
+  int64_t value;
+  if (size > 0)
+    {
+      /* The selector of a far jump or call follows the offset.  */
+      if (fct == FCT_sel)
+	start = &d->data[5];
+
+      uint64_t raw = 0;
+      for (unsigned int i = size; i-- > 0; )
+	raw = raw << 8 | start[i];
+      value = size < 8 ? (int64_t) (raw << (64 - 8 * size)) >> (64 - 8 * size)
+		       : (int64_t) raw;
+
+      if (fct == FCT_rel || fct == FCT_disp8)
+	{
+	  kind = DISASM_OP_TARGET;
+	  value += d->addr + (*d->param_start - d->data);
+#ifndef X86_64
+	  value = (uint32_t) value;
+#endif
+	}
+      else if (fct == FCT_abs)
+	{
+	  kind = DISASM_OP_MEM;
+	  value = raw;
+	}
+      else
+	kind = DISASM_OP_IMM;
+    }
+  else if (modrm_operand_p (fct)
+	   && (d->data[d->opoff1 / 8] & 0xc0) != 0xc0)
+    {
+      kind = DISASM_OP_MEM;
+      value = modrm_disp (d, &size);
+#ifdef X86_64
+      /* Without a SIB byte the 32-bit displacement is RIP-relative.  */
+      if ((d->data[d->opoff1 / 8] & 0xc7) == 5)
+	*pcrelp = insn->noperands;
+#endif
+    }
+  else if (fct == FCT_ds_bx || fct == FCT_ds_si || fct == FCT_es_di)
+    {
+      kind = DISASM_OP_MEM;
+      value = 0;
+    }
+  else
+    {
+      kind = DISASM_OP_REG;
+      value = -1;
+    }
+
+  insn->operands[insn->noperands].kind = kind;
+  insn->operands[insn->noperands].size = size;
+  insn->operands[insn->noperands].value = value;
+  ++insn->noperands;
+}
+
+
+/* Fill in the rest of INSN, which has LENGTH bytes and ends at ADDR,
+   from the mnemonic MNE of MNELEN bytes.  PCREL is the index of a
+   memory operand relative to the end of the instruction, or -1.  */
+static void
+decode_insn (DisasmInsn_t *insn, GElf_Addr addr, size_t length,
+	     const char *mne, size_t mnelen, int pcrel)
+{
+  insn->addr = addr - length;
+  insn->length = length;
+  if (mnelen >= sizeof (insn->mnemonic))
+    mnelen = sizeof (insn->mnemonic) - 1;
+  memcpy (insn->mnemonic, mne, mnelen);
+  insn->mnemonic[mnelen] = '\0';
+  mne = insn->mnemonic;
+
+  if (pcrel >= 0)
+    insn->operands[pcrel].value += addr;
+
+  bool has_target = false;
+  insn->flags = 0;
+  insn->target = 0;
+  for (unsigned int i = 0; i < insn->noperands; ++i)
+    if (insn->operands[i].kind == DISASM_OP_TARGET)
+      {
+	insn->target = insn->operands[i].value;
+	has_target = true;
+      }
+
+  if (strncmp (mne, "jmp", 3) == 0 || strncmp (mne, "ljmp", 4) == 0)
+    insn->flags = DISASM_INSN_JUMP;
+  else if (mne[0] == 'j' || strncmp (mne, "loop", 4) == 0)
+    insn->flags = DISASM_INSN_JUMP | DISASM_INSN_COND;
+  else if (strncmp (mne, "call", 4) == 0 || strncmp (mne, "lcall", 5) == 0)
+    insn->flags = DISASM_INSN_CALL;
+  else if (strncmp (mne, "ret", 3) == 0 || strncmp (mne, "lret", 4) == 0
+	   || strncmp (mne, "iret", 4) == 0)
+    insn->flags = DISASM_INSN_RETURN;
+  else if (strcmp (mne, "(bad)") == 0)
+    insn->flags = DISASM_INSN_INVALID;
+
+  /* Indirect and far jumps and calls have no target address.  */
+  if ((insn->flags & (DISASM_INSN_JUMP | DISASM_INSN_CALL)) != 0
+      && !has_target)
+    insn->flags |= DISASM_INSN_INDIRECT;
+}
+
+
+/* Disassemble with FMT, or if DECODE is true decode the first
+   instruction into INSN.  */
+static inline int
+__attribute__ ((always_inline))
+disasm_insns (const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
+	      const char *fmt, DisasmOutputCB_t outcb, DisasmGetSymCB_t symcb,
+	      void *outcbarg, void *symcbarg, bool decode, DisasmInsn_t *insn)
 {
   const char *save_fmt = fmt;
 
@@ -321,9 +497,15 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
       .bufsize = bufsize,
       .bufcntp = &bufcnt,
       .param_start = &param_start,
-      .end = end
+      .end = end,
+      .decode = decode
     };
 
+  /* The mnemonic in BUF and the PC-relative operand in INSN.  */
+  size_t mne_start = 0;
+  size_t mne_end = 0;
+  int pcrel = -1;
+
   int retval = 0;
   while (1)
     {
@@ -336,11 +518,8 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
       int last_prefix_bit = 0;
       while (data < end)
 	{
-	  unsigned int i;
-	  for (i = idx_cs; i < nknown_prefixes; ++i)
-	    if (known_prefixes[i] == *data)
-	      break;
-	  if (i == nknown_prefixes)
+	  unsigned int i = known_prefixes[*data];
+	  if (i == 0)
 	    break;
 
 	  prefixes |= last_prefix_bit = 1 << i;
@@ -356,8 +535,8 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
       bufcnt = 0;
       size_t cnt = 0;
 
-      const uint8_t *curr = match_data;
-      const uint8_t *const match_end = match_data + sizeof (match_data);
+      const uint16_t *cand = match_list;
+      const uint16_t *cand_end = match_list;
 
       assert (data <= end);
       if (data == end)
@@ -369,16 +548,32 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 	  goto do_ret;
 	}
 
+      /* Only the instructions listed for the leading opcode bytes can
+	 match.  They are tried in the order of match_data.  */
+      const uint8_t *op = data;
+      unsigned int node = 0;
+      const uint16_t *range;
+      do
+	{
+	  range = match_range[node][*op];
+	  node = match_next[node][*op];
+	}
+      while (node != 0 && ++op < end);
+      cand = match_list + range[0];
+      cand_end = match_list + range[1];
+
     next_match:
-      while (curr < match_end)
+      while (cand < cand_end)
 	{
+	  cnt = *cand++;
+	  const uint8_t *curr = match_data + match_off[cnt];
 	  uint_fast8_t len = *curr++;
 	  uint_fast8_t clen = len >> 4;
 	  len &= 0xf;
-	  const uint8_t *next_curr = curr + clen + (len - clen) * 2;
 
 	  assert (len > 0);
-	  assert (curr + clen + 2 * (len - clen) <= match_end);
+	  assert (curr + clen + 2 * (len - clen)
+		  <= match_data + sizeof (match_data));
 
 	  const uint8_t *codep = data;
 	  int correct_prefix = 0;
@@ -416,8 +611,6 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 	      if (masked != *curr++)
 		{
 		not:
-		  curr = next_curr;
-		  ++cnt;
 		  bufcnt = 0;
 		  goto next_match;
 		}
@@ -470,7 +663,13 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 		 are not used uninitialized.  */
 	      __asm (""
 		     : "=mr" (opoff), "=mr" (correct_prefix), "=mr" (codep),
-		     "=mr" (next_curr), "=mr" (len));
+		     "=mr" (len));
+	    }
+
+	  if (insn != NULL)
+	    {
+	      insn->noperands = 0;
+	      pcrel = -1;
 	    }
 
 	  size_t prefix_size = 0;
@@ -571,6 +770,10 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 	      data = begin + 1;
 	      ++addr;
 
+	      mne_start = 0;
+	      mne_end = bufcnt;
+	      if (insn != NULL)
+		insn->noperands = 0;
 	      goto out;
 	    }
 
@@ -825,6 +1028,7 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 		      non_printing += deferred_len;
 		    }
 
+		  mne_start = bufcnt;
 		  ADD_STRING (str);
 
 		  switch (instrtab[cnt].suffix)
@@ -907,6 +1111,7 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 		      printf("unknown suffix %d\n", instrtab[cnt].suffix);
 		      abort ();
 		    }
+		  mne_end = bufcnt;
 
 		  if (deferred_start != NULL)
 		    {
@@ -937,11 +1142,15 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 					    + OFF1_2_BIAS - opoff);
 		      output_data.opoff3 = (instrtab[cnt].off1_3
 					    + OFF1_3_BIAS - opoff);
+		      const uint8_t *op_start = param_start;
 		      int r = op1_fct[instrtab[cnt].fct1] (&output_data);
 		      if (r < 0)
 			goto not;
 		      if (r > 0)
 			goto enomem;
+		      if (insn != NULL)
+			decode_operand (insn, op1_fct[instrtab[cnt].fct1],
+					&output_data, op_start, &pcrel);
 
 		      if (deferred_start != NULL)
 			{
@@ -970,11 +1179,15 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 					    + OFF2_2_BIAS - opoff);
 		      output_data.opoff3 = (instrtab[cnt].off2_3
 					    + OFF2_3_BIAS - opoff);
+		      const uint8_t *op_start = param_start;
 		      int r = op2_fct[instrtab[cnt].fct2] (&output_data);
 		      if (r < 0)
 			goto not;
 		      if (r > 0)
 			goto enomem;
+		      if (insn != NULL)
+			decode_operand (insn, op2_fct[instrtab[cnt].fct2],
+					&output_data, op_start, &pcrel);
 
 		      if (deferred_start != NULL)
 			{
@@ -1007,11 +1220,15 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 #else
 		      output_data.opoff3 = 0;
 #endif
+		      const uint8_t *op_start = param_start;
 		      int r = op3_fct[instrtab[cnt].fct3] (&output_data);
 		      if (r < 0)
 			goto not;
 		      if (r > 0)
 			goto enomem;
+		      if (insn != NULL)
+			decode_operand (insn, op3_fct[instrtab[cnt].fct3],
+					&output_data, op_start, &pcrel);
 
 		      if (deferred_start != NULL)
 			{
@@ -1120,7 +1337,11 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
       /* Make sure we get past the unrecognized opcode if we haven't yet.  */
       if (*startp == data)
 	++data;
+      mne_start = bufcnt;
       ADD_STRING ("(bad)");
+      mne_end = bufcnt;
+      if (insn != NULL)
+	insn->noperands = 0;
       addr += data - begin;
 
     out:
@@ -1129,6 +1350,13 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
       buf[bufcnt] = '\0';
 
       *startp = data;
+      if (decode)
+	{
+	  if (insn != NULL)
+	    decode_insn (insn, addr, data - begin, &buf[mne_start],
+			 mne_end - mne_start, pcrel);
+	  goto do_ret;
+	}
       retval = outcb (buf, bufcnt, outcbarg);
       if (retval != 0)
 	goto do_ret;
@@ -1141,3 +1369,31 @@ i386_disasm (Ebl *ebl __attribute__((unused)),
 
   return retval;
 }
+
+
+int
+i386_disasm (Ebl *ebl __attribute__((unused)),
+	     const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
+	     const char *fmt, DisasmOutputCB_t outcb, DisasmGetSymCB_t symcb,
+	     void *outcbarg, void *symcbarg)
+{
+  return disasm_insns (startp, end, addr, fmt, outcb, symcb, outcbarg,
+		       symcbarg, false, NULL);
+}
+
+
+int
+i386_disasm_decode (Ebl *ebl __attribute__((unused)),
+		    const uint8_t **startp, const uint8_t *end,
+		    GElf_Addr addr, DisasmInsn_t *insn)
+{
+  /* The operand functions find the instruction length and reject
+     invalid encodings, they must run even if INSN is NULL.  The text
+     they produce is not used.  */
+  const uint8_t *start = *startp;
+  int res = disasm_insns (startp, end, addr, "%m %.1o,%.2o,%.3o", NULL,
+			  NULL, NULL, NULL, true, insn);
+  if (res == 0 && *startp == start)
+    res = -1;
+  return res;
+}
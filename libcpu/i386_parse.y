@@ -1109,6 +1109,210 @@ print_op_fct (const void *nodep, VISIT value,
     }
 }
 
+/* The bytes of match_data as they are written out and the offset in
+   it of each instruction.  */
+static uint8_t *match_bytes;
+static size_t nmatch_bytes;
+static size_t match_bytes_max;
+static size_t *match_off;
+
+static void
+match_byte_out (uint8_t byte)
+{
+  fprintf (outfile, " %#" PRIx8 ",", byte);
+
+  if (nmatch_bytes == match_bytes_max)
+    {
+      match_bytes_max = 2 * match_bytes_max + 1024;
+      match_bytes = xrealloc (match_bytes, match_bytes_max);
+    }
+  match_bytes[nmatch_bytes++] = byte;
+}
+
+/* Return true if the byte at position POS of the encoding at P in
+   match_data can be B.  There is no constraint past the end.  */
+static bool
+match_byte_p (const uint8_t *p, size_t pos, unsigned int b)
+{
+  size_t len = *p & 0xf;
+  size_t clen = *p >> 4;
+
+  if (pos >= len)
+    return true;
+  if (pos < clen)
+    return p[1 + pos] == b;
+  const uint8_t *mv = p + 1 + clen + 2 * (pos - clen);
+  return (b & mv[0]) == mv[1];
+}
+
+/* Return true if the instruction encoded at P can match when the
+   opcode bytes after the prefixes start with the N bytes at OP.  The
+   disassembler matches a leading fixed byte against the last prefix
+   byte if it is the same, the rest of the encoding then starts at the
+   opcode.  With only a REX prefix that even fails the match whatever
+   the opcode is.  */
+static bool
+match_candidate_p (const uint8_t *p, const uint8_t *op, size_t n)
+{
+  size_t shift;
+  for (shift = 0; shift < n; ++shift)
+    if (! match_byte_p (p, shift, op[shift]))
+      break;
+  if (shift == n)
+    return true;
+  if ((*p >> 4) == 0)
+    return false;
+
+  switch (p[1])
+    {
+    case 0x26: case 0x2e: case 0x36: case 0x3e: case 0x64: case 0x65:
+    case 0x66: case 0x67: case 0xf0: case 0xf2: case 0xf3:
+      for (shift = 0; shift < n; ++shift)
+	if (! match_byte_p (p, shift + 1, op[shift]))
+	  return false;
+      return true;
+    case 0x40 ... 0x4f:
+      return true;
+    default:
+      return false;
+    }
+}
+
+/* The candidate lists of the dispatch tables.  */
+static uint16_t *match_list;
+static size_t nmatch_list;
+static size_t match_list_max;
+
+/* Append the indices of the instructions which are candidates for the
+   N opcode bytes at OP, in table order, to match_list and store the
+   range of the list in RANGE.  An identical run of indices written
+   earlier is used instead if there is one.  */
+static void
+match_list_out (const uint8_t *op, size_t n, size_t range[2])
+{
+  size_t start = nmatch_list;
+  for (size_t cnt = 0; cnt < ninstructions; ++cnt)
+    if (match_candidate_p (match_bytes + match_off[cnt], op, n))
+      {
+	if (nmatch_list == match_list_max)
+	  {
+	    match_list_max = 2 * match_list_max + 1024;
+	    match_list = xrealloc (match_list,
+				   match_list_max * sizeof (match_list[0]));
+	  }
+	match_list[nmatch_list++] = cnt;
+      }
+
+  size_t len = nmatch_list - start;
+  range[0] = len == 0 ? 0 : start;
+  range[1] = len == 0 ? 0 : nmatch_list;
+
+  const char *last = (const char *) &match_list[start];
+  const char *found = (const char *) match_list;
+  while (len > 0
+	 && (found = memmem (found, last - found + len * 2 - 2,
+			     last, len * 2)) != NULL
+	 && found != last)
+    {
+      if ((found - (const char *) match_list) % 2 == 0)
+	{
+	  range[0] = (const uint16_t *) found - match_list;
+	  range[1] = range[0] + len;
+	  nmatch_list = start;
+	  break;
+	}
+      ++found;
+    }
+}
+
+/* The nodes of the dispatch tables.  Each maps the next opcode byte
+   to a range in match_list and possibly to the node for the byte
+   after it.  */
+static size_t (*match_range)[256][2];
+static size_t (*match_next)[256];
+static size_t nmatch_nodes;
+
+/* A list longer than this is split by the next opcode byte, up to
+   MATCH_DEPTH bytes deep.  */
+#define MATCH_SPLIT 8
+#define MATCH_DEPTH 3
+
+static size_t
+dispatch_node (uint8_t *op, size_t n)
+{
+  size_t node = nmatch_nodes++;
+  match_range = xrealloc (match_range, nmatch_nodes * sizeof (*match_range));
+  match_next = xrealloc (match_next, nmatch_nodes * sizeof (*match_next));
+
+  for (unsigned int b = 0; b < 256; ++b)
+    {
+      op[n] = b;
+      match_list_out (op, n + 1, match_range[node][b]);
+      match_next[node][b] = 0;
+      if (n + 1 < MATCH_DEPTH
+	  && match_range[node][b][1] - match_range[node][b][0] > MATCH_SPLIT)
+	{
+	  size_t next = dispatch_node (op, n + 1);
+	  match_next[node][b] = next;
+	}
+    }
+
+  return node;
+}
+
+/* Write out the dispatch tables which find the instructions that can
+   match an opcode without trying all of match_data.  The first opcode
+   byte selects a list of candidates.  If that list is long the next
+   byte selects a shorter one, as for the escape byte 0x0f and for the
+   groups of instructions told apart by the reg field of the ModRM
+   byte.  Mandatory prefixes are taken care of as part of the opcode
+   since the disassembler matches them against the last prefix.  */
+static void
+dispatch_out (void)
+{
+  uint8_t op[MATCH_DEPTH];
+  dispatch_node (op, 0);
+
+  assert (nmatch_bytes <= UINT16_MAX && nmatch_list <= UINT16_MAX
+	  && nmatch_nodes <= UINT8_MAX);
+
+  fputs ("static const uint16_t match_off[] =\n{", outfile);
+  for (size_t cnt = 0; cnt < ninstructions; ++cnt)
+    fprintf (outfile, "%s %zu,", cnt % 8 == 0 ? "\n " : "", match_off[cnt]);
+  fputs ("\n};\n", outfile);
+
+  fputs ("static const uint16_t match_list[] =\n{", outfile);
+  for (size_t cnt = 0; cnt < nmatch_list; ++cnt)
+    fprintf (outfile, "%s %" PRIu16 ",", cnt % 8 == 0 ? "\n " : "",
+	     match_list[cnt]);
+  fputs ("\n};\n", outfile);
+
+  fprintf (outfile, "static const uint16_t match_range[%zu][256][2] =\n{\n",
+	   nmatch_nodes);
+  for (size_t node = 0; node < nmatch_nodes; ++node)
+    {
+      fputs ("  {\n", outfile);
+      for (unsigned int b = 0; b < 256; ++b)
+	if (match_range[node][b][1] != 0)
+	  fprintf (outfile, "    [%#x] = { %zu, %zu },\n", b,
+		   match_range[node][b][0], match_range[node][b][1]);
+      fputs ("  },\n", outfile);
+    }
+  fputs ("};\n", outfile);
+
+  fprintf (outfile, "static const uint8_t match_next[%zu][256] =\n{\n",
+	   nmatch_nodes);
+  for (size_t node = 0; node < nmatch_nodes; ++node)
+    {
+      fputs ("  {\n", outfile);
+      for (unsigned int b = 0; b < 256; ++b)
+	if (match_next[node][b] != 0)
+	  fprintf (outfile, "    [%#x] = %zu,\n", b, match_next[node][b]);
+      fputs ("  },\n", outfile);
+    }
+  fputs ("};\n", outfile);
+}
+
 static void
 instrtable_out (void)
 {
@@ -1242,6 +1446,7 @@ instrtable_out (void)
   fputs ("};\n", outfile);
 
   fputs ("static const uint8_t match_data[] =\n{\n", outfile);
+  match_off = xmalloc (ninstructions * sizeof (match_off[0]));
   size_t cnt = 0;
   for (instr = instructions; instr != NULL; instr = instr->next, ++cnt)
     {
@@ -1276,7 +1481,9 @@ instrtable_out (void)
       assert (nbytes > 0);
       size_t leadingbytes = leadingbits / 8;
 
-      fprintf (outfile, "  %#zx,", nbytes | (leadingbytes << 4));
+      match_off[cnt] = nmatch_bytes;
+      fputc_unlocked (' ', outfile);
+      match_byte_out (nbytes | (leadingbytes << 4));
 
       /* Now create the mask and byte values.  */
       uint8_t byte = 0;
@@ -1294,12 +1501,14 @@ instrtable_out (void)
 		  if (leadingbytes > 0)
 		    {
 		      assert (mask == 0xff);
-		      fprintf (outfile, " %#" PRIx8 ",", byte);
+		      match_byte_out (byte);
 		      --leadingbytes;
 		    }
 		  else
-		    fprintf (outfile, " %#" PRIx8 ", %#" PRIx8 ",",
-			     mask, byte);
+		    {
+		      match_byte_out (mask);
+		      match_byte_out (byte);
+		    }
 		  byte = mask = nbits = 0;
 		  if (--nbytes == 0)
 		    break;
@@ -1312,8 +1521,8 @@ instrtable_out (void)
 	      unsigned long int remaining = b->field->bits;
 	      while (nbits + remaining > 8)
 		{
-		  fprintf (outfile, " %#" PRIx8 ", %#" PRIx8 ",",
-			   mask << (8 - nbits), byte << (8 - nbits));
+		  match_byte_out (mask << (8 - nbits));
+		  match_byte_out (byte << (8 - nbits));
 		  remaining = nbits + remaining - 8;
 		  byte = mask = nbits = 0;
 		  if (--nbytes == 0)
@@ -1324,7 +1533,8 @@ instrtable_out (void)
 	      nbits += remaining;
 	      if (nbits == 8)
 		{
-		  fprintf (outfile, " %#" PRIx8 ", %#" PRIx8 ",", mask, byte);
+		  match_byte_out (mask);
+		  match_byte_out (byte);
 		  byte = mask = nbits = 0;
 		  if (--nbytes == 0)
 		    break;
@@ -1336,6 +1546,9 @@ instrtable_out (void)
       fputc_unlocked ('\n', outfile);
     }
   fputs ("};\n", outfile);
+  assert (cnt == ninstructions);
+
+  dispatch_out ();
 }
 
 
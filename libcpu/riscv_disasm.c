@@ -108,12 +108,85 @@ static int compare_csr (const void *a, const void *b)
 }
 
 
-int
-riscv_disasm (Ebl *ebl,
-	      const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
-	      const char *fmt, DisasmOutputCB_t outcb,
-	      DisasmGetSymCB_t symcb __attribute__((unused)),
-	      void *outcbarg, void *symcbarg __attribute__((unused)))
+/* Fill in INSN for the instruction of LENGTH bytes at ADDR with the
+   mnemonic MNE and the operands OP as they are printed.  MNE is NULL
+   if the encoding is not known.  */
+static void
+decode_insn (DisasmInsn_t *insn, GElf_Addr addr, size_t length,
+	     const char *mne, char *op[5])
+{
+  insn->addr = addr;
+  insn->length = length;
+  insn->flags = 0;
+  insn->target = 0;
+  insn->noperands = 0;
+
+  if (mne == NULL)
+    {
+      strcpy (insn->mnemonic, "invalid");
+      insn->flags = DISASM_INSN_INVALID;
+      return;
+    }
+  snprintf (insn->mnemonic, sizeof (insn->mnemonic), "%s", mne);
+
+  if (strcmp (mne, "j") == 0)
+    insn->flags = DISASM_INSN_JUMP;
+  else if (strcmp (mne, "jal") == 0)
+    insn->flags = DISASM_INSN_CALL;
+  else if (strcmp (mne, "jr") == 0)
+    insn->flags = DISASM_INSN_JUMP | DISASM_INSN_INDIRECT;
+  else if (strcmp (mne, "jalr") == 0)
+    insn->flags = DISASM_INSN_CALL | DISASM_INSN_INDIRECT;
+  else if (strcmp (mne, "ret") == 0)
+    insn->flags = DISASM_INSN_RETURN;
+  else if (mne[0] == 'b')
+    insn->flags = DISASM_INSN_JUMP | DISASM_INSN_COND;
+
+  for (size_t i = 0; i < 5 && insn->noperands < DISASM_MAX_OPERANDS; ++i)
+    {
+      if (op[i] == NULL)
+	continue;
+
+      int kind;
+      int64_t value = -1;
+      if (isdigit (op[i][0]) || op[i][0] == '-')
+	{
+	  char *endp;
+	  value = strtoull (op[i], &endp, 0);
+	  kind = *endp == '(' ? DISASM_OP_MEM : DISASM_OP_IMM;
+	}
+      else
+	{
+	  kind = DISASM_OP_REG;
+	  for (int n = 0; n < 32; ++n)
+	    if (op[i] == regnames[n] || op[i] == fregnames[n])
+	      value = n;
+	}
+
+      /* Direct jumps and calls print the target last.  */
+      if (kind == DISASM_OP_IMM
+	  && (insn->flags & (DISASM_INSN_JUMP | DISASM_INSN_CALL)) != 0
+	  && (insn->flags & DISASM_INSN_INDIRECT) == 0)
+	{
+	  kind = DISASM_OP_TARGET;
+	  insn->target = value;
+	}
+
+      insn->operands[insn->noperands].kind = kind;
+      insn->operands[insn->noperands].size = 0;
+      insn->operands[insn->noperands].value = value;
+      ++insn->noperands;
+    }
+}
+
+
+/* Disassemble with FMT, or if DECODE is true decode the first
+   instruction into INSN.  */
+static inline int
+__attribute__ ((always_inline))
+disasm_insns (Ebl *ebl, const uint8_t **startp, const uint8_t *end,
+	      GElf_Addr addr, const char *fmt, DisasmOutputCB_t outcb,
+	      void *outcbarg, bool decode, DisasmInsn_t *insn)
 {
   const char *const save_fmt = fmt;
 
@@ -163,6 +236,12 @@ riscv_disasm (Ebl *ebl,
 	  break;
 	}
 
+      if (decode && insn == NULL)
+	{
+	  *startp = data + length;
+	  break;
+	}
+
       char *mne = NULL;
       char mnebuf[32];
       char *op[5] = { NULL, NULL, NULL, NULL, NULL };
@@ -1311,6 +1390,13 @@ riscv_disasm (Ebl *ebl,
 	  len = cp - mnebuf;
 	}
 
+      if (decode)
+	{
+	  decode_insn (insn, addr, length, strp == NULL ? mne : NULL, op);
+	  *startp = data + length;
+	  break;
+	}
+
       if (strp == NULL)
 	{
 
@@ -1499,3 +1585,28 @@ riscv_disasm (Ebl *ebl,
 
   return retval;
 }
+
+
+int
+riscv_disasm (Ebl *ebl,
+	      const uint8_t **startp, const uint8_t *end, GElf_Addr addr,
+	      const char *fmt, DisasmOutputCB_t outcb,
+	      DisasmGetSymCB_t symcb __attribute__((unused)),
+	      void *outcbarg, void *symcbarg __attribute__((unused)))
+{
+  return disasm_insns (ebl, startp, end, addr, fmt, outcb, outcbarg,
+		       false, NULL);
+}
+
+
+int
+riscv_disasm_decode (Ebl *ebl, const uint8_t **startp, const uint8_t *end,
+		     GElf_Addr addr, DisasmInsn_t *insn)
+{
+  const uint8_t *start = *startp;
+  int res = disasm_insns (ebl, startp, end, addr, NULL, NULL, NULL, true,
+			  insn);
+  if (res == 0 && *startp == start)
+    res = -1;
+  return res;
+}
@@ -28,6 +28,7 @@
    not, see <http://www.gnu.org/licenses/>.  */
 
 #define i386_disasm x86_64_disasm
+#define i386_disasm_decode x86_64_disasm_decode
 #define DISFILE "x86_64_dis.h"
 #define MNEFILE "x86_64.mnemonics"
 #define X86_64
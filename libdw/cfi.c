@@ -309,8 +309,11 @@ execute_cfi (Dwarf_CFI *cache,
 
 	  if (unlikely (abi_cfi) && likely (opcode == DW_CFA_restore))
 	    {
-	      /* Special case hack to give backend abi_cfi a shorthand.  */
-	      cache->default_same_value = true;
+	      /* Special case hack to give backend abi_cfi a shorthand.
+		 Every CIE runs the same abi_cfi, so only the first one
+		 needs to store it while other threads might read it.  */
+	      if (! cache->default_same_value)
+		cache->default_same_value = true;
 	      continue;
 	    }
 
@@ -438,12 +441,14 @@ execute_cfi (Dwarf_CFI *cache,
   return result;
 }
 
+/* The lock of CACHE must be held for writing.  */
 static int
-cie_cache_initial_state (Dwarf_CFI *cache, struct dwarf_cie *cie)
+cie_compute_initial_state (Dwarf_CFI *cache, struct dwarf_cie *cie)
 {
   int result = DWARF_E_NOERROR;
 
-  if (likely (cie->initial_state != NULL))
+  /* Another thread might have done it already.  */
+  if (cie->initial_state != NULL)
     return result;
 
   /* This CIE has not been used before.  Play out its initial
@@ -506,6 +511,22 @@ cie_cache_initial_state (Dwarf_CFI *cache, struct dwarf_cie *cie)
   return result;
 }
 
+static int
+cie_cache_initial_state (Dwarf_CFI *cache, struct dwarf_cie *cie)
+{
+  pthread_rwlock_rdlock (&cache->lock);
+  const Dwarf_Frame *initial_state = cie->initial_state;
+  pthread_rwlock_unlock (&cache->lock);
+  if (likely (initial_state != NULL))
+    return DWARF_E_NOERROR;
+
+  pthread_rwlock_wrlock (&cache->lock);
+  int result = cie_compute_initial_state (cache, cie);
+  pthread_rwlock_unlock (&cache->lock);
+
+  return result;
+}
+
 int
 internal_function
 __libdw_frame_at_address (Dwarf_CFI *cache, struct dwarf_fde *fde,
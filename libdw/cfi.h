@@ -98,6 +98,10 @@ struct Dwarf_CFI_s
   /* Search tree for parsed DWARF expressions, indexed by raw pointer.  */
   void *expr_tree;
 
+  /* Lock for the search trees, next_offset and the initial states
+     of the CIEs, which are all filled in as the CFI is used.  */
+  pthread_rwlock_t lock;
+
   /* Backend hook.  */
   struct ebl *ebl;
 
@@ -49,15 +49,14 @@ get_type (Dwarf_Die *die, Dwarf_Attribute *attr_mem, Dwarf_Die *type_mem)
 static int aggregate_size (Dwarf_Die *die, Dwarf_Word *size,
 			   Dwarf_Die *type_mem, int depth);
 
-static int
-array_size (Dwarf_Die *die, Dwarf_Word *size,
-	    Dwarf_Attribute *attr_mem, int depth)
+int
+internal_function
+__libdw_array_layout (Dwarf_Die *die, Dwarf_Word eltsize,
+		      Dwarf_Word *countp, Dwarf_Word *stridep)
 {
-  Dwarf_Word eltsize;
-  Dwarf_Die type_mem, aggregate_type_mem;
-  if (aggregate_size (get_type (die, attr_mem, &type_mem), &eltsize,
-		      &aggregate_type_mem, depth) != 0)
-      return -1;
+  Dwarf_Attribute attr;
+  Dwarf_Attribute *attr_mem = &attr;
+  Dwarf_Die type_mem;
 
   /* An array can have DW_TAG_subrange_type or DW_TAG_enumeration_type
      children instead that give the size of each dimension.  */
@@ -198,7 +197,26 @@ array_size (Dwarf_Die *die, Dwarf_Word *size,
       stride /= 8;
     }
 
-  *size = count_total * stride;
+  *countp = count_total;
+  *stridep = stride;
+  return 0;
+}
+
+static int
+array_size (Dwarf_Die *die, Dwarf_Word *size,
+	    Dwarf_Attribute *attr_mem, int depth)
+{
+  Dwarf_Word eltsize;
+  Dwarf_Die type_mem, aggregate_type_mem;
+  if (aggregate_size (get_type (die, attr_mem, &type_mem), &eltsize,
+		      &aggregate_type_mem, depth) != 0)
+      return -1;
+
+  Dwarf_Word count, stride;
+  if (__libdw_array_layout (die, eltsize, &count, &stride) != 0)
+    return -1;
+
+  *size = count * stride;
   return 0;
 }
 
@@ -355,6 +355,9 @@ valid_p (Dwarf *result)
 	    = (result->sectiondata[IDX_debug_loc]->d_buf
 	       + result->sectiondata[IDX_debug_loc]->d_size);
 	  result->fake_loc_cu->locs = NULL;
+	  result->fake_loc_cu->loclists = NULL;
+	  result->fake_loc_cu->ranges = NULL;
+	  result->fake_loc_cu->types = NULL;
 	  result->fake_loc_cu->address_size = elf_addr_size;
 	  result->fake_loc_cu->offset_size = 4;
 	  result->fake_loc_cu->version = 4;
@@ -383,6 +386,9 @@ valid_p (Dwarf *result)
 	    = (result->sectiondata[IDX_debug_loclists]->d_buf
 	       + result->sectiondata[IDX_debug_loclists]->d_size);
 	  result->fake_loclists_cu->locs = NULL;
+	  result->fake_loclists_cu->loclists = NULL;
+	  result->fake_loclists_cu->ranges = NULL;
+	  result->fake_loclists_cu->types = NULL;
 	  result->fake_loclists_cu->address_size = elf_addr_size;
 	  result->fake_loclists_cu->offset_size = 4;
 	  result->fake_loclists_cu->version = 5;
@@ -416,6 +422,9 @@ valid_p (Dwarf *result)
 	    = (result->sectiondata[IDX_debug_addr]->d_buf
 	       + result->sectiondata[IDX_debug_addr]->d_size);
 	  result->fake_addr_cu->locs = NULL;
+	  result->fake_addr_cu->loclists = NULL;
+	  result->fake_addr_cu->ranges = NULL;
+	  result->fake_addr_cu->types = NULL;
 	  result->fake_addr_cu->address_size = elf_addr_size;
 	  result->fake_addr_cu->offset_size = 4;
 	  result->fake_addr_cu->version = 5;
@@ -579,6 +588,21 @@ dwarf_begin_elf (Elf *elf, Dwarf_Cmd cmd, Elf_Scn *scngrp)
       __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
       return NULL;
     }
+  if (pthread_rwlock_init(&result->files_lines_rwl, NULL) != 0)
+    {
+      pthread_rwlock_destroy (&result->mem_rwl);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
+      return NULL;
+    }
+  if (pthread_rwlock_init(&result->cu_cache_rwl, NULL) != 0)
+    {
+      pthread_rwlock_destroy (&result->files_lines_rwl);
+      pthread_rwlock_destroy (&result->mem_rwl);
+      free (result);
+      __libdw_seterrno (DWARF_E_NOMEM); /* no memory.  */
+      return NULL;
+    }
   result->mem_stacks = 0;
   result->mem_tails = NULL;
 
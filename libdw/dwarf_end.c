@@ -63,6 +63,9 @@ cu_free (void *arg)
   struct Dwarf_CU *p = (struct Dwarf_CU *) arg;
 
   tdestroy (p->locs, noop_free);
+  tdestroy (p->loclists, noop_free);
+  tdestroy (p->ranges, noop_free);
+  tdestroy (p->types, noop_free);
 
   /* Only free the CU internals if its not a fake CU.  */
   if(p != p->dbg->fake_loc_cu && p != p->dbg->fake_loclists_cu
@@ -128,6 +131,8 @@ dwarf_end (Dwarf *dwarf)
       if (dwarf->mem_tails != NULL)
         free (dwarf->mem_tails);
       pthread_rwlock_destroy (&dwarf->mem_rwl);
+      pthread_rwlock_destroy (&dwarf->files_lines_rwl);
+      pthread_rwlock_destroy (&dwarf->cu_cache_rwl);
 
       /* Free the pubnames helper structure.  */
       free (dwarf->pubnames_sets);
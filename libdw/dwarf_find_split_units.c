@@ -0,0 +1,128 @@
+/* Find the split units of all skeleton units.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include "libdwP.h"
+#include "parallel.h"
+
+
+/* A skeleton unit and where its dwo file might be.  */
+struct split_file
+{
+  Dwarf_CU *cu;
+  char *paths[2];
+  Dwarf_CU *split;
+};
+
+
+static void
+open_split_file (void *arg, size_t i)
+{
+  struct split_file *file = &((struct split_file *) arg)[i];
+  for (int p = 0; p < 2 && file->split == NULL; ++p)
+    if (file->paths[p] != NULL)
+      file->split = __libdw_open_split_file (file->cu, file->paths[p]);
+}
+
+
+int
+dwarf_find_split_units (Dwarf *dwarf, unsigned int jobs)
+{
+  if (dwarf == NULL)
+    return -1;
+
+  /* Reading the skeleton units is not thread safe, so first collect
+     the dwo paths of those which are not in the dwp file and were not
+     looked up before.  */
+  struct split_file *files = NULL;
+  size_t nfiles = 0;
+  size_t nalloc = 0;
+  int result = 0;
+  Dwarf_CU *cu = NULL;
+  int res;
+  while ((res = INTUSE(dwarf_get_units) (dwarf, cu, &cu, NULL, NULL,
+					 NULL, NULL)) == 0)
+    {
+      if (cu->unit_type != DW_UT_skeleton)
+	continue;
+
+      if (cu->split == (Dwarf_CU *) -1)
+	__libdw_try_dwp_file (cu);
+      if (cu->split != (Dwarf_CU *) -1)
+	{
+	  result += cu->split != NULL;
+	  continue;
+	}
+
+      if (nfiles == nalloc)
+	{
+	  nalloc = nalloc == 0 ? 64 : 2 * nalloc;
+	  struct split_file *newp = realloc (files, nalloc * sizeof *files);
+	  if (newp == NULL)
+	    {
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      res = -1;
+	      break;
+	    }
+	  files = newp;
+	}
+      files[nfiles].cu = cu;
+      files[nfiles].paths[0] = __libdw_dwo_path (cu, false);
+      files[nfiles].paths[1] = __libdw_dwo_path (cu, true);
+      files[nfiles].split = NULL;
+      ++nfiles;
+    }
+
+  /* Each dwo file gets its own Dwarf and is closed as soon as it has
+     been read, so only as many files as threads are open at once.  */
+  if (res >= 0)
+    run_parallel (jobs == 0 ? default_jobs () : jobs, nfiles, open_split_file, files);
+
+  for (size_t i = 0; i < nfiles; ++i)
+    {
+      cu = files[i].cu;
+      if (files[i].split != NULL)
+	__libdw_link_split_file (cu, files[i].split);
+      if (cu->split != (Dwarf_CU *) -1)
+	++result;
+      else if (res >= 0)
+	/* Don't try again, as __libdw_find_split_unit would.  */
+	cu->split = NULL;
+      free (files[i].paths[0]);
+      free (files[i].paths[1]);
+    }
+  free (files);
+
+  return res < 0 ? -1 : result;
+}
+INTDEF (dwarf_find_split_units)
@@ -60,7 +60,8 @@ dwarf_frame_cfa (Dwarf_Frame *fs, Dwarf_Op **ops, size_t *nops)
       result = __libdw_intern_expression
 	(NULL, fs->cache->other_byte_order,
 	 fs->cache->e_ident[EI_CLASS] == ELFCLASS32 ? 4 : 8, 4,
-	 &fs->cache->expr_tree, &fs->cfa_data.expr, false, false,
+	 &fs->cache->expr_tree, &fs->cache->lock, &fs->cfa_data.expr,
+	 false, false,
 	 ops, nops, IDX_debug_frame);
       break;
 
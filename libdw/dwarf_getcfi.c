@@ -70,6 +70,12 @@ dwarf_getcfi (Dwarf *dbg)
 
       cfi->ebl = NULL;
 
+      if (pthread_rwlock_init (&cfi->lock, NULL) != 0)
+	{
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return NULL;
+	}
+
       dbg->cfi = cfi;
     }
 
@@ -68,6 +68,13 @@ allocate_cfi (Elf *elf, const GElf_Ehdr *ehdr, GElf_Addr vaddr)
   cfi->textrel = 0;		/* XXX ? */
   cfi->datarel = 0;		/* XXX ? */
 
+  if (pthread_rwlock_init (&cfi->lock, NULL) != 0)
+    {
+      free (cfi);
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+
   return cfi;
 }
 
@@ -33,6 +33,7 @@
 #include <dwarf.h>
 #include <search.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 #include <libdwP.h>
@@ -139,7 +140,8 @@ loc_compare (const void *p1, const void *p2)
    This points us directly to the block data for later fetching.
    Returns zero on success, -1 on bad DWARF or 1 if tsearch failed.  */
 static int
-store_implicit_value (Dwarf *dbg, void **cache, Dwarf_Op *op)
+store_implicit_value (Dwarf *dbg, void **cache, pthread_rwlock_t *lock,
+		      Dwarf_Op *op)
 {
   if (dbg == NULL)
     return -1;
@@ -154,7 +156,10 @@ store_implicit_value (Dwarf *dbg, void **cache, Dwarf_Op *op)
   block->addr = op;
   block->data = (unsigned char *) data;
   block->length = op->number;
-  if (unlikely (tsearch (block, cache, loc_compare) == NULL))
+  pthread_rwlock_wrlock (lock);
+  void *res = tsearch (block, cache, loc_compare);
+  pthread_rwlock_unlock (lock);
+  if (unlikely (res == NULL))
     return 1;
   return 0;
 }
@@ -167,15 +172,18 @@ dwarf_getlocation_implicit_value (Dwarf_Attribute *attr, const Dwarf_Op *op,
     return -1;
 
   struct loc_block_s fake = { .addr = (void *) op };
+  pthread_rwlock_rdlock (&attr->cu->dbg->cu_cache_rwl);
   struct loc_block_s **found = tfind (&fake, &attr->cu->locs, loc_compare);
-  if (unlikely (found == NULL))
+  struct loc_block_s *block = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&attr->cu->dbg->cu_cache_rwl);
+  if (unlikely (block == NULL))
     {
       __libdw_seterrno (DWARF_E_NO_BLOCK);
       return -1;
     }
 
-  return_block->length = (*found)->length;
-  return_block->data = (*found)->data;
+  return_block->length = block->length;
+  return_block->data = block->data;
   return 0;
 }
 
@@ -210,10 +218,14 @@ is_constant_offset (Dwarf_Attribute *attr,
     }
 
   /* Check whether we already cached this location.  */
+  Dwarf *dbg = attr->cu->dbg;
   struct loc_s fake = { .addr = attr->valp };
+  pthread_rwlock_rdlock (&dbg->cu_cache_rwl);
   struct loc_s **found = tfind (&fake, &attr->cu->locs, loc_compare);
+  struct loc_s *loc = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&dbg->cu_cache_rwl);
 
-  if (found == NULL)
+  if (loc == NULL)
     {
       Dwarf_Word offset;
       if (INTUSE(dwarf_formudata) (attr, &offset) != 0)
@@ -235,14 +247,23 @@ is_constant_offset (Dwarf_Attribute *attr,
       newp->loc = result;
       newp->nloc = 1;
 
+      /* Another thread might have added it in the meantime.  */
+      pthread_rwlock_wrlock (&dbg->cu_cache_rwl);
       found = tsearch (newp, &attr->cu->locs, loc_compare);
+      loc = found != NULL ? *found : NULL;
+      pthread_rwlock_unlock (&dbg->cu_cache_rwl);
+      if (unlikely (loc == NULL))
+	{
+	  __libdw_seterrno (DWARF_E_NOMEM);
+	  return -1;
+	}
     }
 
-  assert ((*found)->nloc == 1);
+  assert (loc->nloc == 1);
 
   if (llbuf != NULL)
     {
-      *llbuf = (*found)->loc;
+      *llbuf = loc->loc;
       *listlen = 1;
     }
 
@@ -253,8 +274,8 @@ int
 internal_function
 __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
 			   unsigned int address_size, unsigned int ref_size,
-			   void **cache, const Dwarf_Block *block,
-			   bool cfap, bool valuep,
+			   void **cache, pthread_rwlock_t *lock,
+			   const Dwarf_Block *block, bool cfap, bool valuep,
 			   Dwarf_Op **llbuf, size_t *listlen, int sec_index)
 {
   /* Empty location expressions don't have any ops to intern.  */
@@ -266,12 +287,15 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
 
   /* Check whether we already looked at this list.  */
   struct loc_s fake = { .addr = block->data };
+  pthread_rwlock_rdlock (lock);
   struct loc_s **found = tfind (&fake, cache, loc_compare);
-  if (found != NULL)
+  struct loc_s *cached = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (lock);
+  if (cached != NULL)
     {
       /* We already saw it.  */
-      *llbuf = (*found)->loc;
-      *listlen = (*found)->nloc;
+      *llbuf = cached->loc;
+      *listlen = cached->nloc;
 
       if (valuep)
 	{
@@ -621,7 +645,7 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
 
       if (result[n].atom == DW_OP_implicit_value)
 	{
-	  int store = store_implicit_value (dbg, cache, &result[n]);
+	  int store = store_implicit_value (dbg, cache, lock, &result[n]);
 	  if (unlikely (store != 0))
 	    {
 	      if (store < 0)
@@ -655,7 +679,23 @@ __libdw_intern_expression (Dwarf *dbg, bool other_byte_order,
   newp->addr = block->data;
   newp->loc = result;
   newp->nloc = *listlen;
-  (void) tsearch (newp, cache, loc_compare);
+
+  /* Another thread might have interned the same expression in the
+     meantime, then use that one.  */
+  pthread_rwlock_wrlock (lock);
+  found = tsearch (newp, cache, loc_compare);
+  cached = found != NULL ? *found : newp;
+  pthread_rwlock_unlock (lock);
+  if (cached != newp)
+    {
+      *llbuf = cached->loc;
+      *listlen = cached->nloc;
+      if (dbg == NULL)
+	{
+	  free (result);
+	  free (newp);
+	}
+    }
 
   /* We did it.  */
   return 0;
@@ -677,7 +717,7 @@ getlocation (struct Dwarf_CU *cu, const Dwarf_Block *block,
 				    cu->address_size, (cu->version == 2
 						       ? cu->address_size
 						       : cu->offset_size),
-				    &cu->locs, block,
+				    &cu->locs, &cu->dbg->cu_cache_rwl, block,
 				    false, false,
 				    llbuf, listlen, sec_index);
 }
@@ -892,6 +932,93 @@ getlocations_addr (Dwarf_Attribute *attr, ptrdiff_t offset,
   return readp - (unsigned char *) locs->d_buf;
 }
 
+/* Decode all entries of the location list of ATTR once and remember
+   them.  Returns NULL if any entry cannot be decoded, which is
+   remembered too.  */
+static struct loclist_s *
+getloclist (Dwarf_Attribute *attr)
+{
+  Dwarf *dbg = attr->cu->dbg;
+  struct loclist_s fake = { .addr = attr->valp };
+  pthread_rwlock_rdlock (&dbg->cu_cache_rwl);
+  struct loclist_s **found = tfind (&fake, &attr->cu->loclists, loc_compare);
+  struct loclist_s *cached = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&dbg->cu_cache_rwl);
+  if (cached != NULL)
+    return cached->nentries != (size_t) -1 ? cached : NULL;
+
+  Dwarf_Addr base = __libdw_cu_base_address (attr->cu);
+  if (base == (Dwarf_Addr) -1)
+    return NULL;
+
+  ptrdiff_t off;
+  if (initial_offset (attr, &off) != 0)
+    return NULL;
+
+  size_t secidx = attr->cu->version < 5 ? IDX_debug_loc : IDX_debug_loclists;
+  const Elf_Data *d = attr->cu->dbg->sectiondata[secidx];
+
+  struct loclist_entry *entries = NULL;
+  size_t nentries = 0;
+  size_t nalloc = 0;
+  bool nomem = false;
+  Dwarf_Addr start, end;
+  Dwarf_Op *expr;
+  size_t exprlen;
+  while ((off = getlocations_addr (attr, off, &base, &start, &end,
+				   (Dwarf_Addr) -1, d, &expr, &exprlen)) > 0)
+    {
+      if (nentries == nalloc)
+	{
+	  nalloc = nalloc == 0 ? 8 : 2 * nalloc;
+	  struct loclist_entry *newp = realloc (entries,
+						nalloc * sizeof *entries);
+	  if (newp == NULL)
+	    {
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      nomem = true;
+	      off = -1;
+	      break;
+	    }
+	  entries = newp;
+	}
+      entries[nentries].start = start;
+      entries[nentries].end = end;
+      entries[nentries].expr = expr;
+      entries[nentries].exprlen = exprlen;
+      ++nentries;
+    }
+
+  /* A list that cannot be decoded is remembered without entries, so
+     it is not tried again.  Running out of memory might not last.  */
+  struct loclist_s *list = NULL;
+  if (! nomem)
+    {
+      if (off != 0)
+	nentries = 0;
+      list = libdw_alloc (attr->cu->dbg, struct loclist_s,
+			  sizeof (struct loclist_s)
+			  + nentries * sizeof *entries, 1);
+      list->addr = attr->valp;
+      list->nentries = off == 0 ? nentries : (size_t) -1;
+      if (nentries > 0)
+	memcpy (list->entries, entries, nentries * sizeof *entries);
+      /* Another thread might have decoded it in the meantime.  */
+      pthread_rwlock_wrlock (&dbg->cu_cache_rwl);
+      found = tsearch (list, &attr->cu->loclists, loc_compare);
+      list = found != NULL ? *found : NULL;
+      pthread_rwlock_unlock (&dbg->cu_cache_rwl);
+      if (list == NULL)
+	__libdw_seterrno (DWARF_E_NOMEM);
+    }
+  free (entries);
+
+  if (list != NULL && list->nentries == (size_t) -1)
+    return NULL;
+
+  return list;
+}
+
 int
 dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
 			Dwarf_Op **llbufs, size_t *listlens, size_t maxlocs)
@@ -932,13 +1059,35 @@ dwarf_getlocation_addr (Dwarf_Attribute *attr, Dwarf_Addr address,
   if (result != 1)
     return result ?: 1;
 
+  /* This is a true loclistptr.  Usually the whole list is decoded only
+     once and then just searched.  */
+  size_t got = 0;
+  struct loclist_s *list = getloclist (attr);
+  if (list != NULL)
+    {
+      for (size_t i = 0; i < list->nentries && got < maxlocs; ++i)
+	if (address == (Dwarf_Word) -1
+	    || (address >= list->entries[i].start
+		&& address < list->entries[i].end))
+	  {
+	    if (llbufs != NULL)
+	      {
+		llbufs[got] = list->entries[i].expr;
+		listlens[got] = list->entries[i].exprlen;
+	      }
+	    ++got;
+	  }
+      return got;
+    }
+
+  /* Some entry could not be decoded.  Only fail if one that is asked
+     for is broken.  */
   Dwarf_Addr base, start, end;
   Dwarf_Op *expr;
   size_t expr_len;
   ptrdiff_t off = 0;
-  size_t got = 0;
 
-  /* This is a true loclistptr, fetch the initial base address and offset.  */
+  /* Fetch the initial base address and offset.  */
   base = __libdw_cu_base_address (attr->cu);
   if (base == (Dwarf_Addr) -1)
     return -1;
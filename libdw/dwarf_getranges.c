@@ -0,0 +1,179 @@
+/* Return all address ranges of a DIE at once.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <search.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libdwP.h"
+
+
+static int
+ranges_compare (const void *p1, const void *p2)
+{
+  const struct ranges_s *r1 = (const struct ranges_s *) p1;
+  const struct ranges_s *r2 = (const struct ranges_s *) p2;
+
+  if ((uintptr_t) r1->addr < (uintptr_t) r2->addr)
+    return -1;
+  if ((uintptr_t) r1->addr > (uintptr_t) r2->addr)
+    return 1;
+
+  return 0;
+}
+
+static int
+range_start_compare (const void *p1, const void *p2)
+{
+  const Dwarf_Range *r1 = (const Dwarf_Range *) p1;
+  const Dwarf_Range *r2 = (const Dwarf_Range *) p2;
+
+  if (r1->start < r2->start)
+    return -1;
+  if (r1->start > r2->start)
+    return 1;
+
+  return 0;
+}
+
+const Dwarf_Range *
+internal_function
+__libdw_cached_ranges (Dwarf_Die *die, size_t *nrangesp)
+{
+  struct ranges_s fake = { .addr = die->addr };
+  pthread_rwlock_rdlock (&die->cu->dbg->cu_cache_rwl);
+  struct ranges_s **found = tfind (&fake, &die->cu->ranges, ranges_compare);
+  struct ranges_s *cached = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&die->cu->dbg->cu_cache_rwl);
+  if (cached == NULL)
+    return NULL;
+
+  *nrangesp = cached->nranges;
+  return cached->ranges;
+}
+
+int
+dwarf_getranges (Dwarf_Die *die, const Dwarf_Range **rangesp,
+		 size_t *nrangesp)
+{
+  if (die == NULL)
+    return -1;
+
+  Dwarf_CU *cu = die->cu;
+  if (cu == NULL)
+    {
+      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      return -1;
+    }
+
+  *rangesp = __libdw_cached_ranges (die, nrangesp);
+  if (*rangesp != NULL)
+    return 0;
+
+  /* Most DIEs have a single range, only use the heap for more.  */
+  Dwarf_Range one;
+  Dwarf_Range *ranges = &one;
+  size_t nranges = 0;
+  size_t nalloc = 1;
+
+  Dwarf_Addr base;
+  Dwarf_Addr start;
+  Dwarf_Addr end;
+  ptrdiff_t offset = 0;
+  while ((offset = INTUSE(dwarf_ranges) (die, offset, &base,
+					 &start, &end)) > 0)
+    {
+      if (start >= end)
+	continue;
+
+      if (nranges == nalloc)
+	{
+	  nalloc *= 2;
+	  Dwarf_Range *newp = malloc (nalloc * sizeof *ranges);
+	  if (newp == NULL)
+	    {
+	      __libdw_seterrno (DWARF_E_NOMEM);
+	      offset = -1;
+	      break;
+	    }
+	  memcpy (newp, ranges, nranges * sizeof *ranges);
+	  if (ranges != &one)
+	    free (ranges);
+	  ranges = newp;
+	}
+      ranges[nranges].start = start;
+      ranges[nranges].end = end;
+      ++nranges;
+    }
+
+  struct ranges_s *result = NULL;
+  if (offset == 0)
+    {
+      /* Sort and merge overlapping ranges, so a binary search finds
+	 whether an address is covered.  */
+      qsort (ranges, nranges, sizeof *ranges, range_start_compare);
+      size_t n = 0;
+      for (size_t i = 0; i < nranges; ++i)
+	if (n > 0 && ranges[i].start < ranges[n - 1].end)
+	  {
+	    if (ranges[i].end > ranges[n - 1].end)
+	      ranges[n - 1].end = ranges[i].end;
+	  }
+	else
+	  ranges[n++] = ranges[i];
+
+      result = libdw_alloc (cu->dbg, struct ranges_s,
+			    sizeof (struct ranges_s) + n * sizeof *ranges, 1);
+      result->addr = die->addr;
+      result->nranges = n;
+      memcpy (result->ranges, ranges, n * sizeof *ranges);
+
+      /* Another thread might have decoded them in the meantime.  */
+      pthread_rwlock_wrlock (&cu->dbg->cu_cache_rwl);
+      struct ranges_s **found = tsearch (result, &cu->ranges,
+					 ranges_compare);
+      result = found != NULL ? *found : NULL;
+      pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
+      if (result == NULL)
+	__libdw_seterrno (DWARF_E_NOMEM);
+    }
+
+  if (ranges != &one)
+    free (ranges);
+  if (result == NULL)
+    return -1;
+
+  *rangesp = result->ranges;
+  *nrangesp = result->nranges;
+  return 0;
+}
+INTDEF (dwarf_getranges)
@@ -30,7 +30,6 @@
 # include <config.h>
 #endif
 
-#include <assert.h>
 #include <dwarf.h>
 #include "libdwP.h"
 
@@ -46,11 +45,13 @@ dwarf_getsrcfiles (Dwarf_Die *cudie, Dwarf_Files **files, size_t *nfiles)
       return -1;
     }
 
-  int res = -1;
-
-  /* Get the information if it is not already known.  */
+  /* Get the information if it is not already known.  Other threads
+     might do the same for this CU, the first result is kept.  */
   struct Dwarf_CU *const cu = cudie->cu;
-  if (cu->files == NULL)
+  pthread_rwlock_rdlock (&cu->dbg->cu_cache_rwl);
+  Dwarf_Files *cufiles = cu->files;
+  pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
+  if (cufiles == NULL)
     {
       /* For split units there might be a simple file table (without lines).
 	 If not, use the one from the skeleton.  */
@@ -58,7 +59,7 @@ dwarf_getsrcfiles (Dwarf_Die *cudie, Dwarf_Files **files, size_t *nfiles)
 	  || cu->unit_type == DW_UT_split_type)
 	{
 	  /* We tried, assume we fail...  */
-	  cu->files = (void *) -1;
+	  Dwarf_Files *newfiles = (void *) -1l;
 
 	  /* See if there is a .debug_line section, for split CUs
 	     the table is at offset zero.  */
@@ -70,10 +71,10 @@ dwarf_getsrcfiles (Dwarf_Die *cudie, Dwarf_Files **files, size_t *nfiles)
 		{
 		  /* We are only interested in the files, the lines will
 		     always come from the skeleton.  */
-		  res = __libdw_getsrclines (cu->dbg, dwp_off,
-					     __libdw_getcompdir (cudie),
-					     cu->address_size, NULL,
-					     &cu->files);
+		  (void) __libdw_getsrclines (cu->dbg, dwp_off,
+					      __libdw_getcompdir (cudie),
+					      cu->address_size, NULL,
+					      &newfiles);
 		}
 	    }
 	  else
@@ -82,10 +83,15 @@ dwarf_getsrcfiles (Dwarf_Die *cudie, Dwarf_Files **files, size_t *nfiles)
 	      if (skel != NULL)
 		{
 		  Dwarf_Die skeldie = CUDIE (skel);
-		  res = INTUSE(dwarf_getsrcfiles) (&skeldie, files, nfiles);
-		  cu->files = skel->files;
+		  (void) INTUSE(dwarf_getsrcfiles) (&skeldie, &newfiles, NULL);
 		}
 	    }
+
+	  pthread_rwlock_wrlock (&cu->dbg->cu_cache_rwl);
+	  if (cu->files == NULL)
+	    cu->files = newfiles;
+	  cufiles = cu->files;
+	  pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
 	}
       else
 	{
@@ -94,23 +100,21 @@ dwarf_getsrcfiles (Dwarf_Die *cudie, Dwarf_Files **files, size_t *nfiles)
 
 	  /* Let the more generic function do the work.  It'll create more
 	     data but that will be needed in an real program anyway.  */
-	  res = INTUSE(dwarf_getsrclines) (cudie, &lines, &nlines);
+	  (void) INTUSE(dwarf_getsrclines) (cudie, &lines, &nlines);
+
+	  pthread_rwlock_rdlock (&cu->dbg->cu_cache_rwl);
+	  cufiles = cu->files;
+	  pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
 	}
     }
-  else if (cu->files != (void *) -1l)
-    /* We already have the information.  */
-    res = 0;
 
-  if (likely (res == 0))
-    {
-      assert (cu->files != NULL && cu->files != (void *) -1l);
-      *files = cu->files;
-      if (nfiles != NULL)
-	*nfiles = cu->files->nfiles;
-    }
+  if (cufiles == NULL || cufiles == (void *) -1l)
+    return -1;
 
-  // XXX Eventually: unlocking here.
+  *files = cufiles;
+  if (nfiles != NULL)
+    *nfiles = cufiles->nfiles;
 
-  return res;
+  return 0;
 }
 INTDEF (dwarf_getsrcfiles)
@@ -1144,9 +1144,12 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
 		     Dwarf_Lines **linesp, Dwarf_Files **filesp)
 {
   struct files_lines_s fake = { .debug_line_offset = debug_line_offset };
+  pthread_rwlock_rdlock (&dbg->files_lines_rwl);
   struct files_lines_s **found = tfind (&fake, &dbg->files_lines,
 					files_lines_compare);
-  if (found == NULL)
+  struct files_lines_s *fl = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&dbg->files_lines_rwl);
+  if (fl == NULL)
     {
       Elf_Data *data = __libdw_checked_get_data (dbg, IDX_debug_line);
       if (data == NULL
@@ -1166,8 +1169,13 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
 
       node->debug_line_offset = debug_line_offset;
 
+      /* Another thread might have decoded the same unit in the
+	 meantime, then use that one.  */
+      pthread_rwlock_wrlock (&dbg->files_lines_rwl);
       found = tsearch (node, &dbg->files_lines, files_lines_compare);
-      if (found == NULL)
+      fl = found != NULL ? *found : NULL;
+      pthread_rwlock_unlock (&dbg->files_lines_rwl);
+      if (fl == NULL)
 	{
 	  __libdw_seterrno (DWARF_E_NOMEM);
 	  return -1;
@@ -1175,10 +1183,10 @@ __libdw_getsrclines (Dwarf *dbg, Dwarf_Off debug_line_offset,
     }
 
   if (linesp != NULL)
-    *linesp = (*found)->lines;
+    *linesp = fl->lines;
 
   if (filesp != NULL)
-    *filesp = (*found)->files;
+    *filesp = fl->files;
 
   return 0;
 }
@@ -1205,63 +1213,71 @@ dwarf_getsrclines (Dwarf_Die *cudie, Dwarf_Lines **lines, size_t *nlines)
       return -1;
     }
 
-  /* Get the information if it is not already known.  */
+  /* Get the information if it is not already known.  Other threads
+     might do the same for this CU, the first result is kept.  */
   struct Dwarf_CU *const cu = cudie->cu;
-  if (cu->lines == NULL)
+  pthread_rwlock_rdlock (&cu->dbg->cu_cache_rwl);
+  Dwarf_Lines *culines = cu->lines;
+  pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
+  if (culines == NULL)
     {
+      /* Failsafe mode: no data found.  */
+      Dwarf_Lines *newlines = (void *) -1l;
+      Dwarf_Files *newfiles = (void *) -1l;
+
       /* For split units always pick the lines from the skeleton.  */
       if (cu->unit_type == DW_UT_split_compile
 	  || cu->unit_type == DW_UT_split_type)
 	{
-	  /* We tries, assume we fail...  */
-	  cu->lines = (void *) -1l;
+	  /* The files of a split unit might come from its own table,
+	     see dwarf_getsrcfiles.  */
+	  newfiles = NULL;
 
 	  Dwarf_CU *skel = __libdw_find_split_unit (cu);
 	  if (skel != NULL)
 	    {
 	      Dwarf_Die skeldie = CUDIE (skel);
-	      int res = INTUSE(dwarf_getsrclines) (&skeldie, lines, nlines);
-	      if (res == 0)
-		{
-		  cu->lines = skel->lines;
-		  *lines = cu->lines;
-		  *nlines = cu->lines->nlines;
-		}
-	      return res;
+	      size_t skelnlines;
+	      (void) INTUSE(dwarf_getsrclines) (&skeldie, &newlines,
+						&skelnlines);
 	    }
-
-	  __libdw_seterrno (DWARF_E_NO_DEBUG_LINE);
-	  return -1;
+	  else
+	    __libdw_seterrno (DWARF_E_NO_DEBUG_LINE);
+	}
+      else
+	{
+	  /* The die must have a statement list associated.  */
+	  Dwarf_Attribute stmt_list_mem;
+	  Dwarf_Attribute *stmt_list = INTUSE(dwarf_attr) (cudie,
+							   DW_AT_stmt_list,
+							   &stmt_list_mem);
+
+	  /* Get the offset into the .debug_line section.  NB: this call
+	     also checks whether the previous dwarf_attr call failed.  */
+	  Dwarf_Off debug_line_offset;
+	  if (__libdw_formptr (stmt_list, IDX_debug_line,
+			       DWARF_E_NO_DEBUG_LINE, NULL,
+			       &debug_line_offset) != NULL)
+	    (void) __libdw_getsrclines (cu->dbg, debug_line_offset,
+					__libdw_getcompdir (cudie),
+					cu->address_size,
+					&newlines, &newfiles);
 	}
 
-      /* Failsafe mode: no data found.  */
-      cu->lines = (void *) -1l;
-      cu->files = (void *) -1l;
-
-      /* The die must have a statement list associated.  */
-      Dwarf_Attribute stmt_list_mem;
-      Dwarf_Attribute *stmt_list = INTUSE(dwarf_attr) (cudie, DW_AT_stmt_list,
-						       &stmt_list_mem);
-
-      /* Get the offset into the .debug_line section.  NB: this call
-	 also checks whether the previous dwarf_attr call failed.  */
-      Dwarf_Off debug_line_offset;
-      if (__libdw_formptr (stmt_list, IDX_debug_line, DWARF_E_NO_DEBUG_LINE,
-			   NULL, &debug_line_offset) == NULL)
-	return -1;
-
-      if (__libdw_getsrclines (cu->dbg, debug_line_offset,
-			       __libdw_getcompdir (cudie),
-			       cu->address_size, &cu->lines, &cu->files) < 0)
-	return -1;
+      pthread_rwlock_wrlock (&cu->dbg->cu_cache_rwl);
+      if (cu->lines == NULL)
+	cu->lines = newlines;
+      if (cu->files == NULL && newfiles != NULL)
+	cu->files = newfiles;
+      culines = cu->lines;
+      pthread_rwlock_unlock (&cu->dbg->cu_cache_rwl);
     }
-  else if (cu->lines == (void *) -1l)
-    return -1;
 
-  *lines = cu->lines;
-  *nlines = cu->lines->nlines;
+  if (culines == (void *) -1l)
+    return -1;
 
-  // XXX Eventually: unlocking here.
+  *lines = culines;
+  *nlines = culines->nlines;
 
   return 0;
 }
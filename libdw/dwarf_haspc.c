@@ -40,15 +40,38 @@ dwarf_haspc (Dwarf_Die *die, Dwarf_Addr pc)
   if (die == NULL)
     return -1;
 
-  Dwarf_Addr base;
-  Dwarf_Addr begin;
-  Dwarf_Addr end;
-  ptrdiff_t offset = 0;
-  while ((offset = INTUSE(dwarf_ranges) (die, offset, &base,
-					 &begin, &end)) > 0)
-    if (pc >= begin && pc < end)
-      return 1;
-
-  return offset;
+  /* Noncontiguous ranges are decoded only once.  Usually there is a
+     single contiguous range though, which is quicker to check directly
+     than to remember.  */
+  size_t nranges;
+  const Dwarf_Range *ranges = NULL;
+  if (die->cu != NULL)
+    ranges = __libdw_cached_ranges (die, &nranges);
+  if (ranges == NULL)
+    {
+      Dwarf_Addr low;
+      Dwarf_Addr high;
+      if (INTUSE(dwarf_highpc) (die, &high) == 0
+	  && INTUSE(dwarf_lowpc) (die, &low) == 0)
+	return pc >= low && pc < high;
+
+      if (INTUSE(dwarf_getranges) (die, &ranges, &nranges) != 0)
+	return -1;
+    }
+
+  /* The ranges are sorted and don't overlap, so find the first one
+     which ends after PC.  */
+  size_t l = 0;
+  size_t u = nranges;
+  while (l < u)
+    {
+      size_t idx = (l + u) / 2;
+      if (ranges[idx].end <= pc)
+	l = idx + 1;
+      else
+	u = idx;
+    }
+
+  return l < nranges && ranges[l].start <= pc;
 }
 INTDEF (dwarf_haspc)
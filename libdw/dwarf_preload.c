@@ -0,0 +1,184 @@
+/* Read all lazily loaded data of a Dwarf at once.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include <stdlib.h>
+
+#include "libdwP.h"
+#include "parallel.h"
+
+
+/* Collect the units of DWARF, and the split units of its skeleton
+   units, into *UNITSP.  Returns the number of units or -1.  */
+static ssize_t
+collect_units (Dwarf *dwarf, Dwarf_CU ***unitsp)
+{
+  size_t n = 0;
+  size_t nalloc = 0;
+  Dwarf_CU *cu = NULL;
+  int res;
+  while ((res = INTUSE(dwarf_get_units) (dwarf, cu, &cu, NULL, NULL,
+					 NULL, NULL)) == 0)
+    for (int i = 0; i < 2; ++i)
+      {
+	Dwarf_CU *unit = cu;
+	if (i == 1)
+	  {
+	    if (cu->unit_type != DW_UT_skeleton)
+	      break;
+	    unit = __libdw_find_split_unit (cu);
+	    if (unit == NULL)
+	      break;
+	  }
+
+	if (n == nalloc)
+	  {
+	    nalloc = nalloc == 0 ? 64 : 2 * nalloc;
+	    Dwarf_CU **newp = realloc (*unitsp, nalloc * sizeof (Dwarf_CU *));
+	    if (newp == NULL)
+	      {
+		__libdw_seterrno (DWARF_E_NOMEM);
+		return -1;
+	      }
+	    *unitsp = newp;
+	  }
+	(*unitsp)[n++] = unit;
+      }
+
+  return res < 0 ? -1 : (ssize_t) n;
+}
+
+
+/* Read the abbreviations, line table and address ranges of a unit.
+   Errors are not reported, the same calls made later will report them
+   again.  */
+static void
+preload_unit (void *arg, size_t i)
+{
+  Dwarf_CU *cu = ((Dwarf_CU **) arg)[i];
+
+  /* Like __libdw_findabbrev, but until the end of the table.  */
+  while (cu->last_abbrev_offset != (size_t) -1l)
+    {
+      size_t length;
+      Dwarf_Abbrev *abb = __libdw_getabbrev (cu->dbg, cu,
+					     cu->last_abbrev_offset,
+					     &length, NULL);
+      if (abb == NULL || abb == DWARF_END_ABBREV)
+	cu->last_abbrev_offset = (size_t) -1l;
+      else
+	cu->last_abbrev_offset += length;
+    }
+
+  /* Type units only use the file names of their line table.  */
+  Dwarf_Die cudie = CUDIE (cu);
+  if (cu->unit_type == DW_UT_type || cu->unit_type == DW_UT_split_type)
+    {
+      Dwarf_Files *files;
+      size_t nfiles;
+      if (INTUSE(dwarf_hasattr) (&cudie, DW_AT_stmt_list))
+	(void) INTUSE(dwarf_getsrcfiles) (&cudie, &files, &nfiles);
+      return;
+    }
+
+  Dwarf_Lines *lines;
+  size_t nlines;
+  if (INTUSE(dwarf_hasattr) (&cudie, DW_AT_stmt_list))
+    (void) INTUSE(dwarf_getsrclines) (&cudie, &lines, &nlines);
+
+  const Dwarf_Range *ranges;
+  size_t nranges;
+  (void) INTUSE(dwarf_getranges) (&cudie, &ranges, &nranges);
+}
+
+
+static int
+preload (Dwarf *dwarf, unsigned int jobs)
+{
+  if (INTUSE(dwarf_find_split_units) (dwarf, jobs) < 0)
+    return -1;
+
+  Dwarf_CU **units = NULL;
+  ssize_t n = collect_units (dwarf, &units);
+  if (n < 0)
+    {
+      free (units);
+      return -1;
+    }
+
+  /* These are shared between skeleton and split units, and the
+     dwarf_cu_dwp_section_info lookups are not thread safe.  */
+  for (ssize_t i = 0; i < n; ++i)
+    {
+      Dwarf_CU *cu = units[i];
+      (void) __libdw_cu_base_address (cu);
+      (void) __libdw_cu_addr_base (cu);
+      (void) __libdw_cu_str_off_base (cu);
+      (void) __libdw_cu_ranges_base (cu);
+      (void) __libdw_cu_locs_base (cu);
+    }
+
+  run_parallel (jobs == 0 ? default_jobs () : jobs, n, preload_unit, units);
+
+  Dwarf_Aranges *aranges;
+  size_t naranges;
+  (void) INTUSE(dwarf_getaranges) (dwarf, &aranges, &naranges);
+
+  /* Later allocations start new blocks, also for the split units in
+     other Dwarf handles.  */
+  __libdw_alloc_seal (dwarf);
+  for (ssize_t i = 0; i < n; ++i)
+    if (units[i]->dbg != dwarf)
+      __libdw_alloc_seal (units[i]->dbg);
+
+  free (units);
+  return n;
+}
+
+
+int
+dwarf_preload (Dwarf *dwarf, unsigned int jobs)
+{
+  if (dwarf == NULL)
+    return -1;
+
+  int result = preload (dwarf, jobs);
+  if (result < 0)
+    return -1;
+
+  /* Also the units referred to in the alternate file, if there is one.  */
+  Dwarf *alt = INTUSE(dwarf_getalt) (dwarf);
+  if (alt != NULL && preload (alt, jobs) < 0)
+    return -1;
+
+  return result;
+}
@@ -0,0 +1,247 @@
+/* Peel types and compute their sizes, remembering the results.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <dwarf.h>
+#include <search.h>
+
+#include "libdwP.h"
+
+
+static int
+type_compare (const void *p1, const void *p2)
+{
+  const struct type_s *t1 = (const struct type_s *) p1;
+  const struct type_s *t2 = (const struct type_s *) p2;
+
+  if ((uintptr_t) t1->addr < (uintptr_t) t2->addr)
+    return -1;
+  if ((uintptr_t) t1->addr > (uintptr_t) t2->addr)
+    return 1;
+
+  return 0;
+}
+
+/* Arrays of typedefs of arrays... Don't recurse too deep.  */
+#define MAX_DEPTH 256
+
+static const Dwarf_Type_Info *type_info (Dwarf_Die *die, int depth);
+
+/* Get the info of the DW_AT_type of DIE, or NULL if that cannot be
+   read.  Returns -1 only when out of memory.  */
+static int
+target_info (Dwarf_Die *die, int depth, const Dwarf_Type_Info **target)
+{
+  Dwarf_Attribute attr_mem;
+  Dwarf_Die type_mem;
+  Dwarf_Die *type = INTUSE(dwarf_formref_die)
+    (INTUSE(dwarf_attr_integrate) (die, DW_AT_type, &attr_mem), &type_mem);
+
+  *target = NULL;
+  if (type == NULL)
+    return 0;
+
+  *target = type_info (type, depth + 1);
+  return *target == NULL ? -1 : 0;
+}
+
+/* Fill in INFO following the same rules as dwarf_peel_type and
+   dwarf_aggregate_size.  Returns -1 only when out of memory.  */
+static int
+compute_info (Dwarf_Die *die, int depth, Dwarf_Type_Info *info)
+{
+  Dwarf_Attribute attr_mem;
+  const Dwarf_Type_Info *target;
+
+  int tag = INTUSE(dwarf_tag) (die);
+  if (tag == DW_TAG_invalid || depth >= MAX_DEPTH)
+    return 0;
+
+  switch (tag)
+    {
+    case DW_TAG_typedef:
+    case DW_TAG_const_type:
+    case DW_TAG_volatile_type:
+    case DW_TAG_restrict_type:
+    case DW_TAG_atomic_type:
+    case DW_TAG_immutable_type:
+    case DW_TAG_packed_type:
+    case DW_TAG_shared_type:
+      /* Same as the type it aliases, unless there is none.  */
+      if (INTUSE(dwarf_attr_integrate) (die, DW_AT_type, &attr_mem) == NULL)
+	{
+	  info->peeled = 1;
+	  return 0;
+	}
+      if (target_info (die, depth, &target) != 0)
+	return -1;
+      if (target != NULL)
+	*info = *target;
+      return 0;
+    }
+
+  info->peeled = 0;
+
+  bool byte_size = (INTUSE(dwarf_attr_integrate) (die, DW_AT_byte_size,
+						  &attr_mem) != NULL);
+  if (byte_size)
+    info->has_size = INTUSE(dwarf_formudata) (&attr_mem, &info->size) == 0;
+
+  switch (tag)
+    {
+    case DW_TAG_subrange_type:
+      if (byte_size)
+	break;
+      if (target_info (die, depth, &target) != 0)
+	return -1;
+      if (target != NULL && target->peeled == 0 && target->has_size)
+	{
+	  info->size = target->size;
+	  info->has_size = true;
+	}
+      break;
+
+    case DW_TAG_array_type:
+      {
+	/* The stride is wanted even when the size is given directly.  */
+	if (target_info (die, depth, &target) != 0)
+	  return -1;
+	Dwarf_Word count;
+	if (target != NULL && target->peeled == 0 && target->has_size
+	    && __libdw_array_layout (die, target->size, &count,
+				     &info->stride) == 0
+	    && !byte_size)
+	  {
+	    info->size = count * info->stride;
+	    info->has_size = true;
+	  }
+	return 0;
+      }
+
+    /* Assume references and pointers have pointer size if not given an
+       explicit DW_AT_byte_size.  */
+    case DW_TAG_pointer_type:
+    case DW_TAG_reference_type:
+    case DW_TAG_rvalue_reference_type:
+      if (byte_size)
+	break;
+      info->size = die->cu->address_size;
+      info->has_size = true;
+      break;
+    }
+
+  if (info->has_size)
+    info->stride = info->size;
+  return 0;
+}
+
+static const Dwarf_Type_Info *
+type_info (Dwarf_Die *die, int depth)
+{
+  Dwarf *dbg = die->cu->dbg;
+  struct type_s fake = { .addr = die->addr };
+  pthread_rwlock_rdlock (&dbg->cu_cache_rwl);
+  struct type_s **found = tfind (&fake, &die->cu->types, type_compare);
+  struct type_s *cached = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&dbg->cu_cache_rwl);
+  if (cached != NULL)
+    return &cached->info;
+
+  Dwarf_Type_Info info =
+    {
+      .type = *die,
+      .peeled = -1,
+      .has_size = false,
+      .size = 0,
+      .stride = 0
+    };
+  if (compute_info (die, depth, &info) != 0)
+    return NULL;
+
+  struct type_s *newp = libdw_alloc (dbg, struct type_s,
+				     sizeof (struct type_s), 1);
+  newp->addr = die->addr;
+  newp->info = info;
+
+  /* A DW_AT_type loop or another thread might have added DIE on the
+     way already, then that is the one found.  */
+  pthread_rwlock_wrlock (&dbg->cu_cache_rwl);
+  found = tsearch (newp, &die->cu->types, type_compare);
+  cached = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&dbg->cu_cache_rwl);
+  if (cached == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+
+  return &cached->info;
+}
+
+int
+dwarf_type_info (Dwarf_Die *die, Dwarf_Type_Info *info)
+{
+  info->peeled = -1;
+  info->has_size = false;
+  info->size = 0;
+  info->stride = 0;
+
+  /* Ignore previous errors.  */
+  if (die == NULL)
+    return -1;
+
+  if (die->cu == NULL)
+    {
+      __libdw_seterrno (DWARF_E_INVALID_DWARF);
+      return -1;
+    }
+
+  const Dwarf_Type_Info *result = type_info (die, 0);
+  if (result == NULL)
+    return -1;
+
+  *info = *result;
+  if (info->peeled < 0)
+    __libdw_seterrno (DWARF_E_INVALID_DWARF);
+  return info->peeled;
+}
+INTDEF (dwarf_type_info)
+
+int
+dwarf_type_infos (Dwarf_Die *dies, size_t ndies, Dwarf_Type_Info *infos)
+{
+  int result = 0;
+  for (size_t i = 0; i < ndies; ++i)
+    if (INTUSE(dwarf_type_info) (&dies[i], &infos[i]) < 0)
+      result = -1;
+
+  return result;
+}
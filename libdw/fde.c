@@ -245,12 +245,12 @@ binary_search_fde (Dwarf_CFI *cache, Dwarf_Addr address)
   return (Dwarf_Off) -1l;
 }
 
-struct dwarf_fde *
-internal_function
-__libdw_find_fde (Dwarf_CFI *cache, Dwarf_Addr address)
+/* Find the FDE covering ADDRESS, reading more of the section if needed.
+   The lock of CACHE must be held for writing.  */
+static struct dwarf_fde *
+read_fde (Dwarf_CFI *cache, Dwarf_Addr address)
 {
-  /* Look for a cached FDE covering this address.  */
-
+  /* Another thread might have read it already.  */
   const struct dwarf_fde fde_key = { .start = address, .end = 0 };
   struct dwarf_fde **found = tfind (&fde_key, &cache->fde_tree, &compare_fde);
   if (found != NULL)
@@ -325,3 +325,25 @@ __libdw_find_fde (Dwarf_CFI *cache, Dwarf_Addr address)
   __libdw_seterrno (DWARF_E_NO_MATCH);
   return NULL;
 }
+
+struct dwarf_fde *
+internal_function
+__libdw_find_fde (Dwarf_CFI *cache, Dwarf_Addr address)
+{
+  /* Look for a cached FDE covering this address.  */
+
+  const struct dwarf_fde fde_key = { .start = address, .end = 0 };
+  pthread_rwlock_rdlock (&cache->lock);
+  struct dwarf_fde **found = tfind (&fde_key, &cache->fde_tree, &compare_fde);
+  struct dwarf_fde *fde = found != NULL ? *found : NULL;
+  pthread_rwlock_unlock (&cache->lock);
+  if (fde != NULL)
+    return fde;
+
+  /* Reading more entries changes the search trees.  */
+  pthread_rwlock_wrlock (&cache->lock);
+  fde = read_fde (cache, address);
+  pthread_rwlock_unlock (&cache->lock);
+
+  return fde;
+}
@@ -67,4 +67,6 @@ __libdw_destroy_frame_cache (Dwarf_CFI *cache)
 
   if (cache->ebl != NULL && cache->ebl != (void *) -1l)
     ebl_closebackend (cache->ebl);
+
+  pthread_rwlock_destroy (&cache->lock);
 }
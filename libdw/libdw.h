@@ -154,6 +154,26 @@ typedef struct
 } Dwarf_Op;
 
 
+/* A contiguous address range, from START up to but not including END.  */
+typedef struct
+{
+  Dwarf_Addr start;
+  Dwarf_Addr end;
+} Dwarf_Range;
+
+
+/* The peeled type of a DIE and its layout, see dwarf_type_info.  */
+typedef struct
+{
+  Dwarf_Die type;		/* As returned by dwarf_peel_type.  */
+  int peeled;			/* dwarf_peel_type result, -1 on error.  */
+  bool has_size;		/* Whether SIZE is known.  */
+  Dwarf_Word size;		/* As computed by dwarf_aggregate_size.  */
+  Dwarf_Word stride;		/* Distance between array elements, for
+				   other types SIZE.  Zero if unknown.  */
+} Dwarf_Type_Info;
+
+
 /* This describes one Common Information Entry read from a CFI section.
    Pointers here point into the DATA->d_buf block passed to dwarf_next_cfi.  */
 typedef struct
@@ -313,6 +333,26 @@ extern int dwarf_cu_info (Dwarf_CU *cu,
 			  uint64_t *unit_id,
 			  uint8_t *address_size, uint8_t *offset_size);
 
+/* Find the split units of all skeleton units of DWARF at once, instead
+   of one at a time when each is first used.  The dwo files are opened
+   and read on up to JOBS threads, so at most JOBS files are open at
+   the same time.  A JOBS of zero uses as many threads as there are
+   CPUs to run on, like -j0 does for the tools.  Returns the number of skeleton units which have a
+   split unit, or -1 on error.  */
+extern int dwarf_find_split_units (Dwarf *dwarf, unsigned int jobs);
+
+/* Read everything libdw otherwise reads when it is first used: all
+   units and their abbreviations, the split units of skeleton units,
+   the line tables, the address ranges of the units and the aranges,
+   also of the alternate file.  The units are read on up to JOBS
+   threads, or as many as there are CPUs if JOBS is zero.  Memory allocated for DWARF later on is kept apart from
+   what was read here, so after a fork the processes keep sharing it
+   as long as they only look things up.  Returns the number of units,
+   including split units, or -1 on error.  Errors in single line tables
+   or address ranges are not reported, the same lookups made later
+   will report them again.  */
+extern int dwarf_preload (Dwarf *dwarf, unsigned int jobs);
+
 /* Decode one DWARF CFI entry (CIE or FDE) from the raw section data.
    The E_IDENT from the originating ELF file indicates the address
    size and byte order used in the CFI section contained in DATA;
@@ -566,6 +606,15 @@ extern ptrdiff_t dwarf_ranges (Dwarf_Die *die,
 			       ptrdiff_t offset, Dwarf_Addr *basep,
 			       Dwarf_Addr *startp, Dwarf_Addr *endp);
 
+/* Return all PC address ranges covered by this DIE at once, in the
+   same array dwarf_haspc searches.  The ranges are sorted by start
+   address, empty ranges are left out and overlapping ones merged.
+   The array is only decoded on the first call for DIE and is valid
+   until dwarf_end.  Returns 0 on success, possibly with no ranges,
+   and -1 for errors.  */
+extern int dwarf_getranges (Dwarf_Die *die, const Dwarf_Range **rangesp,
+			    size_t *nrangesp)
+     __nonnull_attribute__ (2, 3);
 
 /* Return byte size attribute of DIE.  */
 extern int dwarf_bytesize (Dwarf_Die *die);
@@ -827,6 +876,22 @@ extern int dwarf_getlocation_attr (Dwarf_Attribute *attr,
    For DW_TAG_array_type it can apply much more complex rules.  */
 extern int dwarf_aggregate_size (Dwarf_Die *die, Dwarf_Word *size);
 
+/* Peel the type DIE as dwarf_peel_type does and compute the size of the
+   result as dwarf_aggregate_size does, storing both in INFO.  The result
+   for each DIE on the way is remembered until dwarf_end, so asking again
+   for the same DIE, or for another type built from the same types, does
+   not walk the DW_AT_type chains again.  Returns the dwarf_peel_type
+   result, which is also stored in INFO->peeled.  */
+extern int dwarf_type_info (Dwarf_Die *die, Dwarf_Type_Info *info)
+  __nonnull_attribute__ (2);
+
+/* Call dwarf_type_info for each of the NDIES DIEs, storing the results
+   in INFOS.  Returns 0 if all succeeded, -1 if any of INFOS has PEELED
+   set to -1.  */
+extern int dwarf_type_infos (Dwarf_Die *dies, size_t ndies,
+			     Dwarf_Type_Info *infos)
+  __nonnull_attribute__ (3);
+
 /* Given a language code, as returned by dwarf_srclan, get the default
    lower bound for a subrange type without a lower bound attribute.
    Returns zero on success or -1 on failure when the given language
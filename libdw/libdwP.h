@@ -54,6 +54,36 @@ struct loc_block_s
   size_t length;
 };
 
+/* Known address ranges of a DIE already decoded.  */
+struct ranges_s
+{
+  void *addr;
+  size_t nranges;
+  Dwarf_Range ranges[];
+};
+
+/* Known location lists already decoded.  NENTRIES is (size_t) -1 for
+   a list with an entry that could not be decoded.  */
+struct loclist_s
+{
+  void *addr;
+  size_t nentries;
+  struct loclist_entry
+  {
+    Dwarf_Addr start;
+    Dwarf_Addr end;
+    Dwarf_Op *expr;
+    size_t exprlen;
+  } entries[];
+};
+
+/* Known peeled types and sizes, see dwarf_type_info.  */
+struct type_s
+{
+  void *addr;
+  Dwarf_Type_Info info;
+};
+
 /* Already decoded .debug_line units.  */
 struct files_lines_s
 {
@@ -232,6 +262,14 @@ struct Dwarf
   /* Search tree for decoded .debug_line units.  */
   void *files_lines;
 
+  /* Lock for files_lines, so that the line tables of different CUs can
+     be decoded by different threads at the same time.  */
+  pthread_rwlock_t files_lines_rwl;
+
+  /* Lock for the caches its CUs fill as they are used: lines, files,
+     locs, loclists, ranges and types.  */
+  pthread_rwlock_t cu_cache_rwl;
+
   /* Address ranges read from .debug_aranges.  */
   Dwarf_Aranges *aranges;
 
@@ -422,9 +460,18 @@ struct Dwarf_CU
   /* The source file information.  */
   Dwarf_Files *files;
 
-  /* Known location lists.  */
+  /* Known location expressions.  */
   void *locs;
 
+  /* Known location lists, struct loclist_s.  */
+  void *loclists;
+
+  /* Known address ranges of DIEs, struct ranges_s.  */
+  void *ranges;
+
+  /* Known peeled types of DIEs, struct type_s.  */
+  void *types;
+
   /* Base address for use with ranges and locs.
      Don't access directly, call __libdw_cu_base_address.  */
   Dwarf_Addr base_address;
@@ -464,6 +511,7 @@ INTDECL (dwarf_dieoffset)
 INTDECL (dwarf_diename)
 INTDECL (dwarf_end)
 INTDECL (dwarf_entrypc)
+INTDECL (dwarf_find_split_units)
 INTDECL (dwarf_errmsg)
 INTDECL (dwarf_formaddr)
 INTDECL (dwarf_formblock)
@@ -477,6 +525,7 @@ INTDECL (dwarf_getarange_addr)
 INTDECL (dwarf_getarangeinfo)
 INTDECL (dwarf_getaranges)
 INTDECL (dwarf_getlocation_die)
+INTDECL (dwarf_getranges)
 INTDECL (dwarf_getsrcfiles)
 INTDECL (dwarf_getsrclines)
 INTDECL (dwarf_get_units)
@@ -494,6 +543,7 @@ INTDECL (dwarf_setalt)
 INTDECL (dwarf_siblingof)
 INTDECL (dwarf_srclang)
 INTDECL (dwarf_tag)
+INTDECL (dwarf_type_info)
 
 #define ISV4TU(cu) ((cu)->version == 4 && (cu)->sec_idx == IDX_debug_types)
 
@@ -730,6 +780,11 @@ extern struct libdw_memblock *__libdw_thread_tail (Dwarf* dbg)
 extern void *__libdw_allocate (Dwarf *dbg, size_t minsize, size_t align)
      __attribute__ ((__malloc__)) __nonnull_attribute__ (1);
 
+/* Make later allocations start new blocks, so they don't write into
+   the memory allocated so far.  */
+extern void __libdw_alloc_seal (Dwarf *dbg)
+     __nonnull_attribute__ (1) internal_function;
+
 /* Default OOM handler.  */
 extern void __libdw_oom (void) __attribute ((noreturn)) attribute_hidden;
 
@@ -761,10 +816,47 @@ extern struct Dwarf_CU *__libdw_findcu_addr (Dwarf *dbg, void *addr)
 extern struct Dwarf *__libdw_find_split_dbg_addr (Dwarf *dbg, void *addr)
      __nonnull_attribute__ (1) internal_function;
 
+/* Return the ranges of DIE if dwarf_getranges decoded them already,
+   otherwise NULL.  */
+extern const Dwarf_Range *__libdw_cached_ranges (Dwarf_Die *die,
+						 size_t *nrangesp)
+     __nonnull_attribute__ (1, 2) internal_function;
+
+/* Compute the element count of the array type DIE, all its dimensions
+   multiplied, and the distance between elements of size ELTSIZE.  */
+extern int __libdw_array_layout (Dwarf_Die *die, Dwarf_Word eltsize,
+				 Dwarf_Word *countp, Dwarf_Word *stridep)
+     __nonnull_attribute__ (1, 3, 4) internal_function;
+
 /* Find the split (or skeleton) unit.  */
 extern struct Dwarf_CU *__libdw_find_split_unit (Dwarf_CU *cu)
      internal_function;
 
+/* Look up the split unit of the skeleton unit CU in the DWARF package
+   file and link the two if found.  */
+extern void __libdw_try_dwp_file (Dwarf_CU *cu)
+     internal_function;
+
+/* Return the path of the dwo file named by the skeleton unit CU,
+   relative to the directory of the skeleton file or, if COMP_DIR is
+   true, to the DW_AT_comp_dir of CU.  Returns NULL if there is no such
+   path.  The caller is responsible for freeing the result.  */
+extern char *__libdw_dwo_path (Dwarf_CU *cu, bool comp_dir)
+     internal_function;
+
+/* Open the dwo file DWO_PATH and return its split unit with the same
+   id as the skeleton unit CU, without linking the two.  Returns NULL
+   if there is none.  Only the new Dwarf is changed, so several dwo
+   files can be opened at the same time.  */
+extern struct Dwarf_CU *__libdw_open_split_file (Dwarf_CU *cu,
+						 const char *dwo_path)
+     internal_function;
+
+/* Link the skeleton unit CU with SPLIT returned by
+   __libdw_open_split_file, or release SPLIT on failure.  */
+extern void __libdw_link_split_file (Dwarf_CU *cu, Dwarf_CU *split)
+     internal_function;
+
 /* Find a unit in a DWARF package file for __libdw_intern_next_unit.  */
 extern int __libdw_dwp_find_unit (Dwarf *dbg, bool debug_types, Dwarf_Off off,
 				  uint16_t version, uint8_t unit_type,
@@ -912,11 +1004,12 @@ extern int __libdw_intern_expression (Dwarf *dbg,
 				      bool other_byte_order,
 				      unsigned int address_size,
 				      unsigned int ref_size,
-				      void **cache, const Dwarf_Block *block,
+				      void **cache, pthread_rwlock_t *lock,
+				      const Dwarf_Block *block,
 				      bool cfap, bool valuep,
 				      Dwarf_Op **llbuf, size_t *listlen,
 				      int sec_index)
-  __nonnull_attribute__ (5, 6, 9, 10) internal_function;
+  __nonnull_attribute__ (5, 6, 7, 10, 11) internal_function;
 
 extern Dwarf_Die *__libdw_offdie (Dwarf *dbg, Dwarf_Off offset,
 				  Dwarf_Die *result, bool debug_types)
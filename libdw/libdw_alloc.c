@@ -137,6 +137,17 @@ __libdw_allocate (Dwarf *dbg, size_t minsize, size_t align)
   return (void *) result;
 }
 
+void
+internal_function
+__libdw_alloc_seal (Dwarf *dbg)
+{
+  pthread_rwlock_wrlock (&dbg->mem_rwl);
+  for (size_t i = 0; i < dbg->mem_stacks; i++)
+    if (dbg->mem_tails[i] != NULL)
+      dbg->mem_tails[i]->remaining = 0;
+  pthread_rwlock_unlock (&dbg->mem_rwl);
+}
+
 
 Dwarf_OOM
 dwarf_new_oom_handler (Dwarf *dbg, Dwarf_OOM handler)
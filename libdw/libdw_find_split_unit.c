@@ -41,9 +41,11 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
-static void
-try_split_file (Dwarf_CU *cu, const char *dwo_path)
+Dwarf_CU *
+internal_function
+__libdw_open_split_file (Dwarf_CU *cu, const char *dwo_path)
 {
+  Dwarf_CU *result = NULL;
   int split_fd = open (dwo_path, O_RDONLY);
   if (split_fd != -1)
     {
@@ -57,25 +59,15 @@ try_split_file (Dwarf_CU *cu, const char *dwo_path)
 	      if (split->unit_type == DW_UT_split_compile
 		  && cu->unit_id8 == split->unit_id8)
 		{
-		  if (tsearch (split->dbg, &cu->dbg->split_tree,
-			       __libdw_finddbg_cb) == NULL)
-		    {
-		      /* Something went wrong.  Don't link.  */
-		      __libdw_seterrno (DWARF_E_NOMEM);
-		      break;
-		    }
-
-		  /* Link skeleton and split compile units.  */
-		  __libdw_link_skel_split (cu, split);
-
 		  /* We have everything we need from this ELF
 		     file.  And we are going to close the fd to
 		     not run out of file descriptors.  */
 		  elf_cntl (split_dwarf->elf, ELF_C_FDDONE);
+		  result = split;
 		  break;
 		}
 	    }
-	  if (cu->split == (Dwarf_CU *) -1)
+	  if (result == NULL)
 	    dwarf_end (split_dwarf);
 	}
       /* Always close, because we don't want to run out of file
@@ -83,10 +75,60 @@ try_split_file (Dwarf_CU *cu, const char *dwo_path)
 	 above.  */
       close (split_fd);
     }
+  return result;
+}
+
+void
+internal_function
+__libdw_link_split_file (Dwarf_CU *cu, Dwarf_CU *split)
+{
+  if (tsearch (split->dbg, &cu->dbg->split_tree,
+	       __libdw_finddbg_cb) == NULL)
+    {
+      /* Something went wrong.  Don't link.  */
+      __libdw_seterrno (DWARF_E_NOMEM);
+      dwarf_end (split->dbg);
+      return;
+    }
+
+  /* Link skeleton and split compile units.  */
+  __libdw_link_skel_split (cu, split);
+}
+
+char *
+internal_function
+__libdw_dwo_path (Dwarf_CU *cu, bool comp_dir)
+{
+  Dwarf_Die cudie = CUDIE (cu);
+  Dwarf_Attribute dwo_name;
+  if (dwarf_attr (&cudie, DW_AT_dwo_name, &dwo_name) == NULL
+      && dwarf_attr (&cudie, DW_AT_GNU_dwo_name, &dwo_name) == NULL)
+    return NULL;
+
+  const char *dwo_file = dwarf_formstring (&dwo_name);
+  const char *dwo_dir = NULL;
+  if (comp_dir)
+    {
+      Dwarf_Attribute compdir;
+      dwo_dir = dwarf_formstring (dwarf_attr (&cudie, DW_AT_comp_dir,
+					      &compdir));
+      if (dwo_dir == NULL)
+	return NULL;
+    }
+  return __libdw_filepath (cu->dbg->debugdir, dwo_dir, dwo_file);
 }
 
 static void
-try_dwp_file (Dwarf_CU *cu)
+try_split_file (Dwarf_CU *cu, const char *dwo_path)
+{
+  Dwarf_CU *split = __libdw_open_split_file (cu, dwo_path);
+  if (split != NULL)
+    __libdw_link_split_file (cu, split);
+}
+
+void
+internal_function
+__libdw_try_dwp_file (Dwarf_CU *cu)
 {
   if (cu->dbg->dwp_dwarf == NULL)
     {
@@ -160,47 +202,24 @@ __libdw_find_split_unit (Dwarf_CU *cu)
   if (cu->unit_type == DW_UT_skeleton)
     {
       /* First, try the dwp file.  */
-      try_dwp_file (cu);
+      __libdw_try_dwp_file (cu);
 
-      Dwarf_Die cudie = CUDIE (cu);
-      Dwarf_Attribute dwo_name;
       /* Try a dwo file.  It is fine if dwo_dir doesn't exist, but then
-	 dwo_name needs to be an absolute path.  */
-      if (cu->split == (Dwarf_CU *) -1
-	  && (dwarf_attr (&cudie, DW_AT_dwo_name, &dwo_name) != NULL
-	      || dwarf_attr (&cudie, DW_AT_GNU_dwo_name, &dwo_name) != NULL))
+	 dwo_name needs to be an absolute path.  First try the dwo file
+	 name in the same directory as we found the skeleton file, then
+	 compdir plus dwo_name.  */
+      for (int i = 0; i < 2 && cu->split == (Dwarf_CU *) -1; ++i)
 	{
-	  /* Try the dwo file name in the same directory
-	     as we found the skeleton file.  */
-	  const char *dwo_file = dwarf_formstring (&dwo_name);
-	  const char *debugdir = cu->dbg->debugdir;
-	  char *dwo_path = __libdw_filepath (debugdir, NULL, dwo_file);
+	  char *dwo_path = __libdw_dwo_path (cu, i == 1);
 	  if (dwo_path != NULL)
 	    {
 	      try_split_file (cu, dwo_path);
 	      free (dwo_path);
 	    }
-
-	  if (cu->split == (Dwarf_CU *) -1)
-	    {
-	      /* Try compdir plus dwo_name.  */
-	      Dwarf_Attribute compdir;
-	      dwarf_attr (&cudie, DW_AT_comp_dir, &compdir);
-	      const char *dwo_dir = dwarf_formstring (&compdir);
-	      if (dwo_dir != NULL)
-		{
-		  dwo_path = __libdw_filepath (debugdir, dwo_dir, dwo_file);
-		  if (dwo_path != NULL)
-		    {
-		      try_split_file (cu, dwo_path);
-		      free (dwo_path);
-		    }
-		}
-	    }
-	  /* XXX If still not found we could try stripping dirs from the
-	     comp_dir and adding them from the comp_dir, assuming
-	     someone moved a whole build tree around.  */
 	}
+      /* XXX If still not found we could try stripping dirs from the
+	 comp_dir and adding them from the comp_dir, assuming
+	 someone moved a whole build tree around.  */
     }
 
   /* If we found nothing, make sure we don't try again.  */
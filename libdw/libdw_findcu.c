@@ -168,6 +168,9 @@ __libdw_intern_next_unit (Dwarf *dbg, bool debug_types)
   newp->files = NULL;
   newp->lines = NULL;
   newp->locs = NULL;
+  newp->loclists = NULL;
+  newp->ranges = NULL;
+  newp->types = NULL;
   newp->split = (Dwarf_CU *) -1;
   newp->base_address = (Dwarf_Addr) -1;
   newp->addr_base = (Dwarf_Off) -1;
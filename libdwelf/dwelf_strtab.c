@@ -47,13 +47,29 @@ struct Dwelf_Strent
   const char *string;
   size_t len;
   struct Dwelf_Strent *next;
-  struct Dwelf_Strent *left;
-  struct Dwelf_Strent *right;
   size_t offset;
-  char reverse[0];
 };
 
 
+/* Hash table to find strings which were added before.  */
+#define TYPE Dwelf_Strent *
+#define NAME dwelf_strent_tab
+#define COMPARE(a, b) \
+  ((a)->len != (b)->len || memcmp ((a)->string, (b)->string, (a)->len) != 0)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
+
+#define next_prime __libdwarf_next_prime
+extern size_t next_prime (size_t) attribute_hidden;
+
+#include <dynamicsizehash.c>
+#undef next_prime
+#undef TYPE
+#undef NAME
+#undef COMPARE
+
+
 struct memoryblock
 {
   struct memoryblock *next;
@@ -63,11 +79,13 @@ struct memoryblock
 
 struct Dwelf_Strtab
 {
-  struct Dwelf_Strent *root;
+  dwelf_strent_tab hash;
+  /* All different strings, last added first.  */
+  struct Dwelf_Strent *strings;
+  size_t nstrings;
   struct memoryblock *memory;
   char *backp;
   size_t left;
-  size_t total;
   bool nullstr;
 
   struct Dwelf_Strent null;
@@ -93,6 +111,12 @@ dwelf_strtab_init (bool nullstr)
   Dwelf_Strtab *ret = calloc (1, sizeof (struct Dwelf_Strtab));
   if (ret != NULL)
     {
+      if (dwelf_strent_tab_init (&ret->hash, 63) != 0)
+	{
+	  free (ret);
+	  return NULL;
+	}
+
       ret->nullstr = nullstr;
 
       if (nullstr)
@@ -140,6 +164,7 @@ dwelf_strtab_free (Dwelf_Strtab *st)
       free (old);
     }
 
+  dwelf_strent_tab_free (&st->hash);
   free (st);
 }
 
@@ -154,9 +179,9 @@ newstring (Dwelf_Strtab *st, const char *str, size_t len)
 		  & (__alignof__ (struct Dwelf_Strent) - 1));
 
   /* Make sure there is enough room in the memory block.  */
-  if (st->left < align + sizeof (struct Dwelf_Strent) + len)
+  if (st->left < align + sizeof (struct Dwelf_Strent))
     {
-      if (morememory (st, sizeof (struct Dwelf_Strent) + len))
+      if (morememory (st, sizeof (struct Dwelf_Strent)))
 	return NULL;
 
       align = 0;
@@ -167,42 +192,22 @@ newstring (Dwelf_Strtab *st, const char *str, size_t len)
   newstr->string = str;
   newstr->len = len;
   newstr->next = NULL;
-  newstr->left = NULL;
-  newstr->right = NULL;
   newstr->offset = 0;
-  for (int i = len - 2; i >= 0; --i)
-    newstr->reverse[i] = str[len - 2 - i];
-  newstr->reverse[len - 1] = '\0';
-  st->backp += align + sizeof (struct Dwelf_Strent) + len;
-  st->left -= align + sizeof (struct Dwelf_Strent) + len;
+  st->backp += align + sizeof (struct Dwelf_Strent);
+  st->left -= align + sizeof (struct Dwelf_Strent);
 
   return newstr;
 }
 
 
-/* XXX This function should definitely be rewritten to use a balancing
-   tree algorithm (AVL, red-black trees).  For now a simple, correct
-   implementation is enough.  */
-static Dwelf_Strent **
-searchstring (Dwelf_Strent **sep, Dwelf_Strent *newstr)
+/* FNV-1a over the string.  */
+static unsigned long int
+string_hash (const char *str, size_t len)
 {
-  /* More strings?  */
-  if (*sep == NULL)
-    {
-      *sep = newstr;
-      return sep;
-    }
-
-  /* Compare the strings.  */
-  int cmpres = memcmp ((*sep)->reverse, newstr->reverse,
-		       MIN ((*sep)->len, newstr->len) - 1);
-  if (cmpres == 0)
-    /* We found a matching string.  */
-    return sep;
-  else if (cmpres > 0)
-    return searchstring (&(*sep)->left, newstr);
-  else
-    return searchstring (&(*sep)->right, newstr);
+  uint64_t hval = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < len; ++i)
+    hval = (hval ^ (unsigned char) str[i]) * 0x100000001b3ull;
+  return hval;
 }
 
 
@@ -215,63 +220,29 @@ strtab_add (Dwelf_Strtab *st, const char *str, size_t len)
   if (len == 1 && st->null.string != NULL)
     return &st->null;
 
+  /* Only whole strings are merged here; which strings end in which
+     others is left to dwelf_strtab_finalize.  */
+  unsigned long int hval = string_hash (str, len);
+  Dwelf_Strent key = { .string = str, .len = len };
+  Dwelf_Strent *found = dwelf_strent_tab_find (&st->hash, hval, &key);
+  if (found != NULL)
+    return found;
+
   /* Allocate memory for the new string and its associated information.  */
   Dwelf_Strent *newstr = newstring (st, str, len);
   if (newstr == NULL)
     return NULL;
 
-  /* Search in the array for the place to insert the string.  If there
-     is no string with matching prefix and no string with matching
-     leading substring, create a new entry.  */
-  Dwelf_Strent **sep = searchstring (&st->root, newstr);
-  if (*sep != newstr)
+  if (dwelf_strent_tab_insert (&st->hash, hval, newstr) != 0)
     {
-      /* This is not the same entry.  This means we have a prefix match.  */
-      if ((*sep)->len > newstr->len)
-	{
-	  /* Check whether we already know this string.  */
-	  for (Dwelf_Strent *subs = (*sep)->next; subs != NULL;
-	       subs = subs->next)
-	    if (subs->len == newstr->len)
-	      {
-		/* We have an exact match with a substring.  Free the memory
-		   we allocated.  */
-		st->left += st->backp - (char *) newstr;
-		st->backp = (char *) newstr;
-
-		return subs;
-	      }
-
-	  /* We have a new substring.  This means we don't need the reverse
-	     string of this entry anymore.  */
-	  st->backp -= newstr->len;
-	  st->left += newstr->len;
-
-	  newstr->next = (*sep)->next;
-	  (*sep)->next = newstr;
-	}
-      else if ((*sep)->len != newstr->len)
-	{
-	  /* When we get here it means that the string we are about to
-	     add has a common prefix with a string we already have but
-	     it is longer.  In this case we have to put it first.  */
-	  st->total += newstr->len - (*sep)->len;
-	  newstr->next = *sep;
-	  newstr->left = (*sep)->left;
-	  newstr->right = (*sep)->right;
-	  *sep = newstr;
-	}
-      else
-	{
-	  /* We have an exact match.  Free the memory we allocated.  */
-	  st->left += st->backp - (char *) newstr;
-	  st->backp = (char *) newstr;
-
-	  newstr = *sep;
-	}
+      st->left += st->backp - (char *) newstr;
+      st->backp = (char *) newstr;
+      return NULL;
     }
-  else
-    st->total += newstr->len;
+
+  newstr->next = st->strings;
+  st->strings = newstr;
+  ++st->nstrings;
 
   return newstr;
 }
@@ -288,26 +259,32 @@ dwelf_strtab_add_len (Dwelf_Strtab *st, const char *str, size_t len)
   return strtab_add (st, str, len);
 }
 
-static void
-copystrings (Dwelf_Strent *nodep, char **freep, size_t *offsetp)
+/* Order strings by their bytes from the end backwards, so that a
+   string which ends another one comes right before the shortest of
+   those.  */
+static int
+compare_reversed (const void *p1, const void *p2)
 {
-  if (nodep->left != NULL)
-    copystrings (nodep->left, freep, offsetp);
+  const Dwelf_Strent *s1 = *(const Dwelf_Strent **) p1;
+  const Dwelf_Strent *s2 = *(const Dwelf_Strent **) p2;
+  const unsigned char *e1 = (const unsigned char *) s1->string + s1->len - 1;
+  const unsigned char *e2 = (const unsigned char *) s2->string + s2->len - 1;
+  size_t n = MIN (s1->len, s2->len) - 1;
 
-  /* Process the current node.  */
-  nodep->offset = *offsetp;
-  *freep = (char *) mempcpy (*freep, nodep->string, nodep->len);
-  *offsetp += nodep->len;
+  for (size_t i = 1; i <= n; ++i)
+    if (e1[-i] != e2[-i])
+      return e1[-i] < e2[-i] ? -1 : 1;
 
-  for (Dwelf_Strent *subs = nodep->next; subs != NULL; subs = subs->next)
-    {
-      assert (subs->len < nodep->len);
-      subs->offset = nodep->offset + nodep->len - subs->len;
-      assert (subs->offset != 0 || subs->string[0] == '\0');
-    }
+  return s1->len < s2->len ? -1 : s1->len > s2->len;
+}
 
-  if (nodep->right != NULL)
-    copystrings (nodep->right, freep, offsetp);
+/* Whether string SE is the tail of string OTHER.  */
+static bool
+is_tail (const Dwelf_Strent *se, const Dwelf_Strent *other)
+{
+  return (se->len <= other->len
+	  && memcmp (se->string, other->string + other->len - se->len,
+		     se->len) == 0);
 }
 
 
@@ -316,10 +293,30 @@ dwelf_strtab_finalize (Dwelf_Strtab *st, Elf_Data *data)
 {
   size_t nulllen = st->nullstr ? 1 : 0;
 
+  /* Sort the strings by their reversed bytes.  After that, a string
+     which is the tail of others is directly followed by one of them,
+     so it only needs to be compared with the next one.  */
+  size_t n = st->nstrings;
+  Dwelf_Strent **sorted = malloc (MAX (n, 1) * sizeof sorted[0]);
+  if (sorted == NULL)
+    return NULL;
+  size_t i = n;
+  for (Dwelf_Strent *se = st->strings; se != NULL; se = se->next)
+    sorted[--i] = se;
+  qsort (sorted, n, sizeof sorted[0], compare_reversed);
+
+  size_t total = nulllen;
+  for (i = 0; i < n; ++i)
+    if (i + 1 == n || ! is_tail (sorted[i], sorted[i + 1]))
+      total += sorted[i]->len;
+
   /* Fill in the information.  */
-  data->d_buf = malloc (st->total + nulllen);
+  data->d_buf = malloc (total);
   if (data->d_buf == NULL)
-    return NULL;
+    {
+      free (sorted);
+      return NULL;
+    }
 
   /* The first byte must always be zero if we created the table with a
      null string.  */
@@ -327,18 +324,33 @@ dwelf_strtab_finalize (Dwelf_Strtab *st, Elf_Data *data)
     *((char *) data->d_buf) = '\0';
 
   data->d_type = ELF_T_BYTE;
-  data->d_size = st->total + nulllen;
+  data->d_size = total;
   data->d_off = 0;
   data->d_align = 1;
   data->d_version = EV_CURRENT;
 
-  /* Now run through the tree and add all the string while also updating
-     the offset members of the elfstrent records.  */
+  /* Copy all strings which are not the tail of another one, in order,
+     and set their offsets.  */
   char *endp = (char *) data->d_buf + nulllen;
-  size_t copylen = nulllen;
-  if (st->root)
-    copystrings (st->root, &endp, &copylen);
-  assert (copylen == st->total + nulllen);
+  for (i = 0; i < n; ++i)
+    if (i + 1 == n || ! is_tail (sorted[i], sorted[i + 1]))
+      {
+	sorted[i]->offset = endp - (char *) data->d_buf;
+	endp = (char *) mempcpy (endp, sorted[i]->string, sorted[i]->len);
+      }
+  assert ((size_t) (endp - (char *) data->d_buf) == total);
+
+  /* The others point into the string which follows them, whose offset
+     is known by now when going backwards.  */
+  for (i = n; i-- > 0; )
+    if (i + 1 < n && is_tail (sorted[i], sorted[i + 1]))
+      {
+	sorted[i]->offset = (sorted[i + 1]->offset + sorted[i + 1]->len
+			     - sorted[i]->len);
+	assert (sorted[i]->offset != 0 || sorted[i]->string[0] == '\0');
+      }
+
+  free (sorted);
 
   return data;
 }
@@ -0,0 +1,451 @@
+/* Sorted and hashed index of an ELF symbol table.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+
+#include "libdwelfP.h"
+#include "libelfP.h"
+#include <system.h>
+
+
+struct Dwelf_Symtab
+{
+  /* The converted symbols and the extended section indices.  */
+  Elf_Data *data;
+  Elf_Data *xndxdata;
+  size_t nsyms;
+
+  /* The string table, up to the last terminating zero.  */
+  const char *strtab;
+  size_t strsize;
+
+  /* All symbols but the first, sorted by value and then by index, and
+     the values in the same order.  */
+  GElf_Word *byaddr;
+  GElf_Addr *values;
+
+  /* Our own hash table for the symbols before HASHLIMIT.  CHAIN and
+     HASHES are indexed by symbol, a zero ends a chain.  */
+  size_t hashlimit;
+  size_t nbuckets;
+  GElf_Word *buckets;
+  GElf_Word *chain;
+  GElf_Word *hashes;
+
+  /* The .gnu.hash section of a dynamic symbol table covers the
+     symbols from HASHLIMIT on.  */
+  size_t gnu_nbuckets;
+  const Elf32_Word *gnu_buckets;
+  const Elf32_Word *gnu_chain;
+
+  /* The symbols of section N are SECSYMS[SECSTART[N]] up to
+     SECSYMS[SECSTART[N + 1]].  */
+  size_t shnum;
+  size_t *secstart;
+  GElf_Word *secsyms;
+};
+
+
+static inline GElf_Word
+gnu_hash (const char *name)
+{
+  GElf_Word h = 5381;
+  for (const unsigned char *p = (const unsigned char *) name; *p != '\0'; ++p)
+    h = h * 33 + *p;
+  return h;
+}
+
+struct addr_entry
+{
+  GElf_Addr value;
+  GElf_Word ndx;
+};
+
+static int
+compare_addr (const void *a, const void *b)
+{
+  const struct addr_entry *l = a, *r = b;
+  if (l->value != r->value)
+    return l->value < r->value ? -1 : 1;
+  return l->ndx < r->ndx ? -1 : l->ndx > r->ndx;
+}
+
+/* Use the .gnu.hash section for the dynamic symbol table SCN, if there
+   is one that looks sane.  Sets ST->hashlimit to the first symbol it
+   covers.  */
+static void
+find_gnu_hash (Dwelf_Symtab *st, Elf *elf, Elf_Scn *scn)
+{
+  size_t symndx = elf_ndxscn (scn);
+  size_t wordsize = gelf_getclass (elf) == ELFCLASS32 ? 4 : 8;
+  Elf_Scn *hscn = NULL;
+  while ((hscn = elf_nextscn (elf, hscn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (hscn, &shdr_mem);
+      if (shdr == NULL || shdr->sh_type != SHT_GNU_HASH
+	  || shdr->sh_link != symndx)
+	continue;
+
+      Elf_Data *data = elf_getdata (hscn, NULL);
+      if (data == NULL || data->d_size < 4 * sizeof (Elf32_Word))
+	return;
+      const Elf32_Word *header = data->d_buf;
+      size_t nbuckets = header[0];
+      size_t symoffset = header[1];
+      size_t bloom_size = header[2];
+      if (nbuckets == 0 || symoffset == 0 || symoffset > st->nsyms
+	  || bloom_size > data->d_size / wordsize)
+	return;
+      size_t buckets_at = 4 * sizeof (Elf32_Word) + bloom_size * wordsize;
+      size_t nchain = st->nsyms - symoffset;
+      if (buckets_at > data->d_size
+	  || (data->d_size - buckets_at) / sizeof (Elf32_Word) < nbuckets
+	  || ((data->d_size - buckets_at) / sizeof (Elf32_Word) - nbuckets
+	      < nchain))
+	return;
+
+      st->gnu_nbuckets = nbuckets;
+      st->gnu_buckets = (const void *) ((const char *) data->d_buf
+					+ buckets_at);
+      st->gnu_chain = st->gnu_buckets + nbuckets - symoffset;
+      st->hashlimit = symoffset;
+      return;
+    }
+}
+
+Dwelf_Symtab *
+dwelf_symtab_begin (Elf_Scn *scn)
+{
+  if (scn == NULL)
+    return NULL;
+
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (shdr == NULL)
+    return NULL;
+  if (shdr->sh_type != SHT_SYMTAB && shdr->sh_type != SHT_DYNSYM)
+    {
+      __libdw_seterrno (DWARF_E_INVALID_ELF);
+      return NULL;
+    }
+
+  Elf *elf = scn->elf;
+  Elf_Data *data = elf_getdata (scn, NULL);
+  Elf_Scn *strscn = elf_getscn (elf, shdr->sh_link);
+  Elf_Data *strdata = strscn == NULL ? NULL : elf_getdata (strscn, NULL);
+  size_t shnum;
+  if (data == NULL || strdata == NULL || elf_getshdrnum (elf, &shnum) != 0)
+    {
+      __libdw_seterrno (DWARF_E_INVALID_ELF);
+      return NULL;
+    }
+
+  Dwelf_Symtab *st = calloc (1, sizeof *st);
+  if (st == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      return NULL;
+    }
+
+  st->data = data;
+  st->nsyms = data->d_size / gelf_fsize (elf, ELF_T_SYM, 1, EV_CURRENT);
+  st->shnum = shnum;
+
+  /* Names past the last zero would not be terminated.  */
+  st->strtab = strdata->d_buf;
+  st->strsize = strdata->d_size;
+  while (st->strsize > 0 && st->strtab[st->strsize - 1] != '\0')
+    --st->strsize;
+
+  /* The extended section indices, if any.  */
+  size_t symndx = elf_ndxscn (scn);
+  Elf_Scn *xscn = NULL;
+  while ((xscn = elf_nextscn (elf, xscn)) != NULL)
+    {
+      GElf_Shdr xshdr_mem;
+      GElf_Shdr *xshdr = gelf_getshdr (xscn, &xshdr_mem);
+      if (xshdr != NULL && xshdr->sh_type == SHT_SYMTAB_SHNDX
+	  && xshdr->sh_link == symndx)
+	{
+	  st->xndxdata = elf_getdata (xscn, NULL);
+	  break;
+	}
+    }
+
+  st->hashlimit = st->nsyms;
+  if (shdr->sh_type == SHT_DYNSYM)
+    find_gnu_hash (st, elf, scn);
+
+  size_t n = st->nsyms == 0 ? 0 : st->nsyms - 1;
+  struct addr_entry *sorted = NULL;
+  GElf_Word *shndxs = NULL;
+  st->nbuckets = 1;
+  while (st->nbuckets < st->hashlimit / 2)
+    st->nbuckets *= 2;
+  st->byaddr = malloc (n * sizeof *st->byaddr + 1);
+  st->values = malloc (n * sizeof *st->values + 1);
+  st->buckets = calloc (st->nbuckets, sizeof *st->buckets);
+  st->chain = calloc (st->hashlimit + 1, sizeof *st->chain);
+  st->hashes = malloc ((st->hashlimit + 1) * sizeof *st->hashes);
+  st->secstart = calloc (shnum + 1, sizeof *st->secstart);
+  st->secsyms = malloc (n * sizeof *st->secsyms + 1);
+  sorted = malloc (n * sizeof *sorted + 1);
+  shndxs = malloc (n * sizeof *shndxs + 1);
+  if (st->byaddr == NULL || st->values == NULL || st->buckets == NULL
+      || st->chain == NULL || st->hashes == NULL || st->secstart == NULL
+      || st->secsyms == NULL || sorted == NULL || shndxs == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      goto fail;
+    }
+
+  /* One pass over the symbols collects everything we need.  Walk
+     them backwards so the hash chains come out in index order.  */
+  for (size_t i = st->nsyms; i-- > 1; )
+    {
+      GElf_Sym sym_mem;
+      GElf_Word xndx;
+      GElf_Sym *sym = gelf_getsymshndx (data, st->xndxdata, i,
+					&sym_mem, &xndx);
+      if (sym == NULL)
+	{
+	  __libdw_seterrno (DWARF_E_INVALID_ELF);
+	  goto fail;
+	}
+
+      sorted[i - 1].value = sym->st_value;
+      sorted[i - 1].ndx = i;
+
+      if (sym->st_shndx != SHN_XINDEX)
+	xndx = sym->st_shndx;
+      shndxs[i - 1] = xndx;
+      if (xndx < shnum)
+	++st->secstart[xndx + 1];
+
+      if (i < st->hashlimit && sym->st_name < st->strsize)
+	{
+	  GElf_Word h = gnu_hash (st->strtab + sym->st_name);
+	  size_t b = h & (st->nbuckets - 1);
+	  st->hashes[i] = h;
+	  st->chain[i] = st->buckets[b];
+	  st->buckets[b] = i;
+	}
+    }
+
+  qsort (sorted, n, sizeof *sorted, compare_addr);
+  for (size_t i = 0; i < n; ++i)
+    {
+      st->byaddr[i] = sorted[i].ndx;
+      st->values[i] = sorted[i].value;
+    }
+
+  /* Count sort by section, which keeps the symbols in index order.  */
+  for (size_t s = 0; s < shnum; ++s)
+    st->secstart[s + 1] += st->secstart[s];
+  size_t *next = malloc (shnum * sizeof *next + 1);
+  if (next == NULL)
+    {
+      __libdw_seterrno (DWARF_E_NOMEM);
+      goto fail;
+    }
+  memcpy (next, st->secstart, shnum * sizeof *next);
+  for (size_t i = 0; i < n; ++i)
+    if (shndxs[i] < shnum)
+      st->secsyms[next[shndxs[i]]++] = i + 1;
+  free (next);
+
+  free (shndxs);
+  free (sorted);
+  return st;
+
+ fail:
+  free (shndxs);
+  free (sorted);
+  INTUSE(dwelf_symtab_end) (st);
+  return NULL;
+}
+INTDEF(dwelf_symtab_begin)
+
+void
+dwelf_symtab_end (Dwelf_Symtab *st)
+{
+  if (st == NULL)
+    return;
+
+  free (st->byaddr);
+  free (st->values);
+  free (st->buckets);
+  free (st->chain);
+  free (st->hashes);
+  free (st->secstart);
+  free (st->secsyms);
+  free (st);
+}
+INTDEF(dwelf_symtab_end)
+
+size_t
+dwelf_symtab_count (Dwelf_Symtab *st)
+{
+  return st == NULL ? 0 : st->nsyms;
+}
+
+const void *
+dwelf_symtab_raw (Dwelf_Symtab *st, size_t *nsyms)
+{
+  if (st == NULL)
+    return NULL;
+
+  if (nsyms != NULL)
+    *nsyms = st->nsyms;
+  return st->data->d_buf;
+}
+
+const char *
+dwelf_symtab_getsym (Dwelf_Symtab *st, size_t ndx, GElf_Sym *sym,
+		     GElf_Word *shndx)
+{
+  if (st == NULL || ndx >= st->nsyms)
+    return NULL;
+
+  GElf_Sym sym_mem;
+  if (sym == NULL)
+    sym = &sym_mem;
+  GElf_Word xndx;
+  if (gelf_getsymshndx (st->data, st->xndxdata, ndx, sym, &xndx) == NULL)
+    return NULL;
+  if (shndx != NULL)
+    *shndx = sym->st_shndx == SHN_XINDEX ? xndx : sym->st_shndx;
+
+  if (sym->st_name >= st->strsize)
+    return NULL;
+  return st->strtab + sym->st_name;
+}
+
+static inline const char *
+symname (Dwelf_Symtab *st, size_t ndx)
+{
+  GElf_Sym sym_mem;
+  GElf_Sym *sym = gelf_getsym (st->data, ndx, &sym_mem);
+  if (sym == NULL || sym->st_name >= st->strsize)
+    return NULL;
+  return st->strtab + sym->st_name;
+}
+
+size_t
+dwelf_symtab_find_name (Dwelf_Symtab *st, const char *name, size_t start)
+{
+  if (st == NULL || name == NULL)
+    return 0;
+
+  GElf_Word h = gnu_hash (name);
+  if (start == 0)
+    start = 1;
+
+  if (start < st->hashlimit)
+    for (size_t i = st->buckets[h & (st->nbuckets - 1)]; i != 0;
+	 i = st->chain[i])
+      if (i >= start && st->hashes[i] == h)
+	{
+	  const char *n = symname (st, i);
+	  if (n != NULL && strcmp (n, name) == 0)
+	    return i;
+	}
+
+  if (st->gnu_nbuckets == 0)
+    return 0;
+
+  /* The .gnu.hash chains hold the hashes with the low bit set on the
+     last entry of each chain.  */
+  size_t i = st->gnu_buckets[h % st->gnu_nbuckets];
+  if (i < st->hashlimit)
+    return 0;
+  for (; i < st->nsyms; ++i)
+    {
+      GElf_Word h2 = st->gnu_chain[i];
+      if (i >= start && ((h ^ h2) >> 1) == 0)
+	{
+	  const char *n = symname (st, i);
+	  if (n != NULL && strcmp (n, name) == 0)
+	    return i;
+	}
+      if ((h2 & 1) != 0)
+	break;
+    }
+  return 0;
+}
+INTDEF(dwelf_symtab_find_name)
+
+const GElf_Word *
+dwelf_symtab_addrs (Dwelf_Symtab *st, size_t *n)
+{
+  if (st == NULL)
+    return NULL;
+
+  if (n != NULL)
+    *n = st->nsyms == 0 ? 0 : st->nsyms - 1;
+  return st->byaddr;
+}
+
+size_t
+dwelf_symtab_find_addr (Dwelf_Symtab *st, GElf_Addr addr)
+{
+  if (st == NULL || st->nsyms == 0)
+    return 0;
+
+  size_t l = 0;
+  size_t u = st->nsyms - 1;
+  while (l < u)
+    {
+      size_t m = l + (u - l) / 2;
+      if (st->values[m] <= addr)
+	l = m + 1;
+      else
+	u = m;
+    }
+  return l;
+}
+
+const GElf_Word *
+dwelf_symtab_section (Dwelf_Symtab *st, size_t shndx, size_t *n)
+{
+  if (st == NULL || shndx >= st->shnum)
+    {
+      if (n != NULL)
+	*n = 0;
+      return NULL;
+    }
+
+  if (n != NULL)
+    *n = st->secstart[shndx + 1] - st->secstart[shndx];
+  return st->secsyms + st->secstart[shndx];
+}
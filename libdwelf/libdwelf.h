@@ -127,19 +127,75 @@ extern void dwelf_strtab_free (Dwelf_Strtab *st)
 
 /* Creates a read-only Elf handle from the given file handle.  The
    file may be compressed and/or contain a linux kernel image header,
-   in which case it is eagerly decompressed in full and the Elf handle
-   is created as if created with elf_memory ().  On decompression or
-   file errors NULL is returned (and elf_errno will be set).  If there
-   was no error, but the file is not an ELF file, then an ELF_K_NONE
-   Elf handle is returned (just like with elf_begin).  The Elf handle
-   should be closed with elf_end ().  The file handle will not be
-   closed.  */
+   in which case it is decompressed.  When the compression format has
+   places to start decompressing from, that is done in parts as they
+   are read, otherwise the whole file is decompressed up front and the
+   Elf handle is created as if created with elf_memory ().  On
+   decompression or file errors NULL is returned (and elf_errno will be
+   set).  If there was no error, but the file is not an ELF file, then
+   an ELF_K_NONE Elf handle is returned (just like with elf_begin).  The
+   Elf handle should be closed with elf_end ().  The file handle will
+   not be closed.  */
 extern Elf *dwelf_elf_begin (int fd);
 
 /* Returns a human readable string for the given ELF header e_machine
    value, or NULL if the given number isn't currently known.  */
 extern const char *dwelf_elf_e_machine_string (int machine);
 
+/* Sorted and hashed index of an ELF symbol table.  */
+typedef struct Dwelf_Symtab Dwelf_Symtab;
+
+/* Creates an index of the symbol table section SCN, which must be of
+   type SHT_SYMTAB or SHT_DYNSYM.  The symbols are sorted by address
+   and by section, and their names are put in a hash table (the
+   .gnu.hash section of a dynamic symbol table is used where possible).
+   The index is never changed once created, so it can be shared by
+   several threads.  It stays valid as long as the section data isn't
+   changed and should be freed with dwelf_symtab_end.  Returns NULL on
+   error.  */
+extern Dwelf_Symtab *dwelf_symtab_begin (Elf_Scn *scn);
+
+/* Frees the index ST.  */
+extern void dwelf_symtab_end (Dwelf_Symtab *st);
+
+/* Returns the number of symbols, including the null symbol at index
+   zero.  */
+extern size_t dwelf_symtab_count (Dwelf_Symtab *st);
+
+/* Returns the symbols as an array of Elf32_Sym or Elf64_Sym in the
+   ELF class of the file and in host byte order, and stores the number
+   of symbols in *NSYMS.  */
+extern const void *dwelf_symtab_raw (Dwelf_Symtab *st, size_t *nsyms);
+
+/* Stores symbol NDX in *SYM and its section index (taking
+   SHT_SYMTAB_SHNDX into account) in *SHNDX, either may be NULL.
+   Returns the name of the symbol, or NULL if the symbol doesn't exist
+   or has no valid name.  */
+extern const char *dwelf_symtab_getsym (Dwelf_Symtab *st, size_t ndx,
+					GElf_Sym *sym, GElf_Word *shndx);
+
+/* Returns the lowest index of a symbol called NAME which is at least
+   START, or zero if there is none.  All symbols of that name are found
+   by passing the last index plus one as START.  */
+extern size_t dwelf_symtab_find_name (Dwelf_Symtab *st, const char *name,
+				      size_t start);
+
+/* Returns the indices of all symbols but the null symbol, sorted by
+   st_value and then by index, and stores their number in *N.  */
+extern const GElf_Word *dwelf_symtab_addrs (Dwelf_Symtab *st, size_t *n);
+
+/* Returns the number of symbols in the dwelf_symtab_addrs array with
+   an st_value less than or equal to ADDR, which is the position of
+   the first symbol above ADDR.  */
+extern size_t dwelf_symtab_find_addr (Dwelf_Symtab *st, GElf_Addr addr);
+
+/* Returns the indices, in ascending order, of the symbols defined in
+   section SHNDX and stores their number in *N.  Symbols with special
+   section indices like SHN_ABS or SHN_COMMON can't be looked up this
+   way.  */
+extern const GElf_Word *dwelf_symtab_section (Dwelf_Symtab *st,
+					      size_t shndx, size_t *n);
+
 #ifdef __cplusplus
 }
 #endif
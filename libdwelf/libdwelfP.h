@@ -38,5 +38,8 @@
 INTDECL (dwelf_elf_gnu_debuglink)
 INTDECL (dwelf_dwarf_gnu_debugaltlink)
 INTDECL (dwelf_elf_gnu_build_id)
+INTDECL (dwelf_symtab_begin)
+INTDECL (dwelf_symtab_end)
+INTDECL (dwelf_symtab_find_name)
 
 #endif	/* libdwelfP.h */
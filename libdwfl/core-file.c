@@ -233,7 +233,8 @@ core_file_read_eagerly (Dwfl_Module *mod,
      but we don't have a build-id.  */
 
   if (core->map_address != NULL)
-    /* It's cheap to get, so get it.  */
+    /* It's cheap to get, so get it.  The image is read from the mapped
+       core file only as it is used, not copied in whole.  */
     return true;
 
   /* Only use it if there isn't too much to be read.  */
@@ -563,6 +564,7 @@ dwfl_core_file_report (Dwfl *dwfl, Elf *elf, const char *executable)
 					    &dwfl_elf_phdr_memory_callback, elf,
 					    core_file_read_eagerly, elf,
 					    elf->maximum_size,
+					    elf->map_address != NULL ? elf : NULL,
 					    note_file, note_file_size,
 					    &r_debug_info);
       if (unlikely (seg < 0))
@@ -57,6 +57,8 @@ dwfl_end (Dwfl *dwfl)
       __libdwfl_module_free (dead);
     }
 
+  INTUSE(dwfl_set_module_cache) (dwfl, NULL);
+
   if (dwfl->user_core != NULL)
     {
       free (dwfl->user_core->executable_for_core);
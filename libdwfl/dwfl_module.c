@@ -1,5 +1,5 @@
 /* Maintenance of module list in libdwfl.
-   Copyright (C) 2005, 2006, 2007, 2008, 2014, 2015 Red Hat, Inc.
+   Copyright (C) 2005, 2006, 2007, 2008, 2014, 2015, 2026 Red Hat, Inc.
    This file is part of elfutils.
 
    This file is free software; you can redistribute it and/or modify
@@ -61,6 +61,9 @@ void
 internal_function
 __libdwfl_module_free (Dwfl_Module *mod)
 {
+  /* What MOD shares with other modules goes with the last of them.  */
+  struct dwfl_shared_module *shared = __libdwfl_module_unshare (mod);
+
   if (mod->lazy_cu_root != NULL)
     tdestroy (mod->lazy_cu_root, nofree);
 
@@ -107,6 +110,8 @@ __libdwfl_module_free (Dwfl_Module *mod)
   if (mod->ebl != NULL)
     ebl_closebackend (mod->ebl);
 
+  INTUSE(dwelf_symtab_end) (mod->symtab_index);
+
   if (mod->debug.elf != mod->main.elf)
     free_file (&mod->debug);
   free_file (&mod->main);
@@ -121,41 +126,56 @@ __libdwfl_module_free (Dwfl_Module *mod)
   free (mod->name);
   free (mod->elfpath);
   free (mod);
+
+  __libdwfl_shared_module_release (shared);
 }
 
 void
-dwfl_report_begin_add (Dwfl *dwfl __attribute__ ((unused)))
+dwfl_report_begin_add (Dwfl *dwfl)
 {
-  /* The lookup table will be cleared on demand, there is nothing we need
-     to do here.  */
+  /* The lookup table will be cleared on demand, there is nothing else
+     we need to do here.  */
+  dwfl->report_last = NULL;
 }
 INTDEF (dwfl_report_begin_add)
 
 void
 dwfl_report_begin (Dwfl *dwfl)
 {
-  /* Clear the segment lookup table.  */
-  dwfl->lookup_elts = 0;
+  /* Clear the segment lookup table.  When it was made from the modules
+     alone it stays valid for those reported again unchanged, so keep it
+     until dwfl_report_end sees whether any of them went away.  */
+  if (dwfl->next_segndx != 0)
+    dwfl->lookup_elts = 0;
 
   for (Dwfl_Module *m = dwfl->modulelist; m != NULL; m = m->next)
     m->gc = true;
 
+  dwfl->report_last = NULL;
   dwfl->offline_next_address = OFFLINE_REDZONE;
 }
 INTDEF (dwfl_report_begin)
 
-static inline Dwfl_Module *
-use (Dwfl_Module *mod, Dwfl_Module **tailp, Dwfl *dwfl)
+/* Forget the module pointers in the segment lookup table.  */
+static void
+drop_lookup_module (Dwfl *dwfl)
 {
-  mod->next = *tailp;
-  *tailp = mod;
-
   if (unlikely (dwfl->lookup_module != NULL))
     {
       free (dwfl->lookup_module);
       dwfl->lookup_module = NULL;
     }
+}
 
+static inline Dwfl_Module *
+use (Dwfl_Module *mod, Dwfl_Module **tailp, Dwfl *dwfl)
+{
+  mod->next = *tailp;
+  *tailp = mod;
+
+  drop_lookup_module (dwfl);
+
+  dwfl->report_last = mod;
   return mod;
 }
 
@@ -166,6 +186,27 @@ Dwfl_Module *
 dwfl_report_module (Dwfl *dwfl, const char *name,
 		    GElf_Addr start, GElf_Addr end)
 {
+  /* Modules are usually reported again in the same order as last time.
+     Then the one we want directly follows the last one reported, and
+     the loop below would leave it where it is.  */
+  Dwfl_Module *last = dwfl->report_last;
+  Dwfl_Module *next = last == NULL ? dwfl->modulelist : last->next;
+  if (next != NULL && (last == NULL || ! last->gc)
+      && next->low_addr == start && next->high_addr == end
+      && !strcmp (next->name, name))
+    {
+      /* If the segment lookup table still has this module, it stays
+	 valid.  */
+      if (next->gc
+	  && (dwfl->lookup_module == NULL
+	      || (size_t) next->segment >= dwfl->lookup_elts
+	      || dwfl->lookup_module[next->segment] != next))
+	drop_lookup_module (dwfl);
+      next->gc = false;
+      dwfl->report_last = next;
+      return next;
+    }
+
   Dwfl_Module **tailp = &dwfl->modulelist, **prevp = tailp;
 
   for (Dwfl_Module *m = *prevp; m != NULL; m = *(prevp = &m->next))
@@ -218,6 +259,8 @@ dwfl_report_end (Dwfl *dwfl,
 				 void *arg),
 		 void *arg)
 {
+  dwfl->report_last = NULL;
+
   Dwfl_Module **tailp = &dwfl->modulelist;
   while (*tailp != NULL)
     {
@@ -231,6 +274,14 @@ dwfl_report_end (Dwfl *dwfl,
       if (m->gc)
 	{
 	  *tailp = m->next;
+
+	  /* The segment lookup table can no longer refer to this module.
+	     If it holds only module boundaries, rebuild it from scratch
+	     so it does not keep the ones of modules gone away.  */
+	  drop_lookup_module (dwfl);
+	  if (dwfl->next_segndx == 0)
+	    dwfl->lookup_elts = 0;
+
 	  __libdwfl_module_free (m);
 	}
       else
@@ -240,3 +291,10 @@ dwfl_report_end (Dwfl *dwfl,
   return 0;
 }
 INTDEF (dwfl_report_end)
+
+void
+dwfl_report_remove_module (Dwfl_Module *mod)
+{
+  if (mod != NULL)
+    mod->gc = true;
+}
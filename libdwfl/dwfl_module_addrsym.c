@@ -239,7 +239,14 @@ search_table (struct search_state *state, int start, int end)
 
    Wrapper for old dwfl_module_addrsym and new dwfl_module_addrinfo.
    adjust_st_value set to true returns adjusted SYM st_value, set to false
-   it will not adjust SYM at all, but does match against resolved values.   */
+   it will not adjust SYM at all, but does match against resolved values.
+
+   This doesn't use a Dwelf_Symtab address index: the values compared
+   are resolved through dwfl_module_getsym_info (function descriptors on
+   ppc64, bias), not the raw st_value the index is sorted by, the main
+   and auxiliary tables are searched as one with globals preferred, and
+   the sizeless symbol fallback and min_label depend on all symbols
+   below ADDR anyway.  */
 static const char *
 __libdwfl_addrsym (Dwfl_Module *_mod, GElf_Addr _addr, GElf_Off *off,
 		   GElf_Sym *_closest_sym, GElf_Word *shndxp,
@@ -0,0 +1,424 @@
+/* Share files and DWARF of modules with the same main file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include "cfi.h"
+#include <search.h>
+
+Dwfl_Module_Cache *
+dwfl_module_cache_begin (void)
+{
+  Dwfl_Module_Cache *cache = calloc (1, sizeof *cache);
+  if (cache == NULL)
+    {
+      __libdwfl_seterrno (DWFL_E_NOMEM);
+      return NULL;
+    }
+
+  cache->refs = 1;
+  rwlock_init (cache->lock);
+  return cache;
+}
+
+/* Drop one reference to CACHE, with its lock held.  */
+static void
+cache_release (Dwfl_Module_Cache *cache)
+{
+  if (--cache->refs > 0)
+    {
+      rwlock_unlock (cache->lock);
+      return;
+    }
+
+  /* Every entry holds a reference, so the tree is empty now.  */
+  assert (cache->root == NULL);
+  rwlock_unlock (cache->lock);
+  rwlock_fini (cache->lock);
+  free (cache);
+}
+
+void
+dwfl_module_cache_end (Dwfl_Module_Cache *cache)
+{
+  if (cache == NULL)
+    return;
+
+  rwlock_wrlock (cache->lock);
+  cache_release (cache);
+}
+
+void
+dwfl_set_module_cache (Dwfl *dwfl, Dwfl_Module_Cache *cache)
+{
+  if (dwfl == NULL)
+    return;
+
+  if (cache != NULL)
+    {
+      rwlock_wrlock (cache->lock);
+      ++cache->refs;
+      rwlock_unlock (cache->lock);
+    }
+
+  if (dwfl->module_cache != NULL)
+    {
+      rwlock_wrlock (dwfl->module_cache->lock);
+      cache_release (dwfl->module_cache);
+    }
+
+  dwfl->module_cache = cache;
+}
+INTDEF (dwfl_set_module_cache)
+
+
+static int
+compare_shared (const void *a, const void *b)
+{
+  const struct dwfl_shared_module *sa = a;
+  const struct dwfl_shared_module *sb = b;
+  if (sa->build_id_len != sb->build_id_len)
+    return sa->build_id_len < sb->build_id_len ? -1 : 1;
+  int cmp = memcmp (sa->build_id, sb->build_id, sa->build_id_len);
+  return cmp != 0 ? cmp : strcmp (sa->name, sb->name);
+}
+
+/* Find the entry for build ID BITS of LEN bytes and file NAME in CACHE
+   and take a reference to it, creating it if need be.  The build ID
+   alone does not tell a stripped file from its original, so it is not
+   enough of a key.  The lock must be held.  */
+static struct dwfl_shared_module *
+cache_get (Dwfl_Module_Cache *cache, const void *bits, int len,
+	   const char *name)
+{
+  size_t name_size = strlen (name) + 1;
+  struct dwfl_shared_module *shared = malloc (sizeof *shared + len
+					      + name_size);
+  if (shared == NULL)
+    return NULL;
+  shared->build_id_len = len;
+  memcpy (shared->build_id, bits, len);
+  shared->name = memcpy (shared->build_id + len, name, name_size);
+
+  struct dwfl_shared_module **found = tsearch (shared, &cache->root,
+					       &compare_shared);
+  if (found == NULL)
+    {
+      free (shared);
+      return NULL;
+    }
+
+  if (*found != shared)
+    {
+      free (shared);
+      shared = *found;
+    }
+  else
+    {
+      shared->cache = cache;
+      shared->refs = 0;
+      shared->main_elf = NULL;
+      shared->main_fd = -1;
+      memset (&shared->debug, 0, sizeof shared->debug);
+      shared->debug.fd = -1;
+      shared->dw = NULL;
+      shared->alt = NULL;
+      shared->alt_elf = NULL;
+      shared->alt_fd = -1;
+      shared->ebl = NULL;
+      ++cache->refs;
+    }
+
+  ++shared->refs;
+  return shared;
+}
+
+/* Whether nothing of MOD refers to its main file yet, so that it can
+   still be replaced by the shared one.  */
+static bool
+main_unused (Dwfl_Module *mod)
+{
+  return (mod->symfile == NULL && mod->ebl == NULL && mod->eh_cfi == NULL
+	  && mod->dw == NULL && mod->debug.elf == NULL
+	  && mod->aux_sym.elf == NULL);
+}
+
+void
+internal_function
+__libdwfl_module_share (Dwfl_Module *mod)
+{
+  Dwfl_Module_Cache *cache = mod->dwfl->module_cache;
+  if (cache == NULL || mod->shared != NULL
+      || mod->main.elf == NULL || mod->main.name == NULL
+      || mod->e_type == ET_REL)
+    return;
+
+  const void *bits;
+  GElf_Addr vaddr;
+  int len;
+  if (__libdwfl_find_elf_build_id (NULL, mod->main.elf,
+				   &bits, &vaddr, &len) <= 0)
+    return;
+
+  rwlock_wrlock (cache->lock);
+
+  struct dwfl_shared_module *shared = cache_get (cache, bits, len,
+						      mod->main.name);
+  if (shared != NULL)
+    {
+      mod->shared = shared;
+      /* An image read from memory may depend on this Dwfl,
+	 so only files are shared.  */
+      if (shared->main_elf == NULL && mod->main.fd != -1)
+	{
+	  /* This is the first module with this file.  */
+	  shared->main_elf = mod->main.elf;
+	  shared->main_fd = mod->main.fd;
+	  mod->shared_main = true;
+	}
+      else if (shared->main_elf != NULL && main_unused (mod))
+	{
+	  /* Use the file another module already has open.  */
+	  if (elf_end (mod->main.elf) == 0 && mod->main.fd != -1)
+	    close (mod->main.fd);
+	  mod->main.elf = shared->main_elf;
+	  mod->main.fd = shared->main_fd;
+	  mod->shared_main = true;
+	}
+    }
+
+  rwlock_unlock (cache->lock);
+}
+
+bool
+internal_function
+__libdwfl_module_shared_dwarf (Dwfl_Module *mod)
+{
+  struct dwfl_shared_module *shared = mod->shared;
+  if (shared == NULL || mod->dw != NULL || mod->debug.elf != NULL)
+    return false;
+
+  rwlock_rdlock (shared->cache->lock);
+
+  /* DWARF read from the main file can only be used with that file.  */
+  bool usable = (shared->dw != NULL
+		 && (shared->debug.elf != shared->main_elf
+		     || mod->main.elf == shared->main_elf));
+  if (usable)
+    {
+      mod->debug = shared->debug;
+      mod->dw = shared->dw;
+      mod->alt = shared->alt;
+      mod->alt_elf = shared->alt_elf;
+      mod->alt_fd = shared->alt_fd;
+      mod->shared_dw = true;
+    }
+
+  rwlock_unlock (shared->cache->lock);
+
+  if (usable)
+    /* Until we have iterated through all CU's, we might do lazy lookups.  */
+    mod->lazycu = 1;
+
+  return usable;
+}
+
+/* Read all units of DW and their abbreviations.  libdw reads those as
+   they are first needed, which is not safe when several threads use
+   one Dwarf.  Once everything is read, they are only looked up.  */
+static void
+read_units (Dwarf *dw)
+{
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie;
+  while (INTUSE(dwarf_get_units) (dw, cu, &cu, NULL, NULL,
+				  &cudie, NULL) == 0)
+    {
+      Dwarf_Off offset = 0;
+      size_t length;
+      Dwarf_Abbrev *abbrev;
+      while ((abbrev = dwarf_getabbrev (&cudie, offset, &length)) != NULL
+	     && abbrev != DWARF_END_ABBREV)
+	offset += length;
+    }
+}
+
+void
+internal_function
+__libdwfl_module_share_dwarf (Dwfl_Module *mod)
+{
+  struct dwfl_shared_module *shared = mod->shared;
+  if (shared == NULL || mod->shared_dw || mod->dw == NULL
+      || (mod->debug.elf == mod->main.elf && ! mod->shared_main))
+    return;
+
+  rwlock_rdlock (shared->cache->lock);
+  bool wanted = shared->dw == NULL;
+  rwlock_unlock (shared->cache->lock);
+  if (! wanted)
+    return;
+
+  /* Nothing else uses MOD->dw yet, so get it ready for other threads
+     before they can see it.  The address ranges of the units are also
+     only computed once, and so is the .debug_frame CFI.  Its contents
+     are read under the lock of the CFI.  */
+  read_units (mod->dw);
+  if (mod->alt != NULL)
+    read_units (mod->alt);
+  Dwarf_Aranges *aranges;
+  (void) __libdw_getdieranges (mod->dw, &aranges, NULL);
+  (void) INTUSE(dwarf_getcfi) (mod->dw);
+
+  rwlock_wrlock (shared->cache->lock);
+
+  if (shared->dw == NULL)
+    {
+      shared->debug = mod->debug;
+      shared->dw = mod->dw;
+      shared->alt = mod->alt;
+      shared->alt_elf = mod->alt_elf;
+      shared->alt_fd = mod->alt_fd;
+      mod->shared_dw = true;
+    }
+
+  rwlock_unlock (shared->cache->lock);
+}
+
+Dwfl_Error
+internal_function
+__libdwfl_module_shared_cfi_ebl (Dwfl_Module *mod, Dwarf_CFI *cfi)
+{
+  struct dwfl_shared_module *shared = mod->shared;
+  Dwfl_Error error = DWFL_E_NOERROR;
+
+  rwlock_wrlock (shared->cache->lock);
+
+  /* The CFI belongs to the shared Dwarf, so it cannot use the backend
+     of one of the modules, which goes away with that module.  */
+  if (shared->ebl == NULL)
+    shared->ebl = ebl_openbackend (shared->debug.elf);
+  if (shared->ebl == NULL)
+    error = DWFL_E_LIBEBL;
+  else if (cfi->ebl == NULL)
+    cfi->ebl = shared->ebl;
+
+  rwlock_unlock (shared->cache->lock);
+
+  return error;
+}
+
+static void
+shared_free (struct dwfl_shared_module *shared)
+{
+  if (shared->dw != NULL)
+    {
+      /* The backend of the CFI is ours, see below.  */
+      if (shared->dw->cfi != NULL && shared->dw->cfi->ebl == shared->ebl)
+	shared->dw->cfi->ebl = NULL;
+      INTUSE(dwarf_end) (shared->dw);
+      if (shared->alt != NULL)
+	{
+	  INTUSE(dwarf_end) (shared->alt);
+	  if (shared->alt_elf != NULL)
+	    elf_end (shared->alt_elf);
+	  if (shared->alt_fd != -1)
+	    close (shared->alt_fd);
+	}
+    }
+
+  if (shared->ebl != NULL)
+    ebl_closebackend (shared->ebl);
+
+  if (shared->debug.elf != shared->main_elf)
+    {
+      if (shared->debug.elf != NULL && elf_end (shared->debug.elf) == 0
+	  && shared->debug.fd != -1)
+	close (shared->debug.fd);
+      free (shared->debug.name);
+    }
+
+  if (shared->main_elf != NULL && elf_end (shared->main_elf) == 0
+      && shared->main_fd != -1)
+    close (shared->main_fd);
+
+  free (shared);
+}
+
+struct dwfl_shared_module *
+internal_function
+__libdwfl_module_unshare (Dwfl_Module *mod)
+{
+  struct dwfl_shared_module *shared = mod->shared;
+  if (shared == NULL)
+    return NULL;
+
+  /* Leave the shared parts out of freeing MOD.  */
+  if (mod->shared_dw)
+    {
+      mod->dw = NULL;
+      mod->alt = NULL;
+      mod->alt_elf = NULL;
+      mod->alt_fd = -1;
+      mod->dwarf_cfi = NULL;
+      mod->debug.name = NULL;
+      mod->debug.elf = NULL;
+      mod->debug.fd = -1;
+    }
+  if (mod->shared_main)
+    {
+      if (mod->debug.elf == mod->main.elf)
+	mod->debug.elf = NULL;
+      mod->main.elf = NULL;
+      mod->main.fd = -1;
+    }
+  mod->shared = NULL;
+
+  return shared;
+}
+
+void
+internal_function
+__libdwfl_shared_module_release (struct dwfl_shared_module *shared)
+{
+  if (shared == NULL)
+    return;
+
+  Dwfl_Module_Cache *cache = shared->cache;
+  rwlock_wrlock (cache->lock);
+  if (--shared->refs == 0)
+    {
+      tdelete (shared, &cache->root, &compare_shared);
+      shared_free (shared);
+      cache_release (cache);
+    }
+  else
+    rwlock_unlock (cache->lock);
+}
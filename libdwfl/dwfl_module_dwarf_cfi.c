@@ -37,7 +37,17 @@ Dwarf_CFI *
 internal_function
 __libdwfl_set_cfi (Dwfl_Module *mod, Dwarf_CFI **slot, Dwarf_CFI *cfi)
 {
-  if (cfi != NULL && cfi->ebl == NULL)
+  /* The CFI of shared DWARF is looked at with the cache lock held.  */
+  if (cfi != NULL && slot == &mod->dwarf_cfi && mod->shared_dw)
+    {
+      Dwfl_Error error = __libdwfl_module_shared_cfi_ebl (mod, cfi);
+      if (error != DWFL_E_NOERROR)
+	{
+	  __libdwfl_seterrno (error);
+	  return NULL;
+	}
+    }
+  else if (cfi != NULL && cfi->ebl == NULL)
     {
       Dwfl_Error error = __libdwfl_module_getebl (mod);
       if (error == DWFL_E_NOERROR)
@@ -233,6 +233,9 @@ __libdwfl_getelf (Dwfl_Module *mod)
     mod_verify_build_id (mod);
 
   mod->main_bias = mod->e_type == ET_REL ? 0 : mod->low_addr - mod->main.vaddr;
+
+  if (mod->main.elf != NULL)
+    __libdwfl_module_share (mod);
 }
 
 static inline void
@@ -1132,6 +1135,7 @@ find_symtab (Dwfl_Module *mod)
     {
     elferr:
       mod->symdata = NULL;
+      mod->symscn = NULL;
       mod->syments = 0;
       mod->first_global = 0;
       mod->symerr = DWFL_E (LIBELF, elf_errno ());
@@ -1202,6 +1206,7 @@ find_symtab (Dwfl_Module *mod)
   mod->symdata = elf_getdata (symscn, NULL);
   if (mod->symdata == NULL || mod->symdata->d_buf == NULL)
     goto elferr;
+  mod->symscn = symscn;
 
   // Sanity check number of symbols.
   shdr = gelf_getshdr (symscn, &shdr_mem);
@@ -1390,6 +1395,13 @@ find_dw (Dwfl_Module *mod)
   if (mod->dwerr != DWFL_E_NOERROR)
     return;
 
+  /* Another module with the same build ID might have done all the work.
+     A main file preinstalled by dwfl_report_elf has not joined the cache
+     in __libdwfl_getelf, so make sure it does.  */
+  __libdwfl_module_share (mod);
+  if (__libdwfl_module_shared_dwarf (mod))
+    return;
+
   /* First see if the main ELF file has the debugging information.  */
   mod->dwerr = load_dw (mod, &mod->main);
   switch (mod->dwerr)
@@ -1402,6 +1414,7 @@ find_dw (Dwfl_Module *mod)
 	 everything about the debug file has been setup (the
 	 find_debuginfo callback might need it).  */
       find_debug_altlink (mod, mod->main.name);
+      __libdwfl_module_share_dwarf (mod);
       return;
 
     case DWFL_E_NO_DWARF:
@@ -1423,6 +1436,7 @@ find_dw (Dwfl_Module *mod)
 	     everything about the debug file has been setup (the
 	     find_debuginfo callback might need it).  */
 	  find_debug_altlink (mod, mod->debug.name);
+	  __libdwfl_module_share_dwarf (mod);
 	  return;
 	}
 
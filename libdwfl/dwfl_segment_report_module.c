@@ -68,6 +68,61 @@ struct read_state
   size_t *buffer_available;
 };
 
+/* A module image in a mapped core file that is read only as libelf
+   needs it.  Each piece of the file image is at VADDR, found at CONTENTS
+   in the mapping of CORE, of which AVAILABLE bytes are in the dump.  */
+struct memory_image
+{
+  Elf *core;
+  size_t npieces;
+  struct
+  {
+    GElf_Off offset;
+    size_t size;
+    GElf_Addr vaddr;
+    const void *contents;
+    size_t available;
+  } pieces[];
+};
+
+static ssize_t
+memory_image_read (void *arg, void *buf, size_t len, int64_t offset)
+{
+  struct memory_image *image = arg;
+
+  /* Parts of the file image outside its segments read as zero,
+     just as in an image read in eagerly.  */
+  memset (buf, 0, len);
+
+  for (size_t i = 0; i < image->npieces; ++i)
+    {
+      GElf_Off start = MAX ((GElf_Off) offset, image->pieces[i].offset);
+      GElf_Off end = MIN ((GElf_Off) offset + len,
+			  image->pieces[i].offset + image->pieces[i].size);
+      if (start >= end)
+	continue;
+
+      /* Data of a segment missing from the dump stays zero too.  */
+      end = MIN (end, image->pieces[i].offset + image->pieces[i].available);
+      if (start >= end)
+	continue;
+
+      memcpy (buf + (start - offset),
+	      image->pieces[i].contents + (start - image->pieces[i].offset),
+	      end - start);
+    }
+
+  return len;
+}
+
+static void
+memory_image_end (void *arg)
+{
+  struct memory_image *image = arg;
+  elf_end (image->core);
+  free (image);
+}
+
 /* Return user segment index closest to ADDR but not above it.
    If NEXT, return the closest to ADDR but not below it.  */
 static int
@@ -292,7 +347,7 @@ dwfl_segment_report_module (Dwfl *dwfl, int ndx, const char *name,
 			    void *memory_callback_arg,
 			    Dwfl_Module_Callback *read_eagerly,
 			    void *read_eagerly_arg,
-			    size_t maxread,
+			    size_t maxread, Elf *lazy,
 			    const void *note_file, size_t note_file_size,
 			    const struct r_debug_info *r_debug_info)
 {
@@ -955,18 +1010,91 @@ dwfl_segment_report_module (Dwfl *dwfl, int ndx, const char *name,
 			       : dynstr_vaddr + dynstrsz - start);
   const GElf_Off whole = MAX (file_trimmed_end, shdrs_end);
 
-  if (elf == NULL
-      && (*read_eagerly) (MODCB_ARGS (mod), &buffer, &buffer_available,
-			  cost, worthwhile, whole, contiguous,
-			  read_eagerly_arg, &elf)
-      && elf == NULL)
+  bool read_now = (elf == NULL
+		   && (*read_eagerly) (MODCB_ARGS (mod), &buffer,
+				       &buffer_available, cost, worthwhile,
+				       whole, contiguous, read_eagerly_arg,
+				       &elf)
+		   && elf == NULL);
+  if (read_now && file_trimmed_end > maxread)
+    file_trimmed_end = maxread;
+
+  if (read_now && lazy != NULL)
+    {
+      /* The caller wants the whole file, and the memory stays around.
+	 Rather than copying it all, make an image that reads each part
+	 of the virtual file from memory when it is first used.  */
+      read_now = false;
+
+      size_t npieces = contiguous < file_trimmed_end ? phnum : 1;
+      struct memory_image *image
+	= malloc (sizeof *image + npieces * sizeof image->pieces[0]);
+      if (unlikely (image == NULL))
+	goto out;
+      image->npieces = 0;
+
+      if (contiguous < file_trimmed_end)
+	for (uint_fast16_t i = 0; i < phnum; ++i)
+	  {
+	    bool is32 = (ei_class == ELFCLASS32);
+	    GElf_Word type = is32 ? p32[i].p_type : p64[i].p_type;
+	    GElf_Addr vaddr = is32 ? p32[i].p_vaddr : p64[i].p_vaddr;
+	    GElf_Off offset = is32 ? p32[i].p_offset : p64[i].p_offset;
+	    GElf_Xword filesz = is32 ? p32[i].p_filesz : p64[i].p_filesz;
+
+	    if (type != PT_LOAD || offset >= file_trimmed_end)
+	      continue;
+
+	    size_t n = image->npieces++;
+	    image->pieces[n].offset = offset;
+	    image->pieces[n].size = MIN (filesz, file_trimmed_end - offset);
+	    image->pieces[n].vaddr = vaddr + bias;
+	  }
+      else
+	{
+	  /* The whole file sits contiguous in memory.  */
+	  image->pieces[0].offset = 0;
+	  image->pieces[0].size = file_trimmed_end;
+	  image->pieces[0].vaddr = start;
+	  image->npieces = 1;
+	}
+
+      /* Find each piece in the mapping, which is not copied.  */
+      for (size_t i = 0; i < image->npieces; ++i)
+	{
+	  void *contents = NULL;
+	  size_t available = 0;
+	  if (! (*memory_callback) (dwfl, addr_segndx (dwfl, segment,
+						       image->pieces[i].vaddr,
+						       false),
+				    &contents, &available,
+				    image->pieces[i].vaddr, 1,
+				    memory_callback_arg))
+	    available = 0;
+	  image->pieces[i].contents = contents;
+	  image->pieces[i].available = available;
+	}
+
+      /* The pieces point into the mapping of LAZY, which is kept for as
+	 long as the image is used.  */
+      image->core = elf_begin (-1, ELF_C_READ_MMAP, lazy);
+      elf = NULL;
+      if (likely (image->core != NULL))
+	{
+	  elf = elf_begin_reader (memory_image_read, memory_image_end, image,
+				  file_trimmed_end);
+	  if (unlikely (elf == NULL))
+	    elf_end (image->core);
+	}
+      if (unlikely (elf == NULL))
+	free (image);
+    }
+
+  if (read_now)
     {
       /* The caller wants to read the whole file in right now, but hasn't
 	 done it for us.  Fill in a local image of the virtual file.  */
 
-      if (file_trimmed_end > maxread)
-	file_trimmed_end = maxread;
-
       void *contents = calloc (1, file_trimmed_end);
       if (unlikely (contents == NULL))
 	goto out;
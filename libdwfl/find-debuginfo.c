@@ -81,7 +81,7 @@ static inline bool
 check_crc (int fd, GElf_Word debuglink_crc)
 {
   uint32_t file_crc;
-  return (__libdwfl_crc32_file (fd, &file_crc) == 0
+  return (__libdwfl_crc32_file_cached (fd, &file_crc) == 0
 	  && file_crc == debuglink_crc);
 }
 
@@ -400,3 +400,272 @@ unzip (int fd, off_t start_offset,
 
   return DWFL_E_NOERROR;
 }
+
+#if !USE_INFLATE
+/* Random access to gzip files.  A deflate stream has no seek points of
+   its own, but decompression can resume at any block boundary given the
+   32K of output before it.  So inflate the file once, saving the state
+   at block boundaries about every GZ_SPAN bytes of output, and later
+   inflate only the chunk between two such checkpoints when libelf reads
+   from it.  This trades a second pass over the parts read for never
+   holding the whole image in memory.  */
+
+#include <fcntl.h>
+
+#define GZ_SPAN		(1 << 20)
+#define GZ_WINDOW	32768
+
+struct gz_point
+{
+  uint64_t out;			/* Offset in the uncompressed image.  */
+  uint64_t in;			/* Offset of the first full byte to read.  */
+  int bits;			/* Bits of the byte before IN still to use.  */
+  unsigned char window[GZ_WINDOW]; /* Output before OUT.  */
+};
+
+struct gz_seekable
+{
+  int fd;
+  off_t start_offset;
+  size_t mapped_size;
+  struct gz_point *points;
+};
+
+static void
+gz_seekable_end (void *arg)
+{
+  struct gz_seekable *gz = arg;
+  close (gz->fd);
+  free (gz->points);
+  free (gz);
+}
+
+/* Read more input at IN for STRM into BUF, from MAPPED if it's there.  */
+static bool
+gz_refill (z_stream *strm, int fd, off_t start_offset, void *mapped,
+	   size_t mapped_size, uint64_t in, unsigned char *buf)
+{
+  size_t n = MIN (mapped_size - in, (size_t) READ_SIZE);
+  if (n == 0)
+    return false;
+  if (mapped != NULL)
+    strm->next_in = mapped + in;
+  else
+    {
+      ssize_t r = pread_retry (fd, buf, n, start_offset + in);
+      if (r <= 0)
+	return false;
+      n = r;
+      strm->next_in = buf;
+    }
+  strm->avail_in = n;
+  return true;
+}
+
+static bool
+gz_decode_chunk (void *arg, size_t ndx, uint64_t start __attribute__ ((unused)),
+		 void *out, size_t size)
+{
+  struct gz_seekable *gz = arg;
+  const struct gz_point *point = &gz->points[ndx];
+
+  unsigned char *buf = malloc (READ_SIZE);
+  if (unlikely (buf == NULL))
+    return false;
+
+  z_stream strm = { .next_in = Z_NULL };
+  if (inflateInit2 (&strm, -15) != Z_OK)
+    {
+      free (buf);
+      return false;
+    }
+
+  bool ok = true;
+  if (point->bits != 0)
+    {
+      unsigned char byte;
+      ok = (pread_retry (gz->fd, &byte, 1,
+			 gz->start_offset + point->in - 1) == 1
+	    && inflatePrime (&strm, point->bits,
+			     byte >> (8 - point->bits)) == Z_OK);
+    }
+  if (ok && point->out != 0)
+    {
+      unsigned int len = MIN (point->out, (uint64_t) GZ_WINDOW);
+      ok = inflateSetDictionary (&strm, point->window + GZ_WINDOW - len,
+				 len) == Z_OK;
+    }
+
+  strm.next_out = out;
+  strm.avail_out = size;
+  uint64_t in = point->in;
+  while (ok && strm.avail_out > 0)
+    {
+      if (strm.avail_in == 0)
+	{
+	  ok = gz_refill (&strm, gz->fd, gz->start_offset, NULL,
+			  gz->mapped_size, in, buf);
+	  if (!ok)
+	    break;
+	  in += strm.avail_in;
+	}
+      int result = inflate (&strm, Z_NO_FLUSH);
+      if (result == Z_STREAM_END)
+	break;
+      ok = result == Z_OK;
+    }
+
+  inflateEnd (&strm);
+  free (buf);
+  return ok && strm.avail_out == 0;
+}
+
+/* If the MAPPED_SIZE bytes at START_OFFSET of FD are a single gzip
+   member inflating to more than GZ_SPAN bytes, replace *ELFP with
+   an Elf reading the uncompressed image in chunks.  */
+Dwfl_Error internal_function
+__libdw_open_gzip_seekable (int fd, off_t start_offset, void *mapped,
+			    size_t mapped_size, Elf **elfp)
+{
+  /* The trailer gives the uncompressed size modulo 2^32, which is enough
+     to tell small files apart cheaply, before inflating anything.  */
+  unsigned char header[sizeof MAGIC - 1];
+  unsigned char isize[4];
+  if (mapped_size < 18
+      || pread_retry (fd, header, sizeof header,
+		      start_offset) != sizeof header
+      || memcmp (header, MAGIC, sizeof header) != 0
+      || pread_retry (fd, isize, sizeof isize,
+		      start_offset + mapped_size - 4) != sizeof isize)
+    return DWFL_E_BADELF;
+  uint32_t size_mod = (isize[0] | isize[1] << 8 | isize[2] << 16
+		       | (uint32_t) isize[3] << 24);
+  if (mapped_size < UINT32_MAX && size_mod <= GZ_SPAN)
+    return DWFL_E_BADELF;
+
+  unsigned char *buf = malloc (READ_SIZE);
+  unsigned char *window = malloc (GZ_WINDOW);
+  if (unlikely (buf == NULL || window == NULL))
+    {
+      free (buf);
+      free (window);
+      return DWFL_E_NOMEM;
+    }
+
+  z_stream strm = { .next_in = Z_NULL };
+  if (inflateInit2 (&strm, 15 + 16) != Z_OK)
+    {
+      free (buf);
+      free (window);
+      return DWFL_E_NOMEM;
+    }
+
+  Dwfl_Error error = DWFL_E_BADELF;
+  struct gz_point *points = NULL;
+  size_t npoints = 0;
+  size_t allocated = 0;
+  uint64_t totin = 0;
+  uint64_t totout = 0;
+  uint64_t last = 0;
+  int result = Z_OK;
+  while (result != Z_STREAM_END)
+    {
+      if (strm.avail_in == 0
+	  && !gz_refill (&strm, fd, start_offset, mapped, mapped_size,
+			 totin, buf))
+	goto fail;
+
+      if (strm.avail_out == 0)
+	{
+	  strm.next_out = window;
+	  strm.avail_out = GZ_WINDOW;
+	}
+
+      unsigned int avail_in = strm.avail_in;
+      unsigned int avail_out = strm.avail_out;
+      result = inflate (&strm, Z_BLOCK);
+      totin += avail_in - strm.avail_in;
+      totout += avail_out - strm.avail_out;
+      if (result == Z_MEM_ERROR)
+	{
+	  error = DWFL_E_NOMEM;
+	  goto fail;
+	}
+      if (result != Z_OK && result != Z_STREAM_END)
+	goto fail;
+
+      /* At the end of a block header which is not the last one.  */
+      if (result == Z_OK
+	  && (strm.data_type & 128) != 0 && (strm.data_type & 64) == 0
+	  && (totout == 0 || totout - last >= GZ_SPAN))
+	{
+	  if (npoints == allocated)
+	    {
+	      allocated = allocated == 0 ? 16 : 2 * allocated;
+	      struct gz_point *newp = realloc (points,
+					       allocated * sizeof *points);
+	      if (unlikely (newp == NULL))
+		{
+		  error = DWFL_E_NOMEM;
+		  goto fail;
+		}
+	      points = newp;
+	    }
+
+	  /* Unroll the circular window so it ends at TOTOUT.  */
+	  struct gz_point *point = &points[npoints++];
+	  point->out = totout;
+	  point->in = totin;
+	  point->bits = strm.data_type & 7;
+	  size_t used = GZ_WINDOW - strm.avail_out;
+	  memcpy (point->window, window + used, GZ_WINDOW - used);
+	  memcpy (point->window + GZ_WINDOW - used, window, used);
+	  last = totout;
+	}
+    }
+
+  /* A single member covering the whole file, else leave it to
+     __libdw_gunzip, which copes with the rest.  */
+  if (totin != mapped_size || npoints < 2 || totout > SIZE_MAX
+      || points[0].out != 0)
+    goto fail;
+
+  inflateEnd (&strm);
+  free (buf);
+  free (window);
+
+  uint64_t *starts = malloc (npoints * sizeof starts[0]);
+  struct gz_seekable *gz = malloc (sizeof *gz);
+  if (unlikely (starts == NULL || gz == NULL))
+    {
+      free (starts);
+      free (gz);
+      free (points);
+      return DWFL_E_NOMEM;
+    }
+  for (size_t i = 0; i < npoints; ++i)
+    starts[i] = points[i].out;
+
+  gz->fd = fcntl (fd, F_DUPFD_CLOEXEC, 0);
+  if (gz->fd < 0)
+    {
+      free (starts);
+      free (gz);
+      free (points);
+      return DWFL_E_ERRNO;
+    }
+  gz->start_offset = start_offset;
+  gz->mapped_size = mapped_size;
+  gz->points = points;
+
+  return __libdw_open_seekable (totout, npoints, starts, gz_decode_chunk,
+				gz_seekable_end, gz, elfp);
+
+ fail:
+  inflateEnd (&strm);
+  free (buf);
+  free (window);
+  free (points);
+  return error;
+}
+#endif
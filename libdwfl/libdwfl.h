@@ -49,6 +49,9 @@ typedef struct Dwfl_Thread Dwfl_Thread;
    PC location described by an FDE belonging to Dwfl_Thread.  */
 typedef struct Dwfl_Frame Dwfl_Frame;
 
+/* Files and DWARF that modules of several sessions share.  */
+typedef struct Dwfl_Module_Cache Dwfl_Module_Cache;
+
 /* Handle for debuginfod-client connection.  */
 #ifndef _ELFUTILS_DEBUGINFOD_CLIENT_TYPEDEF
 typedef struct debuginfod_client debuginfod_client;
@@ -95,6 +98,31 @@ extern Dwfl *dwfl_begin (const Dwfl_Callbacks *callbacks)
 /* End a session.  */
 extern void dwfl_end (Dwfl *);
 
+/* Create a cache through which the modules of all sessions using it
+   share what they read about the same file.  Modules whose main ELF
+   file has the same build ID and file name then use one Elf handle for
+   it, and one Dwarf handle (with its CFI) and debuginfo file, so that
+   each is read and decoded only once.  Files with the same build ID
+   but different names, like a stripped file and its original, are
+   kept apart.  Relocatable (ET_REL) modules and modules without a file
+   name are never shared.
+   What is shared is freed with the last module using it.
+   Returns NULL for an allocation error.  */
+extern Dwfl_Module_Cache *dwfl_module_cache_begin (void);
+
+/* Release the caller's reference to CACHE.  It is freed once no session
+   uses it anymore.  */
+extern void dwfl_module_cache_end (Dwfl_Module_Cache *cache);
+
+/* Make DWFL use CACHE for modules it opens files for from now on, or
+   stop sharing them if CACHE is NULL.  Sessions using CACHE may be used
+   from different threads.  The shared Elf and Dwarf handles are then
+   used concurrently, which needs libelf and libdw built with
+   --enable-thread-safety.  All units of a Dwarf handle and their
+   abbreviations are read before it is shared, since libdw does not
+   lock reading them later.  */
+extern void dwfl_set_module_cache (Dwfl *dwfl, Dwfl_Module_Cache *cache);
+
 /* Return implementation's version string suitable for printing.  */
 extern const char *dwfl_version (Dwfl *);
 
@@ -184,9 +212,17 @@ extern int dwfl_report_end (Dwfl *dwfl,
    dwfl_report_* can be made on DWFL until dwfl_report_end is called.
    This is like dwfl_report_begin, but all the old modules are kept on.
    More dwfl_report_* calls can follow to add more modules.
-   When dwfl_report_end is called, no old modules will be removed.  */
+   When dwfl_report_end is called, no old modules will be removed
+   except those passed to dwfl_report_remove_module.  */
 extern void dwfl_report_begin_add (Dwfl *dwfl);
 
+/* Report that MOD is no longer present in the address space.  It will be
+   deleted by dwfl_report_end just like a module that was not re-reported
+   after dwfl_report_begin.  Together with dwfl_report_begin_add this
+   applies single changes, such as a library being loaded or unloaded,
+   while every other module keeps its loaded DWARF, CFI and symbols.  */
+extern void dwfl_report_remove_module (Dwfl_Module *mod);
+
 
 /* Return the name of the module, and for each non-null argument store
    interesting details: *USERDATA is a location for storing your own
@@ -361,8 +397,14 @@ extern int dwfl_linux_kernel_report_offline (Dwfl *dwfl, const char *release,
    supply non-NULL EXECUTABLE, otherwise dynamic libraries will not be loaded
    into the DWFL map.  This might call dwfl_report_elf on file names found in
    the dump if reading some link_map files is the only way to ascertain those
-   modules' addresses.  Returns the number of modules reported, or -1 for
-   errors.  */
+   modules' addresses.  A module image that is found whole in a mapped
+   ELF uses that part of the mapping in place, without a reference to
+   ELF, which must therefore be kept until DWFL is ended.  Other images
+   in an ELF opened with ELF_C_READ_MMAP are not copied either; their
+   contents are read from the mapping only as they are used, and each
+   such image holds a reference to ELF of its own.  Parts of those images
+   missing from the dump read as zeros, as in an image that is copied.
+   Returns the number of modules reported, or -1 for errors.  */
 extern int dwfl_core_file_report (Dwfl *dwfl, Elf *elf, const char *executable);
 
 /* Call dwfl_report_module for each file mapped into the address space of PID.
@@ -117,6 +117,7 @@ struct Dwfl
   debuginfod_client *debuginfod;
 #endif
   Dwfl_Module *modulelist;    /* List in order used by full traversals.  */
+  Dwfl_Module *report_last;   /* Last module reported since report_begin.  */
 
   Dwfl_Process *process;
   Dwfl_Error attacherr;      /* Previous error attaching process.  */
@@ -134,6 +135,8 @@ struct Dwfl
   int next_segndx;
 
   struct Dwfl_User_Core *user_core;
+
+  Dwfl_Module_Cache *module_cache; /* Shared with other Dwfl's, or NULL.  */
 };
 
 #define OFFLINE_REDZONE		0x10000
@@ -176,6 +179,8 @@ struct Dwfl_Module
 
   struct dwfl_file *symfile;	/* Either main or debug.  */
   Elf_Data *symdata;		/* Data in the ELF symbol table section.  */
+  Elf_Scn *symscn;		/* That section, NULL if from the dynamic segment.  */
+  Dwelf_Symtab *symtab_index;	/* Its names, made when resolving relocs.  */
   Elf_Data *aux_symdata;	/* Data in the auxiliary ELF symbol table.  */
   size_t syments;		/* sh_size / sh_entsize of that section.  */
   size_t aux_syments;		/* sh_size / sh_entsize of aux_sym section.  */
@@ -217,6 +222,42 @@ struct Dwfl_Module
   int segment;			/* Index of first segment table entry.  */
   bool gc;			/* Mark/sweep flag.  */
   bool is_executable;		/* Use Dwfl::executable_for_core?  */
+
+  struct dwfl_shared_module *shared; /* Entry for our main file, or NULL.  */
+  bool shared_main;		/* MAIN belongs to SHARED.  */
+  bool shared_dw;		/* DW, its files and DEBUG belong to SHARED.  */
+};
+
+/* See its typedef in libdwfl.h.  */
+
+struct Dwfl_Module_Cache
+{
+  void *root;			/* tsearch tree of dwfl_shared_module.  */
+  unsigned int refs;		/* Users, Dwfl's and entries.  */
+  rwlock_define (, lock);
+};
+
+/* What modules with the same build ID and main file name in a
+   Dwfl_Module_Cache share.  The fields are set once, by the first
+   module with a usable one.  */
+
+struct dwfl_shared_module
+{
+  Dwfl_Module_Cache *cache;
+  unsigned int refs;		/* Modules using this entry.  */
+
+  Elf *main_elf;		/* Main file, or NULL.  */
+  int main_fd;
+  struct dwfl_file debug;	/* File DW was read from.  */
+  Dwarf *dw;
+  Dwarf *alt;
+  Elf *alt_elf;
+  int alt_fd;
+  Ebl *ebl;			/* For the CFI of DW.  */
+
+  const char *name;		/* Main file name, after BUILD_ID.  */
+  int build_id_len;
+  unsigned char build_id[];
 };
 
 /* This holds information common for all the threads/tasks/TIDs of one process
@@ -465,6 +506,32 @@ extern void __libdwfl_module_free (Dwfl_Module *mod) internal_function;
 /* Find the main ELF file, update MOD->elferr and/or MOD->main.elf.  */
 extern void __libdwfl_getelf (Dwfl_Module *mod) internal_function;
 
+/* Join the Dwfl_Module_Cache entry for the build ID and name of MOD's
+   main file, and share that file with the other modules there if
+   possible.  */
+extern void __libdwfl_module_share (Dwfl_Module *mod) internal_function;
+
+/* Use the Dwarf of another module with the same main file.
+   Returns true if MOD->dw is now set up.  */
+extern bool __libdwfl_module_shared_dwarf (Dwfl_Module *mod)
+  internal_function;
+
+/* Offer the Dwarf just set up for MOD to later modules.  */
+extern void __libdwfl_module_share_dwarf (Dwfl_Module *mod)
+  internal_function;
+
+/* Set the backend of CFI, which belongs to the shared MOD->dw.  */
+extern Dwfl_Error __libdwfl_module_shared_cfi_ebl (Dwfl_Module *mod,
+						   Dwarf_CFI *cfi)
+  internal_function;
+
+/* Clear the parts of MOD that belong to its cache entry, which is
+   returned to be released after freeing the rest of MOD.  */
+extern struct dwfl_shared_module *__libdwfl_module_unshare (Dwfl_Module *mod)
+  internal_function;
+extern void __libdwfl_shared_module_release (struct dwfl_shared_module *sh)
+  internal_function;
+
 /* Process relocations in debugging sections in an ET_REL file.
    FILE must be opened with ELF_C_READ_MMAP_PRIVATE or ELF_C_READ,
    to make it possible to relocate the data in place (or ELF_C_RDWR or
@@ -550,6 +617,10 @@ extern uint32_t __libdwfl_crc32 (uint32_t crc, unsigned char *buf, size_t len)
   attribute_hidden;
 extern int __libdwfl_crc32_file (int fd, uint32_t *resp) attribute_hidden;
 
+/* Same, but reuse the CRC computed before for the same unchanged file.  */
+extern int __libdwfl_crc32_file_cached (int fd, uint32_t *resp)
+  attribute_hidden;
+
 
 /* Given ELF and some parameters return TRUE if the *P return value parameters
    have been successfully filled in.  Any of the *P parameters can be NULL.  */
@@ -614,6 +685,39 @@ extern Dwfl_Error __libdw_unzstd (int fd, off_t start_offset,
 				  void **whole, size_t *whole_size)
   internal_function;
 
+/* Decompress chunk NDX, which starts at offset START of the image, into
+   the SIZE bytes at OUT.  */
+typedef bool Dwfl_Seekable_Decode (void *arg, size_t ndx, uint64_t start,
+				   void *out, size_t size);
+
+/* Open an Elf handle on an image of SIZE bytes, made of NCHUNKS chunks
+   starting at the ascending offsets STARTS, the first at zero.  DECODE
+   decompresses a chunk when it is read.  The Elf handle owns STARTS and
+   ARG, END is called on ARG when it is ended, or if this fails.  */
+extern Dwfl_Error __libdw_open_seekable (uint64_t size, size_t nchunks,
+					 uint64_t *starts,
+					 Dwfl_Seekable_Decode *decode,
+					 void (*end) (void *), void *arg,
+					 Elf **elfp)
+  internal_function;
+
+/* Open an Elf handle on a compressed image which decompresses only the
+   parts of the file being read.  DWFL_E_BADELF if the image is not in
+   the format, or not in a form that allows this; it then has to be
+   decompressed in full.  */
+extern Dwfl_Error __libdw_open_gzip_seekable (int fd, off_t start_offset,
+					      void *mapped, size_t mapped_size,
+					      Elf **elfp)
+  internal_function;
+extern Dwfl_Error __libdw_open_xz_seekable (int fd, off_t start_offset,
+					    void *mapped, size_t mapped_size,
+					    Elf **elfp)
+  internal_function;
+extern Dwfl_Error __libdw_open_zstd_seekable (int fd, off_t start_offset,
+					      void *mapped, size_t mapped_size,
+					      Elf **elfp)
+  internal_function;
+
 /* Skip the image header before a file image: updates *START_OFFSET.  */
 extern Dwfl_Error __libdw_image_header (int fd, off_t *start_offset,
 					void *mapped, size_t mapped_size)
@@ -696,13 +800,17 @@ struct r_debug_info
 };
 
 /* ...
- */
+   If LAZY is not NULL, it is the mapped ELF file MEMORY_CALLBACK returns
+   the contents of in place.  A module image READ_EAGERLY asks for is
+   then not copied in, but read from that mapping as it is used.  The
+   image holds a reference to LAZY.  Parts of the image missing from the
+   dump read as zeros, as they do when it is copied in.  */
 extern int dwfl_segment_report_module (Dwfl *dwfl, int ndx, const char *name,
 				       Dwfl_Memory_Callback *memory_callback,
 				       void *memory_callback_arg,
 				       Dwfl_Module_Callback *read_eagerly,
 				       void *read_eagerly_arg,
-				       size_t maxread,
+				       size_t maxread, Elf *lazy,
 				       const void *note_file,
 				       size_t note_file_size,
 				       const struct r_debug_info *r_debug_info);
@@ -763,6 +871,7 @@ INTDECL (dwfl_report_segment)
 INTDECL (dwfl_report_offline)
 INTDECL (dwfl_report_offline_memory)
 INTDECL (dwfl_report_end)
+INTDECL (dwfl_set_module_cache)
 INTDECL (dwfl_build_id_find_elf)
 INTDECL (dwfl_build_id_find_debuginfo)
 INTDECL (dwfl_standard_find_debuginfo)
@@ -0,0 +1,230 @@
+/* Remember the CRCs of files checked against a debuglink.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+#include <fcntl.h>
+#include <inttypes.h>
+#include <search.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Debuglink candidates are usually big and the same ones get checked
+   over and over, by every Dwfl and every process looking at the same
+   modules.  A file is known by its device, inode, size and time of
+   last modification, any of which changes when it is replaced or
+   rewritten.  If ELFUTILS_CRC32_CACHE names a file, the CRCs are also
+   kept there, one "dev ino size sec nsec crc" line per file, so that
+   other processes do not compute them again either.  Only a file of
+   the user's own that nobody else can write is trusted.  Entries of
+   files long gone are never removed, so once the file has grown to
+   CRC32_CACHE_MAX_SIZE it is started over.  */
+#define CRC32_CACHE_MAX_SIZE (1024 * 1024)
+
+struct crc32_entry
+{
+  uint64_t dev;
+  uint64_t ino;
+  uint64_t size;
+  uint64_t sec;
+  uint64_t nsec;
+  uint32_t crc;
+};
+
+static void *crc32_cache;
+static const char *crc32_cache_file;
+rwlock_define (static, crc32_cache_lock);
+once_define (static, crc32_cache_once);
+
+static int
+compare_entry (const void *a, const void *b)
+{
+  const struct crc32_entry *ea = a;
+  const struct crc32_entry *eb = b;
+#define COMPARE(field) \
+  if (ea->field != eb->field) return ea->field < eb->field ? -1 : 1
+  COMPARE (ino);
+  COMPARE (dev);
+  COMPARE (size);
+  COMPARE (sec);
+  COMPARE (nsec);
+#undef COMPARE
+  return 0;
+}
+
+/* Add ENTRY to the cache, with the lock held.  */
+static bool
+add_entry (const struct crc32_entry *entry)
+{
+  struct crc32_entry *copy = malloc (sizeof *copy);
+  if (copy == NULL)
+    return false;
+  *copy = *entry;
+
+  struct crc32_entry **found = tsearch (copy, &crc32_cache, &compare_entry);
+  if (found == NULL || *found != copy)
+    {
+      free (copy);
+      return false;
+    }
+  return true;
+}
+
+/* Whether the cache file open on FD can be trusted, and if so its
+   size in *SIZEP.  */
+static bool
+trusted_file (int fd, off_t *sizep)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0
+      || ! S_ISREG (st.st_mode)
+      || st.st_uid != geteuid ()
+      || (st.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+    return false;
+  *sizep = st.st_size;
+  return true;
+}
+
+static void
+crc32_cache_init (void)
+{
+  rwlock_init (crc32_cache_lock);
+
+  crc32_cache_file = secure_getenv ("ELFUTILS_CRC32_CACHE");
+  if (crc32_cache_file == NULL || crc32_cache_file[0] == '\0')
+    {
+      crc32_cache_file = NULL;
+      return;
+    }
+
+  int fd = open (crc32_cache_file, O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return;
+
+  off_t size;
+  FILE *f = NULL;
+  if (! trusted_file (fd, &size))
+    {
+      /* Neither read nor written.  */
+      crc32_cache_file = NULL;
+      close (fd);
+      return;
+    }
+  if (size >= CRC32_CACHE_MAX_SIZE || (f = fdopen (fd, "r")) == NULL)
+    {
+      close (fd);
+      return;
+    }
+
+  char *line = NULL;
+  size_t linesize = 0;
+  while (getline (&line, &linesize, f) > 0)
+    {
+      struct crc32_entry entry;
+      if (sscanf (line, "%" SCNx64 " %" SCNx64 " %" SCNx64
+		  " %" SCNx64 " %" SCNx64 " %" SCNx32,
+		  &entry.dev, &entry.ino, &entry.size,
+		  &entry.sec, &entry.nsec, &entry.crc) == 6)
+	add_entry (&entry);
+    }
+  free (line);
+  fclose (f);
+}
+
+/* Append ENTRY to the cache file.  A single write to a file opened
+   for appending does not mix with those of other processes.  If it
+   fails, the entry is still kept in memory.  When the file is full,
+   it is emptied first, whatever is still used gets added again.  */
+static void
+store_entry (const struct crc32_entry *entry)
+{
+  char line[128];
+  int len = snprintf (line, sizeof line,
+		      "%" PRIx64 " %" PRIx64 " %" PRIx64
+		      " %" PRIx64 " %" PRIx64 " %08" PRIx32 "\n",
+		      entry->dev, entry->ino, entry->size,
+		      entry->sec, entry->nsec, entry->crc);
+  if (len <= 0 || (size_t) len >= sizeof line)
+    return;
+
+  int fd = open (crc32_cache_file, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC,
+		 0600);
+  if (fd < 0)
+    return;
+  off_t size;
+  if (trusted_file (fd, &size)
+      && (size < CRC32_CACHE_MAX_SIZE || ftruncate (fd, 0) == 0))
+    {
+      ssize_t n __attribute__ ((unused)) = write (fd, line, len);
+    }
+  close (fd);
+}
+
+int
+__libdwfl_crc32_file_cached (int fd, uint32_t *resp)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0 || ! S_ISREG (st.st_mode))
+    return __libdwfl_crc32_file (fd, resp);
+
+  once (crc32_cache_once, crc32_cache_init);
+
+  struct crc32_entry key =
+    {
+      .dev = st.st_dev,
+      .ino = st.st_ino,
+      .size = st.st_size,
+      .sec = st.st_mtim.tv_sec,
+      .nsec = st.st_mtim.tv_nsec
+    };
+
+  rwlock_rdlock (crc32_cache_lock);
+  struct crc32_entry **found = tfind (&key, &crc32_cache, &compare_entry);
+  if (found != NULL)
+    *resp = (*found)->crc;
+  rwlock_unlock (crc32_cache_lock);
+  if (found != NULL)
+    return 0;
+
+  if (__libdwfl_crc32_file (fd, &key.crc) != 0)
+    return -1;
+  *resp = key.crc;
+
+  rwlock_wrlock (crc32_cache_lock);
+  bool added = add_entry (&key);
+  rwlock_unlock (crc32_cache_lock);
+
+  if (added && crc32_cache_file != NULL)
+    store_entry (&key);
+
+  return 0;
+}
@@ -2,3 +2,173 @@
 
 #define LZMA
 #include "gzip.c"
+
+/* Random access to xz files made of several independently compressed
+   blocks, as written by xz --block-size or by multi-threaded xz.  The
+   stream index tells where each block starts, so each block is a chunk
+   of the image that can be decompressed on its own.  */
+
+#include <fcntl.h>
+
+struct xz_seekable
+{
+  int fd;
+  off_t start_offset;
+  lzma_index *index;
+  lzma_check check;
+};
+
+static void
+xz_seekable_end (void *arg)
+{
+  struct xz_seekable *xz = arg;
+  lzma_index_end (xz->index, NULL);
+  close (xz->fd);
+  free (xz);
+}
+
+static bool
+xz_decode_block (void *arg, size_t ndx __attribute__ ((unused)),
+		 uint64_t start, void *out, size_t size)
+{
+  struct xz_seekable *xz = arg;
+
+  lzma_index_iter iter;
+  lzma_index_iter_init (&iter, xz->index);
+  if (lzma_index_iter_locate (&iter, start))
+    return false;
+
+  uint64_t total_size = iter.block.total_size;
+  if (total_size > SIZE_MAX || total_size == 0
+      || iter.block.uncompressed_size != size)
+    return false;
+
+  unsigned char *in = malloc (total_size);
+  if (unlikely (in == NULL))
+    return false;
+
+  lzma_ret ret = LZMA_DATA_ERROR;
+  size_t out_pos = 0;
+  if ((size_t) pread_retry (xz->fd, in, total_size,
+			    xz->start_offset
+			    + iter.block.compressed_file_offset) == total_size)
+    {
+      lzma_filter filters[LZMA_FILTERS_MAX + 1];
+      lzma_block block =
+	{
+	  .version = 0,
+	  .check = xz->check,
+	  .filters = filters,
+	  .header_size = lzma_block_header_size_decode (in[0])
+	};
+      if (block.header_size <= total_size
+	  && lzma_block_header_decode (&block, NULL, in) == LZMA_OK)
+	{
+	  size_t in_pos = block.header_size;
+	  ret = lzma_block_compressed_size (&block,
+					    iter.block.unpadded_size);
+	  if (ret == LZMA_OK)
+	    ret = lzma_block_buffer_decode (&block, NULL, in, &in_pos,
+					    total_size, out, &out_pos, size);
+	  for (size_t i = 0; filters[i].id != LZMA_VLI_UNKNOWN; ++i)
+	    free (filters[i].options);
+	}
+    }
+
+  free (in);
+  return ret == LZMA_OK && out_pos == size;
+}
+
+/* If the MAPPED_SIZE bytes at START_OFFSET of FD are a single xz stream
+   of several blocks, replace *ELFP with an Elf reading the uncompressed
+   image block by block.  */
+Dwfl_Error internal_function
+__libdw_open_xz_seekable (int fd, off_t start_offset,
+			  void *mapped __attribute__ ((unused)),
+			  size_t mapped_size, Elf **elfp)
+{
+  uint8_t header[LZMA_STREAM_HEADER_SIZE];
+  uint8_t footer[LZMA_STREAM_HEADER_SIZE];
+  if (mapped_size < 2 * LZMA_STREAM_HEADER_SIZE
+      || pread_retry (fd, header, sizeof header,
+		      start_offset) != sizeof header
+      || memcmp (header, MAGIC, sizeof MAGIC - 1) != 0
+      || pread_retry (fd, footer, sizeof footer,
+		      start_offset + mapped_size
+		      - sizeof footer) != sizeof footer)
+    return DWFL_E_BADELF;
+
+  lzma_stream_flags header_flags;
+  lzma_stream_flags footer_flags;
+  if (lzma_stream_header_decode (&header_flags, header) != LZMA_OK
+      || lzma_stream_footer_decode (&footer_flags, footer) != LZMA_OK
+      || lzma_stream_flags_compare (&header_flags, &footer_flags) != LZMA_OK
+      || footer_flags.backward_size > mapped_size - 2 * sizeof footer)
+    return DWFL_E_BADELF;
+
+  size_t index_size = footer_flags.backward_size;
+  uint8_t *index_buf = malloc (index_size);
+  if (unlikely (index_buf == NULL))
+    return DWFL_E_NOMEM;
+  if ((size_t) pread_retry (fd, index_buf, index_size,
+			    start_offset + mapped_size - sizeof footer
+			    - index_size) != index_size)
+    {
+      free (index_buf);
+      return DWFL_E_BADELF;
+    }
+
+  lzma_index *index = NULL;
+  uint64_t memlimit = UINT64_MAX;
+  size_t in_pos = 0;
+  lzma_ret ret = lzma_index_buffer_decode (&index, &memlimit, NULL,
+					   index_buf, &in_pos, index_size);
+  free (index_buf);
+  if (ret != LZMA_OK)
+    return ret == LZMA_MEM_ERROR ? DWFL_E_NOMEM : DWFL_E_BADELF;
+
+  /* Only a single stream without padding, which also covers the whole
+     image, and which is worth the trouble.  */
+  uint64_t size = lzma_index_uncompressed_size (index);
+  lzma_vli nblocks = lzma_index_block_count (index);
+  if (lzma_index_stream_size (index) != mapped_size
+      || nblocks < 2 || nblocks > SIZE_MAX / sizeof (uint64_t)
+      || size == 0 || size > SIZE_MAX)
+    {
+      lzma_index_end (index, NULL);
+      return DWFL_E_BADELF;
+    }
+
+  uint64_t *starts = malloc (nblocks * sizeof starts[0]);
+  struct xz_seekable *xz = malloc (sizeof *xz);
+  Dwfl_Error error = DWFL_E_NOMEM;
+  if (unlikely (starts == NULL || xz == NULL))
+    goto fail;
+
+  lzma_index_iter iter;
+  lzma_index_iter_init (&iter, index);
+  error = DWFL_E_BADELF;
+  for (size_t i = 0; i < nblocks; ++i)
+    {
+      if (lzma_index_iter_next (&iter, LZMA_INDEX_ITER_BLOCK))
+	goto fail;
+      starts[i] = iter.block.uncompressed_file_offset;
+    }
+
+  xz->fd = fcntl (fd, F_DUPFD_CLOEXEC, 0);
+  error = DWFL_E_ERRNO;
+  if (xz->fd < 0)
+    goto fail;
+  xz->start_offset = start_offset;
+  xz->index = index;
+  xz->check = footer_flags.check;
+
+  return __libdw_open_seekable (size, nblocks, starts, xz_decode_block,
+				xz_seekable_end, xz, elfp);
+
+ fail:
+  free (starts);
+  free (xz);
+  lzma_index_end (index, NULL);
+  return error;
+}
@@ -40,10 +40,12 @@
 
 #if !USE_LZMA
 # define __libdw_unlzma(...)	DWFL_E_BADELF
+# define __libdw_open_xz_seekable(...)	DWFL_E_BADELF
 #endif
 
 #if !USE_ZSTD
 # define __libdw_unzstd(...)	DWFL_E_BADELF
+# define __libdw_open_zstd_seekable(...)	DWFL_E_BADELF
 #endif
 
 /* Consumes and replaces *ELF only on success.  */
@@ -64,6 +66,32 @@ decompress (int fd __attribute__ ((unused)), Elf **elf)
   if (mapped_size == 0)
     return error;
 
+  /* Rather than inflating everything into memory up front, see whether
+     the image can be decompressed in chunks as it is read: a gzip file
+     with checkpoints saved along the way, an xz file of several blocks,
+     or a zstd file of several frames.  A bzip2 file is always inflated
+     whole, since libbz2 cannot start decompressing at a block, which
+     need not begin on a byte boundary.  So is an xz file of a single
+     block, or a zstd file of a single frame, since neither library can
+     save and restore the decoder state in the middle of one.  */
+  Elf *seekelf = NULL;
+  error = __libdw_open_gzip_seekable (fd, offset, mapped, mapped_size,
+				      &seekelf);
+  if (error == DWFL_E_BADELF)
+    error = __libdw_open_xz_seekable (fd, offset, mapped, mapped_size,
+				      &seekelf);
+  if (error == DWFL_E_BADELF)
+    error = __libdw_open_zstd_seekable (fd, offset, mapped, mapped_size,
+					&seekelf);
+  if (error == DWFL_E_NOERROR)
+    {
+      elf_end (*elf);
+      *elf = seekelf;
+      return error;
+    }
+  if (error != DWFL_E_BADELF)
+    return error;
+
   error = __libdw_gunzip (fd, offset, mapped, mapped_size, &buffer, &size);
   if (error == DWFL_E_BADELF)
     error = __libdw_bunzip2 (fd, offset, mapped, mapped_size, &buffer, &size);
@@ -201,6 +201,53 @@ relocate_getsym (Dwfl_Module *mod,
 				   *shndx, &sym->st_value);
 }
 
+/* Check whether symbol NDX of module M is a defined global symbol
+   called NAME.  If it is, store it with its resolved value in *SYM
+   and return DWFL_E_NOERROR, if not return DWFL_E_RELUNDEF.  */
+static Dwfl_Error
+match_symbol (Dwfl_Module *m, size_t ndx, const char *name, GElf_Sym *sym)
+{
+  GElf_Word shndx;
+  sym = gelf_getsymshndx (m->symdata, m->symxndxdata, ndx, sym, &shndx);
+  if (unlikely (sym == NULL))
+    return DWFL_E_LIBELF;
+  if (sym->st_shndx != SHN_XINDEX)
+    shndx = sym->st_shndx;
+
+  /* We are looking for a defined global symbol with a name.  */
+  if (shndx == SHN_UNDEF || shndx == SHN_COMMON
+      || GELF_ST_BIND (sym->st_info) == STB_LOCAL
+      || sym->st_name == 0)
+    return DWFL_E_RELUNDEF;
+
+  /* Get this candidate symbol's name.  */
+  if (unlikely (sym->st_name >= m->symstrdata->d_size))
+    return DWFL_E_BADSTROFF;
+  const char *n = m->symstrdata->d_buf;
+  n += sym->st_name;
+
+  /* Does the name match?  */
+  if (strcmp (name, n))
+    return DWFL_E_RELUNDEF;
+
+  /* We found it!  */
+  if (shndx == SHN_ABS) /* XXX maybe should apply bias? */
+    return DWFL_E_NOERROR;
+
+  if (m->e_type != ET_REL)
+    {
+      sym->st_value = dwfl_adjusted_st_value (m, m->symfile->elf,
+					      sym->st_value);
+      return DWFL_E_NOERROR;
+    }
+
+  /* In an ET_REL file, the symbol table values are relative
+     to the section, not to the module's load base.  */
+  size_t symshstrndx = SHN_UNDEF;
+  return __libdwfl_relocate_value (m, m->symfile->elf, &symshstrndx,
+				   shndx, &sym->st_value);
+}
+
 /* Handle an undefined symbol.  We really only support ET_REL for Linux
    kernel modules, and offline archives.  The behavior of the Linux module
    loader is very simple and easy to mimic.  It only matches magically
@@ -209,7 +256,7 @@ relocate_getsym (Dwfl_Module *mod,
    it from being loaded.  */
 static Dwfl_Error
 resolve_symbol (Dwfl_Module *referer, struct reloc_symtab_cache *symtab,
-		GElf_Sym *sym, GElf_Word shndx)
+		GElf_Sym *sym)
 {
   /* First we need its name.  */
   if (sym->st_name != 0)
@@ -269,48 +316,36 @@ resolve_symbol (Dwfl_Module *referer, struct reloc_symtab_cache *symtab,
 		&& m->symerr != DWFL_E_NO_SYMTAB)
 	      return m->symerr;
 
-	    for (size_t ndx = 1; ndx < m->syments; ++ndx)
+	    /* Look the name up in an index of the symbol table section.
+	       A table read from the dynamic segment has no section, and
+	       if the index can't be made we just don't try again.  */
+	    if (m->symtab_index == NULL && m->symscn != NULL)
 	      {
-		sym = gelf_getsymshndx (m->symdata, m->symxndxdata,
-					ndx, sym, &shndx);
-		if (unlikely (sym == NULL))
-		  return DWFL_E_LIBELF;
-		if (sym->st_shndx != SHN_XINDEX)
-		  shndx = sym->st_shndx;
-
-		/* We are looking for a defined global symbol with a name.  */
-		if (shndx == SHN_UNDEF || shndx == SHN_COMMON
-		    || GELF_ST_BIND (sym->st_info) == STB_LOCAL
-		    || sym->st_name == 0)
-		  continue;
-
-		/* Get this candidate symbol's name.  */
-		if (unlikely (sym->st_name >= m->symstrdata->d_size))
-		  return DWFL_E_BADSTROFF;
-		const char *n = m->symstrdata->d_buf;
-		n += sym->st_name;
-
-		/* Does the name match?  */
-		if (strcmp (name, n))
-		  continue;
-
-		/* We found it!  */
-		if (shndx == SHN_ABS) /* XXX maybe should apply bias? */
-		  return DWFL_E_NOERROR;
-
-		if (m->e_type != ET_REL)
+		m->symtab_index = INTUSE(dwelf_symtab_begin) (m->symscn);
+		if (m->symtab_index == NULL)
+		  m->symscn = NULL;
+	      }
+
+	    if (m->symtab_index != NULL)
+	      {
+		for (size_t ndx = INTUSE(dwelf_symtab_find_name) (m->symtab_index,
+								  name, 1);
+		     ndx != 0 && ndx < m->syments;
+		     ndx = INTUSE(dwelf_symtab_find_name) (m->symtab_index,
+							   name, ndx + 1))
 		  {
-		    sym->st_value = dwfl_adjusted_st_value (m, m->symfile->elf,
-							    sym->st_value);
-		    return DWFL_E_NOERROR;
+		    Dwfl_Error result = match_symbol (m, ndx, name, sym);
+		    if (result != DWFL_E_RELUNDEF)
+		      return result;
 		  }
+		continue;
+	      }
 
-		/* In an ET_REL file, the symbol table values are relative
-		   to the section, not to the module's load base.  */
-		size_t symshstrndx = SHN_UNDEF;
-		return __libdwfl_relocate_value (m, m->symfile->elf,
-						 &symshstrndx,
-						 shndx, &sym->st_value);
+	    for (size_t ndx = 1; ndx < m->syments; ++ndx)
+	      {
+		Dwfl_Error result = match_symbol (m, ndx, name, sym);
+		if (result != DWFL_E_RELUNDEF)
+		  return result;
 	      }
 	  }
     }
@@ -369,7 +404,7 @@ relocate (Dwfl_Module * const mod,
 	if (shndx == SHN_UNDEF || shndx == SHN_COMMON)
 	  {
 	    /* Maybe we can figure it out anyway.  */
-	    error = resolve_symbol (mod, reloc_symtab, &sym, shndx);
+	    error = resolve_symbol (mod, reloc_symtab, &sym);
 	    if (error != DWFL_E_NOERROR
 		&& !(error == DWFL_E_RELUNDEF && shndx == SHN_COMMON))
 	      return error;
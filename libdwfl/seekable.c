@@ -0,0 +1,187 @@
+/* Compressed images decompressed in chunks as they are read.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include "libdwflP.h"
+
+/* Some compression formats have points from which decompression can
+   start: the blocks of an xz stream, the frames of a zstd file, or
+   checkpoints saved while inflating a gzip file once.  Instead of
+   inflating the whole image up front, the chunk between two such points
+   is decompressed when libelf reads from it.  Only a few chunks are
+   kept around.  */
+
+#define CACHED_CHUNKS	4
+
+struct cached_chunk
+{
+  size_t ndx;
+  unsigned char *data;
+  unsigned int last_used;
+};
+
+struct seekable
+{
+  uint64_t size;
+  size_t nchunks;
+  uint64_t *starts;
+  Dwfl_Seekable_Decode *decode;
+  void (*end) (void *);
+  void *arg;
+  unsigned int clock;
+  struct cached_chunk cache[CACHED_CHUNKS];
+  rwlock_define (, lock);
+};
+
+static void
+seekable_end (void *arg)
+{
+  struct seekable *s = arg;
+  for (size_t i = 0; i < CACHED_CHUNKS; ++i)
+    free (s->cache[i].data);
+  free (s->starts);
+  s->end (s->arg);
+  rwlock_fini (s->lock);
+  free (s);
+}
+
+static size_t
+chunk_size (struct seekable *s, size_t ndx)
+{
+  uint64_t end = ndx + 1 < s->nchunks ? s->starts[ndx + 1] : s->size;
+  return end - s->starts[ndx];
+}
+
+/* Return the cached chunk containing OFFSET, decompressing it first if
+   necessary.  Called with the lock held.  */
+static struct cached_chunk *
+get_chunk (struct seekable *s, uint64_t offset)
+{
+  size_t lo = 0;
+  size_t hi = s->nchunks;
+  while (hi - lo > 1)
+    {
+      size_t mid = (lo + hi) / 2;
+      if (s->starts[mid] <= offset)
+	lo = mid;
+      else
+	hi = mid;
+    }
+
+  struct cached_chunk *victim = &s->cache[0];
+  for (size_t i = 0; i < CACHED_CHUNKS; ++i)
+    {
+      struct cached_chunk *c = &s->cache[i];
+      if (c->data != NULL && c->ndx == lo)
+	{
+	  c->last_used = ++s->clock;
+	  return c;
+	}
+      if (c->data == NULL
+	  || (victim->data != NULL && c->last_used < victim->last_used))
+	victim = c;
+    }
+
+  size_t size = chunk_size (s, lo);
+  unsigned char *data = malloc (size);
+  if (unlikely (data == NULL))
+    return NULL;
+  if (! (*s->decode) (s->arg, lo, s->starts[lo], data, size))
+    {
+      free (data);
+      return NULL;
+    }
+
+  free (victim->data);
+  victim->ndx = lo;
+  victim->data = data;
+  victim->last_used = ++s->clock;
+  return victim;
+}
+
+static ssize_t
+seekable_read (void *arg, void *buf, size_t len, int64_t offset)
+{
+  struct seekable *s = arg;
+  if (offset < 0)
+    return -1;
+  if ((uint64_t) offset >= s->size)
+    return 0;
+  len = MIN (len, s->size - offset);
+
+  rwlock_wrlock (s->lock);
+  size_t done = 0;
+  while (done < len)
+    {
+      struct cached_chunk *c = get_chunk (s, offset + done);
+      if (c == NULL)
+	break;
+      size_t skip = offset + done - s->starts[c->ndx];
+      size_t n = MIN (chunk_size (s, c->ndx) - skip, len - done);
+      memcpy (buf + done, c->data + skip, n);
+      done += n;
+    }
+  rwlock_unlock (s->lock);
+
+  return done == len ? (ssize_t) len : -1;
+}
+
+Dwfl_Error
+internal_function
+__libdw_open_seekable (uint64_t size, size_t nchunks, uint64_t *starts,
+		       Dwfl_Seekable_Decode *decode, void (*end) (void *),
+		       void *arg, Elf **elfp)
+{
+  struct seekable *s = calloc (1, sizeof *s);
+  if (unlikely (s == NULL))
+    {
+      free (starts);
+      end (arg);
+      return DWFL_E_NOMEM;
+    }
+  s->size = size;
+  s->nchunks = nchunks;
+  s->starts = starts;
+  s->decode = decode;
+  s->end = end;
+  s->arg = arg;
+  rwlock_init (s->lock);
+
+  Elf *elf = elf_begin_reader (seekable_read, seekable_end, s, size);
+  if (elf == NULL)
+    {
+      seekable_end (s);
+      return DWFL_E_LIBELF;
+    }
+
+  *elfp = elf;
+  return DWFL_E_NOERROR;
+}
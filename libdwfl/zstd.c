@@ -2,3 +2,255 @@
 
 #define ZSTD
 #include "gzip.c"
+
+/* Random access to zstd files made of several frames, each of which
+   can be decompressed on its own.  The frames are found from the seek
+   table of the zstd seekable format, a skippable frame at the end of
+   the file, or else by walking the frame headers of a mapped file.  A
+   single frame has no seek points, so that is still inflated whole.  */
+
+#include <fcntl.h>
+
+#define SEEKABLE_MAGIC		0x8F92EAB1
+#define SEEK_TABLE_MAGIC	0x184D2A5E
+#define SEEK_TABLE_FOOTER	9
+
+struct zstd_frame
+{
+  uint64_t in;
+  size_t in_size;
+};
+
+struct zstd_seekable
+{
+  int fd;
+  off_t start_offset;
+  struct zstd_frame *frames;
+  ZSTD_DCtx *dctx;
+};
+
+static void
+zstd_seekable_end (void *arg)
+{
+  struct zstd_seekable *zs = arg;
+  ZSTD_freeDCtx (zs->dctx);
+  close (zs->fd);
+  free (zs->frames);
+  free (zs);
+}
+
+static bool
+zstd_decode_frame (void *arg, size_t ndx,
+		   uint64_t start __attribute__ ((unused)),
+		   void *out, size_t size)
+{
+  struct zstd_seekable *zs = arg;
+  const struct zstd_frame *frame = &zs->frames[ndx];
+
+  void *in = malloc (frame->in_size);
+  if (unlikely (in == NULL))
+    return false;
+
+  bool ok = false;
+  if ((size_t) pread_retry (zs->fd, in, frame->in_size,
+			    zs->start_offset + frame->in) == frame->in_size)
+    {
+      size_t n = ZSTD_decompressDCtx (zs->dctx, out, size,
+				      in, frame->in_size);
+      ok = !ZSTD_isError (n) && n == size;
+    }
+
+  free (in);
+  return ok;
+}
+
+static inline uint32_t
+read_le32 (const unsigned char *p)
+{
+  return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t) p[3] << 24;
+}
+
+/* Add a chunk of SIZE bytes decompressed from the frame at IN.  Empty
+   frames are left out.  */
+static bool
+add_frame (struct zstd_frame **frames, uint64_t **starts, size_t *nframes,
+	   size_t *allocated, uint64_t in, size_t in_size, uint64_t start,
+	   uint64_t size)
+{
+  if (size == 0)
+    return true;
+  if (*nframes == *allocated)
+    {
+      *allocated = *allocated == 0 ? 16 : 2 * *allocated;
+      struct zstd_frame *newf = realloc (*frames,
+					 *allocated * sizeof **frames);
+      if (newf != NULL)
+	*frames = newf;
+      uint64_t *news = realloc (*starts, *allocated * sizeof **starts);
+      if (news != NULL)
+	*starts = news;
+      if (unlikely (newf == NULL || news == NULL))
+	return false;
+    }
+  (*frames)[*nframes] = (struct zstd_frame) { .in = in, .in_size = in_size };
+  (*starts)[*nframes] = start;
+  ++*nframes;
+  return true;
+}
+
+/* Read the seek table at the end of the file, if there is one.  */
+static Dwfl_Error
+read_seek_table (int fd, off_t start_offset, size_t mapped_size,
+		 struct zstd_frame **frames, uint64_t **starts,
+		 size_t *nframes, size_t *allocated, uint64_t *size)
+{
+  unsigned char footer[SEEK_TABLE_FOOTER];
+  if (mapped_size < 8 + sizeof footer
+      || pread_retry (fd, footer, sizeof footer,
+		      start_offset + mapped_size
+		      - sizeof footer) != sizeof footer
+      || read_le32 (footer + 5) != SEEKABLE_MAGIC
+      || (footer[4] & 0x7c) != 0)
+    return DWFL_E_BADELF;
+
+  uint32_t n = read_le32 (footer);
+  size_t entsize = (footer[4] & 0x80) ? 12 : 8;
+  if (n > (mapped_size - 8 - sizeof footer) / entsize)
+    return DWFL_E_BADELF;
+  size_t table_size = n * entsize + sizeof footer;
+  size_t frame_size = 8 + table_size;
+
+  unsigned char *table = malloc (frame_size);
+  if (unlikely (table == NULL))
+    return DWFL_E_NOMEM;
+  Dwfl_Error error = DWFL_E_BADELF;
+  if ((size_t) pread_retry (fd, table, frame_size,
+			    start_offset + mapped_size
+			    - frame_size) != frame_size
+      || read_le32 (table) != SEEK_TABLE_MAGIC
+      || read_le32 (table + 4) != table_size)
+    goto out;
+
+  uint64_t in = 0;
+  uint64_t out = 0;
+  error = DWFL_E_NOERROR;
+  for (uint32_t i = 0; i < n && error == DWFL_E_NOERROR; ++i)
+    {
+      const unsigned char *entry = table + 8 + i * entsize;
+      uint32_t in_size = read_le32 (entry);
+      uint32_t out_size = read_le32 (entry + 4);
+      if (in_size > mapped_size - frame_size - in)
+	error = DWFL_E_BADELF;
+      else if (!add_frame (frames, starts, nframes, allocated,
+			   in, in_size, out, out_size))
+	error = DWFL_E_NOMEM;
+      in += in_size;
+      out += out_size;
+    }
+  if (error == DWFL_E_NOERROR && in != mapped_size - frame_size)
+    error = DWFL_E_BADELF;
+  *size = out;
+
+ out:
+  free (table);
+  return error;
+}
+
+/* Walk the frame headers of the whole mapped file.  */
+static Dwfl_Error
+walk_frames (void *mapped, size_t mapped_size,
+	     struct zstd_frame **frames, uint64_t **starts,
+	     size_t *nframes, size_t *allocated, uint64_t *size)
+{
+  uint64_t out = 0;
+  size_t in = 0;
+  while (in < mapped_size)
+    {
+      const void *frame = mapped + in;
+      size_t in_size = ZSTD_findFrameCompressedSize (frame,
+						     mapped_size - in);
+      if (ZSTD_isError (in_size) || in_size == 0)
+	return DWFL_E_BADELF;
+
+      /* Skippable frames have magic numbers 0x184D2A50 to 0x184D2A5F.  */
+      if (in_size < 4 || (read_le32 (frame) & 0xFFFFFFF0) != 0x184D2A50)
+	{
+	  unsigned long long out_size
+	    = ZSTD_getFrameContentSize (frame, mapped_size - in);
+	  if (out_size == ZSTD_CONTENTSIZE_UNKNOWN
+	      || out_size == ZSTD_CONTENTSIZE_ERROR)
+	    return DWFL_E_BADELF;
+	  if (!add_frame (frames, starts, nframes, allocated,
+			  in, in_size, out, out_size))
+	    return DWFL_E_NOMEM;
+	  out += out_size;
+	}
+      in += in_size;
+    }
+  *size = out;
+  return DWFL_E_NOERROR;
+}
+
+/* If the MAPPED_SIZE bytes at START_OFFSET of FD are several zstd
+   frames, replace *ELFP with an Elf reading the uncompressed image frame
+   by frame.  */
+Dwfl_Error internal_function
+__libdw_open_zstd_seekable (int fd, off_t start_offset, void *mapped,
+			    size_t mapped_size, Elf **elfp)
+{
+  unsigned char header[sizeof MAGIC - 1];
+  if (mapped_size <= sizeof header
+      || pread_retry (fd, header, sizeof header,
+		      start_offset) != sizeof header
+      || memcmp (header, MAGIC, sizeof header) != 0)
+    return DWFL_E_BADELF;
+
+  struct zstd_frame *frames = NULL;
+  uint64_t *starts = NULL;
+  size_t nframes = 0;
+  size_t allocated = 0;
+  uint64_t size = 0;
+  Dwfl_Error error = read_seek_table (fd, start_offset, mapped_size,
+				      &frames, &starts, &nframes,
+				      &allocated, &size);
+  if (error == DWFL_E_BADELF && mapped != NULL)
+    {
+      nframes = 0;
+      error = walk_frames (mapped, mapped_size, &frames, &starts,
+			   &nframes, &allocated, &size);
+    }
+  if (error == DWFL_E_NOERROR && (nframes < 2 || size > SIZE_MAX))
+    error = DWFL_E_BADELF;
+
+  struct zstd_seekable *zs = NULL;
+  if (error == DWFL_E_NOERROR)
+    {
+      zs = malloc (sizeof *zs);
+      if (unlikely (zs == NULL))
+	error = DWFL_E_NOMEM;
+      else
+	{
+	  zs->dctx = ZSTD_createDCtx ();
+	  zs->fd = fcntl (fd, F_DUPFD_CLOEXEC, 0);
+	  if (zs->dctx == NULL || zs->fd < 0)
+	    {
+	      error = zs->fd < 0 ? DWFL_E_ERRNO : DWFL_E_NOMEM;
+	      if (zs->fd >= 0)
+		close (zs->fd);
+	      ZSTD_freeDCtx (zs->dctx);
+	      free (zs);
+	    }
+	}
+    }
+  if (error != DWFL_E_NOERROR)
+    {
+      free (frames);
+      free (starts);
+      return error;
+    }
+
+  zs->start_offset = start_offset;
+  zs->frames = frames;
+  return __libdw_open_seekable (size, nframes, starts, zstd_decode_frame,
+				zstd_seekable_end, zs, elfp);
+}
@@ -172,7 +172,7 @@ __elfw2(LIBELFBITS,getphdr_wrlock) (Elf *elf)
 		}
 	    }
 	}
-      else if (likely (elf->fildes != -1))
+      else if (likely (__libelf_can_read (elf)))
 	{
 	  /* Allocate memory for the program headers.  We know the number
 	     of entries from the ELF header.  */
@@ -186,8 +186,8 @@ __elfw2(LIBELFBITS,getphdr_wrlock) (Elf *elf)
 	  elf->state.ELFW(elf,LIBELFBITS).phdr_flags |= ELF_F_MALLOCED;
 
 	  /* Read the header.  */
-	  ssize_t n = pread_retry (elf->fildes,
-				   elf->state.ELFW(elf,LIBELFBITS).phdr, size,
+	  ssize_t n = __libelf_pread (elf,
+				      elf->state.ELFW(elf,LIBELFBITS).phdr, size,
 				   elf->start_offset + ehdr->e_phoff);
 	  if (unlikely ((size_t) n != size))
 	    {
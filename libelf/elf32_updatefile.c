@@ -37,6 +37,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 #include "libelfP.h"
 
@@ -337,9 +339,26 @@ __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
 		       user's section data with the latest one, rather than
 		       crashing.  */
 
-		    if (unlikely (change_bo
-				  && dl->data.d.d_size != 0
-				  && dl->data.d.d_type != ELF_T_BYTE))
+		    if (dl->flags & ELF_F_FILERANGE)
+		      {
+			/* The bytes are already in the file byte order.
+			   Read them right into place.  */
+			if (unlikely ((size_t) pread_retry (dl->src_fd,
+							    last_position,
+							    dl->data.d.d_size,
+							    dl->src_offset)
+				      != dl->data.d.d_size))
+			  {
+			    free (scns);
+			    __libelf_seterrno (ELF_E_READ_ERROR);
+			    return 1;
+			  }
+
+			last_position += dl->data.d.d_size;
+		      }
+		    else if (unlikely (change_bo
+				       && dl->data.d.d_size != 0
+				       && dl->data.d.d_type != ELF_T_BYTE))
 		      {
 #undef fctp
 #define fctp __elf_xfctstom[ELFW(ELFCLASS, LIBELFBITS) - 1][dl->data.d.d_type]
@@ -493,9 +512,144 @@ __elfw2(LIBELFBITS,updatemmap) (Elf *elf, int change_bo, size_t shnum)
 #define MAX_TMPBUF	32768
 
 
+/* Number of blocks collected for a single pwritev call.  */
+#define MAX_IOV		64
+
+/* Blocks of data which follow each other in the file are collected
+   and written with one system call.  */
+struct gather
+{
+  int fd;
+  int64_t pos;			/* File offset of the first block.  */
+  size_t len;			/* Total length of the blocks.  */
+  int cnt;
+  struct iovec iov[MAX_IOV];
+};
+
+/* Write out the collected blocks.  */
+static int
+gather_flush (struct gather *g)
+{
+  struct iovec *iov = g->iov;
+  int cnt = g->cnt;
+  int64_t pos = g->pos;
+
+  while (cnt > 0)
+    {
+      ssize_t n = TEMP_FAILURE_RETRY (pwritev (g->fd, iov, cnt, pos));
+      if (unlikely (n <= 0))
+	{
+	  __libelf_seterrno (ELF_E_WRITE_ERROR);
+	  return 1;
+	}
+      pos += n;
+
+      /* Skip what has been written.  */
+      while (cnt > 0 && (size_t) n >= iov->iov_len)
+	{
+	  n -= iov->iov_len;
+	  ++iov;
+	  --cnt;
+	}
+      if (cnt > 0)
+	{
+	  iov->iov_base = (char *) iov->iov_base + n;
+	  iov->iov_len -= n;
+	}
+    }
+
+  g->cnt = 0;
+  g->len = 0;
+  return 0;
+}
+
+/* Write LEN bytes at BUF to offset POS, together with the preceding
+   blocks if they end there.  BUF must stay valid until the next
+   gather_flush.  */
+static int
+gather_add (struct gather *g, const void *buf, size_t len, int64_t pos)
+{
+  if (len == 0)
+    return 0;
+
+  if (g->cnt > 0 && (pos != g->pos + (int64_t) g->len || g->cnt == MAX_IOV)
+      && unlikely (gather_flush (g) != 0))
+    return 1;
+
+  if (g->cnt == 0)
+    g->pos = pos;
+  g->iov[g->cnt].iov_base = (void *) buf;
+  g->iov[g->cnt].iov_len = len;
+  ++g->cnt;
+  g->len += len;
+  return 0;
+}
+
+/* Copy LEN bytes at SRC_POS in SRC_FD to DEST_POS in DEST_FD.  If the
+   kernel can, the data does not pass through user space and the file
+   system might even share the blocks of both files.  */
+static int
+copy_range (int dest_fd, int64_t dest_pos, int src_fd, int64_t src_pos,
+	    size_t len)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+  while (len > 0)
+    {
+      off_t in = src_pos;
+      off_t out = dest_pos;
+      ssize_t n = copy_file_range (src_fd, &in, dest_fd, &out, len, 0);
+      if (n < 0 && errno == EINTR)
+	continue;
+      /* Not supported for these files, or the source is too short.
+	 Copying through memory takes care of both.  */
+      if (n <= 0)
+	break;
+      src_pos += n;
+      dest_pos += n;
+      len -= n;
+    }
+  if (len == 0)
+    return 0;
+#endif
+
+  size_t bufsize = MIN (len, (size_t) 1 << 20);
+  char *buf = malloc (bufsize);
+  if (unlikely (buf == NULL))
+    {
+      __libelf_seterrno (ELF_E_NOMEM);
+      return 1;
+    }
+
+  int result = 0;
+  while (len > 0)
+    {
+      size_t n = MIN (len, bufsize);
+      if (unlikely ((size_t) pread_retry (src_fd, buf, n, src_pos) != n))
+	{
+	  __libelf_seterrno (ELF_E_READ_ERROR);
+	  result = 1;
+	  break;
+	}
+      if (unlikely ((size_t) pwrite_retry (dest_fd, buf, n, dest_pos) != n))
+	{
+	  __libelf_seterrno (ELF_E_WRITE_ERROR);
+	  result = 1;
+	  break;
+	}
+      src_pos += n;
+      dest_pos += n;
+      len -= n;
+    }
+
+  free (buf);
+  return result;
+}
+
+
 /* Helper function to write out fill bytes.  */
 static int
-fill (int fd, int64_t pos, size_t len, char *fillbuf, size_t *filledp)
+fill (struct gather *g, int64_t pos, size_t len, char *fillbuf,
+      size_t *filledp)
 {
   size_t filled = *filledp;
   size_t fill_len = MIN (len, FILLBUFSIZE);
@@ -509,14 +663,12 @@ fill (int fd, int64_t pos, size_t len, char *fillbuf, size_t *filledp)
 
   do
     {
-      /* This many bytes we want to write in this round.  */
+      /* This many bytes we want to write in this round.  The part of
+	 FILLBUF used does not change anymore.  */
       size_t n = MIN (filled, len);
 
-      if (unlikely ((size_t) pwrite_retry (fd, fillbuf, n, pos) != n))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  return 1;
-	}
+      if (unlikely (gather_add (g, fillbuf, n, pos) != 0))
+	return 1;
 
       pos += n;
       len -= n;
@@ -534,6 +686,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
   char fillbuf[FILLBUFSIZE];
   size_t filled = 0;
   bool previous_scn_changed = false;
+  struct gather out = { .fd = elf->fildes };
 
   /* We need the ELF header several times.  */
   ElfW2(LIBELFBITS,Ehdr) *ehdr = elf->state.ELFW(elf,LIBELFBITS).ehdr;
@@ -598,7 +751,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
       /* Maybe the user wants a gap between the ELF header and the program
 	 header.  */
       if (ehdr->e_phoff > ehdr->e_ehsize
-	  && unlikely (fill (elf->fildes, ehdr->e_ehsize,
+	  && unlikely (fill (&out, ehdr->e_ehsize,
 			     ehdr->e_phoff - ehdr->e_ehsize, fillbuf, &filled)
 		       != 0))
 	return 1;
@@ -628,11 +781,11 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 
       /* Write out the ELF header.  */
       size_t phdr_size = sizeof (ElfW2(LIBELFBITS,Phdr)) * phnum;
-      if (unlikely ((size_t) pwrite_retry (elf->fildes, out_phdr,
-					   phdr_size, ehdr->e_phoff)
-		    != phdr_size))
+      if (unlikely (gather_add (&out, out_phdr, phdr_size, ehdr->e_phoff)
+		    != 0
+		    || gather_flush (&out) != 0))
 	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
+	  free (tmp_phdr);
 	  return 1;
 	}
 
@@ -722,7 +875,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 			|| ((scn->flags | dl->flags | elf->flags)
 			    & ELF_F_DIRTY) != 0))
 		  {
-		    if (unlikely (fill (elf->fildes, last_offset,
+		    if (unlikely (fill (&out, last_offset,
 					(scn_start + dl->data.d.d_off)
 					- last_offset, fillbuf,
 					&filled) != 0))
@@ -736,7 +889,19 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 
 		last_offset = scn_start + dl->data.d.d_off;
 
-		if ((scn->flags | dl->flags | elf->flags) & ELF_F_DIRTY)
+		if (((scn->flags | dl->flags | elf->flags) & ELF_F_DIRTY)
+		    && (dl->flags & ELF_F_FILERANGE))
+		  {
+		    /* The bytes are already in the file byte order.  */
+		    if (unlikely (gather_flush (&out) != 0
+				  || copy_range (elf->fildes, last_offset,
+						 dl->src_fd, dl->src_offset,
+						 dl->data.d.d_size) != 0))
+		      goto fail_free;
+
+		    scn_changed = true;
+		  }
+		else if ((scn->flags | dl->flags | elf->flags) & ELF_F_DIRTY)
 		  {
 		    char tmpbuf[MAX_TMPBUF];
 		    void *buf = dl->data.d.d_buf;
@@ -766,21 +931,18 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 			(*fctp) (buf, dl->data.d.d_buf, dl->data.d.d_size, 1);
 		      }
 
-		    ssize_t n = pwrite_retry (elf->fildes, buf,
-					      dl->data.d.d_size,
-					      last_offset);
-		    if (unlikely ((size_t) n != dl->data.d.d_size))
-		      {
-			if (buf != dl->data.d.d_buf && buf != tmpbuf)
-			  free (buf);
-
-			__libelf_seterrno (ELF_E_WRITE_ERROR);
-			goto fail_free;
-		      }
+		    /* A converted buffer has to be written right away.  */
+		    int res = gather_add (&out, buf, dl->data.d.d_size,
+					  last_offset);
+		    if (res == 0 && buf != dl->data.d.d_buf)
+		      res = gather_flush (&out);
 
 		    if (buf != dl->data.d.d_buf && buf != tmpbuf)
 		      free (buf);
 
+		    if (unlikely (res != 0))
+		      goto fail_free;
+
 		    scn_changed = true;
 		  }
 
@@ -797,7 +959,7 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
 		 header) changed we might have to fill the gap.  */
 	      if (scn_start > last_offset && previous_scn_changed)
 		{
-		  if (unlikely (fill (elf->fildes, last_offset,
+		  if (unlikely (fill (&out, last_offset,
 				      scn_start - last_offset, fillbuf,
 				      &filled) != 0))
 		    goto fail_free;
@@ -825,21 +987,20 @@ __elfw2(LIBELFBITS,updatefile) (Elf *elf, int change_bo, size_t shnum)
       /* Fill the gap between last section and section header table if
 	 necessary.  */
       if ((elf->flags & ELF_F_DIRTY) && last_offset < shdr_offset
-	  && unlikely (fill (elf->fildes, last_offset,
+	  && unlikely (fill (&out, last_offset,
 			     shdr_offset - last_offset,
 			     fillbuf, &filled) != 0))
 	goto fail_free;
 
       /* Write out the section header table.  */
       if (shdr_flags & ELF_F_DIRTY
-	  && unlikely ((size_t) pwrite_retry (elf->fildes, shdr_data,
-					      sizeof (ElfW2(LIBELFBITS,Shdr))
-					      * shnum, shdr_offset)
-		       != sizeof (ElfW2(LIBELFBITS,Shdr)) * shnum))
-	{
-	  __libelf_seterrno (ELF_E_WRITE_ERROR);
-	  goto fail_free;
-	}
+	  && unlikely (gather_add (&out, shdr_data,
+				   sizeof (ElfW2(LIBELFBITS,Shdr)) * shnum,
+				   shdr_offset) != 0))
+	goto fail_free;
+
+      if (unlikely (gather_flush (&out) != 0))
+	goto fail_free;
 
       free (shdr_data_mem);
       free (scns);
@@ -69,9 +69,20 @@ file_read_ar (int fildes, void *map_address, off_t offset, size_t maxsize,
 }
 
 
+/* Read from FILDES, or through READER if that is not NULL.  */
+static ssize_t
+read_file_or_reader (int fildes, Elf_Reader *reader, void *buf, size_t len,
+		     int64_t offset)
+{
+  if (reader != NULL)
+    return reader->read (reader->arg, buf, len, offset);
+  return pread_retry (fildes, buf, len, offset);
+}
+
+
 static size_t
 get_shnum (void *map_address, unsigned char *e_ident, int fildes,
-	   int64_t offset, size_t maxsize)
+	   Elf_Reader *reader, int64_t offset, size_t maxsize)
 {
   size_t result;
   union
@@ -176,11 +187,11 @@ get_shnum (void *map_address, unsigned char *e_ident, int fildes,
 					 + offsetof (Elf32_Shdr, sh_size)),
 			sizeof (Elf32_Word));
 	      else
-		if (unlikely ((r = pread_retry (fildes, &size,
-						sizeof (Elf32_Word),
-						offset + ehdr.e32->e_shoff
-						+ offsetof (Elf32_Shdr,
-							    sh_size)))
+		if (unlikely ((r = read_file_or_reader (fildes, reader, &size,
+							sizeof (Elf32_Word),
+							offset + ehdr.e32->e_shoff
+							+ offsetof (Elf32_Shdr,
+								    sh_size)))
 			      != sizeof (Elf32_Word)))
 		  {
 		    if (r < 0)
@@ -235,11 +246,11 @@ get_shnum (void *map_address, unsigned char *e_ident, int fildes,
 					 + offsetof (Elf64_Shdr, sh_size)),
 			sizeof (Elf64_Xword));
 	      else
-		if (unlikely ((r = pread_retry (fildes, &size,
-						sizeof (Elf64_Xword),
-						offset + ehdr.e64->e_shoff
-						+ offsetof (Elf64_Shdr,
-							    sh_size)))
+		if (unlikely ((r = read_file_or_reader (fildes, reader, &size,
+							sizeof (Elf64_Xword),
+							offset + ehdr.e64->e_shoff
+							+ offsetof (Elf64_Shdr,
+								    sh_size)))
 			      != sizeof (Elf64_Xword)))
 		  {
 		    if (r < 0)
@@ -278,8 +289,9 @@ get_shnum (void *map_address, unsigned char *e_ident, int fildes,
 
 /* Create descriptor for ELF file in memory.  */
 static Elf *
-file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
-	       int64_t offset, size_t maxsize, Elf_Cmd cmd, Elf *parent)
+file_read_elf (int fildes, Elf_Reader *reader, void *map_address,
+	       unsigned char *e_ident, int64_t offset, size_t maxsize,
+	       Elf_Cmd cmd, Elf *parent)
 {
   /* Verify the binary is of the class we can handle.  */
   if (unlikely ((e_ident[EI_CLASS] != ELFCLASS32
@@ -296,7 +308,8 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
   /* Determine the number of sections.  Returns -1 and sets libelf errno
      if the file handle or elf file is invalid.  Returns zero if there
      are no section headers (or they cannot be read).  */
-  size_t scncnt = get_shnum (map_address, e_ident, fildes, offset, maxsize);
+  size_t scncnt = get_shnum (map_address, e_ident, fildes, reader, offset,
+			     maxsize);
   if (scncnt == (size_t) -1l)
     /* Could not determine the number of sections.  */
     return NULL;
@@ -326,6 +339,8 @@ file_read_elf (int fildes, void *map_address, unsigned char *e_ident,
     /* Not enough memory.  allocate_elf will have set libelf errno.  */
     return NULL;
 
+  elf->reader = reader;
+
   assert ((unsigned int) scncnt == scncnt);
   assert (offsetof (struct Elf, state.elf32.scns)
 	  == offsetof (struct Elf, state.elf64.scns));
@@ -559,8 +574,8 @@ __libelf_read_mmaped_file (int fildes, void *map_address,  int64_t offset,
   switch (kind)
     {
     case ELF_K_ELF:
-      return file_read_elf (fildes, map_address, e_ident, offset, maxsize,
-			    cmd, parent);
+      return file_read_elf (fildes, NULL, map_address, e_ident, offset,
+			    maxsize, cmd, parent);
 
     case ELF_K_AR:
       return file_read_ar (fildes, map_address, offset, maxsize, cmd, parent);
@@ -622,8 +637,8 @@ read_unmmaped_file (int fildes, int64_t offset, size_t maxsize, Elf_Cmd cmd,
       /* Make sure at least the ELF header is contained in the file.  */
       if ((size_t) nread >= (mem.header[EI_CLASS] == ELFCLASS32
 			     ? sizeof (Elf32_Ehdr) : sizeof (Elf64_Ehdr)))
-	return file_read_elf (fildes, NULL, mem.header, offset, maxsize, cmd,
-			      parent);
+	return file_read_elf (fildes, NULL, NULL, mem.header, offset, maxsize,
+			      cmd, parent);
       FALLTHROUGH;
 
     default:
@@ -637,6 +652,42 @@ read_unmmaped_file (int fildes, int64_t offset, size_t maxsize, Elf_Cmd cmd,
 }
 
 
+/* Create descriptor for the ELF image of MAXSIZE bytes which is only
+   available through READER.  */
+Elf *
+internal_function
+__libelf_read_reader_file (Elf_Reader *reader, size_t maxsize)
+{
+  /* See read_unmmaped_file, but we only handle ELF files.  */
+  union
+  {
+    Elf64_Ehdr ehdr;
+    unsigned char header[sizeof (Elf64_Ehdr)];
+  } mem;
+
+  ssize_t nread = reader->read (reader->arg, mem.header,
+				MIN (sizeof (Elf64_Ehdr), maxsize), 0);
+  if (unlikely (nread == -1))
+    {
+      __libelf_seterrno (ELF_E_READ_ERROR);
+      return NULL;
+    }
+
+  if (determine_kind (mem.header, nread) == ELF_K_ELF
+      && (size_t) nread >= (mem.header[EI_CLASS] == ELFCLASS32
+			    ? sizeof (Elf32_Ehdr) : sizeof (Elf64_Ehdr)))
+    return file_read_elf (-1, reader, NULL, mem.header, 0, maxsize,
+			  ELF_C_READ, NULL);
+
+  /* Nothing we can do with this image, create a dummy descriptor.  */
+  Elf *elf = allocate_elf (-1, NULL, 0, maxsize, ELF_C_READ, NULL,
+			   ELF_K_NONE, 0);
+  if (elf != NULL)
+    elf->reader = reader;
+  return elf;
+}
+
+
 /* Open a file for reading.  If possible we will try to mmap() the file.  */
 static struct Elf *
 read_file (int fildes, int64_t offset, size_t maxsize,
@@ -42,7 +42,7 @@ elf_cntl (Elf *elf, Elf_Cmd cmd)
   if (elf == NULL)
     return -1;
 
-  if (elf->fildes == -1)
+  if (! __libelf_can_read (elf))
     {
       __libelf_seterrno (ELF_E_INVALID_HANDLE);
       return -1;
@@ -65,6 +65,15 @@ elf_cntl (Elf *elf, Elf_Cmd cmd)
     case ELF_C_FDDONE:
       /* Mark the file descriptor as not usable.  */
       elf->fildes = -1;
+
+      /* Likewise release the reader, which is done with as well.  */
+      if (elf->reader != NULL)
+	{
+	  if (elf->reader->end != NULL)
+	    elf->reader->end (elf->reader->arg);
+	  free (elf->reader);
+	  elf->reader = NULL;
+	}
       break;
 
     default:
@@ -236,6 +236,13 @@ elf_end (Elf *elf)
 	munmap (elf->map_address, elf->maximum_size);
     }
 
+  if (elf->reader != NULL)
+    {
+      if (elf->reader->end != NULL)
+	elf->reader->end (elf->reader->arg);
+      free (elf->reader);
+    }
+
   rwlock_unlock (elf->lock);
   rwlock_fini (elf->lock);
 
@@ -315,7 +315,7 @@ __libelf_set_rawdata_wrlock (Elf_Scn *scn)
 	  scn->rawdata_base = scn->rawdata.d.d_buf
 	    = (char *) elf->map_address + elf->start_offset + offset;
 	}
-      else if (likely (elf->fildes != -1))
+      else if (likely (__libelf_can_read (elf)))
 	{
 	  /* First see whether the information in the section header is
 	     valid and it does not ask for too much.  Check for unsigned
@@ -337,8 +337,8 @@ __libelf_set_rawdata_wrlock (Elf_Scn *scn)
 	      return 1;
 	    }
 
-	  ssize_t n = pread_retry (elf->fildes, scn->rawdata.d.d_buf, size,
-				   elf->start_offset + offset);
+	  ssize_t n = __libelf_pread (elf, scn->rawdata.d.d_buf, size,
+				      elf->start_offset + offset);
 	  if (unlikely ((size_t) n != size))
 	    {
 	      /* Cannot read the data.  */
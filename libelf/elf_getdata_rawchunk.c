@@ -142,8 +142,8 @@ elf_getdata_rawchunk (Elf *elf, int64_t offset, size_t size, Elf_Type type)
 	}
 
       /* Read the file content.  */
-      if (unlikely ((size_t) pread_retry (elf->fildes, rawchunk, size,
-					  elf->start_offset + offset)
+      if (unlikely ((size_t) __libelf_pread (elf, rawchunk, size,
+					     elf->start_offset + offset)
 		    != size))
 	{
 	  /* Something went wrong.  */
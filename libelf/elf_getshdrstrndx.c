@@ -133,8 +133,8 @@ elf_getshdrstrndx (Elf *elf, size_t *dst)
 		  Elf32_Shdr shdr_mem;
 		  ssize_t r;
 
-		  if (unlikely ((r = pread_retry (elf->fildes, &shdr_mem,
-						  sizeof (Elf32_Shdr), offset))
+		  if (unlikely ((r = __libelf_pread (elf, &shdr_mem,
+						     sizeof (Elf32_Shdr), offset))
 				!= sizeof (Elf32_Shdr)))
 		    {
 		      /* We must be able to read this ELF section header.  */
@@ -198,8 +198,8 @@ elf_getshdrstrndx (Elf *elf, size_t *dst)
 		  Elf64_Shdr shdr_mem;
 		  ssize_t r;
 
-		  if (unlikely ((r = pread_retry (elf->fildes, &shdr_mem,
-						  sizeof (Elf64_Shdr), offset))
+		  if (unlikely ((r = __libelf_pread (elf, &shdr_mem,
+						     sizeof (Elf64_Shdr), offset))
 				!= sizeof (Elf64_Shdr)))
 		    {
 		      /* We must be able to read this ELF section header.  */
@@ -0,0 +1,87 @@
+/* Let section data be a range of bytes of another file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of either
+
+     * the GNU Lesser General Public License as published by the Free
+       Software Foundation; either version 3 of the License, or (at
+       your option) any later version
+
+   or
+
+     * the GNU General Public License as published by the Free
+       Software Foundation; either version 2 of the License, or (at
+       your option) any later version
+
+   or both in parallel, as here.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+   General Public License for more details.
+
+   You should have received copies of the GNU General Public License and
+   the GNU Lesser General Public License along with this program.  If
+   not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <libelf.h>
+#include <stddef.h>
+
+#include "libelfP.h"
+
+
+int
+elf_setdata_file (Elf_Data *data, int fd, int64_t offset)
+{
+  if (data == NULL)
+    return -1;
+
+  Elf_Data_Scn *data_scn = (Elf_Data_Scn *) data;
+  Elf_Scn *scn = data_scn->s;
+  if (unlikely (scn == NULL || scn->elf->kind != ELF_K_ELF))
+    {
+      __libelf_seterrno (ELF_E_INVALID_HANDLE);
+      return -1;
+    }
+
+  if (unlikely (fd >= 0 && offset < 0))
+    {
+      __libelf_seterrno (ELF_E_INVALID_OFFSET);
+      return -1;
+    }
+
+  rwlock_wrlock (scn->elf->lock);
+
+  /* Only the data making up the section contents is written, not the
+     raw data or a raw chunk.  */
+  Elf_Data_List *dl = scn->data_list_rear != NULL ? &scn->data_list : NULL;
+  while (dl != NULL && &dl->data != data_scn)
+    dl = dl->next;
+
+  int result = -1;
+  if (unlikely (dl == NULL))
+    __libelf_seterrno (ELF_E_INVALID_HANDLE);
+  else
+    {
+      if (fd >= 0)
+	{
+	  dl->src_fd = fd;
+	  dl->src_offset = offset;
+	  dl->flags |= ELF_F_FILERANGE;
+	}
+      else
+	dl->flags &= ~ELF_F_FILERANGE;
+      dl->flags |= ELF_F_DIRTY;
+      result = 0;
+    }
+
+  rwlock_unlock (scn->elf->lock);
+
+  return result;
+}
@@ -81,6 +81,150 @@ union unaligned
 
 #endif
 
+/* Where the compiler can build functions for other instruction sets,
+   build the array conversions below also for the x86 ones which have
+   byte shuffles, and pick one when called, like crc32 does.  This
+   doesn't use IFUNCs, which would make libelf ELFOSABI_GNU.  */
+#if defined HAVE_TARGET_DISPATCH && (defined __x86_64__ || defined __i386__)
+# define XLATE_X86	1
+#else
+# define XLATE_X86	0
+#endif
+
+/* Swapping the bytes of whole 16-byte vectors with a single shuffle
+   only pays off where the target can do that shuffle natively.  */
+#if XLATE_X86 || defined __SSSE3__ || defined __ARM_NEON || defined __ALTIVEC__
+# define XLATE_SHUFFLE	1
+#else
+# define XLATE_SHUFFLE	0
+#endif
+
+/* Define NAME calling do_NAME, which is inlined into a variant for
+   each instruction set.  */
+#if XLATE_X86
+# define XLATE_DISPATCH(Name)						      \
+  static void __attribute__ ((target ("avx2")))				      \
+  Name##_avx2 (char *dest, const char *src, size_t n)			      \
+  {									      \
+    do_##Name (dest, src, n);						      \
+  }									      \
+									      \
+  static void __attribute__ ((target ("ssse3")))			      \
+  Name##_ssse3 (char *dest, const char *src, size_t n)			      \
+  {									      \
+    do_##Name (dest, src, n);						      \
+  }									      \
+									      \
+  static void								      \
+  Name (char *dest, const char *src, size_t n)				      \
+  {									      \
+    if (__builtin_cpu_supports ("avx2"))				      \
+      Name##_avx2 (dest, src, n);					      \
+    else if (__builtin_cpu_supports ("ssse3"))				      \
+      Name##_ssse3 (dest, src, n);					      \
+    else								      \
+      do_##Name (dest, src, n);						      \
+  }
+#else
+# define XLATE_DISPATCH(Name)						      \
+  static void								      \
+  Name (char *dest, const char *src, size_t n)				      \
+  {									      \
+    do_##Name (dest, src, n);						      \
+  }
+#endif
+
+typedef unsigned char xlate_v16 __attribute__ ((vector_size (16)));
+
+/* Byte swap arrays of N values of the given number of bits.  Going
+   forward is fine unless DEST overlaps the end of SRC.  */
+#define SWAPPED(Bits, i)	((i) ^ (Bits / 8 - 1))
+#define BSWAP_ARRAY(Bits)						      \
+  static inline __attribute__ ((always_inline)) void			      \
+  do_bswap_array_##Bits (char *dest, const char *src, size_t n)		      \
+  {									      \
+    const size_t size = Bits / 8;					      \
+    if (dest <= src || dest >= src + n * size)				      \
+      {									      \
+	size_t i = 0;							      \
+	if (XLATE_SHUFFLE)						      \
+	  {								      \
+	    const xlate_v16 mask =					      \
+	      {								      \
+		SWAPPED (Bits, 0), SWAPPED (Bits, 1), SWAPPED (Bits, 2),      \
+		SWAPPED (Bits, 3), SWAPPED (Bits, 4), SWAPPED (Bits, 5),      \
+		SWAPPED (Bits, 6), SWAPPED (Bits, 7), SWAPPED (Bits, 8),      \
+		SWAPPED (Bits, 9), SWAPPED (Bits, 10), SWAPPED (Bits, 11),    \
+		SWAPPED (Bits, 12), SWAPPED (Bits, 13), SWAPPED (Bits, 14),   \
+		SWAPPED (Bits, 15)					      \
+	      };							      \
+	    for (; i + 16 / size <= n; i += 16 / size)			      \
+	      {								      \
+		xlate_v16 v;						      \
+		memcpy (&v, src + i * size, 16);			      \
+		v = __builtin_shuffle (v, mask);			      \
+		memcpy (dest + i * size, &v, 16);			      \
+	      }								      \
+	  }								      \
+	for (; i < n; ++i)						      \
+	  STORE (Bits, (dest + i * size),				      \
+		 bswap_##Bits (FETCH (Bits, (src + i * size))));	      \
+      }									      \
+    else								      \
+      while (n-- > 0)							      \
+	STORE (Bits, (dest + n * size),					      \
+	       bswap_##Bits (FETCH (Bits, (src + n * size))));		      \
+  }									      \
+  XLATE_DISPATCH (bswap_array_##Bits)
+BSWAP_ARRAY (16)
+BSWAP_ARRAY (32)
+BSWAP_ARRAY (64)
+
+#if XLATE_SHUFFLE
+/* Symbol table entries mix fields of different sizes, so they need
+   their own shuffles: one for an Elf32_Sym, three for two Elf64_Sym.  */
+static inline __attribute__ ((always_inline)) void
+do_bswap_sym32 (char *dest, const char *src, size_t n)
+{
+  const xlate_v16 sym = { 3, 2, 1, 0, 7, 6, 5, 4,
+			  11, 10, 9, 8, 12, 13, 15, 14 };
+  for (size_t i = 0; i < n; ++i)
+    {
+      xlate_v16 v;
+      memcpy (&v, src + i * 16, 16);
+      v = __builtin_shuffle (v, sym);
+      memcpy (dest + i * 16, &v, 16);
+    }
+}
+
+XLATE_DISPATCH (bswap_sym32)
+
+static inline __attribute__ ((always_inline)) void
+do_bswap_sym64_pairs (char *dest, const char *src, size_t n)
+{
+  const xlate_v16 head = { 3, 2, 1, 0, 4, 5, 7, 6,
+			   15, 14, 13, 12, 11, 10, 9, 8 };
+  const xlate_v16 middle = { 7, 6, 5, 4, 3, 2, 1, 0,
+			     11, 10, 9, 8, 12, 13, 15, 14 };
+  const xlate_v16 tail = { 7, 6, 5, 4, 3, 2, 1, 0,
+			   15, 14, 13, 12, 11, 10, 9, 8 };
+  for (size_t i = 0; i < n; ++i)
+    {
+      xlate_v16 v0, v1, v2;
+      memcpy (&v0, src + i * 48, 16);
+      memcpy (&v1, src + i * 48 + 16, 16);
+      memcpy (&v2, src + i * 48 + 32, 16);
+      v0 = __builtin_shuffle (v0, head);
+      v1 = __builtin_shuffle (v1, middle);
+      v2 = __builtin_shuffle (v2, tail);
+      memcpy (dest + i * 48, &v0, 16);
+      memcpy (dest + i * 48 + 16, &v1, 16);
+      memcpy (dest + i * 48 + 32, &v2, 16);
+    }
+}
+XLATE_DISPATCH (bswap_sym64_pairs)
+#endif
+
 /* Now define the conversion functions for the basic types.  We use here
    the fact that file and memory types are the same and that we have the
    ELFxx_FSZ_* macros.
@@ -108,23 +252,13 @@ union unaligned
 		     int encode __attribute__ ((unused)))		      \
   {									      \
     size_t n = len / sizeof (TName);					      \
-    if (dest < ptr)							      \
-      while (n-- > 0)							      \
-	{								      \
-	  FName##1 (dest, ptr);						      \
-	  dest += Bytes;						      \
-	  ptr += Bytes;							      \
-	}								      \
-    else								      \
+    switch (Bytes)							      \
       {									      \
-	dest += len;							      \
-	ptr += len;							      \
-	while (n-- > 0)							      \
-	  {								      \
-	    ptr -= Bytes;						      \
-	    dest -= Bytes;						      \
-	    FName##1 (dest, ptr);					      \
-	  }								      \
+      case 2: bswap_array_16 (dest, ptr, n); break;			      \
+      case 4: bswap_array_32 (dest, ptr, n); break;			      \
+      case 8: bswap_array_64 (dest, ptr, n); break;			      \
+      default:								      \
+	abort ();							      \
       }									      \
   }
 
@@ -174,6 +308,34 @@ union unaligned
 #include "chdr_xlate.h"
 
 
+/* Symbol tables and relocations make up most of what is converted in
+   large files.  Convert all whole chunks of CHUNK bytes with KERNEL,
+   taking STEP bytes at a time, and leave the rest to the generic
+   function.  */
+#define BULK(Bits, Name, Kernel, Chunk, Step)				      \
+  static void								      \
+  ElfW2(Bits, cvt_##Name##_bulk) (void *dest, const void *src,		      \
+				  size_t len, int encode)		      \
+  {									      \
+    size_t done = len - len % (Chunk);					      \
+    Kernel (dest, src, done / (Step));					      \
+    ElfW2(Bits, cvt_##Name) (dest + done, src + done, len - done,	      \
+			     encode);					      \
+  }
+BULK (32, Rel, bswap_array_32, sizeof (Elf32_Rel), 4)
+BULK (32, Rela, bswap_array_32, sizeof (Elf32_Rela), 4)
+BULK (64, Rel, bswap_array_64, sizeof (Elf64_Rel), 8)
+BULK (64, Rela, bswap_array_64, sizeof (Elf64_Rela), 8)
+#if XLATE_SHUFFLE
+BULK (32, Sym, bswap_sym32, sizeof (Elf32_Sym), sizeof (Elf32_Sym))
+BULK (64, Sym, bswap_sym64_pairs, 2 * sizeof (Elf64_Sym),
+      2 * sizeof (Elf64_Sym))
+# define cvt_Sym_table	cvt_Sym_bulk
+#else
+# define cvt_Sym_table	cvt_Sym
+#endif
+
+
 /* Now the externally visible table with the function pointers.  */
 const xfct_t __elf_xfctstom[ELFCLASSNUM - 1][ELF_T_NUM] =
 {
@@ -186,11 +348,11 @@ const xfct_t __elf_xfctstom[ELFCLASSNUM - 1][ELF_T_NUM] =
 	[ELF_T_HALF]	= ElfW2(Bits, cvt_Half),			      \
 	[ELF_T_OFF]	= ElfW2(Bits, cvt_Off),				      \
 	[ELF_T_PHDR]	= ElfW2(Bits, cvt_Phdr),			      \
-	[ELF_T_RELA]	= ElfW2(Bits, cvt_Rela),			      \
-	[ELF_T_REL]	= ElfW2(Bits, cvt_Rel),				      \
+	[ELF_T_RELA]	= ElfW2(Bits, cvt_Rela_bulk),			      \
+	[ELF_T_REL]	= ElfW2(Bits, cvt_Rel_bulk),			      \
 	[ELF_T_SHDR]	= ElfW2(Bits, cvt_Shdr),			      \
 	[ELF_T_SWORD]	= ElfW2(Bits, cvt_Sword),			      \
-	[ELF_T_SYM]	= ElfW2(Bits, cvt_Sym),				      \
+	[ELF_T_SYM]	= ElfW2(Bits, cvt_Sym_table),			      \
 	[ELF_T_WORD]	= ElfW2(Bits, cvt_Word),			      \
 	[ELF_T_XWORD]	= ElfW2(Bits, cvt_Xword),			      \
 	[ELF_T_SXWORD]	= ElfW2(Bits, cvt_Sxword),			      \
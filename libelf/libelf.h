@@ -237,6 +237,12 @@ typedef struct Elf Elf;
 /* Descriptor for ELF file section.  */
 typedef struct Elf_Scn Elf_Scn;
 
+/* Callback used by elf_begin_reader to read LEN bytes at OFFSET of the
+   ELF image into BUF.  Must return the number of bytes read, which is
+   only less than LEN at the end of the image, or -1 on error.  */
+typedef ssize_t Elf_Read_Fn (void *__arg, void *__buf, size_t __len,
+			     int64_t __offset);
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -251,6 +257,16 @@ extern Elf *elf_begin (int __fildes, Elf_Cmd __cmd, Elf *__ref);
 /* Create descriptor for memory region.  */
 extern Elf *elf_memory (char *__image, size_t __size);
 
+/* Create descriptor for an ELF image of SIZE bytes which is neither in
+   memory nor in a file, but whose contents are read on demand through
+   READ_FN (ARG, ...).  Only the parts of the image actually used (the
+   headers and the data of the sections asked for) are read.  If END_FN
+   is not NULL it is called with ARG when the descriptor is released,
+   or earlier by elf_cntl with ELF_C_FDDONE or ELF_C_FDREAD, as for a
+   file descriptor.  On failure neither callback is called again.  */
+extern Elf *elf_begin_reader (Elf_Read_Fn *__read_fn, void (*__end_fn) (void *),
+			      void *__arg, size_t __size);
+
 /* Advance archive descriptor to next element.  */
 extern Elf_Cmd elf_next (Elf *__elf);
 
@@ -442,6 +458,16 @@ extern Elf_Data *elf_rawdata (Elf_Scn *__scn, Elf_Data *__data);
 /* Create new data descriptor for section SCN.  */
 extern Elf_Data *elf_newdata (Elf_Scn *__scn);
 
+/* Let the contents of DATA be the d_size bytes at OFFSET in the file
+   open as FD, which are already in the byte order of the ELF file DATA
+   belongs to.  elf_update then copies them straight from FD, without
+   passing them through user memory if the kernel can copy (or share)
+   file ranges, instead of writing d_buf.  d_buf need not be set and is
+   not used for writing.  FD must stay open and the bytes unchanged
+   until elf_update is called.  A negative FD makes DATA use d_buf
+   again.  Returns zero on success, -1 otherwise.  */
+extern int elf_setdata_file (Elf_Data *__data, int __fd, int64_t __offset);
+
 /* Get data translated from a chunk of the file contents as section data
    would be for TYPE.  The resulting Elf_Data pointer is valid until
    elf_end (ELF) is called.  */
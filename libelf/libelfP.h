@@ -82,7 +82,8 @@ enum
 {
   ELF_F_MMAPPED = 0x40,
   ELF_F_MALLOCED = 0x80,
-  ELF_F_FILEDATA = 0x100
+  ELF_F_FILEDATA = 0x100,
+  ELF_F_FILERANGE = 0x200
 };
 
 
@@ -166,6 +167,10 @@ typedef struct Elf_Data_List
   Elf_Data_Scn data;
   struct Elf_Data_List *next;
   int flags;
+  /* If ELF_F_FILERANGE is set in flags, the data is read from this file
+     descriptor at this offset when it is written.  */
+  int src_fd;
+  int64_t src_offset;
 } Elf_Data_List;
 
 
@@ -270,6 +275,16 @@ typedef struct Elf_Data_Chunk
 } Elf_Data_Chunk;
 
 
+/* Source of the file contents for descriptors created with
+   elf_begin_reader, used instead of a file descriptor.  */
+typedef struct Elf_Reader
+{
+  Elf_Read_Fn *read;
+  void (*end) (void *);
+  void *arg;
+} Elf_Reader;
+
+
 /* The ELF descriptor.  */
 struct Elf
 {
@@ -293,6 +308,10 @@ struct Elf
   /* The used file descriptor.  -1 if not available anymore.  */
   int fildes;
 
+  /* If not NULL the file contents not in memory are read through this
+     instead of FILDES.  */
+  Elf_Reader *reader;
+
   /* Offset in the archive this file starts or zero.  */
   int64_t start_offset;
 
@@ -404,6 +423,24 @@ struct Elf
   /* There absolutely never must be anything following the union.  */
 };
 
+/* Return true if data of ELF which is not in memory can still be read
+   from the underlying file or reader.  */
+static inline bool
+__libelf_can_read (Elf *elf)
+{
+  return elf->fildes != -1 || elf->reader != NULL;
+}
+
+/* Read LEN bytes at OFFSET of the file underlying ELF into BUF.  Same
+   return value as pread_retry.  */
+static inline ssize_t
+__libelf_pread (Elf *elf, void *buf, size_t len, int64_t offset)
+{
+  if (elf->reader != NULL)
+    return elf->reader->read (elf->reader->arg, buf, len, offset);
+  return pread_retry (elf->fildes, buf, len, offset);
+}
+
 /* Type of the conversion functions.  These functions will convert the
    byte order.  */
 typedef void (*xfct_t) (void *, const void *, size_t, int);
@@ -457,6 +494,10 @@ extern int __libelf_next_arhdr_wrlock (Elf *elf) internal_function;
 /* Read all of the file associated with the descriptor.  */
 extern char *__libelf_readall (Elf *elf) internal_function;
 
+/* Create descriptor for ELF image of MAXSIZE bytes provided by READER.  */
+extern Elf *__libelf_read_reader_file (Elf_Reader *reader, size_t maxsize)
+     internal_function;
+
 /* Read the complete section table and convert the byte order if necessary.  */
 extern int __libelf_readsections (Elf *elf) internal_function;
 
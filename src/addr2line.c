@@ -26,9 +26,11 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <libdwelf.h>
 #include <libdwfl.h>
 #include <dwarf.h>
 #include <locale.h>
+#include <search.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdio_ext.h>
@@ -36,7 +38,9 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <libeu.h>
 #include <system.h>
+#include <parallel.h>
 #include <printversion.h>
 
 
@@ -51,6 +55,9 @@ ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 #define OPT_DEMANGLER 0x100
 #define OPT_PRETTY    0x101  /* 'p' is already used to select the process.  */
 #define OPT_RELATIVE  0x102  /* 'r' is something else in binutils addr2line.  */
+#define OPT_BATCH     0x103
+#define OPT_BINARY    0x104
+#define OPT_JOBS      0x105  /* 'j' is already used to select the section.  */
 
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
@@ -58,6 +65,15 @@ static const struct argp_option options[] =
   { NULL, 0, NULL, 0, N_("Input format options:"), 2 },
   { "section", 'j', "NAME", 0,
     N_("Treat addresses as offsets relative to NAME section."), 0 },
+  { "batch", OPT_BATCH, "N", OPTION_ARG_OPTIONAL,
+    N_("Look up N addresses (default 4096) at a time, sorted by compilation unit, and only then print them"),
+    0 },
+  { "binary", OPT_BINARY, NULL, 0,
+    N_("Read addresses from standard input as 8 byte integers in host byte order, and end the output for each with a NUL character"),
+    0 },
+  { "jobs", OPT_JOBS, "N", 0,
+    N_("Look up the addresses of a batch on up to N threads, or one per CPU if N is 0 (implies --batch)"),
+    0 },
 
   { NULL, 0, NULL, 0, N_("Output format options:"), 3 },
   { "addresses", 'a', NULL, 0, N_("Print address before each entry"), 0 },
@@ -105,8 +121,55 @@ static const struct argp argp =
 };
 
 
-/* Handle ADDR.  */
-static int handle_address (const char *addr, Dwfl *dwfl);
+/* An address to look up and what was found for it.  */
+struct address
+{
+  bool valid;
+  uintmax_t addr;
+  Dwfl_Module *mod;
+  Dwfl_Line *line;
+  Dwarf_Addr line_addr;
+  const char *src;
+  int lineno;
+  int linecol;
+
+  /* The scopes for the function names, at ADDR.  */
+  struct scopes *func;
+  /* The scopes for the inlined subroutines, at the address of LINE.  */
+  struct scopes *inlines;
+};
+
+/* The scopes containing PC in CUDIE.  Looked up once for all addresses
+   of a batch that need them, in the order of the CUs.  */
+struct scopes
+{
+  Dwarf_Die *cudie;
+  Dwarf_Addr pc;
+  Dwarf *dwarf;
+  bool want_chain;
+  int nscopes;
+  Dwarf_Die *scopes;
+  /* With --inlines the scopes of the innermost one, SCOPES[0].  */
+  struct inline_chain *chain;
+};
+
+/* The scopes containing an inlined subroutine, as returned by
+   dwarf_getscopes_die.  Shared by all addresses of a batch in it.  */
+struct inline_chain
+{
+  void *addr;
+  int nscopes;
+  Dwarf_Die *scopes;
+};
+
+/* Parse STRING and find what is at the address.  */
+static void read_address (struct address *a, const char *string, Dwfl *dwfl);
+
+/* Find what is at ADDR.  */
+static void set_address (struct address *a, uintmax_t addr, Dwfl *dwfl);
+
+/* Look up and print the first N addresses of the batch.  */
+static int handle_batch (size_t n);
 
 /* True when we should print the address for each entry.  */
 static bool print_addresses;
@@ -141,6 +204,22 @@ static bool demangle;
 /* True if all information should be printed on one line.  */
 static bool pretty;
 
+/* Number of addresses looked up together.  */
+#define DEFAULT_BATCH_SIZE 4096
+static size_t batch_size = 1;
+
+/* True if addresses are read in binary.  */
+static bool binary;
+
+/* Number of threads to use.  */
+static unsigned int nthreads = 1;
+
+/* The addresses of the current batch.  */
+static struct address *batch;
+
+/* The Dwarf handles already prepared for prepare_dwarf.  */
+static void *prepared_dwarfs;
+
 #ifdef USE_DEMANGLE
 static size_t demangle_buffer_len = 0;
 static char *demangle_buffer = NULL;
@@ -171,37 +250,73 @@ main (int argc, char *argv[])
   (void) argp_parse (&argp, argc, argv, 0, &remaining, &dwfl);
   assert (dwfl != NULL);
 
+  if (nthreads > 1 && batch_size == 1)
+    batch_size = DEFAULT_BATCH_SIZE;
+  batch = xmalloc (batch_size * sizeof batch[0]);
+
   /* Now handle the addresses.  In case none are given on the command
      line, read from stdin.  */
+  size_t n = 0;
   if (remaining == argc)
     {
       /* We use no threads here which can interfere with handling a stream.  */
       (void) __fsetlocking (stdin, FSETLOCKING_BYCALLER);
 
-      char *buf = NULL;
-      size_t len = 0;
-      ssize_t chars;
-      while (!feof_unlocked (stdin))
+      if (binary)
 	{
-	  if ((chars = getline (&buf, &len, stdin)) < 0)
-	    break;
+	  uint64_t addr;
+	  while (fread_unlocked (&addr, sizeof addr, 1, stdin) == 1)
+	    {
+	      set_address (&batch[n], addr, dwfl);
+	      if (++n == batch_size)
+		{
+		  result = handle_batch (n);
+		  n = 0;
+		}
+	    }
+	}
+      else
+	{
+	  char *buf = NULL;
+	  size_t len = 0;
+	  ssize_t chars;
+	  while (!feof_unlocked (stdin))
+	    {
+	      if ((chars = getline (&buf, &len, stdin)) < 0)
+		break;
 
-	  if (buf[chars - 1] == '\n')
-	    buf[chars - 1] = '\0';
+	      if (buf[chars - 1] == '\n')
+		buf[chars - 1] = '\0';
 
-	  result = handle_address (buf, dwfl);
-	  fflush (stdout);
-	}
+	      read_address (&batch[n], buf, dwfl);
+	      if (++n == batch_size)
+		{
+		  result = handle_batch (n);
+		  n = 0;
+		}
+	    }
 
-      free (buf);
+	  free (buf);
+	}
     }
   else
     {
       do
-	result = handle_address (argv[remaining], dwfl);
+	{
+	  read_address (&batch[n], argv[remaining], dwfl);
+	  if (++n == batch_size)
+	    {
+	      result = handle_batch (n);
+	      n = 0;
+	    }
+	}
       while (++remaining < argc);
     }
+  if (n > 0)
+    result = handle_batch (n);
 
+  free (batch);
+  tdestroy (prepared_dwarfs, free);
   dwfl_end (dwfl);
 
 #ifdef USE_DEMANGLE
@@ -276,6 +391,36 @@ parse_opt (int key, char *arg, struct argp_state *state)
       pretty = true;
       break;
 
+    case OPT_BATCH:
+      if (arg == NULL)
+	batch_size = DEFAULT_BATCH_SIZE;
+      else
+	{
+	  char *endp;
+	  unsigned long int size = strtoul (arg, &endp, 10);
+	  if (*arg == '\0' || *endp != '\0' || size == 0
+	      || size > SIZE_MAX / (2 * sizeof (struct scopes)))
+	    {
+	      argp_error (state, _("invalid batch size '%s'"), arg);
+	      return EINVAL;
+	    }
+	  batch_size = size;
+	}
+      break;
+
+    case OPT_BINARY:
+      binary = true;
+      break;
+
+    case OPT_JOBS:
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -317,13 +462,11 @@ get_diename (Dwarf_Die *die)
 }
 
 static bool
-print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
+print_dwarf_function (struct scopes *s)
 {
-  Dwarf_Addr bias = 0;
-  Dwarf_Die *cudie = dwfl_module_addrdie (mod, addr, &bias);
-
-  Dwarf_Die *scopes;
-  int nscopes = dwarf_getscopes (cudie, addr - bias, &scopes);
+  Dwarf_Die *cudie = s->cudie;
+  Dwarf_Die *scopes = s->scopes;
+  int nscopes = s->nscopes;
   if (nscopes <= 0)
     return false;
 
@@ -415,7 +558,6 @@ print_dwarf_function (Dwfl_Module *mod, Dwarf_Addr addr)
       }
 
 done:
-  free (scopes);
   return res;
 }
 
@@ -628,8 +770,8 @@ show_int (int (*get) (Dwarf_Line *, unsigned int *),
     printf (" (%s %u)", name, val);
 }
 
-static int
-handle_address (const char *string, Dwfl *dwfl)
+static bool
+parse_address (const char *string, Dwfl *dwfl, uintmax_t *addrp)
 {
   char *endp;
   uintmax_t addr = strtoumax (string, &endp, 16);
@@ -675,13 +817,130 @@ handle_address (const char *string, Dwfl *dwfl)
 
       free (name);
       if (!parsed)
-	return 1;
+	return false;
     }
   else if (just_section != NULL
 	   && !adjust_to_section (just_section, &addr, dwfl))
+    return false;
+
+  *addrp = addr;
+  return true;
+}
+
+static void
+read_address (struct address *a, const char *string, Dwfl *dwfl)
+{
+  uintmax_t addr;
+  if (parse_address (string, dwfl, &addr))
+    set_address (a, addr, dwfl);
+  else
+    a->valid = false;
+}
+
+static void
+set_address (struct address *a, uintmax_t addr, Dwfl *dwfl)
+{
+  if (binary && just_section != NULL
+      && !adjust_to_section (just_section, &addr, dwfl))
+    {
+      a->valid = false;
+      return;
+    }
+
+  a->valid = true;
+  a->addr = addr;
+  a->mod = dwfl_addrmodule (dwfl, addr);
+  a->line = dwfl_module_getsrc (a->mod, addr);
+  a->line_addr = addr;
+  a->src = NULL;
+  if (a->line != NULL)
+    a->src = dwfl_lineinfo (a->line, &a->line_addr, &a->lineno, &a->linecol,
+			    NULL, NULL);
+  a->func = NULL;
+  a->inlines = NULL;
+}
+
+static int
+print_inlines (struct scopes *s)
+{
+  if (s->nscopes < 0)
     return 1;
 
-  Dwfl_Module *mod = dwfl_addrmodule (dwfl, addr);
+  if (s->nscopes == 0 || s->chain->nscopes <= 1)
+    return 0;
+
+  Dwarf_Die *scopes = s->chain->scopes;
+  int nscopes = s->chain->nscopes;
+  Dwarf_Die cu;
+  Dwarf_Files *files;
+  if (dwarf_diecu (&scopes[0], &cu, NULL, NULL) != NULL
+      && dwarf_getsrcfiles (s->cudie, &files, NULL) == 0)
+    {
+      for (int i = 0; i < nscopes - 1; i++)
+	{
+	  Dwarf_Word val;
+	  Dwarf_Attribute attr;
+	  Dwarf_Die *die = &scopes[i];
+	  if (dwarf_tag (die) != DW_TAG_inlined_subroutine)
+	    continue;
+
+	  if (pretty)
+	    printf (" (inlined by) ");
+
+	  if (show_functions)
+	    {
+	      /* Search for the parent inline or function.  It
+		 might not be directly above this inline -- e.g.
+		 there could be a lexical_block in between.  */
+	      for (int j = i + 1; j < nscopes; j++)
+		{
+		  Dwarf_Die *parent = &scopes[j];
+		  int tag = dwarf_tag (parent);
+		  if (tag == DW_TAG_inlined_subroutine
+		      || tag == DW_TAG_entry_point
+		      || tag == DW_TAG_subprogram)
+		    {
+		      printf ("%s%s",
+			      symname (get_diename (parent)),
+			      pretty ? " at " : "\n");
+		      break;
+		    }
+		}
+	    }
+
+	  const char *src = NULL;
+	  int lineno = 0;
+	  int linecol = 0;
+	  if (dwarf_formudata (dwarf_attr (die, DW_AT_call_file,
+					   &attr), &val) == 0)
+	    src = dwarf_filesrc (files, val, NULL, NULL);
+
+	  if (dwarf_formudata (dwarf_attr (die, DW_AT_call_line,
+					   &attr), &val) == 0)
+	    lineno = val;
+
+	  if (dwarf_formudata (dwarf_attr (die, DW_AT_call_column,
+					   &attr), &val) == 0)
+	    linecol = val;
+
+	  if (src != NULL)
+	    {
+	      print_src (src, lineno, linecol, &cu);
+	      putchar ('\n');
+	    }
+	  else
+	    puts ("??:0");
+	}
+    }
+
+  return 0;
+}
+
+static int
+print_address (struct address *a)
+{
+  Dwfl_Module *mod = a->mod;
+  uintmax_t addr = a->addr;
 
   if (print_addresses)
     {
@@ -693,7 +952,7 @@ handle_address (const char *string, Dwfl *dwfl)
     {
       /* First determine the function name.  Use the DWARF information if
 	 possible.  */
-      if (! print_dwarf_function (mod, addr) && !show_symbols)
+      if (! print_dwarf_function (a->func) && !show_symbols)
 	{
 	  const char *name = dwfl_module_addrname (mod, addr);
 	  name = name != NULL ? symname (name) : "??";
@@ -707,19 +966,13 @@ handle_address (const char *string, Dwfl *dwfl)
   if ((show_functions || show_symbols) && pretty)
     printf ("at ");
 
-  Dwfl_Line *line = dwfl_module_getsrc (mod, addr);
-
-  const char *src;
-  int lineno, linecol;
-
-  if (line != NULL && (src = dwfl_lineinfo (line, &addr, &lineno, &linecol,
-					    NULL, NULL)) != NULL)
+  if (a->src != NULL)
     {
-      print_src (src, lineno, linecol, dwfl_linecu (line));
+      print_src (a->src, a->lineno, a->linecol, dwfl_linecu (a->line));
       if (show_flags)
 	{
 	  Dwarf_Addr bias;
-	  Dwarf_Line *info = dwfl_dwarf_line (line, &bias);
+	  Dwarf_Line *info = dwfl_dwarf_line (a->line, &bias);
 	  assert (info != NULL);
 
 	  show_note (&dwarf_linebeginstatement, info, " (is_stmt)");
@@ -735,95 +988,242 @@ handle_address (const char *string, Dwfl *dwfl)
     puts ("??:0");
 
   if (show_inlines)
+    return print_inlines (a->inlines);
+
+  return 0;
+}
+
+static int
+compare_chains (const void *p1, const void *p2)
+{
+  uintptr_t a1 = (uintptr_t) ((const struct inline_chain *) p1)->addr;
+  uintptr_t a2 = (uintptr_t) ((const struct inline_chain *) p2)->addr;
+  return a1 < a2 ? -1 : a1 > a2;
+}
+
+static void
+free_chain (void *p)
+{
+  struct inline_chain *chain = p;
+  free (chain->scopes);
+  free (chain);
+}
+
+/* Look up the scopes of S.  Addresses in the same innermost scope have
+   the same inlined subroutines, so each chain is looked up once and
+   remembered in CHAINS.  */
+static void
+lookup_scopes (struct scopes *s, void **chains)
+{
+  s->scopes = NULL;
+  s->chain = NULL;
+  s->nscopes = dwarf_getscopes (s->cudie, s->pc, &s->scopes);
+  if (s->nscopes <= 0 || !s->want_chain)
+    return;
+
+  struct inline_chain key = { .addr = s->scopes[0].addr };
+  struct inline_chain **found = tfind (&key, chains, compare_chains);
+  if (found != NULL)
     {
-      Dwarf_Addr bias = 0;
-      Dwarf_Die *cudie = dwfl_module_addrdie (mod, addr, &bias);
+      s->chain = *found;
+      return;
+    }
 
-      Dwarf_Die *scopes = NULL;
-      int nscopes = dwarf_getscopes (cudie, addr - bias, &scopes);
-      if (nscopes < 0)
-	return 1;
+  struct inline_chain *chain = xmalloc (sizeof *chain);
+  chain->addr = key.addr;
+  chain->scopes = NULL;
+  Dwarf_Die subroutine;
+  Dwarf_Off dieoff = dwarf_dieoffset (&s->scopes[0]);
+  chain->nscopes = dwarf_getscopes_die (dwarf_offdie (s->dwarf, dieoff,
+						      &subroutine),
+					&chain->scopes);
+  if (tsearch (chain, chains, compare_chains) == NULL)
+    error_exit (errno, _("memory exhausted"));
+  s->chain = chain;
+}
 
-      if (nscopes > 0)
-	{
-	  Dwarf_Die subroutine;
-	  Dwarf_Off dieoff = dwarf_dieoffset (&scopes[0]);
-	  dwarf_offdie (dwfl_module_getdwarf (mod, &bias),
-			dieoff, &subroutine);
-	  free (scopes);
-	  scopes = NULL;
-
-	  nscopes = dwarf_getscopes_die (&subroutine, &scopes);
-	  if (nscopes > 1)
-	    {
-	      Dwarf_Die cu;
-	      Dwarf_Files *files;
-	      if (dwarf_diecu (&scopes[0], &cu, NULL, NULL) != NULL
-		  && dwarf_getsrcfiles (cudie, &files, NULL) == 0)
-		{
-		  for (int i = 0; i < nscopes - 1; i++)
-		    {
-		      Dwarf_Word val;
-		      Dwarf_Attribute attr;
-		      Dwarf_Die *die = &scopes[i];
-		      if (dwarf_tag (die) != DW_TAG_inlined_subroutine)
-			continue;
+/* The scopes to look up for a batch, GROUPS[I] is the index of the
+   first one in the Ith CU.  */
+struct lookups
+{
+  struct scopes *scopes;
+  size_t *groups;
+  void **chains;
+};
 
-		      if (pretty)
-			printf (" (inlined by) ");
+static void
+lookup_group (void *arg, size_t i)
+{
+  struct lookups *l = arg;
+  for (size_t j = l->groups[i]; j < l->groups[i + 1]; ++j)
+    lookup_scopes (&l->scopes[j], &l->chains[i]);
+}
 
-		      if (show_functions)
-			{
-			  /* Search for the parent inline or function.  It
-			     might not be directly above this inline -- e.g.
-			     there could be a lexical_block in between.  */
-			  for (int j = i + 1; j < nscopes; j++)
-			    {
-			      Dwarf_Die *parent = &scopes[j];
-			      int tag = dwarf_tag (parent);
-			      if (tag == DW_TAG_inlined_subroutine
-				  || tag == DW_TAG_entry_point
-				  || tag == DW_TAG_subprogram)
-				{
-				  printf ("%s%s",
-					  symname (get_diename (parent)),
-					  pretty ? " at " : "\n");
-				  break;
-				}
-			    }
-			}
+/* Whether the scopes of different CUs of a Dwarf can be looked up
+   at the same time.  */
+struct prepared_dwarf
+{
+  Dwarf *dwarf;
+  bool parallel;
+};
 
-		      src = NULL;
-		      lineno = 0;
-		      linecol = 0;
-		      if (dwarf_formudata (dwarf_attr (die, DW_AT_call_file,
-						       &attr), &val) == 0)
-			src = dwarf_filesrc (files, val, NULL, NULL);
+static int
+compare_prepared (const void *p1, const void *p2)
+{
+  uintptr_t d1 = (uintptr_t) ((const struct prepared_dwarf *) p1)->dwarf;
+  uintptr_t d2 = (uintptr_t) ((const struct prepared_dwarf *) p2)->dwarf;
+  return d1 < d2 ? -1 : d1 > d2;
+}
 
-		      if (dwarf_formudata (dwarf_attr (die, DW_AT_call_line,
-						       &attr), &val) == 0)
-			lineno = val;
+/* dwarf_getscopes and dwarf_getscopes_die read units and their
+   abbreviations on demand, which can't be done by several threads.
+   Read them all first.  Units importing partial units, or DIEs of an
+   alternate debug file, share those with other units, so their scopes
+   are only looked up one CU at a time.  Returns false in that case.  */
+static bool
+prepare_dwarf (Dwarf *dwarf)
+{
+  struct prepared_dwarf key = { .dwarf = dwarf };
+  struct prepared_dwarf **found = tfind (&key, &prepared_dwarfs,
+					 compare_prepared);
+  if (found != NULL)
+    return (*found)->parallel;
+
+  struct prepared_dwarf *p = xmalloc (sizeof *p);
+  p->dwarf = dwarf;
+  const char *altname;
+  const void *altid;
+  p->parallel = dwelf_dwarf_gnu_debugaltlink (dwarf, &altname, &altid) == 0;
+
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie;
+  uint8_t unit_type;
+  while (p->parallel
+	 && dwarf_get_units (dwarf, cu, &cu, NULL, &unit_type,
+			     &cudie, NULL) == 0)
+    {
+      if (unit_type == DW_UT_partial)
+	p->parallel = false;
+
+      Dwarf_Off offset = 0;
+      size_t length;
+      Dwarf_Abbrev *abbrev;
+      while ((abbrev = dwarf_getabbrev (&cudie, offset, &length)) != NULL
+	     && abbrev != DWARF_END_ABBREV)
+	offset += length;
+    }
 
-		      if (dwarf_formudata (dwarf_attr (die, DW_AT_call_column,
-						       &attr), &val) == 0)
-			linecol = val;
+  if (tsearch (p, &prepared_dwarfs, compare_prepared) == NULL)
+    error_exit (errno, _("memory exhausted"));
+  return p->parallel;
+}
 
-		      if (src != NULL)
-			{
-			  print_src (src, lineno, linecol, &cu);
-			  putchar ('\n');
-			}
-		      else
-			puts ("??:0");
-		    }
-		}
-	    }
+/* A lookup of scopes for an address of the batch.  */
+struct request
+{
+  Dwarf_Die *cudie;
+  Dwarf_Addr pc;
+  Dwarf *dwarf;
+  size_t addr;
+  bool inlines;
+};
+
+static int
+compare_requests (const void *p1, const void *p2)
+{
+  const struct request *r1 = p1;
+  const struct request *r2 = p2;
+  if (r1->cudie != r2->cudie)
+    return (uintptr_t) r1->cudie < (uintptr_t) r2->cudie ? -1 : 1;
+  return r1->pc < r2->pc ? -1 : r1->pc > r2->pc;
+}
+
+static void
+add_request (struct request *r, struct address *a, size_t i,
+	     Dwarf_Addr addr, bool inlines)
+{
+  Dwarf_Addr bias = 0;
+  r->cudie = dwfl_module_addrdie (a->mod, addr, &bias);
+  r->pc = addr - bias;
+  r->dwarf = dwfl_module_getdwarf (a->mod, &bias);
+  r->addr = i;
+  r->inlines = inlines;
+}
+
+static int
+handle_batch (size_t n)
+{
+  /* Sort what needs to be looked up by CU and address, so that each
+     CU is only walked by one thread and each address only once.  */
+  struct request *reqs = xmalloc ((2 * n + 1) * sizeof reqs[0]);
+  size_t nreqs = 0;
+  for (size_t i = 0; i < n; ++i)
+    if (batch[i].valid)
+      {
+	if (show_functions)
+	  add_request (&reqs[nreqs++], &batch[i], i, batch[i].addr, false);
+	if (show_inlines)
+	  add_request (&reqs[nreqs++], &batch[i], i, batch[i].line_addr,
+		       true);
+      }
+  qsort (reqs, nreqs, sizeof reqs[0], compare_requests);
+
+  struct lookups l;
+  l.scopes = xmalloc ((nreqs + 1) * sizeof l.scopes[0]);
+  l.groups = xmalloc ((nreqs + 1) * sizeof l.groups[0]);
+  size_t nscopes = 0;
+  size_t ngroups = 0;
+  for (size_t i = 0; i < nreqs; ++i)
+    {
+      struct request *r = &reqs[i];
+      if (i == 0 || r->cudie != r[-1].cudie)
+	l.groups[ngroups++] = nscopes;
+      if (i == 0 || compare_requests (r, &r[-1]) != 0)
+	l.scopes[nscopes++] = (struct scopes) { .cudie = r->cudie,
+						.pc = r->pc,
+						.dwarf = r->dwarf };
+
+      struct scopes *s = &l.scopes[nscopes - 1];
+      if (r->inlines)
+	{
+	  s->want_chain = true;
+	  batch[r->addr].inlines = s;
 	}
-      free (scopes);
+      else
+	batch[r->addr].func = s;
     }
+  l.groups[ngroups] = nscopes;
+  free (reqs);
 
-  return 0;
-}
+  unsigned int jobs = nthreads;
+  for (size_t i = 0; jobs > 1 && i < ngroups; ++i)
+    {
+      Dwarf *dwarf = l.scopes[l.groups[i]].dwarf;
+      if (dwarf != NULL && !prepare_dwarf (dwarf))
+	jobs = 1;
+    }
+  l.chains = xcalloc (ngroups + 1, sizeof l.chains[0]);
+  run_parallel (jobs, ngroups, lookup_group, &l);
 
+  /* Print in the order the addresses were given.  */
+  int result = 0;
+  for (size_t i = 0; i < n; ++i)
+    {
+      result = batch[i].valid ? print_address (&batch[i]) : 1;
+      if (binary)
+	putchar ('\0');
+    }
+  fflush (stdout);
+
+  for (size_t i = 0; i < nscopes; ++i)
+    free (l.scopes[i].scopes);
+  for (size_t i = 0; i < ngroups; ++i)
+    tdestroy (l.chains[i], free_chain);
+  free (l.chains);
+  free (l.groups);
+  free (l.scopes);
+
+  return result;
+}
 
 #include "debugpred.h"
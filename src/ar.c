@@ -38,6 +38,8 @@
 #include <sys/stat.h>
 #include <sys/time.h>
 
+#include <libeu.h>
+#include <parallel.h>
 #include <system.h>
 #include <printversion.h>
 
@@ -167,6 +169,11 @@ main (int argc, char *argv[])
   int remaining;
   (void) argp_parse (&argp, argc, argv, ARGP_IN_ORDER, &remaining, NULL);
 
+  /* Members extracted at the same time report their errors on
+     their own.  */
+  if (arlib_jobs > 1)
+    (void) __fsetlocking (stderr, FSETLOCKING_INTERNAL);
+
   /* Tell the library which version we are expecting.  */
   (void) elf_version (EV_CURRENT);
 
@@ -451,6 +458,271 @@ should_truncate_fname (size_t *name_max)
   return false;
 }
 
+/* Write the NLEFT bytes of member NAME at DATA, which are at offset
+   OFF in the archive FD, to the file NAME or to stdout for 'p'.  */
+static void
+extract_member (int oper, int fd, const char *name, const char *data,
+		size_t nleft, off_t off, mode_t mode, time_t date,
+		int *status)
+{
+  size_t name_max = 0;
+  int xfd;
+  char tempfname[] = "XXXXXX";
+  bool use_mkstemp = true;
+
+  if (oper == oper_print)
+    xfd = STDOUT_FILENO;
+  else
+    {
+      xfd = mkstemp (tempfname);
+      if (unlikely (xfd == -1))
+	{
+	  /* We cannot create a temporary file.  Try to overwrite
+	     the file or create it if it does not exist.  */
+	  int flags = O_WRONLY | O_CREAT;
+	  if (dont_replace_existing)
+	    flags |= O_EXCL;
+	  else
+	    flags |= O_TRUNC;
+	  xfd = open (name, flags, 0600);
+	  if (unlikely (xfd == -1))
+	    {
+	      int printlen = INT_MAX;
+
+	      if (should_truncate_fname (&name_max))
+		{
+		  /* Try to truncate the name.  First find out by how
+		     much.  */
+		  printlen = name_max;
+		  char truncfname[name_max + 1];
+		  *((char *) mempcpy (truncfname, name,
+				      name_max)) = '\0';
+
+		  xfd = open (truncfname, flags, 0600);
+		}
+
+	      if (xfd == -1)
+		{
+		  error (0, errno, _("cannot open %.*s"),
+			 (int) printlen, name);
+		  *status = 1;
+		  return;
+		}
+	    }
+
+	  use_mkstemp = false;
+	}
+    }
+
+#ifdef HAVE_COPY_FILE_RANGE
+  /* Let the kernel copy the content from the archive if it can.  What
+     is left is written from the mapped archive.  */
+  if (oper != oper_print)
+    while (nleft > 0)
+      {
+	ssize_t n = copy_file_range (fd, &off, xfd, NULL, nleft, 0);
+	if (n < 0 && errno == EINTR)
+	  continue;
+	if (n <= 0)
+	  break;
+	nleft -= n;
+	data += n;
+      }
+#endif
+
+  ssize_t n;
+  while ((n = TEMP_FAILURE_RETRY (write (xfd, data, nleft))) != -1)
+    {
+      nleft -= n;
+      if (nleft == 0)
+	break;
+      data += n;
+    }
+
+  if (unlikely (n == -1))
+    {
+      error (0, errno, _("failed to write %s"), name);
+      *status = 1;
+      unlink (tempfname);
+      close (xfd);
+      return;
+    }
+
+  if (oper != oper_print)
+    {
+      /* Fix up the mode.  */
+      if (unlikely (fchmod (xfd, mode) != 0))
+	{
+	  error (0, errno, _("cannot change mode of %s"),
+		 name);
+	  *status = 0;
+	}
+
+      if (preserve_dates)
+	{
+	  struct timespec tv[2];
+	  tv[0].tv_sec = date;
+	  tv[0].tv_nsec = 0;
+	  tv[1].tv_sec = date;
+	  tv[1].tv_nsec = 0;
+
+	  if (unlikely (futimens (xfd, tv) != 0))
+	    {
+	      error (0, errno,
+		     _("cannot change modification time of %s"),
+		     name);
+	      *status = 1;
+	    }
+	}
+
+      /* If we used a temporary file, move it do the right
+	 name now.  */
+      if (use_mkstemp)
+	{
+	  int r;
+
+	  if (dont_replace_existing)
+	    {
+	      r = link (tempfname, name);
+	      if (likely (r == 0))
+		unlink (tempfname);
+	    }
+	  else
+	    r = rename (tempfname, name);
+
+	  if (unlikely (r) != 0)
+	    {
+	      int printlen = INT_MAX;
+
+	      if (should_truncate_fname (&name_max))
+		{
+		  /* Try to truncate the name.  First find out by how
+		     much.  */
+		  printlen = name_max;
+		  char truncfname[name_max + 1];
+		  *((char *) mempcpy (truncfname, name,
+				      name_max)) = '\0';
+
+		  if (dont_replace_existing)
+		    {
+		      r = link (tempfname, truncfname);
+		      if (likely (r == 0))
+			unlink (tempfname);
+		    }
+		  else
+		    r = rename (tempfname, truncfname);
+		}
+
+	      if (r != 0)
+		{
+		  error (0, errno, _("\
+cannot rename temporary file to %.*s"),
+			 printlen, name);
+		  unlink (tempfname);
+		  *status = 1;
+		}
+	    }
+	}
+
+      close (xfd);
+    }
+}
+
+
+/* With several jobs the members to extract are collected and written
+   at the same time.  Members with the same name, possibly truncated,
+   have to be written one after the other, so the last one wins just
+   as without jobs.  */
+struct extract_job
+{
+  char *name;
+  const char *data;
+  size_t size;
+  off_t off;
+  mode_t mode;
+  time_t date;
+  /* The status as set by extract_member, -1 if unchanged.  */
+  int status;
+};
+
+static struct extract_job *extract_jobs;
+static size_t nextract_jobs;
+static size_t maxextract_jobs;
+static int extract_fd;
+static void *extract_names;
+static size_t extract_name_len;
+
+static int
+extract_name_cmp (const void *a, const void *b)
+{
+  return strncmp (a, b, extract_name_len);
+}
+
+static void
+run_extract_job (void *arg __attribute__ ((unused)), size_t i)
+{
+  struct extract_job *job = &extract_jobs[i];
+  extract_member (oper_extract, extract_fd, job->name, job->data, job->size,
+		  job->off, job->mode, job->date, &job->status);
+}
+
+static void
+noop (void *p __attribute__ ((unused)))
+{
+}
+
+static void
+flush_extract (int *status)
+{
+  run_parallel (arlib_jobs, nextract_jobs, run_extract_job, NULL);
+
+  for (size_t i = 0; i < nextract_jobs; ++i)
+    {
+      if (extract_jobs[i].status != -1)
+	*status = extract_jobs[i].status;
+      free (extract_jobs[i].name);
+    }
+  nextract_jobs = 0;
+
+  tdestroy (extract_names, noop);
+  extract_names = NULL;
+}
+
+static void
+queue_extract (int fd, Elf_Arhdr *arhdr, const char *data, size_t size,
+	       off_t off, int *status)
+{
+  if (extract_name_len == 0)
+    {
+      /* Names are only the same as far as they are used.  */
+      long int len = allow_truncate_fname ? pathconf (".", _PC_NAME_MAX) : -1;
+      extract_name_len = len > 0 ? (size_t) len : SIZE_MAX;
+    }
+
+  if (tfind (arhdr->ar_name, &extract_names, extract_name_cmp) != NULL
+      || nextract_jobs == 4 * (size_t) arlib_jobs)
+    flush_extract (status);
+
+  if (nextract_jobs == maxextract_jobs)
+    {
+      maxextract_jobs = 4 * (size_t) arlib_jobs;
+      extract_jobs = xrealloc (extract_jobs,
+			       maxextract_jobs * sizeof *extract_jobs);
+    }
+
+  struct extract_job *job = &extract_jobs[nextract_jobs++];
+  job->name = xstrdup (arhdr->ar_name);
+  job->data = data;
+  job->size = size;
+  job->off = off;
+  job->mode = arhdr->ar_mode;
+  job->date = arhdr->ar_date;
+  job->status = -1;
+  extract_fd = fd;
+  if (tsearch (job->name, &extract_names, extract_name_cmp) == NULL)
+    error_exit (errno, _("cannot insert into hash table"));
+}
+
 static int
 do_oper_extract (int oper, const char *arfname, char **argv, int argc,
 		 long int instance)
@@ -458,7 +730,6 @@ do_oper_extract (int oper, const char *arfname, char **argv, int argc,
   bool found[argc > 0 ? argc : 1];
   memset (found, '\0', sizeof (found));
 
-  size_t name_max = 0;
   off_t index_off = -1;
   size_t index_size = 0;
   off_t cur_off = SARMAG;
@@ -506,7 +777,7 @@ do_oper_extract (int oper, const char *arfname, char **argv, int argc,
 
       if (force_symtab)
 	{
-	  arlib_add_symbols (elf, arfname, arhdr->ar_name, cur_off);
+	  arlib_queue_symbols (NULL, elf, arfname, arhdr->ar_name, cur_off);
 	  cur_off += (((arhdr->ar_size + 1) & ~((off_t) 1))
 		      + sizeof (struct ar_hdr));
 	}
@@ -580,8 +851,19 @@ do_oper_extract (int oper, const char *arfname, char **argv, int argc,
 	      goto next;
 	    }
 
-	  size_t nleft;
-	  char *data = elf_rawfile (subelf, &nleft);
+	  /* The offset in the archive, before elf_rawfile might read the
+	     member on its own and make its offset zero.  */
+	  off_t off = elf_getbase (subelf);
+
+	  /* Queued members are only written once SUBELF is gone.  Its own
+	     copy of the content, if the archive is not mmapped, is gone
+	     then too, so use the content of the archive.  */
+	  bool queue = arlib_jobs > 1 && oper == oper_extract;
+	  size_t nleft = arhdr->ar_size;
+	  char *data = (queue ? elf_rawfile (elf, NULL)
+			: elf_rawfile (subelf, &nleft));
+	  if (data != NULL && queue)
+	    data += off - elf_getbase (elf);
 	  if (data == NULL)
 	    {
 	      error (0, 0, _("cannot read content of %s: %s"),
@@ -590,150 +872,11 @@ do_oper_extract (int oper, const char *arfname, char **argv, int argc,
 	      goto next;
 	    }
 
-	  int xfd;
-	  char tempfname[] = "XXXXXX";
-	  bool use_mkstemp = true;
-
-	  if (oper == oper_print)
-	    xfd = STDOUT_FILENO;
+	  if (queue)
+	    queue_extract (fd, arhdr, data, nleft, off, &status);
 	  else
-	    {
-	      xfd = mkstemp (tempfname);
-	      if (unlikely (xfd == -1))
-		{
-		  /* We cannot create a temporary file.  Try to overwrite
-		     the file or create it if it does not exist.  */
-		  int flags = O_WRONLY | O_CREAT;
-		  if (dont_replace_existing)
-		    flags |= O_EXCL;
-		  else
-		    flags |= O_TRUNC;
-		  xfd = open (arhdr->ar_name, flags, 0600);
-		  if (unlikely (xfd == -1))
-		    {
-		      int printlen = INT_MAX;
-
-		      if (should_truncate_fname (&name_max))
-			{
-			  /* Try to truncate the name.  First find out by how
-			     much.  */
-			  printlen = name_max;
-			  char truncfname[name_max + 1];
-			  *((char *) mempcpy (truncfname, arhdr->ar_name,
-					      name_max)) = '\0';
-
-			  xfd = open (truncfname, flags, 0600);
-			}
-
-		      if (xfd == -1)
-			{
-			  error (0, errno, _("cannot open %.*s"),
-				 (int) printlen, arhdr->ar_name);
-			  status = 1;
-			  goto next;
-			}
-		    }
-
-		  use_mkstemp = false;
-		}
-	    }
-
-	  ssize_t n;
-	  while ((n = TEMP_FAILURE_RETRY (write (xfd, data, nleft))) != -1)
-	    {
-	      nleft -= n;
-	      if (nleft == 0)
-		break;
-	      data += n;
-	    }
-
-	  if (unlikely (n == -1))
-	    {
-	      error (0, errno, _("failed to write %s"), arhdr->ar_name);
-	      status = 1;
-	      unlink (tempfname);
-	      close (xfd);
-	      goto next;
-	    }
-
-	  if (oper != oper_print)
-	    {
-	      /* Fix up the mode.  */
-	      if (unlikely (fchmod (xfd, arhdr->ar_mode) != 0))
-		{
-		  error (0, errno, _("cannot change mode of %s"),
-			 arhdr->ar_name);
-		  status = 0;
-		}
-
-	      if (preserve_dates)
-		{
-		  struct timespec tv[2];
-		  tv[0].tv_sec = arhdr->ar_date;
-		  tv[0].tv_nsec = 0;
-		  tv[1].tv_sec = arhdr->ar_date;
-		  tv[1].tv_nsec = 0;
-
-		  if (unlikely (futimens (xfd, tv) != 0))
-		    {
-		      error (0, errno,
-			     _("cannot change modification time of %s"),
-			     arhdr->ar_name);
-		      status = 1;
-		    }
-		}
-
-	      /* If we used a temporary file, move it do the right
-		 name now.  */
-	      if (use_mkstemp)
-		{
-		  int r;
-
-		  if (dont_replace_existing)
-		    {
-		      r = link (tempfname, arhdr->ar_name);
-		      if (likely (r == 0))
-			unlink (tempfname);
-		    }
-		  else
-		    r = rename (tempfname, arhdr->ar_name);
-
-		  if (unlikely (r) != 0)
-		    {
-		      int printlen = INT_MAX;
-
-		      if (should_truncate_fname (&name_max))
-			{
-			  /* Try to truncate the name.  First find out by how
-			     much.  */
-			  printlen = name_max;
-			  char truncfname[name_max + 1];
-			  *((char *) mempcpy (truncfname, arhdr->ar_name,
-					      name_max)) = '\0';
-
-			  if (dont_replace_existing)
-			    {
-			      r = link (tempfname, truncfname);
-			      if (likely (r == 0))
-				unlink (tempfname);
-			    }
-			  else
-			    r = rename (tempfname, truncfname);
-			}
-
-		      if (r != 0)
-			{
-			  error (0, errno, _("\
-cannot rename temporary file to %.*s"),
-				 printlen, arhdr->ar_name);
-			  unlink (tempfname);
-			  status = 1;
-			}
-		    }
-		}
-
-	      close (xfd);
-	    }
+	    extract_member (oper, fd, arhdr->ar_name, data, nleft, off,
+			    arhdr->ar_mode, arhdr->ar_date, &status);
 	}
 
     next:
@@ -742,6 +885,9 @@ cannot rename temporary file to %.*s"),
 	error (1, 0, "%s: %s", arfname, elf_errmsg (-1));
     }
 
+  if (nextract_jobs > 0)
+    flush_extract (&status);
+
   hdestroy ();
 
   if (force_symtab)
@@ -980,7 +1126,8 @@ do_oper_delete (const char *arfname, char **argv, int argc,
 
 	  /* If we recreate the symbol table read the file's symbol
 	     table now.  */
-	  arlib_add_symbols (subelf, arfname, arhdr->ar_name, newp->off);
+	  arlib_queue_symbols (elf, subelf, arfname, arhdr->ar_name,
+			       newp->off);
 
 	  /* Remember long file names.  */
 	  remember_long_name (newp, arhdr->ar_name, strlen (arhdr->ar_name));
@@ -1372,12 +1519,13 @@ do_oper_insert (int oper, const char *arfname, char **argv, int argc,
 		 archive content.  But who knows...  */
 	      error_exit (0, "%s: %s", arfname, elf_errmsg (-1));
 
-	    arlib_add_symbols (subelf, arfname, arhdr->ar_name, cur_off);
+	    arlib_queue_symbols (elf, subelf, arfname, arhdr->ar_name,
+				 cur_off);
 
 	    elf_end (subelf);
 	  }
 	else
-	  arlib_add_symbols (memp->elf, arfname, memp->name, cur_off);
+	  arlib_queue_symbols (NULL, memp->elf, arfname, memp->name, cur_off);
 
 	cur_off += (((memp->size + 1) & ~((off_t) 1))
 		    + sizeof (struct ar_hdr));
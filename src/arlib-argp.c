@@ -20,24 +20,31 @@
 #endif
 
 #include <argp.h>
+#include <errno.h>
+
+#include <parallel.h>
 
 #include "arlib.h"
 
 bool arlib_deterministic_output = DEFAULT_AR_DETERMINISTIC;
 
+unsigned int arlib_jobs = 1;
+
 static const struct argp_option options[] =
   {
     { NULL, 'D', NULL, 0,
       N_("Use zero for uid, gid, and date in archive members."), 0 },
     { NULL, 'U', NULL, 0,
       N_("Use actual uid, gid, and date in archive members."), 0 },
+    { "jobs", 'j', "N", 0,
+      N_("Read or extract up to N archive members at the same time, "
+	 "or one per CPU if N is 0."), 0 },
 
     { NULL, 0, NULL, 0, NULL, 0 }
   };
 
 static error_t
-parse_opt (int key, char *arg __attribute__ ((unused)),
-           struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -49,6 +56,15 @@ parse_opt (int key, char *arg __attribute__ ((unused)),
       arlib_deterministic_output = false;
       break;
 
+    case 'j':
+      arlib_jobs = parse_jobs (arg);
+      if (arlib_jobs == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -28,6 +28,7 @@
 #include <time.h>
 
 #include <libeu.h>
+#include <parallel.h>
 
 #include "system.h"
 #include "arlib.h"
@@ -103,10 +104,16 @@ arlib_init (void)
 }
 
 
+static void flush_symbols (void);
+
+
 /* Finalize ARLIB_SYMTAB content.  */
 void
 arlib_finalize (void)
 {
+  /* Add what is still waiting to be read.  */
+  flush_symbols ();
+
   /* Note that the size is stored as decimal string in 10 chars,
      without zero terminator (we add + 1 here only so snprintf can
      put it at the end, we then don't use it when we memcpy it).  */
@@ -202,16 +209,12 @@ arlib_add_symref (const char *symname, off_t symoff)
 }
 
 
-/* Add symbols from ELF with value OFFSET to the symbol table SYMTAB.  */
-void
-arlib_add_symbols (Elf *elf, const char *arfname, const char *membername,
-		   off_t off)
+/* Call ADD with ARG for the name of every symbol ELF defines which
+   goes into the archive symbol table.  */
+static void
+read_symbols (Elf *elf, const char *arfname, const char *membername,
+	      void (*add) (void *arg, const char *symname), void *arg)
 {
-  if (sizeof (off) > sizeof (uint32_t) && off > ~((uint32_t) 0))
-    /* The archive is too big.  */
-    error_exit (0, _("the archive '%s' is too large"),
-		arfname);
-
   /* We only add symbol tables for ELF files.  It makes not much sense
      to add symbols from executables but we do so for compatibility.
      For DSOs and executables we use the dynamic symbol table, for
@@ -269,7 +272,7 @@ arlib_add_symbols (Elf *elf, const char *arfname, const char *membername,
 	  /* Use this symbol.  */
 	  const char *symname = elf_strptr (elf, shdr->sh_link, sym->st_name);
 	  if (symname != NULL)
-	    arlib_add_symref (symname, off);
+	    add (arg, symname);
 	}
 
       /* Only relocatable files can have more than one symbol table.  */
@@ -277,3 +280,140 @@ arlib_add_symbols (Elf *elf, const char *arfname, const char *membername,
 	break;
     }
 }
+
+
+static void
+check_offset (const char *arfname, off_t off)
+{
+  if (sizeof (off) > sizeof (uint32_t) && off > ~((uint32_t) 0))
+    /* The archive is too big.  */
+    error_exit (0, _("the archive '%s' is too large"),
+		arfname);
+}
+
+
+static void
+add_symref (void *arg, const char *symname)
+{
+  arlib_add_symref (symname, *(off_t *) arg);
+}
+
+
+/* Add symbols from ELF with value OFFSET to the symbol table SYMTAB.  */
+void
+arlib_add_symbols (Elf *elf, const char *arfname, const char *membername,
+		   off_t off)
+{
+  check_offset (arfname, off);
+  read_symbols (elf, arfname, membername, add_symref, &off);
+}
+
+
+/* Members whose symbols are read on several threads, each from its
+   own descriptor for the member's bytes.  Each collects the names of
+   its symbols, which are added to the table in order once all of the
+   queue is read.  */
+struct queued_member
+{
+  char *image;
+  size_t size;
+  const char *arfname;
+  char *membername;
+  off_t off;
+  struct obstack names;
+  size_t nnames;
+};
+
+#define QUEUE_SIZE 1024
+static struct queued_member *queue;
+static size_t nqueue;
+
+
+static void
+collect_symname (void *arg, const char *symname)
+{
+  struct queued_member *m = arg;
+  obstack_grow (&m->names, symname, strlen (symname) + 1);
+  ++m->nnames;
+}
+
+
+static void
+read_queued (void *arg __attribute__ ((unused)), size_t i)
+{
+  struct queued_member *m = &queue[i];
+  Elf *elf = elf_memory (m->image, m->size);
+  read_symbols (elf, m->arfname, m->membername, collect_symname, m);
+  elf_end (elf);
+}
+
+
+static void
+flush_symbols (void)
+{
+  if (nqueue == 0)
+    return;
+
+  run_parallel (arlib_jobs, nqueue, read_queued, NULL);
+
+  for (size_t i = 0; i < nqueue; ++i)
+    {
+      struct queued_member *m = &queue[i];
+      const char *symname = obstack_finish (&m->names);
+      for (size_t n = 0; n < m->nnames; ++n)
+	{
+	  arlib_add_symref (symname, m->off);
+	  symname = rawmemchr (symname, '\0') + 1;
+	}
+      obstack_free (&m->names, NULL);
+      free (m->membername);
+    }
+  nqueue = 0;
+}
+
+
+/* Like arlib_add_symbols, but maybe later and on another thread.  */
+void
+arlib_queue_symbols (Elf *arelf, Elf *elf, const char *arfname,
+		     const char *membername, off_t off)
+{
+  if (arlib_jobs == 1)
+    {
+      arlib_add_symbols (elf, arfname, membername, off);
+      return;
+    }
+
+  check_offset (arfname, off);
+  if (elf_kind (elf) != ELF_K_ELF)
+    return;
+
+  if (queue == NULL)
+    queue = xmalloc (QUEUE_SIZE * sizeof *queue);
+  else if (nqueue == QUEUE_SIZE)
+    flush_symbols ();
+
+  /* The content of a member is only that of the archive if the archive
+     is mmapped.  Otherwise the member has its own copy, which is gone
+     with the member, so read the archive's content.  The member name
+     might not stay around either.  */
+  struct queued_member *m = &queue[nqueue++];
+  if (arelf == NULL)
+    m->image = elf_rawfile (elf, &m->size);
+  else
+    {
+      Elf_Arhdr *arhdr = elf_getarhdr (elf);
+      m->image = arhdr != NULL ? elf_rawfile (arelf, NULL) : NULL;
+      if (m->image != NULL)
+	{
+	  m->image += elf_getbase (elf) - elf_getbase (arelf);
+	  m->size = arhdr->ar_size;
+	}
+    }
+  if (m->image == NULL)
+    error_exit (0, "%s(%s): %s", arfname, membername, elf_errmsg (-1));
+  m->arfname = arfname;
+  m->membername = xstrdup (membername);
+  m->off = off;
+  obstack_init (&m->names);
+  m->nnames = 0;
+}
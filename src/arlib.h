@@ -33,6 +33,9 @@
 /* State of -D/-U flags.  */
 extern bool arlib_deterministic_output;
 
+/* Number of archive members to handle at the same time, from -j.  */
+extern unsigned int arlib_jobs;
+
 /* For options common to ar and ranlib.  */
 extern const struct argp_child arlib_argp_children[];
 
@@ -88,6 +91,16 @@ extern void arlib_fini (void);
 extern void arlib_add_symbols (Elf *elf, const char *arfname,
 			       const char *membername, off_t off);
 
+/* Like arlib_add_symbols, but with more than one job the symbols might
+   only be read later on another thread, at the latest by arlib_finalize.
+   ARELF is the archive ELF is a member of, or NULL if ELF is a file of
+   its own.  The symbols are read from the content of ARELF, or else of
+   ELF, which must be kept until then.  ELF itself can be ended right
+   away.  The symbols are added in the order of the calls, so the symbol
+   table is the same.  */
+extern void arlib_queue_symbols (Elf *arelf, Elf *elf, const char *arfname,
+				 const char *membername, off_t off);
+
 /* Add name a file offset of a symbol.  */
 extern void arlib_add_symref (const char *symname, off_t symoff);
 
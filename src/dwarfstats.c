@@ -0,0 +1,874 @@
+/* Print statistics about the DWARF debug information of ELF files.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <argp.h>
+#include <dwarf.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <locale.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include ELFUTILS_HEADER(dw)
+#include ELFUTILS_HEADER(dwelf)
+#include <libeu.h>
+#include <parallel.h>
+#include <system.h>
+#include <printversion.h>
+
+#include "../libdw/known-dwarf.h"
+
+
+/* Name and version of program.  */
+ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
+
+/* Bug report address.  */
+ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
+
+/* Definitions of arguments for argp functions.  */
+static const struct argp_option options[] =
+{
+  { NULL, 0, NULL, 0, N_("Output selection:"), 0 },
+  { "summary", 's', NULL, 0,
+    N_("Only print the totals, not the tag, attribute and form counts"), 0 },
+  { "verbose", 'v', NULL, 0,
+    N_("Print a message for each malformed construct found"), 0 },
+
+  { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Scan N units at the same time, or one per CPU if N is 0"), 0 },
+  { NULL, 0, NULL, 0, NULL, 0 }
+};
+
+/* Short description of program.  */
+static const char doc[] = N_("\
+Print statistics about the DWARF debug information in FILEs.\n\
+\n\
+For each file the number of units, DIEs and attributes is printed, how\n\
+many DIEs have each tag and how many attributes each name and form, the\n\
+size of the line tables and how much of the code the locations of local\n\
+variables and parameters cover.  Malformed constructs are counted and\n\
+the exit status is 1 if any were found.");
+
+/* Strings for arguments in help texts.  */
+static const char args_doc[] = N_("FILE...");
+
+/* Prototype for option handler.  */
+static error_t parse_opt (int key, char *arg, struct argp_state *state);
+
+/* Data structure to communicate with argp functions.  */
+static struct argp argp =
+{
+  options, parse_opt, args_doc, doc, NULL, NULL, NULL
+};
+
+
+/* True if only the totals are printed.  */
+static bool summary;
+
+/* True if each malformed construct is reported.  */
+static bool verbose;
+
+/* Number of units scanned at the same time.  */
+static unsigned int nthreads = 1;
+
+
+/* Counts of tags, attribute names or forms.  The standard ones are
+   counted directly, vendor extensions are kept in a short list.  */
+#define NDIRECT 0x100
+struct histogram
+{
+  size_t direct[NDIRECT];
+  struct code_count
+  {
+    unsigned int code;
+    size_t count;
+  } *other;
+  size_t nother;
+  size_t maxother;
+};
+
+/* Statistics of a file, or of the units one thread scanned.  */
+struct stats
+{
+  size_t units;
+  size_t dies;
+  size_t attributes;
+  struct histogram tags;
+  struct histogram names;
+  struct histogram forms;
+
+  /* Variables and parameters in code with known address ranges.  */
+  size_t vars;
+  size_t vars_with_loc;
+  size_t vars_with_loclist;
+  uint64_t scope_bytes;
+  uint64_t covered_bytes;
+
+  size_t line_tables;
+  size_t lines;
+  size_t files;
+
+  size_t errors;
+};
+
+/* A unit to scan, with its split unit if it is a skeleton.  */
+struct unit
+{
+  Dwarf_Die cudie;
+  Dwarf_Die subdie;
+  bool has_split;
+
+  /* A split unit read without its skeleton has no addresses.  */
+  bool no_addrs;
+
+  /* Messages about malformed constructs, for -v.  */
+  char **messages;
+  size_t nmessages;
+};
+
+/* The statistics of the current file, threads add theirs when done.  */
+static struct stats file_stats;
+static pthread_mutex_t file_stats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static void
+histogram_add (struct histogram *h, unsigned int code, size_t count)
+{
+  if (code < NDIRECT)
+    {
+      h->direct[code] += count;
+      return;
+    }
+
+  for (size_t i = 0; i < h->nother; ++i)
+    if (h->other[i].code == code)
+      {
+	h->other[i].count += count;
+	return;
+      }
+
+  if (h->nother == h->maxother)
+    {
+      h->maxother = 2 * h->maxother + 8;
+      h->other = xrealloc (h->other, h->maxother * sizeof h->other[0]);
+    }
+  h->other[h->nother].code = code;
+  h->other[h->nother].count = count;
+  ++h->nother;
+}
+
+static void
+histogram_merge (struct histogram *to, const struct histogram *from)
+{
+  for (unsigned int code = 0; code < NDIRECT; ++code)
+    to->direct[code] += from->direct[code];
+  for (size_t i = 0; i < from->nother; ++i)
+    histogram_add (to, from->other[i].code, from->other[i].count);
+}
+
+static void
+histogram_free (struct histogram *h)
+{
+  free (h->other);
+}
+
+static int
+code_count_compare (const void *p1, const void *p2)
+{
+  const struct code_count *c1 = p1;
+  const struct code_count *c2 = p2;
+
+  /* Most frequent first, equal counts in code order.  */
+  if (c1->count != c2->count)
+    return c1->count < c2->count ? 1 : -1;
+  if (c1->code != c2->code)
+    return c1->code < c2->code ? -1 : 1;
+  return 0;
+}
+
+static void
+histogram_print (const struct histogram *h, const char *title,
+		 const char *(*name) (unsigned int), const char *prefix)
+{
+  struct code_count *all = xmalloc ((NDIRECT + h->nother) * sizeof *all);
+  size_t n = 0;
+  for (unsigned int code = 0; code < NDIRECT; ++code)
+    if (h->direct[code] != 0)
+      {
+	all[n].code = code;
+	all[n++].count = h->direct[code];
+      }
+  memcpy (&all[n], h->other, h->nother * sizeof *all);
+  n += h->nother;
+  qsort (all, n, sizeof *all, code_count_compare);
+
+  printf ("  %s:\n", title);
+  for (size_t i = 0; i < n; ++i)
+    {
+      const char *s = name (all[i].code);
+      if (s != NULL)
+	printf ("    %s%-*s %10zu\n", prefix, (int) (36 - strlen (prefix)), s,
+		all[i].count);
+      else
+	printf ("    %#-36x %10zu\n", all[i].code, all[i].count);
+    }
+  free (all);
+}
+
+static void
+stats_merge (struct stats *to, const struct stats *from)
+{
+  to->units += from->units;
+  to->dies += from->dies;
+  to->attributes += from->attributes;
+  histogram_merge (&to->tags, &from->tags);
+  histogram_merge (&to->names, &from->names);
+  histogram_merge (&to->forms, &from->forms);
+  to->vars += from->vars;
+  to->vars_with_loc += from->vars_with_loc;
+  to->vars_with_loclist += from->vars_with_loclist;
+  to->scope_bytes += from->scope_bytes;
+  to->covered_bytes += from->covered_bytes;
+  to->line_tables += from->line_tables;
+  to->lines += from->lines;
+  to->files += from->files;
+  to->errors += from->errors;
+}
+
+static void
+stats_free (struct stats *stats)
+{
+  histogram_free (&stats->tags);
+  histogram_free (&stats->names);
+  histogram_free (&stats->forms);
+}
+
+
+static const char *
+dwarf_tag_string (unsigned int tag)
+{
+  switch (tag)
+    {
+#define DWARF_ONE_KNOWN_DW_TAG(NAME, CODE) case CODE: return #NAME;
+      DWARF_ALL_KNOWN_DW_TAG
+#undef DWARF_ONE_KNOWN_DW_TAG
+    default:
+      return NULL;
+    }
+}
+
+static const char *
+dwarf_attr_string (unsigned int attrnum)
+{
+  switch (attrnum)
+    {
+#define DWARF_ONE_KNOWN_DW_AT(NAME, CODE) case CODE: return #NAME;
+      DWARF_ALL_KNOWN_DW_AT
+#undef DWARF_ONE_KNOWN_DW_AT
+    default:
+      return NULL;
+    }
+}
+
+static const char *
+dwarf_form_string (unsigned int form)
+{
+  switch (form)
+    {
+#define DWARF_ONE_KNOWN_DW_FORM(NAME, CODE) case CODE: return #NAME;
+      DWARF_ALL_KNOWN_DW_FORM
+#undef DWARF_ONE_KNOWN_DW_FORM
+    default:
+      return NULL;
+    }
+}
+
+
+/* State while walking the DIEs of a unit.  */
+struct walk
+{
+  struct unit *unit;
+  struct stats *stats;
+  Dwarf_Die *die;
+
+  /* Address ranges of the innermost scope with code, if any.  */
+  const Dwarf_Range *scope;
+  size_t nscope;
+};
+
+/* Count a malformed construct in DIE, remember a message for -v.  */
+static void
+__attribute__ ((format (printf, 4, 5)))
+issue (struct unit *unit, struct stats *stats, Dwarf_Die *die,
+       const char *fmt, ...)
+{
+  ++stats->errors;
+  if (!verbose)
+    return;
+
+  va_list ap;
+  va_start (ap, fmt);
+  char *msg;
+  if (vasprintf (&msg, fmt, ap) < 0)
+    msg = NULL;
+  va_end (ap);
+
+  char *line;
+  if (asprintf (&line, "[%" PRIx64 "] %s", dwarf_dieoffset (die),
+		msg ?: dwarf_errmsg (-1)) < 0)
+    error_exit (errno, _("memory exhausted"));
+  free (msg);
+
+  unit->messages = xrealloc (unit->messages,
+			     (unit->nmessages + 1) * sizeof (char *));
+  unit->messages[unit->nmessages++] = line;
+}
+
+static const char *
+attr_name (unsigned int name)
+{
+  return dwarf_attr_string (name) ?: "<unknown>";
+}
+
+/* Whether the location attribute is a single expression rather than a
+   location list.  Older producers used block forms for those.  */
+static bool
+single_location (Dwarf_Attribute *attr)
+{
+  switch (dwarf_whatform (attr))
+    {
+    case DW_FORM_exprloc:
+    case DW_FORM_block:
+    case DW_FORM_block1:
+    case DW_FORM_block2:
+    case DW_FORM_block4:
+      return true;
+    default:
+      return false;
+    }
+}
+
+static int
+attr_callback (Dwarf_Attribute *attr, void *arg)
+{
+  struct walk *w = arg;
+  unsigned int name = dwarf_whatattr (attr);
+  unsigned int form = dwarf_whatform (attr);
+
+  ++w->stats->attributes;
+  histogram_add (&w->stats->names, name, 1);
+  histogram_add (&w->stats->forms, form, 1);
+
+  /* Check that the values which point somewhere can be read.  */
+  switch (form)
+    {
+    case DW_FORM_string:
+    case DW_FORM_strp:
+    case DW_FORM_line_strp:
+    case DW_FORM_strx:
+    case DW_FORM_strx1:
+    case DW_FORM_strx2:
+    case DW_FORM_strx3:
+    case DW_FORM_strx4:
+    case DW_FORM_GNU_str_index:
+    case DW_FORM_GNU_strp_alt:
+    case DW_FORM_strp_sup:
+      if (dwarf_formstring (attr) == NULL)
+	issue (w->unit, w->stats, w->die,
+	       "DW_AT_%s: %s", attr_name (name), dwarf_errmsg (-1));
+      break;
+
+    case DW_FORM_ref1:
+    case DW_FORM_ref2:
+    case DW_FORM_ref4:
+    case DW_FORM_ref8:
+    case DW_FORM_ref_udata:
+    case DW_FORM_ref_addr:
+    case DW_FORM_ref_sig8:
+    case DW_FORM_GNU_ref_alt:
+    case DW_FORM_ref_sup4:
+    case DW_FORM_ref_sup8:
+      {
+	Dwarf_Die ref;
+	if (dwarf_formref_die (attr, &ref) == NULL)
+	  {
+	    if (form == DW_FORM_ref_sig8)
+	      issue (w->unit, w->stats, w->die,
+		     "DW_AT_%s: type unit not found", attr_name (name));
+	    else
+	      issue (w->unit, w->stats, w->die,
+		     "DW_AT_%s: %s", attr_name (name), dwarf_errmsg (-1));
+	  }
+	else if (dwarf_tag (&ref) == DW_TAG_invalid)
+	  issue (w->unit, w->stats, w->die,
+		 "DW_AT_%s: invalid DIE at [%" PRIx64 "]", attr_name (name),
+		 dwarf_dieoffset (&ref));
+      }
+      break;
+
+    case DW_FORM_addr:
+    case DW_FORM_addrx:
+    case DW_FORM_addrx1:
+    case DW_FORM_addrx2:
+    case DW_FORM_addrx3:
+    case DW_FORM_addrx4:
+    case DW_FORM_GNU_addr_index:
+      {
+	Dwarf_Addr addr;
+	if (!w->unit->no_addrs && dwarf_formaddr (attr, &addr) != 0)
+	  issue (w->unit, w->stats, w->die,
+		 "DW_AT_%s: %s", attr_name (name), dwarf_errmsg (-1));
+      }
+      break;
+    }
+
+  /* Walk all location lists to see whether they can be decoded.  */
+  if ((name == DW_AT_location || name == DW_AT_frame_base)
+      && !w->unit->no_addrs)
+    {
+      Dwarf_Addr base, start, end;
+      Dwarf_Op *expr;
+      size_t exprlen;
+      ptrdiff_t off = 0;
+      if (single_location (attr))
+	off = dwarf_getlocation (attr, &expr, &exprlen);
+      else
+	while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+					  &expr, &exprlen)) > 0)
+	  ;
+      if (off < 0)
+	issue (w->unit, w->stats, w->die,
+	       "DW_AT_%s: %s", attr_name (name), dwarf_errmsg (-1));
+    }
+
+  return DWARF_CB_OK;
+}
+
+/* Bytes of the current scope that [START, END) covers.  */
+static uint64_t
+scope_overlap (struct walk *w, Dwarf_Addr start, Dwarf_Addr end)
+{
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < w->nscope; ++i)
+    {
+      Dwarf_Addr s = MAX (start, w->scope[i].start);
+      Dwarf_Addr e = MIN (end, w->scope[i].end);
+      if (s < e)
+	bytes += e - s;
+    }
+  return bytes;
+}
+
+/* Count how much of its scope the location of a variable or parameter
+   covers.  */
+static void
+scan_variable (struct walk *w, Dwarf_Die *die)
+{
+  if (w->nscope == 0 || dwarf_hasattr (die, DW_AT_declaration))
+    return;
+
+  uint64_t scope_bytes = scope_overlap (w, 0, (Dwarf_Addr) -1);
+  uint64_t covered = 0;
+  ++w->stats->vars;
+  w->stats->scope_bytes += scope_bytes;
+
+  Dwarf_Attribute attr_mem;
+  Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_location, &attr_mem);
+  if (attr != NULL)
+    {
+      ++w->stats->vars_with_loc;
+      if (single_location (attr))
+	covered = scope_bytes;
+      else
+	{
+	  ++w->stats->vars_with_loclist;
+
+	  Dwarf_Addr base, start, end;
+	  Dwarf_Op *expr;
+	  size_t exprlen;
+	  ptrdiff_t off = 0;
+	  while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+					    &expr, &exprlen)) > 0)
+	    if (exprlen > 0)
+	      covered += scope_overlap (w, start, end);
+	}
+    }
+  else if (dwarf_hasattr (die, DW_AT_const_value))
+    {
+      ++w->stats->vars_with_loc;
+      covered = scope_bytes;
+    }
+
+  /* Entries of a location list might overlap.  */
+  w->stats->covered_bytes += MIN (covered, scope_bytes);
+}
+
+static void
+scan_dies (struct walk *w, Dwarf_Die *die)
+{
+  int res;
+  do
+    {
+      int tag = dwarf_tag (die);
+      if (tag == DW_TAG_invalid)
+	{
+	  issue (w->unit, w->stats, die, "%s", dwarf_errmsg (-1));
+	  return;
+	}
+
+      ++w->stats->dies;
+      histogram_add (&w->stats->tags, tag, 1);
+      w->die = die;
+      if (dwarf_getattrs (die, attr_callback, w, 0) < 0)
+	issue (w->unit, w->stats, die, "%s", dwarf_errmsg (-1));
+
+      if (tag == DW_TAG_variable || tag == DW_TAG_formal_parameter)
+	scan_variable (w, die);
+
+      /* Functions and inlined functions start a new scope, which has
+	 no code when they are abstract.  Lexical blocks without code
+	 are part of the scope around them.  Variables directly in the
+	 unit are not in any scope.  */
+      const Dwarf_Range *scope = w->scope;
+      size_t nscope = w->nscope;
+      if (tag == DW_TAG_compile_unit
+	  || tag == DW_TAG_partial_unit
+	  || tag == DW_TAG_subprogram
+	  || tag == DW_TAG_inlined_subroutine
+	  || tag == DW_TAG_lexical_block)
+	{
+	  const Dwarf_Range *ranges = NULL;
+	  size_t nranges = 0;
+	  if (!w->unit->no_addrs
+	      && dwarf_getranges (die, &ranges, &nranges) != 0)
+	    {
+	      issue (w->unit, w->stats, die, "ranges: %s", dwarf_errmsg (-1));
+	      nranges = 0;
+	    }
+	  if (tag == DW_TAG_compile_unit || tag == DW_TAG_partial_unit)
+	    w->nscope = 0;
+	  else if (nranges > 0 || tag != DW_TAG_lexical_block)
+	    {
+	      w->scope = ranges;
+	      w->nscope = nranges;
+	    }
+	}
+
+      Dwarf_Die child;
+      res = dwarf_child (die, &child);
+      if (res == 0)
+	scan_dies (w, &child);
+      else if (res < 0)
+	issue (w->unit, w->stats, die, "%s", dwarf_errmsg (-1));
+
+      w->scope = scope;
+      w->nscope = nscope;
+    }
+  while ((res = dwarf_siblingof (die, die)) == 0);
+
+  if (res < 0)
+    issue (w->unit, w->stats, die, "%s", dwarf_errmsg (-1));
+}
+
+/* Scan unit number I and its split unit.  Different units can be
+   scanned at the same time, everything shared by them has been read
+   by process_file already.  */
+static void
+scan_unit (void *arg, size_t i)
+{
+  struct unit *unit = &((struct unit *) arg)[i];
+  struct stats *stats = xcalloc (1, sizeof *stats);
+  struct walk w = { .unit = unit, .stats = stats };
+
+  ++stats->units;
+  scan_dies (&w, &unit->cudie);
+  if (unit->has_split)
+    {
+      ++stats->units;
+      scan_dies (&w, &unit->subdie);
+    }
+
+  pthread_mutex_lock (&file_stats_lock);
+  stats_merge (&file_stats, stats);
+  pthread_mutex_unlock (&file_stats_lock);
+
+  stats_free (stats);
+  free (stats);
+}
+
+/* Line tables are shared between units, so they are read before the
+   units are scanned in parallel.  */
+static void
+read_lines (struct unit *unit, Dwarf_Die *cudie, bool split)
+{
+  /* The line tables dwz makes for partial units only name files, in a
+     form dwarf_getsrcfiles doesn't read.  */
+  if (!dwarf_hasattr (cudie, DW_AT_stmt_list)
+      || dwarf_tag (cudie) == DW_TAG_partial_unit)
+    return;
+
+  /* Split units only have a file table.  */
+  Dwarf_Files *files;
+  size_t nfiles;
+  Dwarf_Lines *lines;
+  size_t nlines = 0;
+  if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0
+      || (!split && dwarf_getsrclines (cudie, &lines, &nlines) != 0))
+    {
+      issue (unit, &file_stats, cudie, "line table: %s", dwarf_errmsg (-1));
+      return;
+    }
+
+  ++file_stats.line_tables;
+  file_stats.lines += nlines;
+  file_stats.files += nfiles;
+}
+
+/* Abbreviations are read on demand into their unit.  A reference to a
+   DIE in another unit, or a type unit, reads the abbreviations of that
+   unit, which might be scanned by another thread at the same time.  So
+   all of them are read before the units are scanned in parallel.  */
+static void
+read_abbrevs (Dwarf_Die *cudie)
+{
+  Dwarf_Off offset = 0;
+  size_t length;
+  Dwarf_Abbrev *abbrev;
+  while ((abbrev = dwarf_getabbrev (cudie, offset, &length)) != NULL
+	 && abbrev != DWARF_END_ABBREV)
+    offset += length;
+}
+
+/* Likewise for all units of the file of a split unit, which a type
+   unit signature can refer to.  This also reads the type units in,
+   instead of each thread looking for them.  */
+static void
+read_split_abbrevs (Dwarf *split)
+{
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie;
+  while (dwarf_get_units (split, cu, &cu, NULL, NULL, &cudie, NULL) == 0)
+    read_abbrevs (&cudie);
+}
+
+static void
+print_stats (const char *fname, struct stats *stats)
+{
+  printf (_("%s: %zu units, %zu DIEs, %zu attributes\n"),
+	  fname, stats->units, stats->dies, stats->attributes);
+  printf (_("  line tables: %zu, %zu rows, %zu files\n"),
+	  stats->line_tables, stats->lines, stats->files);
+  printf (_("  variables and parameters in code: %zu, %zu with location,"
+	    " %zu location lists\n"),
+	  stats->vars, stats->vars_with_loc, stats->vars_with_loclist);
+  if (stats->scope_bytes > 0)
+    printf (_("  location coverage: %" PRIu64 " of %" PRIu64
+	      " bytes (%.1f%%)\n"),
+	    stats->covered_bytes, stats->scope_bytes,
+	    100.0 * stats->covered_bytes / stats->scope_bytes);
+  printf (_("  malformed: %zu\n"), stats->errors);
+
+  if (!summary)
+    {
+      histogram_print (&stats->tags, _("tags"), dwarf_tag_string, "DW_TAG_");
+      histogram_print (&stats->names, _("attributes"), dwarf_attr_string,
+		       "DW_AT_");
+      histogram_print (&stats->forms, _("forms"), dwarf_form_string,
+		       "DW_FORM_");
+    }
+}
+
+static int
+process_file (const char *fname)
+{
+  int fd = open (fname, O_RDONLY);
+  if (fd == -1)
+    {
+      error (0, errno, _("cannot open '%s'"), fname);
+      return 1;
+    }
+
+  Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+  if (dbg == NULL)
+    {
+      error (0, 0, _("cannot get debug information for '%s': %s"),
+	     fname, dwarf_errmsg (-1));
+      close (fd);
+      return 1;
+    }
+
+  /* The alternate file is only opened on demand, which cannot be done
+     by several threads at once.  */
+  const char *altname;
+  const void *altid;
+  unsigned int jobs = nthreads;
+  if (dwelf_dwarf_gnu_debugaltlink (dbg, &altname, &altid) != 0)
+    jobs = 1;
+
+  /* Open the dwo files of all skeleton units now, so reading the units
+     doesn't look them up one by one.  */
+  dwarf_find_split_units (dbg, jobs);
+
+  memset (&file_stats, 0, sizeof file_stats);
+  struct unit *units = NULL;
+  size_t nunits = 0;
+  size_t maxunits = 0;
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie, subdie;
+  uint8_t unit_type;
+  Dwarf *last_split = NULL;
+  int res;
+  while ((res = dwarf_get_units (dbg, cu, &cu, NULL, &unit_type,
+				 &cudie, &subdie)) == 0)
+    {
+      if (nunits == maxunits)
+	{
+	  maxunits = 2 * maxunits + 16;
+	  units = xrealloc (units, maxunits * sizeof units[0]);
+	}
+      struct unit *unit = &units[nunits++];
+      unit->cudie = cudie;
+      unit->subdie = subdie;
+      unit->has_split = (unit_type == DW_UT_skeleton
+			 && dwarf_tag (&subdie) != DW_TAG_invalid);
+      unit->no_addrs = (unit_type == DW_UT_split_compile
+			|| unit_type == DW_UT_split_type);
+      unit->messages = NULL;
+      unit->nmessages = 0;
+
+      if (!unit->no_addrs)
+	read_lines (unit, &unit->cudie, false);
+      if (unit->has_split)
+	read_lines (unit, &unit->subdie, true);
+
+      read_abbrevs (&unit->cudie);
+      /* The split units of a DWARF package file share one Dwarf.  */
+      if (unit->has_split && dwarf_cu_getdwarf (subdie.cu) != last_split)
+	{
+	  last_split = dwarf_cu_getdwarf (subdie.cu);
+	  read_split_abbrevs (last_split);
+	}
+    }
+  /* A file with only a line table or call frame information has no
+     units at all, which is fine.  */
+  Dwarf_Off next_off;
+  size_t header_size;
+  if (res < 0 && nunits == 0
+      && dwarf_nextcu (dbg, 0, &next_off, &header_size,
+		       NULL, NULL, NULL) == 1)
+    res = 1;
+  if (res < 0)
+    {
+      ++file_stats.errors;
+      if (verbose)
+	error (0, 0, _("%s: cannot read unit: %s"), fname, dwarf_errmsg (-1));
+    }
+
+  run_parallel (jobs, nunits, scan_unit, units);
+
+  /* The messages in unit order, so they don't depend on -j.  */
+  for (size_t i = 0; i < nunits; ++i)
+    {
+      for (size_t j = 0; j < units[i].nmessages; ++j)
+	{
+	  printf ("%s: %s\n", fname, units[i].messages[j]);
+	  free (units[i].messages[j]);
+	}
+      free (units[i].messages);
+    }
+  free (units);
+
+  print_stats (fname, &file_stats);
+  int result = file_stats.errors != 0;
+  stats_free (&file_stats);
+
+  dwarf_end (dbg);
+  close (fd);
+  return result;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  /* Set locale.  */
+  (void) setlocale (LC_ALL, "");
+
+  /* Make sure the message catalog can be found.  */
+  (void) bindtextdomain (PACKAGE_TARNAME, LOCALEDIR);
+
+  /* Initialize the message catalog.  */
+  (void) textdomain (PACKAGE_TARNAME);
+
+  /* Parse and process arguments.  */
+  int remaining;
+  (void) argp_parse (&argp, argc, argv, 0, &remaining, NULL);
+
+  if (remaining == argc)
+    {
+      error (0, 0, _("missing file name"));
+      argp_help (&argp, stderr, ARGP_HELP_SEE, program_invocation_short_name);
+      return 1;
+    }
+
+  int result = 0;
+  do
+    result |= process_file (argv[remaining]);
+  while (++remaining < argc);
+
+  return result;
+}
+
+
+/* Handle program arguments.  */
+static error_t
+parse_opt (int key, char *arg, struct argp_state *state)
+{
+  switch (key)
+    {
+    case 's':
+      summary = true;
+      break;
+
+    case 'v':
+      verbose = true;
+      break;
+
+    case 'j':
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
+    default:
+      return ARGP_ERR_UNKNOWN;
+    }
+  return 0;
+}
@@ -38,6 +38,7 @@
 #include <elf-knowledge.h>
 #include <libeu.h>
 #include <system.h>
+#include <parallel.h>
 #include <printversion.h>
 #include "../libelf/libelfP.h"
 #include "../libelf/common.h"
@@ -66,6 +67,9 @@ static const struct argp_option options[] =
   { "gnu-ld", ARGP_gnuld, NULL, 0,
     N_("Binary has been created with GNU ld and is therefore known to be \
 broken in certain ways"), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Check up to N files, or the sections of one file, at the same \
+time, or one per CPU if N is 0"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -86,7 +90,20 @@ static struct argp argp =
 };
 
 
+/* A file checked in parallel with others, and what was found.  */
+struct file_check
+{
+  const char *fname;
+  int open_errno;
+  char *out;
+  size_t out_len;
+  unsigned int errors;
+};
+
 /* Declarations of local functions.  */
+static void check_file (const char *fname, bool only_one);
+static void check_open_file (int fd, const char *fname, bool only_one);
+static void run_file_check (void *arg, size_t i);
 static void process_file (int fd, Elf *elf, const char *prefix,
 			  const char *suffix, const char *fname, size_t size,
 			  bool only_one);
@@ -99,11 +116,23 @@ static void check_note_section (Ebl *ebl, GElf_Ehdr *ehdr,
 /* Report an error.  */
 #define ERROR(str, args...) \
   do {									      \
-    printf (str, ##args);						      \
-    ++error_count;							      \
+    fprintf (diag_stream ?: stdout, str, ##args);			      \
+    ++*diag_count;							      \
   } while (0)
 static unsigned int error_count;
 
+/* Where messages are printed and errors counted.  Checks running in
+   parallel each collect theirs in a buffer of their own, which are
+   printed in the order the checks would have run in.  */
+static __thread FILE *diag_stream;
+static __thread unsigned int *diag_count = &error_count;
+
+/* Number of threads to use.  */
+static unsigned int nthreads = 1;
+
+/* True if files are checked in parallel, their sections are not.  */
+static bool parallel_files;
+
 /* True if we should perform very strict testing.  */
 static bool be_strict;
 
@@ -117,14 +146,14 @@ static bool is_debuginfo;
 static bool gnuld;
 
 /* Index of section header string table.  */
-static uint32_t shstrndx;
+static __thread uint32_t shstrndx;
 
 /* Array to count references in section groups.  */
-static int *scnref;
+static __thread int *scnref;
 
 /* Numbers of sections and program headers.  */
-static unsigned int shnum;
-static unsigned int phnum;
+static __thread unsigned int shnum;
+static __thread unsigned int phnum;
 
 
 int
@@ -145,60 +174,137 @@ main (int argc, char *argv[])
 
   /* Now process all the files given at the command line.  */
   bool only_one = remaining + 1 == argc;
-  do
+  if (nthreads > 1 && !only_one)
     {
-      /* Open the file.  */
-      int fd = open (argv[remaining], O_RDONLY);
-      if (fd == -1)
-	{
-	  error (0, errno, _("cannot open input file '%s'"), argv[remaining]);
-	  continue;
-	}
+      /* Check the files in parallel and print what was found for each
+	 in the order of the command line.  */
+      parallel_files = true;
+      size_t nfiles = argc - remaining;
+      struct file_check *files = xcalloc (nfiles, sizeof files[0]);
+      for (size_t i = 0; i < nfiles; ++i)
+	files[i].fname = argv[remaining + i];
 
-      /* Create an `Elf' descriptor.  */
-      Elf *elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
-      if (elf == NULL)
-	ERROR (_("cannot generate Elf descriptor for '%s': %s\n"),
-	       argv[remaining], elf_errmsg (-1));
-      else
-	{
-	  unsigned int prev_error_count = error_count;
-	  struct stat st;
+      run_parallel (nthreads, nfiles, run_file_check, files);
 
-	  if (fstat (fd, &st) != 0)
+      for (size_t i = 0; i < nfiles; ++i)
+	{
+	  if (files[i].open_errno != 0)
 	    {
-	      printf ("cannot stat '%s': %m\n", argv[remaining]);
-	      close (fd);
+	      fflush (stdout);
+	      error (0, files[i].open_errno, _("cannot open input file '%s'"),
+		     files[i].fname);
 	      continue;
 	    }
+	  fwrite (files[i].out, 1, files[i].out_len, stdout);
+	  free (files[i].out);
+	  error_count += files[i].errors;
+	}
+      free (files);
+    }
+  else
+    do
+      check_file (argv[remaining], only_one);
+    while (++remaining < argc);
+
+  return error_count != 0;
+}
+
+
+/* Check the file FNAME.  */
+static void
+check_file (const char *fname, bool only_one)
+{
+  /* Open the file.  */
+  int fd = open (fname, O_RDONLY);
+  if (fd == -1)
+    {
+      error (0, errno, _("cannot open input file '%s'"), fname);
+      return;
+    }
 
-	  process_file (fd, elf, NULL, NULL, argv[remaining], st.st_size,
-			only_one);
+  check_open_file (fd, fname, only_one);
+}
 
-	  /* Now we can close the descriptor.  */
-	  if (elf_end (elf) != 0)
-	    ERROR (_("error while closing Elf descriptor: %s\n"),
-		   elf_errmsg (-1));
 
-	  if (prev_error_count == error_count && !be_quiet)
-	    puts (_("No errors"));
+/* Check the file FNAME opened as FD, and close FD.  */
+static void
+check_open_file (int fd, const char *fname, bool only_one)
+{
+  /* Create an `Elf' descriptor.  */
+  Elf *elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+  if (elf == NULL)
+    ERROR (_("cannot generate Elf descriptor for '%s': %s\n"),
+	   fname, elf_errmsg (-1));
+  else
+    {
+      unsigned int prev_error_count = *diag_count;
+      struct stat st;
+
+      if (fstat (fd, &st) != 0)
+	{
+	  fprintf (diag_stream ?: stdout, "cannot stat '%s': %m\n", fname);
+	  close (fd);
+	  return;
 	}
 
-      close (fd);
+      process_file (fd, elf, NULL, NULL, fname, st.st_size, only_one);
+
+      /* Now we can close the descriptor.  */
+      if (elf_end (elf) != 0)
+	ERROR (_("error while closing Elf descriptor: %s\n"),
+	       elf_errmsg (-1));
+
+      if (prev_error_count == *diag_count && !be_quiet)
+	fprintf (diag_stream ?: stdout, "%s\n", _("No errors"));
     }
-  while (++remaining < argc);
 
-  return error_count != 0;
+  close (fd);
+}
+
+
+/* Check one of several files on one of the threads.  */
+static void
+run_file_check (void *arg, size_t i)
+{
+  struct file_check *file = &((struct file_check *) arg)[i];
+
+  /* The message for a file which can't be opened goes to stderr, which
+     is left for the main thread to do in order.  */
+  int fd = open (file->fname, O_RDONLY);
+  if (fd == -1)
+    {
+      file->open_errno = errno;
+      return;
+    }
+
+  diag_stream = open_memstream (&file->out, &file->out_len);
+  if (diag_stream == NULL)
+    error_exit (errno, _("memory exhausted"));
+  diag_count = &file->errors;
+
+  check_open_file (fd, file->fname, false);
+
+  fclose (diag_stream);
+  diag_stream = NULL;
+  diag_count = &error_count;
 }
 
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg __attribute__ ((unused)),
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
+    case 'j':
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     case ARGP_strict:
       be_strict = true;
       break;
@@ -1241,10 +1347,10 @@ struct loaded_segment
 
 
 /* Check whether binary has text relocation flag set.  */
-static bool textrel;
+static __thread bool textrel;
 
 /* Keep track of whether text relocation flag is needed.  */
-static bool needed_textrel;
+static __thread bool needed_textrel;
 
 
 static bool
@@ -1629,7 +1735,7 @@ check_relr (Ebl *ebl, GElf_Ehdr *ehdr, GElf_Shdr *shdr, int idx)
 }
 
 /* Number of dynamic sections.  */
-static int ndynamic;
+static __thread int ndynamic;
 
 
 static void
@@ -2928,7 +3034,7 @@ in_nobits_scn (Ebl *ebl, unsigned int shndx)
 }
 
 
-static struct version_namelist
+static __thread struct version_namelist
 {
   const char *objname;
   const char *name;
@@ -3120,7 +3226,7 @@ unknown_dependency_p (Elf *elf, const char *fname)
 }
 
 
-static unsigned int nverneed;
+static __thread unsigned int nverneed;
 
 static void
 check_verneed (Ebl *ebl, GElf_Shdr *shdr, int idx)
@@ -3267,7 +3373,7 @@ section [%2d] '%s': entry %d has zero offset to next entry, but sh_info says the
 }
 
 
-static unsigned int nverdef;
+static __thread unsigned int nverdef;
 
 static void
 check_verdef (Ebl *ebl, GElf_Shdr *shdr, int idx)
@@ -3662,8 +3768,8 @@ section [%2d] '%s': offset %zu: extra bytes after last attribute section\n"),
 	   idx, section_name (ebl, idx), buffer_pos (data, p));
 }
 
-static bool has_loadable_segment;
-static bool has_interp_segment;
+static __thread bool has_loadable_segment;
+static __thread bool has_interp_segment;
 
 static const struct
 {
@@ -3734,9 +3840,158 @@ static const struct
 
 
 /* Indices of some sections we need later.  */
-static size_t eh_frame_hdr_scnndx;
-static size_t eh_frame_scnndx;
-static size_t gcc_except_table_scnndx;
+static __thread size_t eh_frame_hdr_scnndx;
+static __thread size_t eh_frame_scnndx;
+static __thread size_t gcc_except_table_scnndx;
+
+
+/* The symbol table and relocation checks take most of the time for
+   big files.  They depend on nothing the other checks find, so they
+   can run in parallel after the other checks of the sections.  */
+struct section_check
+{
+  void (*check) (Ebl *ebl, GElf_Ehdr *ehdr, GElf_Shdr *shdr, int idx);
+  GElf_Shdr shdr;
+  int idx;
+
+  /* The messages of the other checks printed before this one.  */
+  char *before;
+  size_t before_len;
+
+  /* And those of this check.  */
+  char *out;
+  size_t out_len;
+  unsigned int errors;
+  bool textrel;
+  bool needed_textrel;
+};
+
+struct section_checks
+{
+  Ebl *ebl;
+  GElf_Ehdr *ehdr;
+  struct section_check *checks;
+  size_t n;
+  size_t alloc;
+
+  /* What the checks need to know of the file.  */
+  unsigned int shnum;
+  unsigned int phnum;
+  uint32_t shstrndx;
+
+  /* The messages since the last section_check.  */
+  char *buf;
+  size_t buf_len;
+  FILE *prev_stream;
+};
+
+static void
+open_diag_buffer (char **bufp, size_t *lenp)
+{
+  diag_stream = open_memstream (bufp, lenp);
+  if (diag_stream == NULL)
+    error_exit (errno, _("memory exhausted"));
+}
+
+/* Run CHECK for section IDX now, or queue it for running in parallel
+   if SC is not NULL.  */
+static void
+section_check (struct section_checks *sc,
+	       void (*check) (Ebl *, GElf_Ehdr *, GElf_Shdr *, int),
+	       Ebl *ebl, GElf_Ehdr *ehdr, GElf_Shdr *shdr, int idx)
+{
+  if (sc == NULL)
+    {
+      check (ebl, ehdr, shdr, idx);
+      return;
+    }
+
+  if (sc->n == sc->alloc)
+    {
+      sc->alloc = 2 * sc->alloc + 8;
+      sc->checks = xrealloc (sc->checks, sc->alloc * sizeof sc->checks[0]);
+    }
+  struct section_check *c = &sc->checks[sc->n++];
+  c->check = check;
+  c->shdr = *shdr;
+  c->idx = idx;
+
+  fclose (diag_stream);
+  c->before = sc->buf;
+  c->before_len = sc->buf_len;
+  open_diag_buffer (&sc->buf, &sc->buf_len);
+
+  c->out = NULL;
+  c->out_len = 0;
+  c->errors = 0;
+}
+
+static void
+run_section_check (void *arg, size_t i)
+{
+  struct section_checks *sc = arg;
+  struct section_check *c = &sc->checks[i];
+
+  /* The calling thread runs checks too, keep its state.  */
+  FILE *saved_stream = diag_stream;
+  unsigned int *saved_count = diag_count;
+  bool saved_textrel = textrel;
+  bool saved_needed_textrel = needed_textrel;
+
+  shnum = sc->shnum;
+  phnum = sc->phnum;
+  shstrndx = sc->shstrndx;
+  textrel = false;
+  needed_textrel = false;
+  open_diag_buffer (&c->out, &c->out_len);
+  diag_count = &c->errors;
+
+  c->check (sc->ebl, sc->ehdr, &c->shdr, c->idx);
+
+  fclose (diag_stream);
+  c->textrel = textrel;
+  c->needed_textrel = needed_textrel;
+
+  diag_stream = saved_stream;
+  diag_count = saved_count;
+  textrel = saved_textrel;
+  needed_textrel = saved_needed_textrel;
+}
+
+/* Run the queued checks and print all messages in order.  */
+static void
+run_section_checks (struct section_checks *sc)
+{
+  fclose (diag_stream);
+  diag_stream = sc->prev_stream;
+
+  /* The checks only read the file.  Read in all the section data
+     first, so they don't change the descriptor at the same time.  */
+  if (sc->n > 0)
+    {
+      Elf_Scn *scn = NULL;
+      while ((scn = elf_nextscn (sc->ebl->elf, scn)) != NULL)
+	(void) elf_getdata (scn, NULL);
+    }
+
+  run_parallel (nthreads, sc->n, run_section_check, sc);
+
+  FILE *out = diag_stream ?: stdout;
+  for (size_t i = 0; i < sc->n; ++i)
+    {
+      struct section_check *c = &sc->checks[i];
+      fwrite (c->before, 1, c->before_len, out);
+      fwrite (c->out, 1, c->out_len, out);
+      free (c->before);
+      free (c->out);
+      *diag_count += c->errors;
+      textrel |= c->textrel;
+      needed_textrel |= c->needed_textrel;
+    }
+  fwrite (sc->buf, 1, sc->buf_len, out);
+  free (sc->buf);
+  free (sc->checks);
+}
 
 
 static void
@@ -3794,6 +4049,24 @@ zeroth section has nonzero link value while ELF header does not signal overflow
   size_t gnu_hash_idx = 0;
 
   size_t versym_scnndx = 0;
+
+  /* Collect the checks to run in parallel, and the messages of the
+     others in between.  */
+  struct section_checks sc_mem;
+  struct section_checks *sc = NULL;
+  if (nthreads > 1 && !parallel_files)
+    {
+      sc = &sc_mem;
+      memset (sc, 0, sizeof *sc);
+      sc->ebl = ebl;
+      sc->ehdr = ehdr;
+      sc->shnum = shnum;
+      sc->phnum = phnum;
+      sc->shstrndx = shstrndx;
+      sc->prev_stream = diag_stream;
+      open_diag_buffer (&sc->buf, &sc->buf_len);
+    }
+
   for (size_t cnt = 1; cnt < shnum; ++cnt)
     {
       Elf_Scn *scn = elf_getscn (ebl->elf, cnt);
@@ -4210,19 +4483,19 @@ section [%2zu] '%s': relocatable files cannot have dynamic symbol tables\n"),
 		   cnt, section_name (ebl, cnt));
 	  FALLTHROUGH;
 	case SHT_SYMTAB:
-	  check_symtab (ebl, ehdr, shdr, cnt);
+	  section_check (sc, check_symtab, ebl, ehdr, shdr, cnt);
 	  break;
 
 	case SHT_RELA:
-	  check_rela (ebl, ehdr, shdr, cnt);
+	  section_check (sc, check_rela, ebl, ehdr, shdr, cnt);
 	  break;
 
 	case SHT_REL:
-	  check_rel (ebl, ehdr, shdr, cnt);
+	  section_check (sc, check_rel, ebl, ehdr, shdr, cnt);
 	  break;
 
 	case SHT_RELR:
-	  check_relr (ebl, ehdr, shdr, cnt);
+	  section_check (sc, check_relr, ebl, ehdr, shdr, cnt);
 	  break;
 
 	case SHT_DYNAMIC:
@@ -4282,6 +4555,9 @@ section [%2zu] '%s': relocatable files cannot have dynamic symbol tables\n"),
 	}
     }
 
+  if (sc != NULL)
+    run_section_checks (sc);
+
   if (has_interp_segment && !dot_interp_section)
     ERROR (_("INTERP program header entry but no .interp section\n"));
 
@@ -4532,7 +4808,7 @@ section [%2d] '%s': no note entries defined for the type of file\n"),
 
 
 /* Index of the PT_GNU_EH_FRAME program eader entry.  */
-static int pt_gnu_eh_frame_pndx;
+static __thread int pt_gnu_eh_frame_pndx;
 
 
 static void
@@ -4822,6 +5098,10 @@ process_elf_file (Elf *elf, const char *prefix, const char *suffix,
   needed_textrel = false;
   has_loadable_segment = false;
   has_interp_segment = false;
+  eh_frame_hdr_scnndx = 0;
+  eh_frame_scnndx = 0;
+  gcc_except_table_scnndx = 0;
+  pt_gnu_eh_frame_pndx = 0;
 
   GElf_Ehdr ehdr_mem;
   GElf_Ehdr *ehdr = gelf_getehdr (elf, &ehdr_mem);
@@ -4831,9 +5111,10 @@ process_elf_file (Elf *elf, const char *prefix, const char *suffix,
   if (!only_one)
     {
       if (prefix != NULL)
-	printf ("\n%s(%s)%s:\n", prefix, fname, suffix);
+	fprintf (diag_stream ?: stdout, "\n%s(%s)%s:\n",
+		 prefix, fname, suffix);
       else
-	printf ("\n%s:\n", fname);
+	fprintf (diag_stream ?: stdout, "\n%s:\n", fname);
     }
 
   if (ehdr == NULL)
@@ -21,11 +21,11 @@
 #endif
 
 #include <argp.h>
-#include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <gelf.h>
 #include <libdw.h>
+#include <libdwelf.h>
 #include <locale.h>
 #include <search.h>
 #include <stdbool.h>
@@ -89,7 +89,8 @@ static int process_file (const char *fname, bool more_than_one);
 /* Check for text relocations in the given file.  The segment
    information is known.  */
 static void check_rel (size_t nsegments, struct segments segments[nsegments],
-		       GElf_Addr addr, Elf *elf, Elf_Scn *symscn, Dwarf *dw,
+		       GElf_Addr addr, Elf_Scn *symscn,
+		       Dwelf_Symtab **symtab, Dwarf *dw,
 		       const char *fname, bool more_than_one,
 		       void **knownsrcs);
 
@@ -238,6 +239,7 @@ process_file (const char *fname, bool more_than_one)
   /* Determine whether the DSO has text relocations at all and locate
      the symbol table.  */
   Elf_Scn *symscn = NULL;
+  Dwelf_Symtab *symtab = NULL;
   Elf_Scn *scn = NULL;
   bool seen_dynamic = false;
   bool have_textrel = false;
@@ -421,8 +423,8 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
 		      goto next;
 		    }
 
-		  check_rel (nsegments, segments, rel->r_offset, elf,
-			     symscn, dw, fname, more_than_one, &knownsrcs);
+		  check_rel (nsegments, segments, rel->r_offset, symscn,
+			     &symtab, dw, fname, more_than_one, &knownsrcs);
 		}
 	    }
 	  else if (shdr->sh_type == SHT_RELA)
@@ -444,8 +446,8 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
 		      goto next;
 		    }
 
-		  check_rel (nsegments, segments, rela->r_offset, elf,
-			     symscn, dw, fname, more_than_one, &knownsrcs);
+		  check_rel (nsegments, segments, rela->r_offset, symscn,
+			     &symtab, dw, fname, more_than_one, &knownsrcs);
 		}
 	    }
 	}
@@ -454,6 +456,7 @@ cannot get relocation at index %d in section %zu in '%s': %s"),
     }
 
  next:
+  dwelf_symtab_end (symtab);
   elf_end (elf);
   elf_end (elf2);
   close (fd);
@@ -480,7 +483,7 @@ ptrcompare (const void *p1, const void *p2)
 
 static void
 check_rel (size_t nsegments, struct segments segments[nsegments],
-	   GElf_Addr addr, Elf *elf, Elf_Scn *symscn, Dwarf *dw,
+	   GElf_Addr addr, Elf_Scn *symscn, Dwelf_Symtab **symtab, Dwarf *dw,
 	   const char *fname, bool more_than_one, void **knownsrcs)
 {
   for (size_t cnt = 0; cnt < nsegments; ++cnt)
@@ -512,47 +515,50 @@ check_rel (size_t nsegments, struct segments segments[nsegments],
 	  {
 	    /* At least look at the symbol table to see which function
 	       the modified address is in.  */
-	    Elf_Data *symdata = elf_getdata (symscn, NULL);
-	    GElf_Shdr shdr_mem;
-	    GElf_Shdr *shdr = gelf_getshdr (symscn, &shdr_mem);
-	    if (shdr != NULL)
+	    if (*symtab == NULL)
+	      *symtab = dwelf_symtab_begin (symscn);
+	    if (*symtab != NULL)
 	      {
-		GElf_Addr lowaddr = 0;
-		int lowidx = -1;
-		GElf_Addr highaddr = ~0ul;
-		int highidx = -1;
-		GElf_Sym sym_mem;
-		GElf_Sym *sym;
-		size_t entries = (shdr->sh_entsize == 0
-				  ? 0 : shdr->sh_size / shdr->sh_entsize);
-
-		for (int i = 0; (size_t) i < entries; ++i)
+		/* The closest symbols below and above the address, the
+		   first one in the table if several have the same value.
+		   Symbols at zero don't count.  */
+		size_t nsyms;
+		const GElf_Word *byaddr = dwelf_symtab_addrs (*symtab, &nsyms);
+		size_t pos = dwelf_symtab_find_addr (*symtab, addr);
+		bool low = false;
+		GElf_Sym lowsym;
+		const char *lowstr = NULL;
+		bool high = false;
+		GElf_Sym highsym;
+		const char *highstr = NULL;
+
+		if (pos < nsyms)
 		  {
-		    sym = gelf_getsym (symdata, i, &sym_mem);
-		    if (sym == NULL)
-		      continue;
-
-		    if (sym->st_value < addr && sym->st_value > lowaddr)
-		      {
-			lowaddr = sym->st_value;
-			lowidx = i;
-		      }
-		    if (sym->st_value > addr && sym->st_value < highaddr)
+		    highstr = dwelf_symtab_getsym (*symtab, byaddr[pos],
+						   &highsym, NULL);
+		    high = highsym.st_value != ~0ul;
+		  }
+		if (addr > 0)
+		  {
+		    pos = dwelf_symtab_find_addr (*symtab, addr - 1);
+		    if (pos > 0)
 		      {
-			highaddr = sym->st_value;
-			highidx = i;
+			dwelf_symtab_getsym (*symtab, byaddr[pos - 1], &lowsym,
+					     NULL);
+			if (lowsym.st_value > 0)
+			  {
+			    pos = dwelf_symtab_find_addr (*symtab,
+							  lowsym.st_value - 1);
+			    lowstr = dwelf_symtab_getsym (*symtab, byaddr[pos],
+							  &lowsym, NULL);
+			    low = true;
+			  }
 		      }
 		  }
 
-		if (lowidx != -1)
+		if (low)
 		  {
-		    sym = gelf_getsym (symdata, lowidx, &sym_mem);
-		    assert (sym != NULL);
-
-		    const char *lowstr = elf_strptr (elf, shdr->sh_link,
-						     sym->st_name);
-
-		    if (sym->st_value + sym->st_size > addr)
+		    if (lowsym.st_value + lowsym.st_size > addr)
 		      {
 			/* It is this function.  */
 			if (tfind (lowstr, knownsrcs, ptrcompare) == NULL)
@@ -563,30 +569,21 @@ the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
 			    tsearch (lowstr, knownsrcs, ptrcompare);
 			  }
 		      }
-		    else if (highidx == -1)
+		    else if (! high)
 		      printf (_("\
 the file containing the function '%s' might not be compiled with -fpic/-fPIC\n"),
 			      lowstr);
 		    else
-		      {
-			sym = gelf_getsym (symdata, highidx, &sym_mem);
-			assert (sym != NULL);
-
-			printf (_("\
+		      printf (_("\
 either the file containing the function '%s' or the file containing the function '%s' is not compiled with -fpic/-fPIC\n"),
-				lowstr, elf_strptr (elf, shdr->sh_link,
-						    sym->st_name));
-		      }
+			      lowstr, highstr);
 		    return;
 		  }
-		else if (highidx != -1)
+		else if (high)
 		  {
-		    sym = gelf_getsym (symdata, highidx, &sym_mem);
-		    assert (sym != NULL);
-
 		    printf (_("\
 the file containing the function '%s' might not be compiled with -fpic/-fPIC\n"),
-			    elf_strptr (elf, shdr->sh_link, sym->st_name));
+			    highstr);
 		    return;
 		  }
 	      }
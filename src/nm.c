@@ -30,6 +30,7 @@
 #include <gelf.h>
 #include <inttypes.h>
 #include <libdw.h>
+#include <libdwelf.h>
 #include <locale.h>
 #include <obstack.h>
 #include <search.h>
@@ -43,6 +44,7 @@
 #include <libeu.h>
 #include <system.h>
 #include <color.h>
+#include <parallel.h>
 #include <printversion.h>
 #include "../libebl/libeblP.h"
 #include "../libdwfl/libdwflP.h"
@@ -96,6 +98,9 @@ static const struct argp_option options[] =
   { "demangle", 'C', NULL, 0,
     N_("Decode low-level symbol names into source code names"), 0 },
 #endif
+  { "jobs", 'j', "N", 0,
+    N_("Sort, demangle and read debug information on up to N threads, or one per CPU if N is 0"),
+    0 },
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
 };
@@ -134,6 +139,11 @@ static int handle_ar (int fd, Elf *elf, const char *prefix, const char *fname,
 static int handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 		       const char *suffix);
 
+#ifdef USE_DEMANGLE
+/* Free the demangled names kept for all files.  */
+static void free_demangled (void);
+#endif
+
 
 #define INTERNAL_ERROR(fname) \
   error_exit (0, _("%s: INTERNAL ERROR %d (%s): %s"),      \
@@ -145,7 +155,13 @@ typedef struct GElf_SymX
 {
   GElf_Sym sym;
   Elf32_Word xndx;
+  /* Index in the symbol table, the last sort key.  */
+  Elf32_Word ndx;
   char *where;
+  /* The name in the string table, NULL if st_name is invalid.  */
+  const char *name;
+  /* The name to print, NAME demangled if requested.  */
+  const char *dmname;
 } GElf_SymX;
 
 
@@ -183,6 +199,9 @@ static bool reverse_sort;
 static bool demangle;
 #endif
 
+/* Number of threads to use.  */
+static unsigned int nthreads = 1;
+
 /* Type of the section we are printing.  */
 static GElf_Word symsec_type = SHT_SYMTAB;
 
@@ -249,14 +268,17 @@ main (int argc, char *argv[])
       while (++remaining < argc);
     }
 
+#ifdef USE_DEMANGLE
+  free_demangled ();
+#endif
+
   return result;
 }
 
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -345,6 +367,15 @@ parse_opt (int key, char *arg,
       reverse_sort = true;
       break;
 
+    case 'j':
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     default:
       return ARGP_ERR_UNKNOWN;
     }
@@ -616,105 +647,288 @@ get_var_range (Dwarf_Die *die, Dwarf_Word *lowpc, Dwarf_Word *highpc)
 static void *local_root;
 
 
+/* The local names found in one CU.  */
+struct local_cu
+{
+  Dwarf_Die cudie;
+  Dwarf_Files *files;
+  size_t nfiles;
+  struct local_name *names;
+  size_t nnames;
+};
+
+
+/* Collect the local names of CU number I.  Different CUs can be
+   handled at the same time, everything shared by them has been read
+   by get_local_names already.  */
+static void
+get_cu_local_names (void *arg, size_t i)
+{
+  struct local_cu *cu = &((struct local_cu *) arg)[i];
+  size_t maxnames = 0;
+
+  Dwarf_Die die_mem;
+  Dwarf_Die *die = &die_mem;
+  if (dwarf_child (&cu->cudie, die) == 0)
+    /* Iterate over all immediate children of the CU DIE.  */
+    do
+      {
+	int tag = dwarf_tag (die);
+	if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
+	  continue;
+
+	/* We are interested in five attributes: name, decl_file,
+	   decl_line, low_pc, and high_pc.  */
+	Dwarf_Attribute attr_mem;
+	Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
+	const char *name = dwarf_formstring (attr);
+	if (name == NULL)
+	  continue;
+
+	Dwarf_Word fileidx;
+	attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
+	if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= cu->nfiles)
+	  continue;
+
+	Dwarf_Word lineno;
+	attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
+	if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
+	  continue;
+
+	Dwarf_Addr lowpc;
+	Dwarf_Addr highpc;
+	if (tag == DW_TAG_subprogram)
+	  {
+	    if (dwarf_lowpc (die, &lowpc) != 0
+		|| dwarf_highpc (die, &highpc) != 0)
+	      continue;
+	  }
+	else
+	  {
+	    if (get_var_range (die, &lowpc, &highpc) != 0)
+	      continue;
+	  }
+
+	/* We have all the information.  Create a record.  */
+	if (cu->nnames == maxnames)
+	  {
+	    maxnames = 2 * maxnames + 16;
+	    cu->names = xrealloc (cu->names, maxnames * sizeof cu->names[0]);
+	  }
+	struct local_name *newp = &cu->names[cu->nnames++];
+	newp->name = name;
+	newp->file = dwarf_filesrc (cu->files, fileidx, NULL, NULL);
+	newp->lineno = lineno;
+	newp->lowpc = lowpc;
+	newp->highpc = highpc;
+      }
+    while (dwarf_siblingof (die, die) == 0);
+}
+
+
 static void
 get_local_names (Dwarf *dbg)
 {
   Dwarf_Off offset = 0;
   Dwarf_Off old_offset;
   size_t hsize;
+  struct local_cu *cus = NULL;
+  size_t ncus = 0;
+  size_t maxcus = 0;
 
+  /* Find the CUs and read their line information first, that
+     changes data shared between CUs.  */
   while (dwarf_nextcu (dbg, old_offset = offset, &offset, &hsize, NULL, NULL,
 		       NULL) == 0)
     {
-      Dwarf_Die cudie_mem;
-      Dwarf_Die *cudie = dwarf_offdie (dbg, old_offset + hsize, &cudie_mem);
+      if (ncus == maxcus)
+	{
+	  maxcus = 2 * maxcus + 16;
+	  cus = xrealloc (cus, maxcus * sizeof cus[0]);
+	}
+      struct local_cu *cu = &cus[ncus];
 
       /* If we cannot get the CU DIE there is no need to go on with
 	 this CU.  */
-      if (cudie == NULL)
+      if (dwarf_offdie (dbg, old_offset + hsize, &cu->cudie) == NULL)
 	continue;
       /* This better be a CU DIE.  */
-      if (dwarf_tag (cudie) != DW_TAG_compile_unit)
+      if (dwarf_tag (&cu->cudie) != DW_TAG_compile_unit)
 	continue;
 
       /* Get the line information.  */
-      Dwarf_Files *files;
-      size_t nfiles;
-      if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
+      if (dwarf_getsrcfiles (&cu->cudie, &cu->files, &cu->nfiles) != 0)
 	continue;
 
-      Dwarf_Die die_mem;
-      Dwarf_Die *die = &die_mem;
-      if (dwarf_child (cudie, die) == 0)
-	/* Iterate over all immediate children of the CU DIE.  */
-	do
-	  {
-	    int tag = dwarf_tag (die);
-	    if (tag != DW_TAG_subprogram && tag != DW_TAG_variable)
-	      continue;
+      cu->names = NULL;
+      cu->nnames = 0;
+      ++ncus;
+    }
 
-	    /* We are interested in five attributes: name, decl_file,
-	       decl_line, low_pc, and high_pc.  */
-	    Dwarf_Attribute attr_mem;
-	    Dwarf_Attribute *attr = dwarf_attr (die, DW_AT_name, &attr_mem);
-	    const char *name = dwarf_formstring (attr);
-	    if (name == NULL)
-	      continue;
+  /* Names in an alternate debug file are only looked up on demand,
+     which can't be done by several threads.  */
+  const char *altname;
+  const void *altid;
+  unsigned int jobs = nthreads;
+  if (dwelf_dwarf_gnu_debugaltlink (dbg, &altname, &altid) != 0)
+    jobs = 1;
+  run_parallel (jobs, ncus, get_cu_local_names, cus);
+
+  /* Build the search tree in the original order, local_compare merges
+     some entries.  */
+  for (size_t i = 0; i < ncus; ++i)
+    {
+      for (size_t j = 0; j < cus[i].nnames; ++j)
+	{
+	  struct local_name *newp = xmalloc (sizeof (*newp));
+	  *newp = cus[i].names[j];
+
+	  /* Check whether a similar local_name is already in the
+	     cache.  That should not happen.  But if it does, we
+	     don't want to leak memory.  */
+	  struct local_name **tres = tsearch (newp, &local_root,
+					      local_compare);
+	  if (tres == NULL)
+	    error_exit (errno, _("cannot create search tree"));
+	  else if (*tres != newp)
+	    free (newp);
+	}
+      free (cus[i].names);
+    }
+  free (cus);
+}
 
-	    Dwarf_Word fileidx;
-	    attr = dwarf_attr (die, DW_AT_decl_file, &attr_mem);
-	    if (dwarf_formudata (attr, &fileidx) != 0 || fileidx >= nfiles)
-	      continue;
+#ifdef USE_DEMANGLE
+/* A demangled name.  They are kept for all files, the same names come
+   up again and again in the members of an archive.  */
+struct demangled
+{
+  char *mangled;
+  /* NULL if MANGLED cannot be demangled.  */
+  char *name;
+  struct demangled *next;
+};
 
-	    Dwarf_Word lineno;
-	    attr = dwarf_attr (die, DW_AT_decl_line, &attr_mem);
-	    if (dwarf_formudata (attr, &lineno) != 0 || lineno == 0)
-	      continue;
+/* FNV-1a hash of a mangled name.  */
+static unsigned long int
+demangled_hash (const char *name)
+{
+  uint64_t hval = 0xcbf29ce484222325ull;
+  for (; *name != '\0'; ++name)
+    hval = (hval ^ (unsigned char) *name) * 0x100000001b3ull;
+  return hval;
+}
 
-	    Dwarf_Addr lowpc;
-	    Dwarf_Addr highpc;
-	    if (tag == DW_TAG_subprogram)
-	      {
-		if (dwarf_lowpc (die, &lowpc) != 0
-		    || dwarf_highpc (die, &highpc) != 0)
-		  continue;
-	      }
-	    else
-	      {
-		if (get_var_range (die, &lowpc, &highpc) != 0)
-		  continue;
-	      }
+#define TYPE struct demangled *
+#define NAME demangled_tab
+#define COMPARE(a, b) strcmp ((a)->mangled, (b)->mangled)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
 
-	    /* We have all the information.  Create a record.  */
-	    struct local_name *newp = xmalloc (sizeof (*newp));
-	    newp->name = name;
-	    newp->file = dwarf_filesrc (files, fileidx, NULL, NULL);
-	    newp->lineno = lineno;
-	    newp->lowpc = lowpc;
-	    newp->highpc = highpc;
-
-	   /* Check whether a similar local_name is already in the
-	      cache.  That should not happen.  But if it does, we
-	      don't want to leak memory.  */
-	    struct local_name **tres = tsearch (newp, &local_root,
-						local_compare);
-	    if (tres == NULL)
-              error_exit (errno, _("cannot create search tree"));
-	    else if (*tres != newp)
-	      free (newp);
-	  }
-	while (dwarf_siblingof (die, die) == 0);
+#include <dynamicsizehash.c>
+#undef TYPE
+#undef NAME
+#undef COMPARE
+
+static demangled_tab demangled_cache;
+static struct demangled *demangled_list;
+
+
+static void
+demangle_one (void *arg, size_t i)
+{
+  struct demangled *d = ((struct demangled **) arg)[i];
+  int status = -1;
+  d->name = __cxa_demangle (d->mangled, NULL, NULL, &status);
+  if (status != 0)
+    {
+      free (d->name);
+      d->name = NULL;
+    }
+}
+
+
+/* Set the dmname of the symbols.  Names not seen before are demangled
+   on up to NTHREADS threads.  */
+static void
+demangle_symbols (GElf_SymX *syms, size_t nsyms)
+{
+  if (demangled_cache.table == NULL
+      && demangled_tab_init (&demangled_cache, 1021) != 0)
+    error_exit (errno, _("memory exhausted"));
+
+  struct demangled **found = xmalloc (nsyms * sizeof found[0] + 1);
+  struct demangled **todo = NULL;
+  size_t ntodo = 0;
+  size_t maxtodo = 0;
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    {
+      /* Require GNU v3 ABI by the "_Z" prefix.  */
+      const char *symstr = syms[cnt].name;
+      found[cnt] = NULL;
+      if (symstr == NULL || symstr[0] != '_' || symstr[1] != 'Z')
+	continue;
+
+      unsigned long int hval = demangled_hash (symstr);
+      struct demangled fake = { .mangled = (char *) symstr };
+      found[cnt] = demangled_tab_find (&demangled_cache, hval, &fake);
+      if (found[cnt] == NULL)
+	{
+	  struct demangled *d = xmalloc (sizeof *d);
+	  d->mangled = xstrdup (symstr);
+	  d->name = NULL;
+	  d->next = demangled_list;
+	  demangled_list = d;
+	  if (demangled_tab_insert (&demangled_cache, hval, d) != 0)
+	    error_exit (errno, _("memory exhausted"));
+
+	  if (ntodo == maxtodo)
+	    {
+	      maxtodo = 2 * maxtodo + 64;
+	      todo = xrealloc (todo, maxtodo * sizeof todo[0]);
+	    }
+	  todo[ntodo++] = d;
+	  found[cnt] = d;
+	}
+    }
+
+  run_parallel (nthreads, ntodo, demangle_one, todo);
+  free (todo);
+
+  for (size_t cnt = 0; cnt < nsyms; ++cnt)
+    if (found[cnt] != NULL && found[cnt]->name != NULL)
+      syms[cnt].dmname = found[cnt]->name;
+  free (found);
+}
+
+
+static void
+free_demangled (void)
+{
+  if (demangled_cache.table == NULL)
+    return;
+
+  demangled_tab_free (&demangled_cache);
+  while (demangled_list != NULL)
+    {
+      struct demangled *d = demangled_list;
+      demangled_list = d->next;
+      free (d->mangled);
+      free (d->name);
+      free (d);
     }
 }
+#endif
 
-/* Do elf_strptr, but return a backup string and never NULL.  */
+/* Return the name to print, or a backup string and never NULL.  */
 static const char *
-sym_name (Elf *elf, GElf_Word strndx, GElf_Word st_name, char buf[], size_t n)
+sym_name (const GElf_SymX *sym, char buf[], size_t n)
 {
-  const char *symstr = elf_strptr (elf, strndx, st_name);
+  const char *symstr = sym->dmname;
   if (symstr == NULL)
     {
-      snprintf (buf, n, "[invalid st_name %#" PRIx32 "]", st_name);
+      snprintf (buf, n, "[invalid st_name %#" PRIx32 "]", sym->sym.st_name);
       symstr = buf;
     }
   return symstr;
@@ -722,7 +936,7 @@ sym_name (Elf *elf, GElf_Word strndx, GElf_Word st_name, char buf[], size_t n)
 
 /* Show symbols in SysV format.  */
 static void
-show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
+show_symbols_sysv (Ebl *ebl, const char *fullname,
 		   GElf_SymX *syms, size_t nsyms, int longest_name,
 		   int longest_where)
 {
@@ -777,11 +991,6 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 	  /* TRANS: the "sysv|" parts makes the string unique.  */
 	  longest_where, sgettext ("sysv|Line"));
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (cnt = 0; cnt < nsyms; ++cnt)
     {
@@ -790,8 +999,7 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 	continue;
 
       char symstrbuf[50];
-      const char *symstr = sym_name (ebl->elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
+      const char *symstr = sym_name (&syms[cnt], symstrbuf, sizeof symstrbuf);
 
       /* Printing entries with a zero-length name makes the output
 	 not very well parseable.  Since these entries don't carry
@@ -803,19 +1011,6 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
       if (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_FILE)
 	continue;
 
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
-
       char symbindbuf[50];
       char symtypebuf[50];
       char secnamebuf[1024];
@@ -866,10 +1061,6 @@ show_symbols_sysv (Ebl *ebl, GElf_Word strndx, const char *fullname,
 				shnum));
     }
 
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
-
   if (scnnames_malloced)
     free (scnnames);
 }
@@ -925,7 +1116,7 @@ class_type_char (Elf *elf, const GElf_Ehdr *ehdr, GElf_Sym *sym)
 
 
 static void
-show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
+show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr,
 		  const char *prefix, const char *fname, const char *fullname,
 		  GElf_SymX *syms, size_t nsyms)
 {
@@ -934,17 +1125,11 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
   if (prefix != NULL && ! print_file_name)
     printf ("\n%s:\n", fname);
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
     {
       char symstrbuf[50];
-      const char *symstr = sym_name (elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
+      const char *symstr = sym_name (&syms[cnt], symstrbuf, sizeof symstrbuf);
 
       /* Printing entries with a zero-length name makes the output
 	 not very well parseable.  Since these entries don't carry
@@ -956,19 +1141,6 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       if (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_FILE)
 	continue;
 
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
-
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
@@ -1049,15 +1221,11 @@ show_symbols_bsd (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 	fputs_unlocked (color_off, stdout);
       putchar_unlocked ('\n');
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
 static void
-show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
+show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr,
 		    const char *prefix, const char *fullname, GElf_SymX *syms,
 		    size_t nsyms)
 {
@@ -1066,17 +1234,11 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 
   int digits = length_map[gelf_getclass (elf) - 1][radix];
 
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-
   /* Iterate over all symbols.  */
   for (size_t cnt = 0; cnt < nsyms; ++cnt)
     {
       char symstrbuf[50];
-      const char *symstr = sym_name (elf, strndx, syms[cnt].sym.st_name,
-				     symstrbuf, sizeof symstrbuf);
+      const char *symstr = sym_name (&syms[cnt], symstrbuf, sizeof symstrbuf);
 
       /* Printing entries with a zero-length name makes the output
 	 not very well parseable.  Since these entries don't carry
@@ -1088,19 +1250,6 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
       if (GELF_ST_TYPE (syms[cnt].sym.st_info) == STT_FILE)
 	continue;
 
-#ifdef USE_DEMANGLE
-      /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-      if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	{
-	  int status = -1;
-	  char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					   &demangle_buffer_len, &status);
-
-	  if (status == 0)
-	    symstr = dmsymstr;
-	}
-#endif
-
       /* If we have to precede the line with the file name.  */
       if (print_file_name)
 	{
@@ -1127,16 +1276,14 @@ show_symbols_posix (Elf *elf, const GElf_Ehdr *ehdr, GElf_Word strndx,
 		digits, syms[cnt].sym.st_size);
       putchar ('\n');
     }
-
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
 }
 
 
 /* Maximum size of memory we allocate on the stack.  */
 #define MAX_STACK_ALLOC	65536
 
+/* Symbols which compare equal stay in symbol table order, so the
+   result doesn't depend on how they are sorted.  */
 static int
 sort_by_address (const void *p1, const void *p2)
 {
@@ -1146,28 +1293,103 @@ sort_by_address (const void *p1, const void *p2)
   int result = (s1->sym.st_value < s2->sym.st_value
 		? -1 : (s1->sym.st_value == s2->sym.st_value ? 0 : 1));
 
+  if (result == 0)
+    return s1->ndx < s2->ndx ? -1 : s1->ndx > s2->ndx;
   return reverse_sort ? -result : result;
 }
 
-static Elf *sort_by_name_elf;
-static size_t sort_by_name_ndx;
-
 static int
 sort_by_name (const void *p1, const void *p2)
 {
   GElf_SymX *s1 = (GElf_SymX *) p1;
   GElf_SymX *s2 = (GElf_SymX *) p2;
 
-  const char *n1 = elf_strptr (sort_by_name_elf, sort_by_name_ndx,
-			       s1->sym.st_name) ?: "";
-  const char *n2 = elf_strptr (sort_by_name_elf, sort_by_name_ndx,
-			       s2->sym.st_name) ?: "";
-
-  int result = strcmp (n1, n2);
+  int result = strcmp (s1->name ?: "", s2->name ?: "");
 
+  if (result == 0)
+    return s1->ndx < s2->ndx ? -1 : s1->ndx > s2->ndx;
   return reverse_sort ? -result : result;
 }
 
+/* For sorting on several threads: parts of the table are sorted on
+   their own and then merged in pairs until one part is left.  */
+struct sort_parts
+{
+  GElf_SymX *from;
+  GElf_SymX *to;
+  size_t *bounds;
+  size_t stride;
+  int (*compare) (const void *, const void *);
+};
+
+static void
+sort_part (void *arg, size_t i)
+{
+  struct sort_parts *sp = arg;
+  qsort (sp->from + sp->bounds[i], sp->bounds[i + 1] - sp->bounds[i],
+	 sizeof (GElf_SymX), sp->compare);
+}
+
+static void
+merge_parts (void *arg, size_t i)
+{
+  struct sort_parts *sp = arg;
+  size_t *bounds = &sp->bounds[2 * i * sp->stride];
+  GElf_SymX *l = sp->from + bounds[0];
+  GElf_SymX *lend = sp->from + bounds[sp->stride];
+  GElf_SymX *r = lend;
+  GElf_SymX *rend = sp->from + bounds[2 * sp->stride];
+  GElf_SymX *out = sp->to + bounds[0];
+
+  while (l < lend && r < rend)
+    *out++ = sp->compare (l, r) <= 0 ? *l++ : *r++;
+  memcpy (out, l, (lend - l) * sizeof (GElf_SymX));
+  memcpy (out + (lend - l), r, (rend - r) * sizeof (GElf_SymX));
+}
+
+static void
+sort_symbols (GElf_SymX *syms, size_t nsyms,
+	      int (*compare) (const void *, const void *))
+{
+  /* Not worth it for small tables.  */
+  size_t nparts = MIN (nthreads, nsyms / 4096);
+  if (nparts <= 1)
+    {
+      qsort (syms, nsyms, sizeof (GElf_SymX), compare);
+      return;
+    }
+
+  /* Use a power of two parts, the last ones might be empty.  */
+  size_t n = 1;
+  while (n < nparts)
+    n *= 2;
+  size_t partsize = (nsyms + n - 1) / n;
+  size_t bounds[n + 1];
+  for (size_t i = 0; i <= n; ++i)
+    bounds[i] = MIN (i * partsize, nsyms);
+
+  GElf_SymX *tmp = xmalloc (nsyms * sizeof (GElf_SymX));
+  struct sort_parts sp =
+    {
+      .from = syms,
+      .to = tmp,
+      .bounds = bounds,
+      .stride = 1,
+      .compare = compare
+    };
+  run_parallel (nthreads, n, sort_part, &sp);
+  for (; sp.stride < n; sp.stride *= 2)
+    {
+      run_parallel (nthreads, n / sp.stride / 2, merge_parts, &sp);
+      GElf_SymX *t = sp.from;
+      sp.from = sp.to;
+      sp.to = t;
+    }
+  if (sp.from != syms)
+    memcpy (syms, sp.from, nsyms * sizeof (GElf_SymX));
+  free (tmp);
+}
+
 /* Stub libdwfl callback, only the ELF handle already open is ever
    used.  Only used for finding the alternate debug file if the Dwarf
    comes from the main file.  We are not interested in separate
@@ -1337,12 +1559,6 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
     sym_mem = xmalloc (nentries * sizeof (GElf_SymX));
 
   /* Iterate over all symbols.  */
-#ifdef USE_DEMANGLE
-  size_t demangle_buffer_len = 0;
-  char *demangle_buffer = NULL;
-#endif
-  int longest_name = 4;
-  int longest_where = 4;
   size_t nentries_used = 0;
   for (size_t cnt = 0; cnt < nentries; ++cnt)
     {
@@ -1359,145 +1575,140 @@ show_symbols (int fd, Ebl *ebl, GElf_Ehdr *ehdr,
 	  || (hide_local && GELF_ST_BIND (sym->st_info) == STB_LOCAL))
 	continue;
 
+      const char *symstr = elf_strptr (ebl->elf, shdr->sh_link,
+				       sym->st_name);
+      if (symstr == NULL && format == format_sysv)
+	continue;
+
+      /* We use this entry.  */
+      sym_mem[nentries_used].ndx = cnt;
       sym_mem[nentries_used].where = "";
-      if (format == format_sysv)
-	{
-	  const char *symstr = elf_strptr (ebl->elf, shdr->sh_link,
-					   sym->st_name);
-	  if (symstr == NULL)
-	    continue;
+      sym_mem[nentries_used].name = symstr;
+      sym_mem[nentries_used].dmname = symstr;
+      ++nentries_used;
+    }
 
 #ifdef USE_DEMANGLE
-	  /* Demangle if necessary.  Require GNU v3 ABI by the "_Z" prefix.  */
-	  if (demangle && symstr[0] == '_' && symstr[1] == 'Z')
-	    {
-	      int status = -1;
-	      char *dmsymstr = __cxa_demangle (symstr, demangle_buffer,
-					       &demangle_buffer_len, &status);
-
-	      if (status == 0)
-		symstr = dmsymstr;
-	    }
+  if (demangle)
+    demangle_symbols (sym_mem, nentries_used);
 #endif
 
-	  longest_name = MAX ((size_t) longest_name, strlen (symstr));
+  /* Find the source lines for the SysV format.  */
+  int longest_name = 4;
+  int longest_where = 4;
+  if (format == format_sysv)
+    for (size_t cnt = 0; cnt < nentries_used; ++cnt)
+      {
+	GElf_Sym *sym = &sym_mem[cnt].sym;
+	const char *symstr = sym_mem[cnt].dmname;
 
-	  if (sym->st_shndx != SHN_UNDEF
-	      && GELF_ST_BIND (sym->st_info) != STB_LOCAL
-	      && global_root != NULL)
-	    {
-	      Dwarf_Global fake = { .name = symstr };
-	      Dwarf_Global **found = tfind (&fake, &global_root,
-					    global_compare);
-	      if (found != NULL)
-		{
-		  Dwarf_Die die_mem;
-		  Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset,
-						 &die_mem);
-
-		  Dwarf_Die cudie_mem;
-		  Dwarf_Die *cudie = NULL;
-
-		  Dwarf_Addr lowpc;
-		  Dwarf_Addr highpc;
-		  if (die != NULL
-		      && dwarf_lowpc (die, &lowpc) == 0
-		      && lowpc <= sym->st_value
-		      && dwarf_highpc (die, &highpc) == 0
-		      && highpc > sym->st_value)
-		    cudie = dwarf_offdie (dbg, (*found)->cu_offset,
-					  &cudie_mem);
-		  if (cudie != NULL)
-		    {
-		      Dwarf_Line *line = dwarf_getsrc_die (cudie,
-							   sym->st_value);
-		      if (line != NULL)
-			{
-			  /* We found the line.  */
-			  int lineno;
-			  (void) dwarf_lineno (line, &lineno);
-			  const char *file = dwarf_linesrc (line, NULL, NULL);
-			  file = (file != NULL) ? xbasename (file) : "???";
-			  int n;
-			  n = obstack_printf (&whereob, "%s:%d%c", file,
-					      lineno, '\0');
-			  sym_mem[nentries_used].where
-			    = obstack_finish (&whereob);
-
-			  /* The return value of obstack_print included the
-			     NUL byte, so subtract one.  */
-			  if (--n > (int) longest_where)
-			    longest_where = (size_t) n;
-			}
-		    }
-		}
-	    }
+	longest_name = MAX ((size_t) longest_name, strlen (symstr));
 
-	  /* Try to find the symbol among the local symbols.  */
-	  if (sym_mem[nentries_used].where[0] == '\0')
-	    {
-	      struct local_name fake =
-		{
-		  .name = symstr,
-		  .lowpc = sym->st_value,
-		  .highpc = sym->st_value,
-		};
-	      struct local_name **found = tfind (&fake, &local_root,
-						 local_compare);
-	      if (found != NULL)
-		{
-		  /* We found the line.  */
-		  int n = obstack_printf (&whereob, "%s:%" PRIu64 "%c",
-					  xbasename ((*found)->file),
-					  (*found)->lineno,
-					  '\0');
-		  sym_mem[nentries_used].where = obstack_finish (&whereob);
-
-		  /* The return value of obstack_print included the
-		     NUL byte, so subtract one.  */
-		  if (--n > (int) longest_where)
-		    longest_where = (size_t) n;
-		}
-	    }
-	}
+	if (sym->st_shndx != SHN_UNDEF
+	    && GELF_ST_BIND (sym->st_info) != STB_LOCAL
+	    && global_root != NULL)
+	  {
+	    Dwarf_Global fake = { .name = symstr };
+	    Dwarf_Global **found = tfind (&fake, &global_root,
+					  global_compare);
+	    if (found != NULL)
+	      {
+		Dwarf_Die die_mem;
+		Dwarf_Die *die = dwarf_offdie (dbg, (*found)->die_offset,
+					       &die_mem);
+
+		Dwarf_Die cudie_mem;
+		Dwarf_Die *cudie = NULL;
+
+		Dwarf_Addr lowpc;
+		Dwarf_Addr highpc;
+		if (die != NULL
+		    && dwarf_lowpc (die, &lowpc) == 0
+		    && lowpc <= sym->st_value
+		    && dwarf_highpc (die, &highpc) == 0
+		    && highpc > sym->st_value)
+		  cudie = dwarf_offdie (dbg, (*found)->cu_offset,
+					&cudie_mem);
+		if (cudie != NULL)
+		  {
+		    Dwarf_Line *line = dwarf_getsrc_die (cudie,
+							 sym->st_value);
+		    if (line != NULL)
+		      {
+			/* We found the line.  */
+			int lineno;
+			(void) dwarf_lineno (line, &lineno);
+			const char *file = dwarf_linesrc (line, NULL, NULL);
+			file = (file != NULL) ? xbasename (file) : "???";
+			int n;
+			n = obstack_printf (&whereob, "%s:%d%c", file,
+					    lineno, '\0');
+			sym_mem[cnt].where = obstack_finish (&whereob);
+
+			/* The return value of obstack_print included the
+			   NUL byte, so subtract one.  */
+			if (--n > (int) longest_where)
+			  longest_where = (size_t) n;
+		      }
+		  }
+	      }
+	  }
+
+	/* Try to find the symbol among the local symbols.  */
+	if (sym_mem[cnt].where[0] == '\0')
+	  {
+	    struct local_name fake =
+	      {
+		.name = symstr,
+		.lowpc = sym->st_value,
+		.highpc = sym->st_value,
+	      };
+	    struct local_name **found = tfind (&fake, &local_root,
+					       local_compare);
+	    if (found != NULL)
+	      {
+		/* We found the line.  */
+		int n = obstack_printf (&whereob, "%s:%" PRIu64 "%c",
+					xbasename ((*found)->file),
+					(*found)->lineno,
+					'\0');
+		sym_mem[cnt].where = obstack_finish (&whereob);
+
+		/* The return value of obstack_print included the
+		   NUL byte, so subtract one.  */
+		if (--n > (int) longest_where)
+		  longest_where = (size_t) n;
+	      }
+	  }
+      }
 
-      /* We use this entry.  */
-      ++nentries_used;
-    }
-#ifdef USE_DEMANGLE
-  free (demangle_buffer);
-#endif
   /* Now we know the exact number.  */
   size_t nentries_orig = nentries;
   nentries = nentries_used;
 
   /* Sort the entries according to the users wishes.  */
   if (sort == sort_name)
-    {
-      sort_by_name_elf = ebl->elf;
-      sort_by_name_ndx = shdr->sh_link;
-      qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_name);
-    }
+    sort_symbols (sym_mem, nentries, sort_by_name);
   else if (sort == sort_numeric)
-    qsort (sym_mem, nentries, sizeof (GElf_SymX), sort_by_address);
+    sort_symbols (sym_mem, nentries, sort_by_address);
 
   /* Finally print according to the users selection.  */
   switch (format)
     {
     case format_sysv:
-      show_symbols_sysv (ebl, shdr->sh_link, fullname, sym_mem, nentries,
+      show_symbols_sysv (ebl, fullname, sym_mem, nentries,
 			 longest_name, longest_where);
       break;
 
     case format_bsd:
-      show_symbols_bsd (ebl->elf, ehdr, shdr->sh_link, prefix, fname, fullname,
+      show_symbols_bsd (ebl->elf, ehdr, prefix, fname, fullname,
 			sym_mem, nentries);
       break;
 
     case format_posix:
     default:
       assert (format == format_posix);
-      show_symbols_posix (ebl->elf, ehdr, shdr->sh_link, prefix, fullname,
+      show_symbols_posix (ebl->elf, ehdr, prefix, fullname,
 			  sym_mem, nentries);
       break;
     }
@@ -34,6 +34,7 @@
 #include <libeu.h>
 #include <system.h>
 #include <color.h>
+#include <parallel.h>
 #include <printversion.h>
 #include "../libebl/libeblP.h"
 
@@ -45,6 +46,10 @@ ARGP_PROGRAM_VERSION_HOOK_DEF = print_version;
 ARGP_PROGRAM_BUG_ADDRESS_DEF = PACKAGE_BUGREPORT;
 
 
+/* Values for the parameters which have no short form.  */
+#define OPT_JOBS	0x100
+
+
 /* Definitions of arguments for argp functions.  */
 static const struct argp_option options[] =
 {
@@ -59,6 +64,10 @@ static const struct argp_option options[] =
   { "section", 'j', "NAME", 0,
     N_("Only display information for section NAME."), 0 },
 
+  { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
+  { "jobs", OPT_JOBS, "N", 0,
+    N_("Disassemble on N threads, or one per CPU if N is 0"), 0 },
+
   { NULL, 0, NULL, 0, NULL, 0 }
 };
 
@@ -125,6 +134,9 @@ static bool print_full_content;
 /* If true print disassembled output..  */
 static bool print_disasm;
 
+/* Number of threads to disassemble on.  */
+static unsigned int nthreads = 1;
+
 
 int
 main (int argc, char *argv[])
@@ -170,8 +182,7 @@ main (int argc, char *argv[])
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   /* True if any of the control options is set.  */
   static bool any_control_option;
@@ -211,6 +222,15 @@ parse_opt (int key, char *arg,
       any_control_option = true;
       break;
 
+    case OPT_JOBS:
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     case ARGP_KEY_FINI:
       if (! any_control_option)
 	{
@@ -621,8 +641,10 @@ struct disasm_info
   GElf_Addr addr;
   const uint8_t *cur;
   const uint8_t *last_end;
+  const uint8_t *stop;
   const char *address_color;
   const char *bytes_color;
+  FILE *out;
 };
 
 
@@ -633,22 +655,26 @@ disasm_output (char *buf, size_t buflen, void *arg)
 {
   struct disasm_info *info = (struct disasm_info *) arg;
 
+  /* The instruction at STOP is left to whoever goes on from there.  */
+  if (info->last_end >= info->stop)
+    return 1;
+
   if (info->address_color != NULL)
-    printf ("%s%8" PRIx64 "%s:   ",
-	    info->address_color, (uint64_t) info->addr, color_off);
+    fprintf (info->out, "%s%8" PRIx64 "%s:   ",
+	     info->address_color, (uint64_t) info->addr, color_off);
   else
-    printf ("%8" PRIx64 ":   ", (uint64_t) info->addr);
+    fprintf (info->out, "%8" PRIx64 ":   ", (uint64_t) info->addr);
 
   if (info->bytes_color != NULL)
-    fputs_unlocked (info->bytes_color, stdout);
+    fputs_unlocked (info->bytes_color, info->out);
   size_t cnt;
   for (cnt = 0; cnt < (size_t) MIN (info->cur - info->last_end, 8); ++cnt)
-    printf (" %02" PRIx8, info->last_end[cnt]);
+    fprintf (info->out, " %02" PRIx8, info->last_end[cnt]);
   if (info->bytes_color != NULL)
-    fputs_unlocked (color_off, stdout);
+    fputs_unlocked (color_off, info->out);
 
-  printf ("%*s %.*s\n",
-	  (int) (8 - cnt) * 3 + 1, "", (int) buflen, buf);
+  fprintf (info->out, "%*s %.*s\n",
+	   (int) (8 - cnt) * 3 + 1, "", (int) buflen, buf);
 
   info->addr += cnt;
 
@@ -657,18 +683,18 @@ disasm_output (char *buf, size_t buflen, void *arg)
   if (info->cur - info->last_end > 8)
     {
       if (info->address_color != NULL)
-	printf ("%s%8" PRIx64 "%s:   ",
-		info->address_color, (uint64_t) info->addr, color_off);
+	fprintf (info->out, "%s%8" PRIx64 "%s:   ",
+		 info->address_color, (uint64_t) info->addr, color_off);
       else
-	printf ("%8" PRIx64 ":   ", (uint64_t) info->addr);
+	fprintf (info->out, "%8" PRIx64 ":   ", (uint64_t) info->addr);
 
       if (info->bytes_color != NULL)
-	fputs_unlocked (info->bytes_color, stdout);
+	fputs_unlocked (info->bytes_color, info->out);
       for (; cnt < (size_t) (info->cur - info->last_end); ++cnt)
-	printf (" %02" PRIx8, info->last_end[cnt]);
+	fprintf (info->out, " %02" PRIx8, info->last_end[cnt]);
       if (info->bytes_color != NULL)
-	fputs_unlocked (color_off, stdout);
-      putchar_unlocked ('\n');
+	fputs_unlocked (color_off, info->out);
+      putc_unlocked ('\n', info->out);
       info->addr += info->cur - info->last_end - 8;
     }
 
@@ -678,6 +704,203 @@ disasm_output (char *buf, size_t buflen, void *arg)
 }
 
 
+/* Disassemble the section at INFO->cur from START on, up to the first
+   instruction which starts at or after STOP.  END is the end of the
+   section, so an instruction is decoded the same wherever the part
+   starts.  Return where the next instruction starts.  */
+static const uint8_t *
+disasm_part (DisasmCtx_t *ctx, const struct disasm_info *proto,
+	     const uint8_t *start, const uint8_t *stop, const uint8_t *end,
+	     const char *fmt, FILE *out)
+{
+  struct disasm_info info = *proto;
+  info.addr += start - proto->cur;
+  info.last_end = info.cur = start;
+  info.stop = stop;
+  info.out = out;
+
+  disasm_cb (ctx, &info.cur, end, info.addr, fmt, disasm_output, &info,
+	     NULL /* XXX */);
+
+  return info.last_end;
+}
+
+
+/* Sections at least twice this size are disassembled by several
+   threads, in parts of about this size.  */
+#define PART_SIZE (64 * 1024)
+
+struct disasm_part
+{
+  const uint8_t *start;
+  const uint8_t *stop;
+  const uint8_t *next;
+  char *out;
+  size_t out_len;
+};
+
+struct disasm_parts
+{
+  Ebl *ebl;
+  const struct disasm_info *proto;
+  const uint8_t *end;
+  const char *fmt;
+  struct disasm_part *parts;
+};
+
+static void
+run_disasm_part (void *arg, size_t i)
+{
+  struct disasm_parts *parts = (struct disasm_parts *) arg;
+  struct disasm_part *part = &parts->parts[i];
+
+  /* The context has no ELF file, libelf is not used from several
+     threads.  disasm_cb does not look up symbols in it anyway.  */
+  DisasmCtx_t *ctx = disasm_begin (parts->ebl, NULL, NULL);
+  if (ctx == NULL)
+    error_exit (0, _("cannot disassemble"));
+  FILE *out = open_memstream (&part->out, &part->out_len);
+  if (out == NULL)
+    error_exit (errno, _("cannot allocate memory"));
+
+  part->next = disasm_part (ctx, parts->proto, part->start, part->stop,
+			    parts->end, parts->fmt, out);
+
+  fclose (out);
+  (void) disasm_end (ctx);
+}
+
+
+static int
+compare_offsets (const void *p1, const void *p2)
+{
+  size_t o1 = *(const size_t *) p1;
+  size_t o2 = *(const size_t *) p2;
+  return (o1 > o2) - (o1 < o2);
+}
+
+/* Return the sorted offsets in section SCN, at ADDR with SIZE bytes,
+   at which a function starts according to the symbol table, or the
+   dynamic symbol table if there is none.  */
+static size_t *
+function_starts (Elf *elf, Elf_Scn *scn, GElf_Addr addr, size_t size,
+		 size_t *nstarts)
+{
+  Elf_Scn *symscn = NULL;
+  Elf_Scn *iscn = NULL;
+  while ((iscn = elf_nextscn (elf, iscn)) != NULL)
+    {
+      GElf_Shdr shdr_mem;
+      GElf_Shdr *shdr = gelf_getshdr (iscn, &shdr_mem);
+      if (shdr != NULL && shdr->sh_entsize != 0
+	  && (shdr->sh_type == SHT_SYMTAB
+	      || (shdr->sh_type == SHT_DYNSYM && symscn == NULL)))
+	symscn = iscn;
+    }
+
+  *nstarts = 0;
+  Elf_Data *data = symscn == NULL ? NULL : elf_getdata (symscn, NULL);
+  if (data == NULL)
+    return NULL;
+
+  Elf_Data *xndxdata = NULL;
+  int xndxscnidx = elf_scnshndx (symscn);
+  if (xndxscnidx > 0)
+    xndxdata = elf_getdata (elf_getscn (elf, xndxscnidx), NULL);
+
+  size_t nsyms = data->d_size / gelf_fsize (elf, ELF_T_SYM, 1, EV_CURRENT);
+  size_t scnndx = elf_ndxscn (scn);
+  size_t *starts = xmalloc (nsyms * sizeof *starts + 1);
+  size_t n = 0;
+  for (size_t cnt = 1; cnt < nsyms; ++cnt)
+    {
+      GElf_Sym sym_mem;
+      Elf32_Word xndx;
+      GElf_Sym *sym = gelf_getsymshndx (data, xndxdata, cnt, &sym_mem, &xndx);
+      if (sym == NULL || GELF_ST_TYPE (sym->st_info) != STT_FUNC
+	  || (sym->st_shndx == SHN_XINDEX ? xndx : sym->st_shndx) != scnndx
+	  || sym->st_value <= addr || sym->st_value - addr >= size)
+	continue;
+      starts[n++] = sym->st_value - addr;
+    }
+
+  qsort (starts, n, sizeof *starts, compare_offsets);
+  *nstarts = n;
+  return starts;
+}
+
+
+/* Disassemble a large section in parts which start at functions, on
+   several threads.  A part stops before the first instruction which
+   starts in the next part.  If that is not where the next part
+   starts, that part is disassembled again from there, so the listing
+   is the same as disassembling the whole section at once.  Return
+   false if the section is not split.  */
+static bool
+disasm_parallel (Ebl *ebl, DisasmCtx_t *ctx, Elf_Scn *scn,
+		 const struct disasm_info *proto, const uint8_t *end,
+		 const char *fmt)
+{
+  size_t size = end - proto->cur;
+  if (nthreads == 1 || size < 2 * PART_SIZE)
+    return false;
+
+  size_t nstarts;
+  size_t *starts = function_starts (ebl->elf, scn, proto->addr, size,
+				    &nstarts);
+  struct disasm_part *parts = xmalloc ((nstarts + 1) * sizeof *parts);
+  size_t nparts = 0;
+  size_t offset = 0;
+  for (size_t cnt = 0; cnt < nstarts; ++cnt)
+    if (starts[cnt] >= offset + PART_SIZE && size - starts[cnt] >= PART_SIZE)
+      {
+	parts[nparts].start = proto->cur + offset;
+	parts[nparts++].stop = proto->cur + starts[cnt];
+	offset = starts[cnt];
+      }
+  parts[nparts].start = proto->cur + offset;
+  parts[nparts++].stop = end;
+  free (starts);
+
+  if (nparts == 1)
+    {
+      free (parts);
+      return false;
+    }
+
+  struct disasm_parts args =
+    {
+      .ebl = ebl,
+      .proto = proto,
+      .end = end,
+      .fmt = fmt
+    };
+  const uint8_t *next = proto->cur;
+  for (size_t first = 0; first < nparts; first += 4 * nthreads)
+    {
+      size_t n = MIN (nparts - first, 4 * nthreads);
+      args.parts = &parts[first];
+      run_parallel (nthreads, n, run_disasm_part, &args);
+
+      for (size_t cnt = first; cnt < first + n; ++cnt)
+	{
+	  if (parts[cnt].start == next)
+	    {
+	      fwrite_unlocked (parts[cnt].out, 1, parts[cnt].out_len, stdout);
+	      next = parts[cnt].next;
+	    }
+	  else if (next < parts[cnt].stop)
+	    next = disasm_part (ctx, proto, next, parts[cnt].stop, end, fmt,
+				stdout);
+	  free (parts[cnt].out);
+	}
+    }
+
+  free (parts);
+  return true;
+}
+
+
 static int
 show_disasm (Ebl *ebl, const char *fname, uint32_t shstrndx)
 {
@@ -710,6 +933,8 @@ show_disasm (Ebl *ebl, const char *fname, uint32_t shstrndx)
 	  struct disasm_info info;
 	  info.addr = shdr->sh_addr;
 	  info.last_end = info.cur = data->d_buf;
+	  info.stop = info.cur + data->d_size;
+	  info.out = stdout;
 	  char *fmt;
 	  if (color_mode)
 	    {
@@ -732,8 +957,9 @@ show_disasm (Ebl *ebl, const char *fname, uint32_t shstrndx)
 	      fmt = "%7m %.1o,%.2o,%.3o,%.4o,%.5o%34a %l";
 	    }
 
-	  disasm_cb (ctx, &info.cur, info.cur + data->d_size, info.addr,
-		     fmt, disasm_output, &info, NULL /* XXX */);
+	  if (! disasm_parallel (ebl, ctx, scn, &info, info.stop, fmt))
+	    disasm_cb (ctx, &info.cur, info.stop, info.addr,
+		       fmt, disasm_output, &info, NULL /* XXX */);
 
 	  if (color_mode)
 	    free (fmt);
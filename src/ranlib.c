@@ -92,6 +92,10 @@ main (int argc, char *argv[])
   int remaining;
   (void) argp_parse (&argp, argc, argv, ARGP_IN_ORDER, &remaining, NULL);
 
+  /* Members read at the same time report their errors on their own.  */
+  if (arlib_jobs > 1)
+    (void) __fsetlocking (stderr, FSETLOCKING_INTERNAL);
+
   /* Tell the library which version we are expecting.  */
   (void) elf_version (EV_CURRENT);
 
@@ -189,7 +193,7 @@ handle_file (const char *fname)
 	}
       else
 	{
-	  arlib_add_symbols (elf, fname, arhdr->ar_name, cur_off);
+	  arlib_queue_symbols (arelf, elf, fname, arhdr->ar_name, cur_off);
 	  cur_off += (((arhdr->ar_size + 1) & ~((off_t) 1))
 		      + sizeof (struct ar_hdr));
 	}
@@ -7549,28 +7549,30 @@ print_debug_frame_section (Dwfl_Module *dwflmod, Ebl *ebl, GElf_Ehdr *ehdr,
 
 /* Returns the signedness (or false if it cannot be determined) and
    the byte size (or zero if it cannot be gotten) of the given DIE
-   DW_AT_type attribute.  Uses dwarf_peel_type and dwarf_aggregate_size.  */
+   DW_AT_type attribute.  Uses dwarf_type_info, which remembers the
+   types already seen.  */
 static void
 die_type_sign_bytes (Dwarf_Die *die, bool *is_signed, int *bytes)
 {
   Dwarf_Attribute attr;
   Dwarf_Die type;
+  Dwarf_Type_Info info;
 
   *bytes = 0;
   *is_signed = false;
 
-  if (dwarf_peel_type (dwarf_formref_die (dwarf_attr_integrate (die,
+  if (dwarf_type_info (dwarf_formref_die (dwarf_attr_integrate (die,
 								DW_AT_type,
 								&attr), &type),
-		       &type) == 0)
+		       &info) == 0)
     {
       Dwarf_Word val;
-      *is_signed = (dwarf_formudata (dwarf_attr (&type, DW_AT_encoding,
+      *is_signed = (dwarf_formudata (dwarf_attr (&info.type, DW_AT_encoding,
 						 &attr), &val) == 0
 		    && (val == DW_ATE_signed || val == DW_ATE_signed_char));
 
-      if (dwarf_aggregate_size (&type, &val) == 0)
-	*bytes = val;
+      if (info.has_size)
+	*bytes = info.size;
     }
 }
 
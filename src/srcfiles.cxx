@@ -32,6 +32,7 @@
 #endif
 
 #include "printversion.h"
+#include "parallel.h"
 #include <dwarf.h>
 #include <argp.h>
 #include <cstring>
@@ -49,8 +50,13 @@
 #include <fcntl.h>
 #include <iostream>
 #include <libdw.h>
+#include <libdwelf.h>
 #include <sstream>
 #include <vector>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 /* Libraries for use by the --zip option */
 #ifdef HAVE_LIBARCHIVE
@@ -89,6 +95,9 @@ static const struct argp_option options[] =
   { "verbose", 'v', NULL, 0,
     N_ ("Increase verbosity of logging messages."), 0 },
   { "cu-only", 'c', NULL, 0, N_("Only list the CU names."), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Search the CUs and fetch the source files on up to N threads, "
+       "or one per CPU if N is 0"), 0 },
   #ifdef HAVE_LIBARCHIVE
   { "zip", 'z', NULL, 0, N_("Zip all the source files and send to stdout. "
     "Cannot be used with the null option"), 0 },
@@ -124,6 +133,8 @@ static bool verbose;
 static bool null_arg;
 /* Only print compilation unit names.  */
 static bool CU_only;
+/* Number of threads to use.  */
+static unsigned int nthreads = 1;
 #ifdef HAVE_LIBARCHIVE
   /* Zip all the source files and send to stdout. */
   static bool zip;
@@ -140,8 +151,6 @@ static bool CU_only;
 static error_t
 parse_opt (int key, char *arg, struct argp_state *state)
 {
-  /* Suppress "unused parameter" warning.  */
-  (void)arg;
   switch (key)
     {
     case ARGP_KEY_INIT:
@@ -160,6 +169,15 @@ parse_opt (int key, char *arg, struct argp_state *state)
       CU_only = true;
       break;
 
+    case 'j':
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+        {
+          argp_error (state, _("invalid number of jobs '%s'"), arg);
+          return EINVAL;
+        }
+      break;
+
     #ifdef HAVE_LIBARCHIVE
       case 'z':
       zip = true;
@@ -213,6 +231,84 @@ string canonicalize_path(string path)
    listed.  */
 set<pair<string, Dwfl_Module*>> debug_sourcefiles;
 
+/* The source files of one CU.  CUs are searched by several threads, the
+   results are merged in the order of the CUs.  */
+struct cu_sourcefiles
+{
+  Dwarf_Die cudie;
+  vector<string> files;
+  ostringstream log;
+};
+
+static void
+collect_cu_sourcefiles (void *arg, size_t i)
+{
+  cu_sourcefiles &cu = static_cast<cu_sourcefiles *> (arg)[i];
+  Dwarf_Die *cudie = &cu.cudie;
+
+  const char *cuname = dwarf_diename (cudie) ?: "<unknown>";
+  Dwarf_Files *files;
+  size_t nfiles;
+  if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
+    return;
+
+  /* extract DW_AT_comp_dir to resolve relative file names.  */
+  const char *comp_dir = "";
+  const char *const *dirs;
+  size_t ndirs;
+
+  if (dwarf_getsrcdirs (files, &dirs, &ndirs) == 0 && dirs[0] != NULL)
+    comp_dir = dirs[0];
+  if (comp_dir == NULL)
+    comp_dir = "";
+
+  if (verbose)
+    cu.log << "searching for sources for cu=" << cuname
+           << " comp_dir=" << comp_dir << " #files=" << nfiles
+           << " #dirs=" << ndirs << endl;
+
+  if (comp_dir[0] == '\0' && cuname[0] != '/')
+    {
+      /* This is a common symptom for dwz-compressed debug files,
+         where the altdebug file cannot be resolved.  */
+      if (verbose)
+        cu.log << "skipping cu=" << cuname << " due to empty comp_dir" << endl;
+      return;
+    }
+  for (size_t f = 1; f < nfiles; ++f)
+    {
+      const char *hat;
+      if (CU_only)
+      {
+        if (strcmp(cuname, "<unknown>") == 0 || strcmp(cuname, "<artificial>") == 0 )
+          continue;
+        hat = cuname;
+      }
+      else
+        hat = dwarf_filesrc (files, f, NULL, NULL);
+
+      if (hat == NULL)
+        continue;
+
+      if (string(hat).find("<built-in>")
+          != string::npos) /* gcc intrinsics, don't bother recording */
+        continue;
+
+      string waldo;
+      if (hat[0] == '/') /* absolute */
+        waldo = (string (hat));
+      else if (comp_dir[0] != '\0') /* comp_dir relative */
+        waldo = (string (comp_dir) + string ("/") + string (hat));
+      else
+       {
+         if (verbose)
+          cu.log << "skipping file=" << hat << " due to empty comp_dir" << endl;
+         continue;
+       }
+      cu.files.push_back (canonicalize_path (waldo));
+    }
+}
+
 static int
 collect_sourcefiles (Dwfl_Module *dwflmod,
                      void **userdata __attribute__ ((unused)),
@@ -228,188 +324,258 @@ collect_sourcefiles (Dwfl_Module *dwflmod,
   Dwarf_Off offset = 0;
   Dwarf_Off old_offset;
   size_t hsize;
-  /* Traverse all CUs of this module.  */
+  /* Find all CUs of this module first, the units are read on demand
+     which can't be done by several threads.  */
+  vector<cu_sourcefiles> cus;
   while (dwarf_nextcu (dbg, old_offset = offset, &offset, &hsize, NULL, NULL, NULL) == 0)
     {
-      Dwarf_Die cudie_mem;
-      Dwarf_Die *cudie = dwarf_offdie (dbg, old_offset + hsize, &cudie_mem);
+      cus.emplace_back ();
+      if (dwarf_offdie (dbg, old_offset + hsize, &cus.back ().cudie) == NULL)
+        cus.pop_back ();
+    }
+  if (cus.empty ())
+    return DWARF_CB_OK;
+
+  /* Names in an alternate debug file are also only looked up on
+     demand.  */
+  const char *altname;
+  const void *altid;
+  unsigned int jobs = nthreads;
+  if (dwelf_dwarf_gnu_debugaltlink (dbg, &altname, &altid) != 0)
+    jobs = 1;
+  run_parallel (jobs, cus.size (), collect_cu_sourcefiles, cus.data ());
+
+  for (cu_sourcefiles &cu : cus)
+    {
+      if (verbose)
+        clog << cu.log.str ();
+      for (const string &file : cu.files)
+        debug_sourcefiles.insert (make_pair (file, dwflmod));
+    }
+  return DWARF_CB_OK;
+}
 
-      if (cudie == NULL)
-        continue;
+#ifdef HAVE_LIBARCHIVE
+/* A source file to add to the archive.  */
+struct source_file
+{
+  const string *path;
+  Dwfl_Module *dwflmod;
+  const unsigned char *bits;
+  int bits_length;
 
-      const char *cuname = dwarf_diename (cudie) ?: "<unknown>";
-      Dwarf_Files *files;
-      size_t nfiles;
-      if (dwarf_getsrcfiles (cudie, &files, &nfiles) != 0)
-        continue;
+  /* Set once it has been fetched.  */
+  int fd;
+  string error;
+};
 
-      /* extract DW_AT_comp_dir to resolve relative file names.  */
-      const char *comp_dir = "";
-      const char *const *dirs;
-      size_t ndirs;
+/* The source files are fetched by up to NTHREADS threads, each with its
+   own debuginfod client, and added to the archive by the main thread in
+   the order in which they arrive.  At most WINDOW files are being
+   fetched or wait to be added at the same time, which bounds the
+   number of open files.  */
+struct fetch_queue
+{
+  vector<source_file> files;
+  size_t window;
+
+  mutex lock;
+  /* Signaled when a file has been added.  */
+  condition_variable added;
+  /* Signaled when a file has been fetched.  */
+  condition_variable fetched;
+  size_t next = 0;
+  size_t in_flight = 0;
+  deque<source_file *> done;
+};
 
-      if (dwarf_getsrcdirs (files, &dirs, &ndirs) == 0 && dirs[0] != NULL)
-        comp_dir = dirs[0];
-      if (comp_dir == NULL)
-        comp_dir = "";
+static void
+fetch_file (source_file *file
+            #ifdef ENABLE_LIBDEBUGINFOD
+            , debuginfod_client *client
+            #endif
+            )
+{
+  file->fd = -1;
+  const std::string &file_path = *file->path;
 
-      if (verbose)
-        clog << "searching for sources for cu=" << cuname
-                  << " comp_dir=" << comp_dir << " #files=" << nfiles
-                  << " #dirs=" << ndirs << endl;
+  /* Attempt to query debuginfod client to fetch source files.  */
+  #ifdef ENABLE_LIBDEBUGINFOD
+  /* Ensure successful client and build ID acquisition.  */
+  if (client != NULL && file->bits_length > 0)
+  {
+    file->fd = debuginfod_find_source(client,
+                                      file->bits, file->bits_length,
+                                      file_path.c_str(), NULL);
+  }
+  else
+  {
+      if (client == NULL)
+          file->error = "Error: Failed to initialize debuginfod client.";
+      else
+          file->error = "Error: Invalid build ID length ("
+                        + to_string (file->bits_length) + ").";
+  }
 
-      if (comp_dir[0] == '\0' && cuname[0] != '/')
-        {
-          /* This is a common symptom for dwz-compressed debug files,
-             where the altdebug file cannot be resolved.  */
-          if (verbose)
-            clog << "skipping cu=" << cuname << " due to empty comp_dir" << endl;
-          continue;
-        }
-      for (size_t f = 1; f < nfiles; ++f)
-        {
-          const char *hat;
-          if (CU_only)
-          {
-            if (strcmp(cuname, "<unknown>") == 0 || strcmp(cuname, "<artificial>") == 0 )
-              continue;
-            hat = cuname;
-          }
-          else
-            hat = dwarf_filesrc (files, f, NULL, NULL);
+  if (no_backup)
+    return;
+  #endif
 
-          if (hat == NULL)
-            continue;
+  /* Files could not be located using debuginfod, search locally */
+  if (file->fd < 0)
+    file->fd = open(file_path.c_str(), O_RDONLY);
+}
 
-          if (string(hat).find("<built-in>")
-              != string::npos) /* gcc intrinsics, don't bother recording */
-            continue;
+static void
+fetch_files (fetch_queue *queue)
+{
+  #ifdef ENABLE_LIBDEBUGINFOD
+  /* A debuginfod client can only be used by one thread at a time.  */
+  unique_ptr <debuginfod_client, void (*)(debuginfod_client*)>
+    client (debuginfod_begin(), &debuginfod_end);
+  #endif
 
-          string waldo;
-          if (hat[0] == '/') /* absolute */
-            waldo = (string (hat));
-          else if (comp_dir[0] != '\0') /* comp_dir relative */
-            waldo = (string (comp_dir) + string ("/") + string (hat));
-          else
-           {
-             if (verbose)
-              clog << "skipping file=" << hat << " due to empty comp_dir" << endl;
-             continue;
-           }
-          waldo = canonicalize_path (waldo);
-          debug_sourcefiles.insert (make_pair(waldo, dwflmod));
-        }
-    }
-  return DWARF_CB_OK;
+  unique_lock<mutex> lock (queue->lock);
+  while (true)
+  {
+    queue->added.wait (lock, [queue] {
+      return (queue->next == queue->files.size ()
+              || queue->in_flight < queue->window);
+    });
+    if (queue->next == queue->files.size ())
+      break;
+
+    source_file *file = &queue->files[queue->next++];
+    queue->in_flight++;
+    lock.unlock ();
+    fetch_file (file
+                #ifdef ENABLE_LIBDEBUGINFOD
+                , client.get ()
+                #endif
+                );
+    lock.lock ();
+    queue->done.push_back (file);
+    queue->fetched.notify_one ();
+  }
 }
 
-#ifdef HAVE_LIBARCHIVE
-void zip_files()
+/* Add FILE to the archive and close it.  Returns false if it is missing.  */
+static bool
+add_file (struct archive *a, source_file *file)
 {
-  struct archive *a = archive_write_new();
   struct stat st;
   char buff[BUFFER_SIZE];
   int len;
-  int fd;
-  #ifdef ENABLE_LIBDEBUGINFOD
-  /* Initialize a debuginfod client.  */
-  static unique_ptr <debuginfod_client, void (*)(debuginfod_client*)>
-    client (debuginfod_begin(), &debuginfod_end);
-  #endif
+  int fd = file->fd;
+  const std::string &file_path = *file->path;
+
+  if (!file->error.empty ())
+    cerr << file->error << endl;
+
+  if (fd < 0)
+  {
+    if (verbose)
+      cerr << file_path << endl;
+    return false;
+  }
+
+  /* Create an entry for each file including file information to be placed in the zip.  */
+  if (fstat(fd, &st) == -1)
+  {
+    if (verbose)
+      cerr << file_path << endl;
+    if (verbose)
+      cerr << "Error: Failed to get file status for " << file_path << ": " << strerror(errno) << endl;
+    close(fd);
+    return false;
+  }
+  struct archive_entry *entry = archive_entry_new();
+  /* Removing first "/"" to make the path "relative" before zipping, otherwise warnings are raised when unzipping.  */
+  string entry_name = file_path.substr(file_path.find_first_of('/') + 1);
+  archive_entry_set_pathname(entry, entry_name.c_str());
+  archive_entry_copy_stat(entry, &st);
+  if (archive_write_header(a, entry) != ARCHIVE_OK)
+  {
+    if (verbose)
+      cerr << file_path << endl;
+    if (verbose)
+      cerr << "Error: failed to write header for " << file_path << ": " << archive_error_string(a) << endl;
+    archive_entry_free(entry);
+    close(fd);
+    return false;
+  }
+
+  /* Write the file to the zip.  */
+  len = read(fd, buff, sizeof(buff));
+  if (len == -1)
+  {
+    if (verbose)
+      cerr << file_path << endl;
+    if (verbose)
+      cerr << "Error: Failed to open file: " << file_path << ": " << strerror(errno) <<endl;
+    archive_entry_free(entry);
+    close(fd);
+    return false;
+  }
+  while (len > 0)
+  {
+    if (archive_write_data(a, buff, len) < ARCHIVE_OK)
+    {
+      if (verbose)
+        cerr << "Error: Failed to read from the file: " << file_path << ": " << strerror(errno) << endl;
+      break;
+    }
+    len = read(fd, buff, sizeof(buff));
+  }
+  close(fd);
+  archive_entry_free(entry);
+  return true;
+}
+
+void zip_files()
+{
+  struct archive *a = archive_write_new();
 
   archive_write_set_format_zip(a);
   archive_write_open_fd(a, STDOUT_FILENO);
 
-  int missing_files = 0;
+  fetch_queue queue;
+  queue.window = 2 * nthreads;
   for (const auto &pair : debug_sourcefiles)
   {
-    fd = -1;
-    const std::string &file_path = pair.first;
-
-    /* Attempt to query debuginfod client to fetch source files.  */
+    source_file file = { &pair.first, pair.second, NULL, 0, -1, string () };
     #ifdef ENABLE_LIBDEBUGINFOD
-    Dwfl_Module* dwflmod = pair.second;
     /* Obtain source file's build ID.  */
-    const unsigned char *bits;
     GElf_Addr vaddr;
-    int bits_length = dwfl_module_build_id(dwflmod, &bits, &vaddr);
-    /* Ensure successful client and build ID acquisition.  */
-    if (client.get() != NULL && bits_length > 0)
-    {
-      fd = debuginfod_find_source(client.get(),
-                                    bits, bits_length,
-                                    file_path.c_str(), NULL);
-    }
-    else
-    {
-        if (client.get() == NULL)
-            cerr << "Error: Failed to initialize debuginfod client." << endl;
-        else
-            cerr << "Error: Invalid build ID length (" << bits_length << ")." << endl;
-    }
+    file.bits_length = dwfl_module_build_id(file.dwflmod, &file.bits, &vaddr);
     #endif
+    queue.files.push_back (file);
+  }
 
-    if (!no_backup)
-      /* Files could not be located using debuginfod, search locally */
-      if (fd < 0)
-        fd = open(file_path.c_str(), O_RDONLY);
-    if (fd < 0)
-    {
-      if (verbose)
-        cerr << file_path << endl;
-      missing_files++;
-      continue;
-    }
+  vector<thread> threads;
+  for (unsigned int i = 0; i < nthreads && i < queue.files.size (); ++i)
+    threads.emplace_back (fetch_files, &queue);
 
-    /* Create an entry for each file including file information to be placed in the zip.  */
-    if (fstat(fd, &st) == -1)
-    {
-      if (verbose)
-        cerr << file_path << endl;
-      missing_files++;
-      if (verbose)
-        cerr << "Error: Failed to get file status for " << file_path << ": " << strerror(errno) << endl;
-      continue;
-    }
-    struct archive_entry *entry = archive_entry_new();
-    /* Removing first "/"" to make the path "relative" before zipping, otherwise warnings are raised when unzipping.  */
-    string entry_name = file_path.substr(file_path.find_first_of('/') + 1);
-    archive_entry_set_pathname(entry, entry_name.c_str());
-    archive_entry_copy_stat(entry, &st);
-    if (archive_write_header(a, entry) != ARCHIVE_OK)
-    {
-      if (verbose)
-        cerr << file_path << endl;
-      missing_files++;
-      if (verbose)
-        cerr << "Error: failed to write header for " << file_path << ": " << archive_error_string(a) << endl;
-      continue;
-    }
+  int missing_files = 0;
+  for (size_t i = 0; i < queue.files.size (); ++i)
+  {
+    unique_lock<mutex> lock (queue.lock);
+    queue.fetched.wait (lock, [&queue] { return !queue.done.empty (); });
+    source_file *file = queue.done.front ();
+    queue.done.pop_front ();
+    lock.unlock ();
 
-    /* Write the file to the zip.  */
-    len = read(fd, buff, sizeof(buff));
-    if (len == -1)
-    {
-      if (verbose)
-        cerr << file_path << endl;
+    if (!add_file (a, file))
       missing_files++;
-      if (verbose)
-        cerr << "Error: Failed to open file: " << file_path << ": " << strerror(errno) <<endl;
-      continue;
-    }
-    while (len > 0)
-    {
-      if (archive_write_data(a, buff, len) < ARCHIVE_OK)
-      {
-        if (verbose)
-          cerr << "Error: Failed to read from the file: " << file_path << ": " << strerror(errno) << endl;
-        break;
-      }
-      len = read(fd, buff, sizeof(buff));
-    }
-    close(fd);
-    archive_entry_free(entry);
+
+    lock.lock ();
+    queue.in_flight--;
+    queue.added.notify_all ();
   }
+
+  for (thread &t : threads)
+    t.join ();
+
   if (verbose && missing_files > 0 )
     cerr << missing_files << " file(s) listed above could not be found.  " << endl;
 
@@ -39,6 +39,7 @@
 #include <sys/stat.h>
 
 #include <libeu.h>
+#include <parallel.h>
 #include <system.h>
 #include <printversion.h>
 
@@ -73,6 +74,9 @@ Select character size and endianness: s = 7-bit, S = 8-bit, {b,l} = 16-bit, {B,L
   { "radix", 't', "{o,d,x}", 0,
     N_("Print location of the string in base 8, 10, or 16 respectively."), 0 },
   { NULL, 'o', NULL, 0, N_("Alias for --radix=o"), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Scan large files in N parts at the same time, or one per CPU if N is 0"),
+    0 },
 
   { NULL, 0, NULL, 0, N_("Miscellaneous:"), 0 },
   { NULL, 0, NULL, 0, NULL, 0 }
@@ -131,6 +135,18 @@ static enum
 /* Page size in use.  */
 static size_t ps;
 
+/* Number of threads to scan a large block with.  */
+static unsigned int nthreads = 1;
+
+/* Printable characters.  With multibyte characters this applies to
+   the character values up to 255, all others are not printable.  */
+static bool printable[256];
+
+/* True if the printable characters are exactly the tab and ASCII
+   0x20 to 0x7e, as in the C locale.  Only then they can be found with
+   the vector code in class_run.  */
+static bool printable_ascii;
+
 
 /* Mapped parts of the ELF file.  */
 static unsigned char *elfmap;
@@ -142,7 +158,7 @@ static off_t elfmap_off;
 int
 main (int argc, char *argv[])
 {
-  /* We use no threads.  */
+  /* Only the main thread reads and writes these.  */
   __fsetlocking (stdin, FSETLOCKING_BYCALLER);
   __fsetlocking (stdout, FSETLOCKING_BYCALLER);
 
@@ -165,6 +181,16 @@ main (int argc, char *argv[])
   /* Determine the page size.  We will likely need it a couple of times.  */
   ps = sysconf (_SC_PAGESIZE);
 
+  /* Look up the classes of the characters only once.  The 7-bit
+     restriction only applies to single byte characters.  */
+  printable_ascii = true;
+  for (unsigned int c = 0; c < 256; ++c)
+    {
+      printable[c] = ((isprint (c) || c == '\t')
+		      && (! char_7bit || bytes_per_char != 1 || c <= 127));
+      printable_ascii &= printable[c] == (c == '\t' || (c >= 0x20 && c < 0x7f));
+    }
+
   struct stat st;
   int result = 0;
   if (remaining == argc)
@@ -222,8 +248,7 @@ main (int argc, char *argv[])
 
 /* Handle program arguments.  */
 static error_t
-parse_opt (int key, char *arg,
-	   struct argp_state *state __attribute__ ((unused)))
+parse_opt (int key, char *arg, struct argp_state *state)
 {
   switch (key)
     {
@@ -270,6 +295,15 @@ parse_opt (int key, char *arg,
     case 'o':
       goto octfmt;
 
+    case 'j':
+      nthreads = parse_jobs (arg);
+      if (nthreads == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
     case 't':
       switch (arg[0])
 	{
@@ -308,35 +342,136 @@ parse_opt (int key, char *arg,
 }
 
 
+/* Where the compiler can build functions for other instruction sets,
+   build class_run_vec also for AVX2 and pick it when the CPU has it,
+   like gelf_xlate.c does, without an IFUNC.  Otherwise the vector
+   operations below use what the target has, like SSE2 or NEON.  */
+#if defined HAVE_TARGET_DISPATCH && (defined __x86_64__ || defined __i386__)
+# define STRINGS_AVX2	1
+#else
+# define STRINGS_AVX2	0
+#endif
+
+typedef unsigned char strings_v32 __attribute__ ((vector_size (32)));
+
+
+/* Return true if the character starting at BUF is printable.  */
+static inline bool
+char_printable (const unsigned char *buf)
+{
+  if (bytes_per_char == 1)
+    return printable[buf[0]];
+
+  uint32_t ch;
+  if (bytes_per_char == 2)
+    {
+      if (big_endian)
+	ch = buf[0] << 8 | buf[1];
+      else
+	ch = buf[1] << 8 | buf[0];
+    }
+  else
+    {
+      if (big_endian)
+	ch = buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
+      else
+	ch = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
+    }
+
+  return ch <= 255 && printable[ch];
+}
+
+
+/* Return the number of characters at BUF, at most N, which are all
+   printable if PRINT is true or all not printable otherwise.  A
+   character starts at every byte, all N of them must be complete.  */
+static inline __attribute__ ((always_inline)) size_t
+do_class_run_vec (const unsigned char *buf, size_t n, bool print)
+{
+  size_t i = 0;
+  if (printable_ascii)
+    {
+      /* Classify 32 characters at once.  A character is printable if
+	 the byte with its low bits is and all other bytes are zero.  */
+      const size_t low = big_endian ? bytes_per_char - 1 : 0;
+      for (; i + 32 <= n; i += 32)
+	{
+	  strings_v32 v;
+	  memcpy (&v, buf + i + low, sizeof v);
+	  strings_v32 m = (strings_v32) ((v - 0x20 < 0x5f) | (v == '\t'));
+	  for (size_t k = 0; k < bytes_per_char; ++k)
+	    if (k != low)
+	      {
+		memcpy (&v, buf + i + k, sizeof v);
+		m &= (strings_v32) (v == 0);
+	      }
+	  if (! print)
+	    m = ~m;
+
+	  uint64_t w[4];
+	  memcpy (w, &m, sizeof w);
+	  for (size_t j = 0; j < 4; ++j)
+	    if (w[j] != UINT64_MAX)
+#if __BYTE_ORDER == __LITTLE_ENDIAN
+	      return i + j * 8 + __builtin_ctzll (~w[j]) / 8;
+#else
+	      return i + j * 8 + __builtin_clzll (~w[j]) / 8;
+#endif
+	}
+    }
+
+  while (i < n && char_printable (buf + i) == print)
+    ++i;
+  return i;
+}
+
+#if STRINGS_AVX2
+static size_t __attribute__ ((target ("avx2")))
+class_run_vec_avx2 (const unsigned char *buf, size_t n, bool print)
+{
+  return do_class_run_vec (buf, n, print);
+}
+#endif
+
+static size_t
+class_run_vec (const unsigned char *buf, size_t n, bool print)
+{
+#if STRINGS_AVX2
+  if (__builtin_cpu_supports ("avx2"))
+    return class_run_vec_avx2 (buf, n, print);
+#endif
+  return do_class_run_vec (buf, n, print);
+}
+
+/* Like class_run_vec, but most runs are short.  Look at the first
+   few characters here before going to the blocks.  */
+static inline size_t
+class_run (const unsigned char *buf, size_t n, bool print)
+{
+  size_t i = 0;
+  while (i < n && char_printable (buf + i) == print)
+    if (++i == 16)
+      return i + class_run_vec (buf + i, n - i, print);
+  return i;
+}
+
+
 static void
 process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
-		  size_t len, char **unprinted)
+		  size_t len, char **unprinted, FILE *out)
 {
   size_t curlen = *unprinted == NULL ? 0 : strlen (*unprinted);
   const unsigned char *start = buf;
   while (len >= bytes_per_char)
     {
-      uint32_t ch;
-
-      if (bytes_per_char == 2)
-	{
-	  if (big_endian)
-	    ch = buf[0] << 8 | buf[1];
-	  else
-	    ch = buf[1] << 8 | buf[0];
-	}
-      else
-	{
-	  if (big_endian)
-	    ch = buf[0] << 24 | buf[1] << 16 | buf[2] << 8 | buf[3];
-	  else
-	    ch = buf[3] << 24 | buf[2] << 16 | buf[1] << 8 | buf[0];
-	}
-
-      if (ch <= 255 && (isprint (ch) || ch == '\t'))
+      if (char_printable (buf))
 	{
-	  ++buf;
-	  ++curlen;
+	  /* Take all of the run of printable characters.  */
+	  size_t n = class_run (buf, len - bytes_per_char + 1, true);
+	  buf += n;
+	  curlen += n;
+	  len -= n;
+	  continue;
 	}
       else
 	{
@@ -345,19 +480,19 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 	      /* We found a match.  */
 	      if (unlikely (fname != NULL))
 		{
-		  fputs_unlocked (fname, stdout);
-		  fputs_unlocked (": ", stdout);
+		  fputs_unlocked (fname, out);
+		  fputs_unlocked (": ", out);
 		}
 
 	      if (unlikely (radix != radix_none))
-		printf ((radix == radix_octal ? "%7" PRIo64 " "
-			 : (radix == radix_decimal ? "%7" PRId64 " "
-			    : "%7" PRIx64 " ")),
-			(int64_t) to - len - (buf - start));
+		fprintf (out, (radix == radix_octal ? "%7" PRIo64 " "
+			       : (radix == radix_decimal ? "%7" PRId64 " "
+				  : "%7" PRIx64 " ")),
+			 (int64_t) to - len - (buf - start));
 
 	      if (unlikely (*unprinted != NULL))
 		{
-		  fputs_unlocked (*unprinted, stdout);
+		  fputs_unlocked (*unprinted, out);
 		  free (*unprinted);
 		  *unprinted = NULL;
 		}
@@ -366,8 +501,8 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 		 assume the file data is encoded in UCS-2/UTF-16 or
 		 UCS-4/UTF-32 respectively we could convert the string.
 		 But there is no such guarantee.  */
-	      fwrite_unlocked (start, 1, buf - start, stdout);
-	      putc_unlocked ('\n', stdout);
+	      fwrite_unlocked (start, 1, buf - start, out);
+	      putc_unlocked ('\n', out);
 	    }
 
 	  start = ++buf;
@@ -375,6 +510,14 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 
 	  if (len <= min_len)
 	    break;
+
+	  /* Skip the following characters which are not printable
+	     either, but stop where the loop would.  */
+	  size_t n = class_run (buf, len - 1 - MAX (min_len,
+						    bytes_per_char - 1),
+				false);
+	  start = buf += n;
+	  len -= n;
 	}
 
       --len;
@@ -387,13 +530,13 @@ process_chunk_mb (const char *fname, const unsigned char *buf, off_t to,
 
 static void
 process_chunk (const char *fname, const unsigned char *buf, off_t to,
-	       size_t len, char **unprinted)
+	       size_t len, char **unprinted, FILE *out)
 {
   /* We are not going to slow the check down for the 2- and 4-byte
      encodings.  Handle them special.  */
   if (unlikely (bytes_per_char != 1))
     {
-      process_chunk_mb (fname, buf, to, len, unprinted);
+      process_chunk_mb (fname, buf, to, len, unprinted, out);
       return;
     }
 
@@ -401,10 +544,14 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
   const unsigned char *start = buf;
   while (len > 0)
     {
-      if ((isprint (*buf) || *buf == '\t') && (! char_7bit || *buf <= 127))
+      if (printable[*buf])
 	{
-	  ++buf;
-	  ++curlen;
+	  /* Take all of the run of printable characters.  */
+	  size_t n = class_run (buf, len, true);
+	  buf += n;
+	  curlen += n;
+	  len -= n;
+	  continue;
 	}
       else
 	{
@@ -413,24 +560,24 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
 	      /* We found a match.  */
 	      if (likely (fname != NULL))
 		{
-		  fputs_unlocked (fname, stdout);
-		  fputs_unlocked (": ", stdout);
+		  fputs_unlocked (fname, out);
+		  fputs_unlocked (": ", out);
 		}
 
 	      if (likely (radix != radix_none))
-		printf ((radix == radix_octal ? "%7" PRIo64 " "
-			 : (radix == radix_decimal ? "%7" PRId64 " "
-			    : "%7" PRIx64 " ")),
-			(int64_t) to - len - (buf - start));
+		fprintf (out, (radix == radix_octal ? "%7" PRIo64 " "
+			       : (radix == radix_decimal ? "%7" PRId64 " "
+				  : "%7" PRIx64 " ")),
+			 (int64_t) to - len - (buf - start));
 
 	      if (unlikely (*unprinted != NULL))
 		{
-		  fputs_unlocked (*unprinted, stdout);
+		  fputs_unlocked (*unprinted, out);
 		  free (*unprinted);
 		  *unprinted = NULL;
 		}
-	      fwrite_unlocked (start, 1, buf - start, stdout);
-	      putc_unlocked ('\n', stdout);
+	      fwrite_unlocked (start, 1, buf - start, out);
+	      putc_unlocked ('\n', out);
 	    }
 
 	  start = ++buf;
@@ -438,6 +585,12 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
 
 	  if (len <= min_len)
 	    break;
+
+	  /* Skip the following characters which are not printable
+	     either, but stop where the loop would.  */
+	  size_t n = class_run (buf, len - 1 - min_len, false);
+	  start = buf += n;
+	  len -= n;
 	}
 
       --len;
@@ -448,6 +601,97 @@ process_chunk (const char *fname, const unsigned char *buf, off_t to,
 }
 
 
+/* Blocks at least twice this size are scanned by several threads, in
+   parts of about this size.  */
+#define PART_SIZE (8 * 1024 * 1024)
+
+struct chunk_part
+{
+  const char *fname;
+  const unsigned char *buf;
+  off_t to;
+  size_t len;
+  char *unprinted;
+  char *out;
+  size_t out_len;
+};
+
+static void
+run_chunk_part (void *arg, size_t i)
+{
+  struct chunk_part *part = (struct chunk_part *) arg + i;
+  FILE *out = open_memstream (&part->out, &part->out_len);
+  if (out == NULL)
+    error_exit (errno, _("cannot allocate memory"));
+  process_chunk (part->fname, part->buf, part->to, part->len,
+		 &part->unprinted, out);
+  fclose (out);
+}
+
+/* Like process_chunk, printing to stdout.  If there is nothing left
+   over from before, a large block is split into parts which are
+   scanned at the same time.  All parts but the last end with a
+   character which is not printable and the next part starts right
+   after it, so the strings found are the same as for the whole
+   block.  With multibyte characters the parts overlap.  */
+static void
+process_block (const char *fname, const unsigned char *buf, off_t to,
+	       size_t len, char **unprinted)
+{
+  if (nthreads == 1 || *unprinted != NULL || len < 2 * PART_SIZE)
+    {
+      process_chunk (fname, buf, to, len, unprinted, stdout);
+      return;
+    }
+
+  /* The last character starts before this.  */
+  const size_t nchars = len - bytes_per_char + 1;
+  struct chunk_part *parts = xmalloc (nthreads * sizeof *parts);
+  size_t begin = 0;
+  while (begin < len)
+    {
+      size_t nparts = 0;
+      while (nparts < nthreads && begin < len)
+	{
+	  size_t end = len;
+	  size_t next = len;
+	  if (len - begin >= 2 * PART_SIZE)
+	    {
+	      size_t n = begin + PART_SIZE;
+	      n += class_run (buf + n, nchars - n, true);
+	      if (n < nchars)
+		{
+		  end = n + bytes_per_char;
+		  next = n + 1;
+		}
+	    }
+
+	  parts[nparts++] = (struct chunk_part)
+	    {
+	      .fname = fname,
+	      .buf = buf + begin,
+	      .to = to - (off_t) (len - end),
+	      .len = end - begin
+	    };
+	  begin = next;
+	}
+
+      run_parallel (nthreads, nparts, run_chunk_part, parts);
+
+      for (size_t i = 0; i < nparts; ++i)
+	{
+	  fwrite_unlocked (parts[i].out, 1, parts[i].out_len, stdout);
+	  free (parts[i].out);
+	}
+
+      /* Only the last part can end in the middle of a string.  */
+      *unprinted = parts[nparts - 1].unprinted;
+    }
+
+  free (parts);
+}
+
+
 /* Map a file in as large chunks as possible.  */
 static void *
 map_file (int fd, off_t start_off, off_t fdlen, size_t *map_sizep)
@@ -535,7 +779,7 @@ read_block_no_mmap (int fd, const char *fname, off_t from, off_t fdlen)
 	  /* We only use complete characters.  */
 	  nb &= ~(bytes_per_char - 1);
 
-	  process_chunk (fname, buf, from + nb, nb, &unprinted);
+	  process_chunk (fname, buf, from + nb, nb, &unprinted, stdout);
 
 	  /* If the last bytes of the buffer (modulo the character
 	     size) have been printed we are not copying them.  */
@@ -609,7 +853,7 @@ read_block (int fd, const char *fname, off_t fdlen, off_t from, off_t to)
       && from < (off_t) (elfmap_off + elfmap_size))
     /* There are at least a few bytes in this mapping which we can
        use.  */
-    process_chunk (fname, elfmap_base + (from - elfmap_off),
+    process_block (fname, elfmap_base + (from - elfmap_off),
 		   MIN (to, (off_t) (elfmap_off + elfmap_size)),
 		   MIN (to, (off_t) (elfmap_off + elfmap_size)) - from,
 		   &unprinted);
@@ -664,7 +908,7 @@ read_block (int fd, const char *fname, off_t fdlen, off_t from, off_t to)
 	    error_exit (errno, _("re-mmap failed"));
 	  elfmap_off = handled_to;
 
-	  process_chunk (fname, remap_base - to_keep,
+	  process_block (fname, remap_base - to_keep,
 			 elfmap_off + (read_now & ~(bytes_per_char - 1)),
 			 to_keep + (read_now & ~(bytes_per_char - 1)),
 			 &unprinted);
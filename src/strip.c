@@ -37,6 +37,7 @@
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/wait.h>
 
 #include <elf-knowledge.h>
 #include <libebl.h>
@@ -44,6 +45,7 @@
 #include <libeu.h>
 #include <system.h>
 #include <printversion.h>
+#include <parallel.h>
 
 typedef uint8_t GElf_Byte;
 
@@ -70,6 +72,10 @@ static const struct argp_option options[] =
   { "output", 'o', "FILE", 0, N_("Place stripped output into FILE"), 0 },
   { NULL, 'f', "FILE", 0, N_("Extract the removed sections into FILE"), 0 },
   { NULL, 'F', "FILE", 0, N_("Embed name FILE instead of -f argument"), 0 },
+  { "jobs", 'j', "N", 0,
+    N_("Strip up to N files at the same time, or one per CPU if N is 0.  "
+       "With several files, each -o, -f and -F applies to the next FILE "
+       "and must be given for every FILE."), 0 },
 
   { NULL, 0, NULL, 0, N_("Output options:"), 0 },
   { "strip-all", 's', NULL, OPTION_HIDDEN, NULL, 0 },
@@ -143,6 +149,25 @@ static const char *debug_fname;
 /* Name to pretend the debug output file has.  */
 static const char *debug_fname_embed;
 
+/* A file to strip, with the output names given for it.  */
+struct strip_job
+{
+  const char *fname;
+  const char *output_fname;
+  const char *debug_fname;
+  const char *debug_fname_embed;
+};
+
+/* The files to strip, in command line order.  */
+static struct strip_job *jobs;
+static size_t njobs;
+
+/* The -o, -f and -F options seen after the last file.  */
+static struct strip_job next_job;
+
+/* Number of files stripped at the same time.  */
+static unsigned int nprocs = 1;
+
 /* If true output files shall have same date as the input file.  */
 static bool preserve_dates;
 
@@ -217,12 +242,67 @@ section_name_matches (struct section_pattern *patterns, const char *name)
 }
 
 
-int
-main (int argc, char *argv[])
+/* Strip the file of job I.  */
+static int
+run_job (size_t i)
+{
+  output_fname = jobs[i].output_fname;
+  debug_fname = jobs[i].debug_fname;
+  debug_fname_embed = jobs[i].debug_fname_embed;
+  return process_file (jobs[i].fname);
+}
+
+
+/* Strip all files, up to NPROCS at the same time.  Each file is
+   stripped in its own process, because many errors end the process
+   right away.  That must not stop another file in the middle of being
+   rewritten, or leave its temporary debug file behind.  */
+static int
+run_jobs (void)
 {
-  int remaining;
   int result = 0;
+  if (nprocs == 1 || njobs == 1)
+    {
+      for (size_t i = 0; i < njobs; ++i)
+	result |= run_job (i);
+      return result;
+    }
 
+  fflush (NULL);
+  size_t next = 0;
+  unsigned int running = 0;
+  while (next < njobs || running > 0)
+    {
+      if (next < njobs && running < nprocs)
+	{
+	  pid_t pid = fork ();
+	  if (pid == 0)
+	    exit (run_job (next));
+	  if (pid > 0)
+	    {
+	      ++next;
+	      ++running;
+	      continue;
+	    }
+	  if (running == 0)
+	    error_exit (errno, _("cannot create process"));
+	}
+
+      int status;
+      if (wait (&status) < 0)
+	error_exit (errno, _("cannot wait for process"));
+      --running;
+      if (! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+	result = 1;
+    }
+
+  return result;
+}
+
+
+int
+main (int argc, char *argv[])
+{
   /* We use no threads here which can interfere with handling a stream.  */
   __fsetlocking (stdin, FSETLOCKING_BYCALLER);
   __fsetlocking (stdout, FSETLOCKING_BYCALLER);
@@ -237,39 +317,71 @@ main (int argc, char *argv[])
   /* Initialize the message catalog.  */
   textdomain (PACKAGE_TARNAME);
 
-  /* Parse and process arguments.  */
-  if (argp_parse (&argp, argc, argv, 0, &remaining, NULL) != 0)
+  /* Parse and process arguments.  The files are collected in order,
+     each with the output names given before it.  */
+  if (argp_parse (&argp, argc, argv, ARGP_IN_ORDER, NULL, NULL) != 0)
     return EXIT_FAILURE;
 
-  if (reloc_debug && debug_fname == NULL)
-    error_exit (0, _("--reloc-debug-sections used without -f"));
-
-  if (reloc_debug_only &&
-      (debug_fname != NULL || remove_secs != NULL
-       || remove_comment == true || remove_debug == true))
-    error_exit (0,
-		_("--reloc-debug-sections-only incompatible with -f, -g, --remove-comment and --remove-section"));
-
-  /* Tell the library which version we are expecting.  */
-  elf_version (EV_CURRENT);
+  if (njobs == 0)
+    {
+      /* The user didn't specify a name so we use a.out.  */
+      next_job.fname = "a.out";
+      jobs = xmalloc (sizeof *jobs);
+      jobs[njobs++] = next_job;
+    }
+  else if (next_job.output_fname != NULL || next_job.debug_fname != NULL
+	   || next_job.debug_fname_embed != NULL)
+    {
+      /* For a single file the options can also follow it.  */
+      if (njobs > 1)
+	error_exit (0, _("Only one input file allowed together with '-o' and '-f'"));
+      if ((next_job.output_fname != NULL && jobs[0].output_fname != NULL)
+	  || (next_job.debug_fname != NULL && jobs[0].debug_fname != NULL)
+	  || (next_job.debug_fname_embed != NULL
+	      && jobs[0].debug_fname_embed != NULL))
+	error_exit (0, _("-o, -f or -F option specified twice"));
+      jobs[0].output_fname = jobs[0].output_fname ?: next_job.output_fname;
+      jobs[0].debug_fname = jobs[0].debug_fname ?: next_job.debug_fname;
+      jobs[0].debug_fname_embed = (jobs[0].debug_fname_embed
+				   ?: next_job.debug_fname_embed);
+    }
 
-  if (remaining == argc)
-    /* The user didn't specify a name so we use a.out.  */
-    result = process_file ("a.out");
-  else
+  /* With several files, the names must be given for all of them, or
+     else for none and they apply to the single file.  */
+  if (njobs > 1)
     {
-      /* If we have seen the '-o' or '-f' option there must be exactly one
-	 input file.  */
-      if ((output_fname != NULL || debug_fname != NULL)
-	  && remaining + 1 < argc)
+      size_t noutput = 0, ndebug = 0, nembed = 0;
+      for (size_t i = 0; i < njobs; ++i)
+	{
+	  noutput += jobs[i].output_fname != NULL;
+	  ndebug += jobs[i].debug_fname != NULL;
+	  nembed += jobs[i].debug_fname_embed != NULL;
+	}
+      if ((noutput != 0 && noutput != njobs)
+	  || (ndebug != 0 && ndebug != njobs)
+	  || (nembed != 0 && nembed != njobs))
 	error_exit (0, _("Only one input file allowed together with '-o' and '-f'"));
+    }
 
-      /* Process all the remaining files.  */
-      do
-	result |= process_file (argv[remaining]);
-      while (++remaining < argc);
+  for (size_t i = 0; i < njobs; ++i)
+    {
+      if (reloc_debug && jobs[i].debug_fname == NULL)
+	error_exit (0, _("--reloc-debug-sections used without -f"));
+
+      if (reloc_debug_only &&
+	  (jobs[i].debug_fname != NULL || remove_secs != NULL
+	   || remove_comment == true || remove_debug == true))
+	error_exit (0,
+		    _("--reloc-debug-sections-only incompatible with -f, -g, --remove-comment and --remove-section"));
     }
 
+  /* Tell the library which version we are expecting.  */
+  elf_version (EV_CURRENT);
+
+  /* Process all the files.  Each reports its own errors.  */
+  int result = run_jobs ();
+
+  free (jobs);
   free_patterns ();
   return result;
 }
@@ -282,30 +394,46 @@ parse_opt (int key, char *arg, struct argp_state *state)
   switch (key)
     {
     case 'f':
-      if (debug_fname != NULL)
+      if (next_job.debug_fname != NULL)
 	{
 	  error (0, 0, _("-f option specified twice"));
 	  return EINVAL;
 	}
-      debug_fname = arg;
+      next_job.debug_fname = arg;
       break;
 
     case 'F':
-      if (debug_fname_embed != NULL)
+      if (next_job.debug_fname_embed != NULL)
 	{
 	  error (0, 0, _("-F option specified twice"));
 	  return EINVAL;
 	}
-      debug_fname_embed = arg;
+      next_job.debug_fname_embed = arg;
       break;
 
     case 'o':
-      if (output_fname != NULL)
+      if (next_job.output_fname != NULL)
 	{
 	  error (0, 0, _("-o option specified twice"));
 	  return EINVAL;
 	}
-      output_fname = arg;
+      next_job.output_fname = arg;
+      break;
+
+    case 'j':
+      nprocs = parse_jobs (arg);
+      if (nprocs == 0)
+	{
+	  argp_error (state, _("invalid number of jobs '%s'"), arg);
+	  return EINVAL;
+	}
+      break;
+
+    case ARGP_KEY_ARG:
+      next_job.fname = arg;
+      jobs = xrealloc (jobs, (njobs + 1) * sizeof *jobs);
+      jobs[njobs++] = next_job;
+      memset (&next_job, '\0', sizeof next_job);
       break;
 
     case 'p':
@@ -1031,6 +1159,9 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
     }
   memcpy (cp, fname, fname_len);
 
+  /* Unchanged sections might be copied straight from the input file.  */
+  const int input_fd = fd;
+
   /* If we are not replacing the input file open a new file here.  */
   if (output_fname != NULL)
     {
@@ -1647,6 +1778,36 @@ handle_elf (int fd, Elf *elf, const char *prefix, const char *fname,
 	    /* There cannot be any overflows.  */
 	    INTERNAL_ERROR (fname);
 
+	  /* Sections nobody looked at so far which only go to the debug
+	     file are not changed anymore.  Let libelf copy them straight
+	     from the old file instead of reading them in, unless their
+	     relocations get resolved.  */
+	  GElf_Xword align = shdr_info[cnt].shdr.sh_addralign ?: 1;
+	  if (! discard_section
+	      && shdr_info[cnt].idx == 0
+	      && shdr_info[cnt].data == NULL
+	      && shdr_info[cnt].shdr.sh_type == SHT_PROGBITS
+	      && (shdr_info[cnt].shdr.sh_flags & SHF_COMPRESSED) == 0
+	      && powerof2 (align)
+	      && ! (reloc_debug && ehdr->e_type == ET_REL))
+	    {
+	      Elf_Data *debugdata = elf_newdata (scn);
+	      if (debugdata == NULL)
+		INTERNAL_ERROR (fname);
+	      debugdata->d_type = ELF_T_BYTE;
+	      debugdata->d_size = shdr_info[cnt].shdr.sh_size;
+	      debugdata->d_align = align;
+	      /* The offset in shdr_info is that in the new file.  */
+	      GElf_Shdr oldshdr_mem;
+	      GElf_Shdr *oldshdr = gelf_getshdr (shdr_info[cnt].scn,
+						 &oldshdr_mem);
+	      if (oldshdr == NULL
+		  || elf_setdata_file (debugdata, input_fd,
+				       elf_getbase (elf) + oldshdr->sh_offset) != 0)
+		INTERNAL_ERROR (fname);
+	      continue;
+	    }
+
 	  /* Get the data from the old file if necessary. */
 	  if (shdr_info[cnt].data == NULL)
 	    {
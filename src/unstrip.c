@@ -444,10 +444,53 @@ adjust_reloc (GElf_Xword *info,
     }
 }
 
+/* Update the symbol indices of NENT relocations right in the buffer
+   of DATA, rather than converting each with gelf_getrel and
+   gelf_update_rel.  Return false if DATA isn't such an array.  */
+static bool
+adjust_relocs_in_place (Elf_Data *data, int elfclass, bool rela,
+			size_t nent, size_t map[], size_t map_size)
+{
+  if (data->d_type != (rela ? ELF_T_RELA : ELF_T_REL))
+    return false;
+
+#define ADJUST_RELOCS(Rel, R_SYM, R_TYPE, R_INFO)			      \
+  {									      \
+    if (data->d_size / sizeof (Rel) < nent)				      \
+      return false;							      \
+    Rel *rel = data->d_buf;						      \
+    for (size_t i = 0; i < nent; ++i)					      \
+      {									      \
+	size_t ndx = R_SYM (rel[i].r_info);				      \
+	if (ndx != STN_UNDEF)						      \
+	  {								      \
+	    if (ndx > map_size)						      \
+	      error_exit (0, "bad symbol ndx section");			      \
+	    rel[i].r_info = R_INFO (map[ndx - 1], R_TYPE (rel[i].r_info));  \
+	  }								      \
+      }									      \
+  }
+
+  if (elfclass == ELFCLASS32 && rela)
+    ADJUST_RELOCS (Elf32_Rela, ELF32_R_SYM, ELF32_R_TYPE, ELF32_R_INFO)
+  else if (elfclass == ELFCLASS32)
+    ADJUST_RELOCS (Elf32_Rel, ELF32_R_SYM, ELF32_R_TYPE, ELF32_R_INFO)
+  else if (rela)
+    ADJUST_RELOCS (Elf64_Rela, ELF64_R_SYM, ELF64_R_TYPE, ELF64_R_INFO)
+  else
+    ADJUST_RELOCS (Elf64_Rel, ELF64_R_SYM, ELF64_R_TYPE, ELF64_R_INFO)
+
+#undef ADJUST_RELOCS
+
+  elf_flagdata (data, ELF_C_SET, ELF_F_DIRTY);
+  return true;
+}
+
 /* Update relocation sections using the symbol table.  */
 static void
 adjust_relocs (Elf_Scn *outscn, Elf_Scn *inscn, const GElf_Shdr *shdr,
-	       size_t map[], size_t map_size, const GElf_Shdr *symshdr)
+	       int elfclass, size_t map[], size_t map_size,
+	       const GElf_Shdr *symshdr)
 {
   Elf_Data *data = elf_getdata (outscn, NULL);
 
@@ -457,6 +500,11 @@ adjust_relocs (Elf_Scn *outscn, Elf_Scn *inscn, const GElf_Shdr *shdr,
       if (shdr->sh_entsize == 0)
 	error_exit (0, "REL section cannot have zero sh_entsize");
 
+      if (adjust_relocs_in_place (data, elfclass, false,
+				  shdr->sh_size / shdr->sh_entsize,
+				  map, map_size))
+	break;
+
       for (size_t i = 0; i < shdr->sh_size / shdr->sh_entsize; ++i)
 	{
 	  GElf_Rel rel_mem;
@@ -472,6 +520,11 @@ adjust_relocs (Elf_Scn *outscn, Elf_Scn *inscn, const GElf_Shdr *shdr,
       if (shdr->sh_entsize == 0)
 	error_exit (0, "RELA section cannot have zero sh_entsize");
 
+      if (adjust_relocs_in_place (data, elfclass, true,
+				  shdr->sh_size / shdr->sh_entsize,
+				  map, map_size))
+	break;
+
       for (size_t i = 0; i < shdr->sh_size / shdr->sh_entsize; ++i)
 	{
 	  GElf_Rela rela_mem;
@@ -622,7 +675,8 @@ adjust_all_relocs (Elf *elf, Elf_Scn *symtab, const GElf_Shdr *symshdr,
 	ELF_CHECK (shdr != NULL, _("cannot get section header: %s"));
 
 	if (shdr->sh_type != SHT_NOBITS && shdr->sh_link == new_sh_link)
-	  adjust_relocs (scn, scn, shdr, map, map_size, symshdr);
+	  adjust_relocs (scn, scn, shdr, gelf_getclass (elf),
+			 map, map_size, symshdr);
       }
 }
 
@@ -731,6 +785,16 @@ check_symtab_section_symbols (Elf *elf, bool rel, Elf_Scn *scn,
   return NULL;
 }
 
+/* FNV-1a hash of a section or symbol name.  */
+static size_t
+name_hash (const char *name)
+{
+  uint64_t hval = 0xcbf29ce484222325ull;
+  for (; *name != '\0'; ++name)
+    hval = (hval ^ (unsigned char) *name) * 0x100000001b3ull;
+  return hval;
+}
+
 struct section
 {
   Elf_Scn *scn;
@@ -739,6 +803,7 @@ struct section
   Elf_Scn *outscn;
   Dwelf_Strent *strent;
   GElf_Shdr shdr;
+  struct section *name_next;	/* Next in the same name hash bucket.  */
 };
 
 static int
@@ -840,7 +905,7 @@ struct symbol
       };
     };
 
-    /* For a symbol discarded after first sort, this matches its better's
+    /* For a symbol discarded as a duplicate, this matches its better's
        map pointer.  */
     size_t *duplicate;
   };
@@ -913,9 +978,11 @@ collect_symbols (Elf *outelf, bool rel, Elf_Scn *symscn, Elf_Scn *strscn,
   if (s1->value > s2->value)						      \
     return 1
 
-/* Symbol comparison used to sort symbols in preparation for deduplication.  */
+/* Symbol comparison used to deduplicate symbols found in both the stripped
+   and unstripped input files.  The position in the symbol index map is
+   not compared, duplicates always have distinct positions there.  */
 static int
-compare_symbols (const void *a, const void *b)
+compare_symbols_duplicate (const void *a, const void *b)
 {
   const struct symbol *s1 = a;
   const struct symbol *s2 = b;
@@ -924,40 +991,32 @@ compare_symbols (const void *a, const void *b)
   CMP (size);
   CMP (shndx);
 
-  int res = s1->compare - s2->compare;
-  if (res != 0)
-    return res;
-
-  res = strcmp (s1->name, s2->name);
-  if (res != 0)
-    return res;
-
-  /* Duplicates still have distinct positions in the symbol index map.
-     Compare map positions to ensure that duplicate symbols are ordered
-     consistently even if the sort function is unstable.  */
-  CMP (map);
-  error_exit (0, _("found two identical index map positions."));
+  return (s1->compare - s2->compare) ?: strcmp (s1->name, s2->name);
 }
 
-/* Symbol comparison used to deduplicate symbols found in both the stripped
-   and unstripped input files.
-
-   Similar to compare_symbols, but does not differentiate symbols based
-   on their position in the symbol index map.  Duplicates can't be found
-   by comparing index map postions because they always have distinct
-   positions in the map.  */
-static int
-compare_symbols_duplicate (const void *a, const void *b)
+/* Hash everything compare_symbols_duplicate looks at.  */
+static unsigned long int
+symbol_hash (const struct symbol *s)
 {
-  const struct symbol *s1 = a;
-  const struct symbol *s2 = b;
+  uint64_t hval = name_hash (s->name);
+  hval = (hval ^ s->value) * 0x100000001b3ull;
+  hval = (hval ^ s->size) * 0x100000001b3ull;
+  hval = (hval ^ s->shndx) * 0x100000001b3ull;
+  return hval ^ (uint16_t) s->compare;
+}
 
-  CMP (value);
-  CMP (size);
-  CMP (shndx);
+/* Hash table to find the duplicates among all symbols.  */
+#define TYPE struct symbol *
+#define NAME symbol_tab
+#define COMPARE(a, b) compare_symbols_duplicate (a, b)
+#define NO_UNDEF
+#include <dynamicsizehash.h>
+#undef NO_UNDEF
 
-  return (s1->compare - s2->compare) ?: strcmp (s1->name, s2->name);
-}
+#include <dynamicsizehash.c>
+#undef TYPE
+#undef NAME
+#undef COMPARE
 
 /* Compare symbols for output order after slots have been assigned.  */
 static int
@@ -1001,6 +1060,48 @@ compare_symbols_output (const void *a, const void *b)
 
 #undef CMP
 
+static int
+compare_symbols_output_ptr (const void *a, const void *b)
+{
+  return compare_symbols_output (*(const struct symbol **) a,
+				 *(const struct symbol **) b);
+}
+
+/* Fill OUTPUT with pointers to the NSYMS SYMBOLS in the order of
+   compare_symbols_output.  SYMBOLS are in index map order, which is
+   the order of all but the section symbols already, so they are just
+   distributed to their groups.  */
+static void
+order_output_symbols (struct symbol *symbols, size_t nsyms,
+		      struct symbol **output)
+{
+  /* Local section symbols, other local symbols, the same for nonlocal
+     symbols and finally the discarded symbols.  */
+#define GROUP(s)							      \
+  ((s)->name == NULL ? 4						      \
+   : ((GELF_ST_BIND ((s)->info.info) != STB_LOCAL) * 2			      \
+      + (GELF_ST_TYPE ((s)->info.info) != STT_SECTION)))
+  size_t start[5] = { 0, };
+  for (size_t i = 0; i < nsyms; ++i)
+    ++start[GROUP (&symbols[i])];
+  size_t next[5];
+  for (size_t g = 0, pos = 0; g < 5; ++g)
+    {
+      size_t n = start[g];
+      start[g] = next[g] = pos;
+      pos += n;
+    }
+  for (size_t i = 0; i < nsyms; ++i)
+    output[next[GROUP (&symbols[i])]++] = &symbols[i];
+#undef GROUP
+
+  /* binutils always puts section symbols in section index order.  */
+  qsort (&output[start[0]], next[0] - start[0], sizeof output[0],
+	 compare_symbols_output_ptr);
+  qsort (&output[start[2]], next[2] - start[2], sizeof output[0],
+	 compare_symbols_output_ptr);
+}
+
 /* Return true if the flags of the sections match, ignoring the SHF_INFO_LINK
    flag if the section contains relocation information.  */
 static bool
@@ -1059,6 +1160,28 @@ find_alloc_section (const GElf_Shdr *shdr, GElf_Addr bias, const char *name,
   return NULL;
 }
 
+/* Hash the allocated sections of an ET_REL file by name, so a section
+   out of order does not need a scan of all of them.  Each bucket lists
+   its sections in their order in SECTIONS.  */
+static struct section **
+hash_alloc_sections (struct section sections[], size_t nalloc,
+		     size_t *nbuckets)
+{
+  size_t n = 16;
+  while (n < 2 * nalloc)
+    n *= 2;
+  struct section **buckets = xcalloc (n, sizeof buckets[0]);
+  for (size_t i = nalloc; i-- > 0; )
+    {
+      struct section **bucket = &buckets[name_hash (sections[i].name)
+					 & (n - 1)];
+      sections[i].name_next = *bucket;
+      *bucket = &sections[i];
+    }
+  *nbuckets = n;
+  return buckets;
+}
+
 static inline const char *
 get_section_name (size_t ndx, const GElf_Shdr *shdr, const Elf_Data *shstrtab)
 {
@@ -1460,8 +1583,10 @@ more sections in stripped file than debug file -- arguments reversed?"));
       max_off = elf_update (stripped, ELF_C_NULL);
     }
 
-  /* Cache the stripped file's section details.  */
-  struct section sections[stripped_shnum - 1];
+  /* Cache the stripped file's section details.  This can be too big
+     for the stack with one section per function.  */
+  struct section *sections = xmalloc ((stripped_shnum - 1)
+				      * sizeof sections[0]);
   Elf_Scn *scn = NULL;
   while ((scn = elf_nextscn (stripped, scn)) != NULL)
     {
@@ -1503,6 +1628,8 @@ more sections in stripped file than debug file -- arguments reversed?"));
   Elf_Scn *unstripped_symtab = NULL;
   size_t unstripped_strndx = 0;
   size_t alloc_avail = 0;
+  struct section **alloc_hash = NULL;
+  size_t alloc_nbuckets = 0;
   scn = NULL;
   while ((scn = elf_nextscn (unstripped, scn)) != NULL)
     {
@@ -1544,12 +1671,19 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	      if (likely (sections_match (sections, alloc_avail, shdr, name)))
 		sec = &sections[alloc_avail++];
 	      else
-		for (size_t i = alloc_avail + 1; i < nalloc; ++i)
-		  if (sections_match (sections, i, shdr, name))
-		    {
-		      sec = &sections[i];
+		{
+		  /* Only look at the later sections of the same name.  */
+		  if (alloc_hash == NULL)
+		    alloc_hash = hash_alloc_sections (sections, nalloc,
+						      &alloc_nbuckets);
+		  for (sec = alloc_hash[name_hash (name)
+					& (alloc_nbuckets - 1)];
+		       sec != NULL; sec = sec->name_next)
+		    if (sec > &sections[alloc_avail]
+			&& sections_match (sections, sec - sections,
+					   shdr, name))
 		      break;
-		    }
+		}
 	    }
 	}
       else
@@ -1596,6 +1730,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
 
       sec->outscn = scn;
     }
+  free (alloc_hash);
 
   /* If that failed due to changes made by prelink, we take another tack.
      We keep track of a .bss section that was partly split into .dynbss
@@ -1877,14 +2012,18 @@ more sections in stripped file than debug file -- arguments reversed?"));
 		       &symbols[stripped_nsym - 1],
 		       &symndx_map[stripped_nsym - 1], split_bss);
 
-      /* Next, sort our array of all symbols.  */
-      qsort (symbols, total_syms, sizeof symbols[0], compare_symbols);
-
-      /* Now we can weed out the duplicates.  Assign remaining symbols
-	 new slots, collecting a map from old indices to new.  */
+      /* Now we can weed out the duplicates.  Of each set of equal
+	 symbols the last one is kept, the others refer to it.  Assign
+	 remaining symbols a nonzero slot, collecting a map from old
+	 indices to new.  */
+      symbol_tab dups;
+      if (symbol_tab_init (&dups, total_syms) != 0)
+	error_exit (errno, _("memory exhausted"));
       size_t nsym = 0;
-      for (struct symbol *s = symbols; s < &symbols[total_syms]; ++s)
+      for (size_t i = total_syms; i-- > 0; )
 	{
+	  struct symbol *s = &symbols[i];
+
 	  /* Skip a section symbol for a removed section.  */
 	  if (s->shndx == SHN_UNDEF
 	      && GELF_ST_TYPE (s->info.info) == STT_SECTION)
@@ -1895,52 +2034,55 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	      continue;
 	    }
 
-	  struct symbol *n = s;
-	  while (n + 1 < &symbols[total_syms]
-		 && !compare_symbols_duplicate (s, n + 1))
-	    ++n;
-
-	  while (s < n)
+	  unsigned long int hval = symbol_hash (s);
+	  struct symbol *n = symbol_tab_find (&dups, hval, s);
+	  if (n != NULL)
 	    {
-	      /* This is a duplicate.  Its twin will get the next slot.  */
+	      /* This is a duplicate.  Its twin has a slot.  */
 	      s->name = NULL;	/* Mark as discarded. */
 	      s->duplicate = n->map;
-	      ++s;
+	      continue;
 	    }
 
+	  if (symbol_tab_insert (&dups, hval, s) != 0)
+	    error_exit (errno, _("memory exhausted"));
+
 	  /* Allocate the next slot.  */
 	  *s->map = ++nsym;
 	}
+      symbol_tab_free (&dups);
 
-      /* Now we sort again, to determine the order in the output.  */
-      qsort (symbols, total_syms, sizeof symbols[0], compare_symbols_output);
+      /* Now determine the order in the output.  SYMBOLS is still in
+	 index map order, so only the section symbols need sorting.  */
+      struct symbol **output = xmalloc (total_syms * sizeof output[0]);
+      order_output_symbols (symbols, total_syms, output);
 
       if (nsym < total_syms)
 	/* The discarded symbols are now at the end of the table.  */
-	assert (symbols[nsym].name == NULL);
+	assert (output[nsym]->name == NULL);
 
       /* Now a final pass updates the map with the final order,
 	 and builds up the new string table.  */
       symstrtab = dwelf_strtab_init (true);
       for (size_t i = 0; i < nsym; ++i)
 	{
-	  assert (symbols[i].name != NULL);
-	  assert (*symbols[i].map != 0);
-	  *symbols[i].map = 1 + i;
-	  symbols[i].strent = dwelf_strtab_add (symstrtab, symbols[i].name);
+	  assert (output[i]->name != NULL);
+	  assert (*output[i]->map != 0);
+	  *output[i]->map = 1 + i;
+	  output[i]->strent = dwelf_strtab_add (symstrtab, output[i]->name);
 	}
 
       /* Scan the discarded symbols too, just to update their slots
 	 in SYMNDX_MAP to refer to their live duplicates.  */
       for (size_t i = nsym; i < total_syms; ++i)
 	{
-	  assert (symbols[i].name == NULL);
-	  if (symbols[i].duplicate == NULL)
-	    assert (*symbols[i].map == STN_UNDEF);
+	  assert (output[i]->name == NULL);
+	  if (output[i]->duplicate == NULL)
+	    assert (*output[i]->map == STN_UNDEF);
 	  else
 	    {
-	      assert (*symbols[i].duplicate != STN_UNDEF);
-	      *symbols[i].map = *symbols[i].duplicate;
+	      assert (*output[i]->duplicate != STN_UNDEF);
+	      *output[i]->map = *output[i]->duplicate;
 	    }
 	}
 
@@ -2009,7 +2151,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
       shdr->sh_info = 1;
       for (size_t i = 0; i < nsym; ++i)
 	{
-	  struct symbol *s = &symbols[i];
+	  struct symbol *s = output[i];
 
 	  /* Fill in the symbol details.  */
 	  sym.st_name = dwelf_strent_off (s->strent);
@@ -2049,6 +2191,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
 	    if (sec->outscn != NULL && sec->shdr.sh_link == old_sh_link)
 	      {
 		adjust_relocs (sec->outscn, sec->scn, &sec->shdr,
+			       gelf_getclass (unstripped),
 			       symndx_map, total_syms, shdr);
 		scn_adjusted[elf_ndxscn (sec->outscn)] = true;
 	      }
@@ -2060,6 +2203,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
 			 total_syms - (stripped_nsym - 1),
 			 scn_adjusted);
 
+      free (output);
       free (symbols);
       free (symndx_map);
     }
@@ -2184,6 +2328,7 @@ more sections in stripped file than debug file -- arguments reversed?"));
       free (symstrdata->d_buf);
     }
   free_new_data ();
+  free (sections);
 }
 
 /* Process one pair of files, already opened.  */
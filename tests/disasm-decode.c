@@ -0,0 +1,216 @@
+/* Test disasm_decode against the text disassembler.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(asm)
+#include ELFUTILS_HEADER(ebl)
+#include <libelf.h>
+#include <gelf.h>
+#include "system.h"
+
+
+static int errors;
+
+#define fail(fmt, ...) \
+  (printf ("%s %s %#" PRIx64 ": " fmt "\n", fname, scnname, addr, \
+	   ##__VA_ARGS__), ++errors)
+
+/* Keep the text of the first instruction only.  */
+static int
+first_insn (char *str, size_t len, void *arg)
+{
+  snprintf (arg, 256, "%.*s", (int) len, str);
+  return 1;
+}
+
+/* Return whether WORD is a word of TEXT.  */
+static bool
+has_word (const char *text, const char *word)
+{
+  size_t len = strlen (word);
+  for (const char *p = text; (p = strstr (p, word)) != NULL; ++p)
+    if ((p == text || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0'))
+      return true;
+  return false;
+}
+
+struct counts
+{
+  size_t insns;
+  size_t jumps;
+  size_t calls;
+  size_t returns;
+  size_t invalid;
+};
+
+/* Decode the bytes from START to END one instruction at a time and
+   compare to the text disassembly.  */
+static void
+check_range (const char *fname, const char *scnname, DisasmCtx_t *ctx,
+	     GElf_Half machine, const uint8_t *start, const uint8_t *end,
+	     GElf_Addr addr, struct counts *counts)
+{
+  while (start < end)
+    {
+      char text[256] = "";
+      const uint8_t *tp = start;
+      const uint8_t *dp = start;
+      const uint8_t *lp = start;
+      disasm_cb (ctx, &tp, end, addr, "%m %.1o,%.2o,%.3o,%.4o,%.5o",
+		 first_insn, text, NULL);
+      DisasmInsn_t insn;
+      int dres = disasm_decode (ctx, &dp, end, addr, &insn);
+      int lres = disasm_decode (ctx, &lp, end, addr, NULL);
+
+      if (tp == start)
+	{
+	  /* No complete instruction is left.  */
+	  if (dres != -1 || lres != -1 || dp != start || lp != start)
+	    fail ("decoded a truncated instruction");
+	  break;
+	}
+
+      if (dres != 0 || lres != 0)
+	{
+	  fail ("disasm_decode failed: %d %d", dres, lres);
+	  break;
+	}
+      if (dp != tp || lp != tp)
+	{
+	  fail ("length %td and %td instead of %td '%s'",
+		dp - start, lp - start, tp - start, text);
+	  break;
+	}
+      if (insn.addr != addr || insn.length != (size_t) (tp - start))
+	fail ("wrong address or length");
+
+      /* The BPF disassembler does not print mnemonics.  */
+      bool invalid = (machine == EM_BPF ? strncmp (text, "invalid", 7) == 0
+		      : machine == EM_RISCV ? strncmp (text, "0x", 2) == 0
+		      : strcmp (text, "(bad)") == 0);
+      if (((insn.flags & DISASM_INSN_INVALID) != 0) != invalid)
+	fail ("'%s' is %s", text, invalid ? "invalid" : "valid");
+      else if (!invalid && machine != EM_BPF
+	       && !has_word (text, insn.mnemonic))
+	fail ("mnemonic '%s' for '%s'", insn.mnemonic, text);
+
+      if (insn.noperands > DISASM_MAX_OPERANDS)
+	fail ("%u operands", insn.noperands);
+      for (unsigned int i = 0; i < insn.noperands; ++i)
+	if (insn.operands[i].kind == DISASM_OP_TARGET)
+	  {
+	    /* Short x86-64 jumps print only 32 bits of the target.  */
+	    char hex[32];
+	    char hex32[32];
+	    snprintf (hex, sizeof hex, "0x%" PRIx64, insn.target);
+	    snprintf (hex32, sizeof hex32, "0x%" PRIx32,
+		      (uint32_t) insn.target);
+	    if (insn.operands[i].value != (int64_t) insn.target
+		|| (strstr (text, hex) == NULL && strstr (text, hex32) == NULL))
+	      fail ("target %s for '%s'", hex, text);
+	  }
+	else if (insn.operands[i].kind < DISASM_OP_REG
+		 || insn.operands[i].kind > DISASM_OP_TARGET)
+	  fail ("operand %u has kind %d", i, insn.operands[i].kind);
+
+      ++counts->insns;
+      counts->jumps += (insn.flags & DISASM_INSN_JUMP) != 0;
+      counts->calls += (insn.flags & DISASM_INSN_CALL) != 0;
+      counts->returns += (insn.flags & DISASM_INSN_RETURN) != 0;
+      counts->invalid += (insn.flags & DISASM_INSN_INVALID) != 0;
+
+      addr += tp - start;
+      start = tp;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  const uint8_t *p = NULL;
+  if (disasm_decode (NULL, &p, p, 0, NULL) != -1)
+    error (EXIT_FAILURE, 0, "disasm_decode accepted NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      const char *fname = argv[i];
+      int fd = open (fname, O_RDONLY);
+      if (fd < 0)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+      Elf *elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+      if (elf == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin %s: %s", fname, elf_errmsg (-1));
+      Ebl *ebl = ebl_openbackend (elf);
+      if (ebl == NULL)
+	error (EXIT_FAILURE, 0, "no backend for %s", fname);
+      DisasmCtx_t *ctx = disasm_begin (ebl, elf, NULL);
+      if (ctx == NULL)
+	error (EXIT_FAILURE, 0, "cannot disassemble %s: %s", fname,
+	       asm_errmsg (-1));
+      GElf_Ehdr ehdr_mem;
+      GElf_Half machine = gelf_getehdr (elf, &ehdr_mem)->e_machine;
+      size_t shstrndx;
+      elf_getshdrstrndx (elf, &shstrndx);
+
+      Elf_Scn *scn = NULL;
+      while ((scn = elf_nextscn (elf, scn)) != NULL)
+	{
+	  GElf_Shdr shdr_mem;
+	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+	  if (shdr->sh_type != SHT_PROGBITS
+	      || (shdr->sh_flags & SHF_EXECINSTR) == 0)
+	    continue;
+	  const char *scnname = elf_strptr (elf, shstrndx, shdr->sh_name);
+	  Elf_Data *data = elf_getdata (scn, NULL);
+	  if (data == NULL || data->d_size == 0)
+	    continue;
+	  const uint8_t *start = data->d_buf;
+	  const uint8_t *end = start + data->d_size;
+
+	  /* Once from the start, and once from the second byte to see
+	     more odd and invalid encodings.  */
+	  struct counts counts = { 0, 0, 0, 0, 0 };
+	  check_range (fname, scnname, ctx, machine, start, end,
+		       shdr->sh_addr, &counts);
+	  printf ("%s %s: %zu instructions, %zu jumps, %zu calls,"
+		  " %zu returns, %zu invalid\n", fname, scnname, counts.insns,
+		  counts.jumps, counts.calls, counts.returns, counts.invalid);
+	  memset (&counts, 0, sizeof counts);
+	  check_range (fname, scnname, ctx, machine, start + 1, end,
+		       shdr->sh_addr + 1, &counts);
+	  printf ("%s %s+1: %zu instructions, %zu jumps, %zu calls,"
+		  " %zu returns, %zu invalid\n", fname, scnname, counts.insns,
+		  counts.jumps, counts.calls, counts.returns, counts.invalid);
+	}
+
+      disasm_end (ctx);
+      ebl_closebackend (ebl);
+      elf_end (elf);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+/* Test dwarf_getranges, dwarf_haspc and location list lookups against
+   walking the lists one entry at a time.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include "system.h"
+
+
+static const char *fname;
+static int errors;
+static size_t ndies;
+static size_t nranges;
+static size_t nloclists;
+static size_t nbroken;
+
+#define fail(die, fmt, ...) \
+  (printf ("%s [%" PRIx64 "]: " fmt "\n", fname, dwarf_dieoffset (die), \
+	   ##__VA_ARGS__), ++errors)
+
+/* Whether PC is in one of the ranges dwarf_ranges reports.  */
+static bool
+slow_haspc (Dwarf_Die *die, Dwarf_Addr pc)
+{
+  Dwarf_Addr base, start, end;
+  ptrdiff_t off = 0;
+  while ((off = dwarf_ranges (die, off, &base, &start, &end)) > 0)
+    if (pc >= start && pc < end)
+      return true;
+  return false;
+}
+
+static void
+check_haspc (Dwarf_Die *die, Dwarf_Addr pc)
+{
+  if (dwarf_haspc (die, pc) != slow_haspc (die, pc))
+    fail (die, "dwarf_haspc wrong for %#" PRIx64, pc);
+}
+
+static void
+check_ranges (Dwarf_Die *die)
+{
+  const Dwarf_Range *ranges;
+  size_t n;
+  if (dwarf_getranges (die, &ranges, &n) != 0)
+    {
+      fail (die, "dwarf_getranges: %s", dwarf_errmsg (-1));
+      return;
+    }
+
+  const Dwarf_Range *again;
+  size_t nagain;
+  if (dwarf_getranges (die, &again, &nagain) != 0
+      || again != ranges || nagain != n)
+    fail (die, "dwarf_getranges not cached");
+
+  for (size_t i = 0; i < n; ++i)
+    if (ranges[i].start >= ranges[i].end
+	|| (i > 0 && ranges[i - 1].end > ranges[i].start))
+      fail (die, "range %zu unsorted or empty", i);
+
+  /* Every nonempty range is covered.  */
+  Dwarf_Addr base, start, end;
+  ptrdiff_t off = 0;
+  while ((off = dwarf_ranges (die, off, &base, &start, &end)) > 0)
+    {
+      if (start >= end)
+	continue;
+      size_t i = 0;
+      while (i < n && ranges[i].end < end)
+	++i;
+      if (i == n || ranges[i].start > start)
+	fail (die, "range %#" PRIx64 "..%#" PRIx64 " missing", start, end);
+    }
+
+  for (size_t i = 0; i < n; ++i)
+    {
+      check_haspc (die, ranges[i].start);
+      check_haspc (die, ranges[i].start - 1);
+      check_haspc (die, ranges[i].end - 1);
+      check_haspc (die, ranges[i].end);
+    }
+
+  ndies += n > 0;
+  nranges += n;
+}
+
+static void
+check_loclist (Dwarf_Die *die, Dwarf_Attribute *attr)
+{
+  Dwarf_Addr base, start, end;
+  Dwarf_Op *expr;
+  size_t exprlen;
+  ptrdiff_t off = 0;
+  while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+				    &expr, &exprlen)) > 0)
+    {
+      /* The same expressions in the same order as a walk that stops at
+	 entries covering START.  */
+      Dwarf_Op *exprs[16];
+      size_t lens[16];
+      int got = dwarf_getlocation_addr (attr, start, exprs, lens, 16);
+      size_t want = 0;
+      Dwarf_Addr wstart, wend;
+      Dwarf_Op *wexpr;
+      size_t wlen;
+      ptrdiff_t woff = 0;
+      while ((woff = dwarf_getlocations (attr, woff, &base, &wstart, &wend,
+					 &wexpr, &wlen)) > 0)
+	if (start >= wstart && start < wend)
+	  {
+	    if (want < (size_t) got
+		&& (exprs[want] != wexpr || lens[want] != wlen))
+	      fail (die, "location %zu at %#" PRIx64 " differs", want, start);
+	    ++want;
+	  }
+      if (got < 0 || (size_t) got != (want < 16 ? want : 16))
+	fail (die, "%d locations at %#" PRIx64 " instead of %zu",
+	      got, start, want);
+    }
+  if (off < 0)
+    {
+      /* A list that cannot be decoded is only decoded once, but still
+	 gives the same answer.  */
+      int first = dwarf_getlocation_addr (attr, (Dwarf_Addr) -1,
+					  NULL, NULL, 0);
+      int again = dwarf_getlocation_addr (attr, (Dwarf_Addr) -1,
+					  NULL, NULL, 0);
+      if (first != again)
+	fail (die, "%d locations, then %d", first, again);
+      ++nbroken;
+      return;
+    }
+
+  int all = dwarf_getlocation_addr (attr, (Dwarf_Addr) -1, NULL, NULL, 0);
+  size_t count = 0;
+  off = 0;
+  while ((off = dwarf_getlocations (attr, off, &base, &start, &end,
+				    &expr, &exprlen)) > 0)
+    ++count;
+  if (all < 0 || (size_t) all != count)
+    fail (die, "%d locations instead of %zu", all, count);
+
+  ++nloclists;
+}
+
+static void
+walk_tree (Dwarf_Die *dwarf_die)
+{
+  Dwarf_Die die = *dwarf_die;
+  do
+    {
+      check_ranges (&die);
+
+      Dwarf_Attribute attr;
+      if (dwarf_attr (&die, DW_AT_location, &attr) != NULL
+	  && (dwarf_whatform (&attr) == DW_FORM_sec_offset
+	      || dwarf_whatform (&attr) == DW_FORM_loclistx
+	      || dwarf_whatform (&attr) == DW_FORM_data4
+	      || dwarf_whatform (&attr) == DW_FORM_data8))
+	check_loclist (&die, &attr);
+
+      Dwarf_Die child;
+      if (dwarf_child (&die, &child) == 0)
+	walk_tree (&child);
+    }
+  while (dwarf_siblingof (&die, &die) == 0);
+}
+
+int
+main (int argc, char *argv[])
+{
+  const Dwarf_Range *ranges;
+  size_t n;
+  if (dwarf_getranges (NULL, &ranges, &n) != -1)
+    error (EXIT_FAILURE, 0, "dwarf_getranges accepted NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      fname = argv[i];
+      int fd = open (fname, O_RDONLY);
+      if (fd < 0)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	error (EXIT_FAILURE, 0, "dwarf_begin %s: %s", fname,
+	       dwarf_errmsg (-1));
+
+      ndies = nranges = nloclists = nbroken = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_Die cudie, subdie;
+      uint8_t unit_type;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, &unit_type,
+			      &cudie, &subdie) == 0)
+	{
+	  Dwarf_Die die = (unit_type == DW_UT_skeleton ? subdie : cudie);
+	  if (dwarf_tag (&die) != DW_TAG_invalid)
+	    walk_tree (&die);
+	}
+      printf ("%s: %zu dies with %zu ranges, %zu location lists,"
+	      " %zu broken\n", fname, ndies, nranges, nloclists, nbroken);
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
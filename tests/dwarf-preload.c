@@ -0,0 +1,167 @@
+/* Test dwarf_preload against reading everything lazily.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include "system.h"
+
+
+struct summary
+{
+  size_t nlines;
+  size_t naranges;
+  size_t nranges;
+  uint64_t sum;
+};
+
+static Dwarf *
+open_dwarf (const char *fname, int *fdp)
+{
+  *fdp = open (fname, O_RDONLY);
+  if (*fdp < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+  Dwarf *dbg = dwarf_begin (*fdp, DWARF_C_READ);
+  if (dbg == NULL)
+    error (EXIT_FAILURE, 0, "dwarf_begin %s: %s", fname, dwarf_errmsg (-1));
+  return dbg;
+}
+
+static void
+summarize_die (Dwarf_Die *cudie, struct summary *s)
+{
+  Dwarf_Lines *lines;
+  size_t nlines;
+  if (dwarf_getsrclines (cudie, &lines, &nlines) == 0)
+    for (size_t i = 0; i < nlines; ++i)
+      {
+	Dwarf_Line *line = dwarf_onesrcline (lines, i);
+	Dwarf_Addr addr;
+	int lineno;
+	dwarf_lineaddr (line, &addr);
+	dwarf_lineno (line, &lineno);
+	s->sum += addr + lineno;
+	++s->nlines;
+      }
+
+  const Dwarf_Range *ranges;
+  size_t nranges;
+  if (dwarf_getranges (cudie, &ranges, &nranges) == 0)
+    for (size_t i = 0; i < nranges; ++i)
+      {
+	s->sum += ranges[i].start + ranges[i].end;
+	++s->nranges;
+      }
+}
+
+static void
+summarize (Dwarf *dbg, struct summary *s)
+{
+  memset (s, 0, sizeof *s);
+
+  Dwarf_CU *cu = NULL;
+  Dwarf_Die cudie, subdie;
+  uint8_t unit_type;
+  while (dwarf_get_units (dbg, cu, &cu, NULL, &unit_type,
+			  &cudie, &subdie) == 0)
+    {
+      summarize_die (&cudie, s);
+      if (unit_type == DW_UT_skeleton
+	  && dwarf_tag (&subdie) == DW_TAG_compile_unit)
+	summarize_die (&subdie, s);
+    }
+
+  Dwarf_Aranges *aranges;
+  if (dwarf_getaranges (dbg, &aranges, &s->naranges) == 0)
+    for (size_t i = 0; i < s->naranges; ++i)
+      {
+	Dwarf_Addr addr;
+	Dwarf_Word length;
+	Dwarf_Off offset;
+	dwarf_getarangeinfo (dwarf_onearange (aranges, i),
+			     &addr, &length, &offset);
+	s->sum += addr + length + offset;
+      }
+}
+
+int
+main (int argc, char *argv[])
+{
+  int errors = 0;
+
+  if (dwarf_preload (NULL, 1) != -1)
+    error (EXIT_FAILURE, 0, "dwarf_preload accepted NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      const char *fname = argv[i];
+      int fd, lazy_fd;
+      Dwarf *dbg = open_dwarf (fname, &fd);
+      Dwarf *lazy_dbg = open_dwarf (fname, &lazy_fd);
+
+      int n = dwarf_preload (dbg, 2);
+      if (n < 0)
+	error (EXIT_FAILURE, 0, "dwarf_preload %s: %s", fname,
+	       dwarf_errmsg (-1));
+      if (dwarf_preload (dbg, 2) != n)
+	{
+	  printf ("%s: different result the second time\n", fname);
+	  ++errors;
+	}
+
+      struct summary lazy;
+      summarize (lazy_dbg, &lazy);
+
+      /* Look everything up in a child, which shares what was
+	 preloaded.  */
+      fflush (stdout);
+      pid_t pid = fork ();
+      if (pid < 0)
+	error (EXIT_FAILURE, errno, "fork");
+      if (pid == 0)
+	{
+	  struct summary s;
+	  summarize (dbg, &s);
+	  printf ("%s: %d units, %zu lines, %zu ranges, %zu aranges\n",
+		  fname, n, s.nlines, s.nranges, s.naranges);
+	  if (memcmp (&s, &lazy, sizeof s) != 0)
+	    {
+	      printf ("%s: differs from reading lazily\n", fname);
+	      exit (1);
+	    }
+	  exit (0);
+	}
+
+      int status;
+      if (waitpid (pid, &status, 0) != pid
+	  || ! WIFEXITED (status) || WEXITSTATUS (status) != 0)
+	++errors;
+
+      dwarf_end (lazy_dbg);
+      dwarf_end (dbg);
+      close (lazy_fd);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
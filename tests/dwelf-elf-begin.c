@@ -0,0 +1,133 @@
+/* Test reading possibly compressed ELF files through dwelf_elf_begin.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwelf)
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+#include "system.h"
+
+static uint32_t
+checksum (uint32_t sum, Elf_Data *data)
+{
+  for (size_t i = 0; data->d_buf != NULL && i < data->d_size; ++i)
+    sum = sum * 31 + ((unsigned char *) data->d_buf)[i];
+  return sum;
+}
+
+/* Checksum the contents of all sections and segments of ELF.  */
+static uint32_t
+checksum_elf (const char *name, Elf *elf)
+{
+  uint32_t sum = 0;
+
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      Elf_Data *data = elf_rawdata (scn, NULL);
+      if (data == NULL)
+	error (EXIT_FAILURE, 0, "%s: section %zu: %s", name,
+	       elf_ndxscn (scn), elf_errmsg (-1));
+      sum = checksum (sum, data);
+    }
+
+  size_t phnum;
+  if (elf_getphdrnum (elf, &phnum) != 0)
+    error (EXIT_FAILURE, 0, "%s: elf_getphdrnum: %s", name, elf_errmsg (-1));
+  for (size_t i = 0; i < phnum; ++i)
+    {
+      GElf_Phdr phdr_mem;
+      GElf_Phdr *phdr = gelf_getphdr (elf, i, &phdr_mem);
+      if (phdr == NULL)
+	error (EXIT_FAILURE, 0, "%s: gelf_getphdr: %s", name, elf_errmsg (-1));
+      if (phdr->p_filesz == 0)
+	continue;
+      Elf_Data *data = elf_getdata_rawchunk (elf, phdr->p_offset,
+					     phdr->p_filesz, ELF_T_BYTE);
+      if (data == NULL)
+	error (EXIT_FAILURE, 0, "%s: segment %zu: %s", name, i,
+	       elf_errmsg (-1));
+      sum = checksum (sum, data);
+    }
+
+  return sum;
+}
+
+static Elf *
+open_elf (const char *name, int *fdp)
+{
+  *fdp = open (name, O_RDONLY);
+  if (*fdp < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", name);
+  Elf *elf = dwelf_elf_begin (*fdp);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "dwelf_elf_begin %s: %s", name,
+	   elf_errmsg (-1));
+  return elf;
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      int fd;
+      Elf *elf = open_elf (argv[i], &fd);
+      uint32_t sum = checksum_elf (argv[i], elf);
+
+      /* A file decompressed whole up front has no file or reader left,
+	 so elf_cntl refuses it.  Otherwise everything is still there
+	 after reading it all in and letting go of the file.  */
+      bool in_memory = elf_cntl (elf, ELF_C_FDREAD) != 0;
+      close (fd);
+      if (!in_memory)
+	{
+	  if (checksum_elf (argv[i], elf) != sum)
+	    error (EXIT_FAILURE, 0, "%s: contents differ after ELF_C_FDREAD",
+		   argv[i]);
+	  if (elf_cntl (elf, ELF_C_FDDONE) == 0)
+	    error (EXIT_FAILURE, 0, "%s: ELF_C_FDDONE accepted twice",
+		   argv[i]);
+	}
+      elf_end (elf);
+
+      /* The file can also be let go of before reading anything.  */
+      if (!in_memory)
+	{
+	  elf = open_elf (argv[i], &fd);
+	  if (elf_cntl (elf, ELF_C_FDDONE) != 0)
+	    error (EXIT_FAILURE, 0, "%s: elf_cntl (ELF_C_FDDONE): %s",
+		   argv[i], elf_errmsg (-1));
+	  if (elf_end (elf) != 0)
+	    error (EXIT_FAILURE, 0, "%s: elf_end failed", argv[i]);
+	  close (fd);
+	}
+
+      printf ("%s: %08" PRIx32 "%s\n", argv[i], sum,
+	      in_memory ? " in memory" : "");
+    }
+
+  return 0;
+}
@@ -0,0 +1,216 @@
+/* Test (and time) building string tables with Dwelf_Strtab.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include ELFUTILS_HEADER(dwelf)
+#include "system.h"
+#include "libeu.h"
+
+
+/* Make up a symbol name like those of C++ methods; many of them end
+   the same way and many are the tail of another one.  */
+static char *
+make_name (size_t i)
+{
+  static const char *const classes[] = { "4Node", "6Parser", "5Token",
+					 "3Map", "7Visitor" };
+  static const char *const methods[] = { "4sizeEv", "5clearEv", "3getEi",
+					 "6insertERKS_", "4nextEv" };
+  char *name;
+  switch (i % 4)
+    {
+    case 0:
+      name = xasprintf ("_ZN2ns%zu%sN%s", i % 97,
+			classes[i / 4 % 5], methods[i / 20 % 5]);
+      break;
+    case 1:
+      name = xasprintf ("_ZNK%s%s", classes[i / 4 % 5],
+			methods[i / 20 % 5]);
+      break;
+    case 2:
+      name = xasprintf ("sym%zu", i / 4);
+      break;
+    default:
+      name = xasprintf ("%zu", i / 4 % 1000);
+      break;
+    }
+  return name;
+}
+
+static int
+compare_names (const void *a, const void *b)
+{
+  return strcmp (*(const char **) a, *(const char **) b);
+}
+
+/* Whether A is the tail of B.  */
+static bool
+is_tail (const char *a, const char *b)
+{
+  size_t la = strlen (a);
+  size_t lb = strlen (b);
+  return la <= lb && strcmp (a, b + lb - la) == 0;
+}
+
+static void
+check (size_t n, bool nullstr)
+{
+  char **names = xmalloc (n * sizeof names[0]);
+  Dwelf_Strent **ents = xmalloc (n * sizeof ents[0]);
+  for (size_t i = 0; i < n; ++i)
+    names[i] = make_name (i);
+  /* Also add the empty string and duplicates.  */
+  if (n > 2)
+    {
+      names[n - 1][0] = '\0';
+      strcpy (names[n - 2], names[0]);
+    }
+
+  Dwelf_Strtab *st = dwelf_strtab_init (nullstr);
+  if (st == NULL)
+    error (EXIT_FAILURE, errno, "dwelf_strtab_init");
+  for (size_t i = 0; i < n; ++i)
+    if ((ents[i] = dwelf_strtab_add (st, names[i])) == NULL)
+      error (EXIT_FAILURE, errno, "dwelf_strtab_add");
+
+  Elf_Data data;
+  if (dwelf_strtab_finalize (st, &data) == NULL)
+    error (EXIT_FAILURE, errno, "dwelf_strtab_finalize");
+
+  /* Every string is where it is said to be.  */
+  for (size_t i = 0; i < n; ++i)
+    {
+      size_t off = dwelf_strent_off (ents[i]);
+      if (off + strlen (names[i]) >= data.d_size
+	  || strcmp ((char *) data.d_buf + off, names[i]) != 0)
+	error (EXIT_FAILURE, 0, "\"%s\" not at offset %zu", names[i], off);
+      if (strcmp (dwelf_strent_str (ents[i]), names[i]) != 0)
+	error (EXIT_FAILURE, 0, "\"%s\" is not \"%s\"",
+	       dwelf_strent_str (ents[i]), names[i]);
+    }
+  if (nullstr && ((char *) data.d_buf)[0] != '\0')
+    error (EXIT_FAILURE, 0, "no leading null string");
+
+  /* And no string is stored which is the tail of another.  */
+  qsort (names, n, sizeof names[0], compare_names);
+  size_t expect = nullstr ? 1 : 0;
+  for (size_t i = 0; i < n; ++i)
+    {
+      if (i > 0 && strcmp (names[i - 1], names[i]) == 0)
+	continue;
+      if (nullstr && names[i][0] == '\0')
+	continue;
+      bool tail = false;
+      for (size_t j = 0; j < n && ! tail; ++j)
+	tail = (strcmp (names[i], names[j]) != 0
+		&& is_tail (names[i], names[j]));
+      if (! tail)
+	expect += strlen (names[i]) + 1;
+    }
+  if (data.d_size != expect)
+    error (EXIT_FAILURE, 0, "table of %zu strings has %zu bytes, not %zu",
+	   n, data.d_size, expect);
+
+  free (data.d_buf);
+  dwelf_strtab_free (st);
+  for (size_t i = 0; i < n; ++i)
+    free (names[i]);
+  free (names);
+  free (ents);
+}
+
+/* Print how long a table of N names takes, added in SORTED order of
+   their reversed strings or not.  */
+static void
+bench (size_t n, bool sorted)
+{
+  char **names = xmalloc (n * sizeof names[0]);
+  for (size_t i = 0; i < n; ++i)
+    {
+      names[i] = make_name (i);
+      if (sorted)
+	{
+	  /* Sort reversed names, then turn them around again.  */
+	  size_t len = strlen (names[i]);
+	  for (size_t j = 0; j < len / 2; ++j)
+	    {
+	      char c = names[i][j];
+	      names[i][j] = names[i][len - 1 - j];
+	      names[i][len - 1 - j] = c;
+	    }
+	}
+    }
+  if (sorted)
+    {
+      qsort (names, n, sizeof names[0], compare_names);
+      for (size_t i = 0; i < n; ++i)
+	{
+	  size_t len = strlen (names[i]);
+	  for (size_t j = 0; j < len / 2; ++j)
+	    {
+	      char c = names[i][j];
+	      names[i][j] = names[i][len - 1 - j];
+	      names[i][len - 1 - j] = c;
+	    }
+	}
+    }
+
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  Dwelf_Strtab *st = dwelf_strtab_init (true);
+  for (size_t i = 0; i < n; ++i)
+    dwelf_strtab_add (st, names[i]);
+  Elf_Data data;
+  dwelf_strtab_finalize (st, &data);
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  printf ("%zu %s names: %zu bytes, %.3f s\n", n,
+	  sorted ? "sorted" : "unsorted", data.d_size,
+	  (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+  free (data.d_buf);
+  dwelf_strtab_free (st);
+  for (size_t i = 0; i < n; ++i)
+    free (names[i]);
+  free (names);
+}
+
+int
+main (int argc, char *argv[])
+{
+  /* With an argument, time tables of that many names.  */
+  if (argc > 1)
+    {
+      size_t n = strtoull (argv[1], NULL, 0);
+      bench (n, false);
+      bench (n, true);
+      return 0;
+    }
+
+  static const size_t counts[] = { 0, 1, 2, 3, 10, 100, 1000 };
+  for (size_t c = 0; c < sizeof counts / sizeof counts[0]; ++c)
+    {
+      check (counts[c], true);
+      check (counts[c], false);
+    }
+
+  return 0;
+}
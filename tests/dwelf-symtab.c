@@ -0,0 +1,219 @@
+/* Test dwelf_symtab against plain walks over the symbol table.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include ELFUTILS_HEADER(dwelf)
+#include <gelf.h>
+#include "system.h"
+
+
+static int errors;
+
+static const char **sort_names;
+
+static int
+compare_names (const void *a, const void *b)
+{
+  size_t l = *(const size_t *) a;
+  size_t r = *(const size_t *) b;
+  int c = strcmp (sort_names[l], sort_names[r]);
+  return c != 0 ? c : (l > r) - (l < r);
+}
+
+#define fail(fmt, ...) \
+  (printf ("%s[%zu]: " fmt "\n", fname, scnndx, ##__VA_ARGS__), ++errors)
+
+static void
+check_symtab (const char *fname, Elf *elf, Elf_Scn *scn)
+{
+  size_t scnndx = elf_ndxscn (scn);
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  Elf_Data *data = elf_getdata (scn, NULL);
+  Elf_Data *xndxdata = NULL;
+  Elf_Scn *xscn = NULL;
+  while ((xscn = elf_nextscn (elf, xscn)) != NULL)
+    {
+      GElf_Shdr xshdr_mem;
+      GElf_Shdr *xshdr = gelf_getshdr (xscn, &xshdr_mem);
+      if (xshdr->sh_type == SHT_SYMTAB_SHNDX && xshdr->sh_link == scnndx)
+	xndxdata = elf_getdata (xscn, NULL);
+    }
+  size_t nsyms = data->d_size / gelf_fsize (elf, ELF_T_SYM, 1, EV_CURRENT);
+  size_t shnum;
+  elf_getshdrnum (elf, &shnum);
+
+  Dwelf_Symtab *st = dwelf_symtab_begin (scn);
+  if (st == NULL)
+    {
+      fail ("dwelf_symtab_begin failed");
+      return;
+    }
+
+  size_t n;
+  if (dwelf_symtab_count (st) != nsyms
+      || dwelf_symtab_raw (st, &n) != data->d_buf || n != nsyms)
+    fail ("wrong number of symbols");
+
+  GElf_Sym *syms = malloc (nsyms * sizeof *syms + 1);
+  GElf_Word *shndxs = malloc (nsyms * sizeof *shndxs + 1);
+  const char **names = malloc (nsyms * sizeof *names + 1);
+  for (size_t i = 0; i < nsyms; ++i)
+    {
+      GElf_Word xndx;
+      gelf_getsymshndx (data, xndxdata, i, &syms[i], &xndx);
+      shndxs[i] = syms[i].st_shndx == SHN_XINDEX ? xndx : syms[i].st_shndx;
+      names[i] = elf_strptr (elf, shdr->sh_link, syms[i].st_name);
+
+      GElf_Sym sym;
+      GElf_Word shndx;
+      const char *name = dwelf_symtab_getsym (st, i, &sym, &shndx);
+      if (memcmp (&sym, &syms[i], sizeof sym) != 0 || shndx != shndxs[i]
+	  || (name == NULL) != (names[i] == NULL)
+	  || (name != NULL && strcmp (name, names[i]) != 0))
+	fail ("symbol %zu differs", i);
+    }
+  if (dwelf_symtab_getsym (st, nsyms, NULL, NULL) != NULL)
+    fail ("symbol past the end");
+
+  /* Every name finds all its symbols, in order.  */
+  size_t *order = malloc (nsyms * sizeof *order + 1);
+  size_t nnamed = 0;
+  for (size_t i = 1; i < nsyms; ++i)
+    if (names[i] != NULL)
+      order[nnamed++] = i;
+  sort_names = names;
+  qsort (order, nnamed, sizeof *order, compare_names);
+  for (size_t k = 0; k < nnamed; ++k)
+    {
+      size_t i = order[k];
+      size_t next = (k + 1 < nnamed && strcmp (names[i],
+					       names[order[k + 1]]) == 0
+		     ? order[k + 1] : 0);
+      if (dwelf_symtab_find_name (st, names[i], i) != i
+	  || dwelf_symtab_find_name (st, names[i], i + 1) != next)
+	fail ("'%s' not found at %zu and %zu", names[i], i, next);
+      if ((k == 0 || strcmp (names[i], names[order[k - 1]]) != 0)
+	  && dwelf_symtab_find_name (st, names[i], 0) != i)
+	fail ("'%s' not found first at %zu", names[i], i);
+    }
+  free (order);
+  if (dwelf_symtab_find_name (st, "no such symbol, really", 0) != 0)
+    fail ("found a missing name");
+
+  /* The address order and lookups.  */
+  const GElf_Word *byaddr = dwelf_symtab_addrs (st, &n);
+  if (n != (nsyms == 0 ? 0 : nsyms - 1))
+    fail ("wrong number of sorted symbols");
+  for (size_t i = 0; i < n; ++i)
+    if (byaddr[i] == 0 || byaddr[i] >= nsyms)
+      {
+	fail ("bad sorted symbol %" PRIu32, byaddr[i]);
+	n = 0;
+      }
+  for (size_t i = 0; i < n; ++i)
+    {
+      GElf_Addr value = syms[byaddr[i]].st_value;
+      if (i > 0
+	  && (syms[byaddr[i - 1]].st_value > value
+	      || (syms[byaddr[i - 1]].st_value == value
+		  && byaddr[i - 1] >= byaddr[i])))
+	fail ("symbols %zu and %zu out of order", i - 1, i);
+
+      /* The first and last symbol with this value.  */
+      bool first = i == 0 || syms[byaddr[i - 1]].st_value != value;
+      bool last = i + 1 == n || syms[byaddr[i + 1]].st_value != value;
+      if ((first && value != 0 && dwelf_symtab_find_addr (st, value - 1) != i)
+	  || (last && dwelf_symtab_find_addr (st, value) != i + 1))
+	fail ("wrong position for %#" PRIx64, value);
+    }
+
+  /* The symbols of each section.  */
+  size_t insection = 0;
+  for (size_t i = 1; i < nsyms; ++i)
+    insection += shndxs[i] < shnum;
+  for (size_t s = 0; s < shnum + 1; ++s)
+    {
+      const GElf_Word *secsyms = dwelf_symtab_section (st, s, &n);
+      for (size_t k = 0; k < n; ++k)
+	if (secsyms[k] == 0 || secsyms[k] >= nsyms || shndxs[secsyms[k]] != s
+	    || (k > 0 && secsyms[k - 1] >= secsyms[k]))
+	  {
+	    fail ("bad symbol %zu in section %zu", k, s);
+	    break;
+	  }
+      insection -= n;
+    }
+  if (insection != 0)
+    fail ("symbols missing from sections");
+
+  free (names);
+  free (shndxs);
+  free (syms);
+  dwelf_symtab_end (st);
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  if (dwelf_symtab_begin (NULL) != NULL)
+    error (EXIT_FAILURE, 0, "dwelf_symtab_begin accepted NULL");
+  dwelf_symtab_end (NULL);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      const char *fname = argv[i];
+      int fd = open (fname, O_RDONLY);
+      if (fd < 0)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+      Elf *elf = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+      if (elf == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin %s: %s", fname, elf_errmsg (-1));
+
+      size_t nsymtabs = 0;
+      Elf_Scn *scn = NULL;
+      while ((scn = elf_nextscn (elf, scn)) != NULL)
+	{
+	  GElf_Shdr shdr_mem;
+	  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+	  if (shdr->sh_type == SHT_SYMTAB || shdr->sh_type == SHT_DYNSYM)
+	    {
+	      check_symtab (fname, elf, scn);
+	      ++nsymtabs;
+	    }
+	  else if (dwelf_symtab_begin (scn) != NULL)
+	    error (EXIT_FAILURE, 0, "%s: index of section %zu", fname,
+		   elf_ndxscn (scn));
+	}
+      printf ("%s: %zu symbol tables\n", fname, nsymtabs);
+
+      elf_end (elf);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/* Test module images read from a mapped core file as they are used.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(dwfl)
+#include ELFUTILS_HEADER(elf)
+#include "system.h"
+
+/* Only use the module images found in the core file.  */
+static int
+no_find_elf (Dwfl_Module *mod __attribute__ ((unused)),
+	     void **userdata __attribute__ ((unused)),
+	     const char *modname __attribute__ ((unused)),
+	     Dwarf_Addr base __attribute__ ((unused)),
+	     char **file_name __attribute__ ((unused)),
+	     Elf **elfp __attribute__ ((unused)))
+{
+  return -1;
+}
+
+static const Dwfl_Callbacks cb =
+{
+  .find_elf = no_find_elf,
+};
+
+/* Print a line for each section of the module image, with a checksum
+   of its contents.  */
+static int
+print_module (Dwfl_Module *mod, void **userdata __attribute__ ((unused)),
+	      const char *name, Dwarf_Addr start,
+	      void *arg __attribute__ ((unused)))
+{
+  Dwarf_Addr bias;
+  Elf *elf = dwfl_module_getelf (mod, &bias);
+  printf ("%#" PRIx64 " %s:%s\n", start, name,
+	  elf == NULL ? " no image" : "");
+  if (elf == NULL)
+    return DWARF_CB_OK;
+
+  Elf_Scn *scn = NULL;
+  while ((scn = elf_nextscn (elf, scn)) != NULL)
+    {
+      Elf_Data *data = elf_rawdata (scn, NULL);
+      if (data == NULL)
+	{
+	  printf ("  [%zu] %s\n", elf_ndxscn (scn), elf_errmsg (-1));
+	  continue;
+	}
+
+      uint32_t sum = 0;
+      for (size_t i = 0; data->d_buf != NULL && i < data->d_size; ++i)
+	sum = sum * 31 + ((unsigned char *) data->d_buf)[i];
+      printf ("  [%zu] %08" PRIx32 "\n", elf_ndxscn (scn), sum);
+    }
+  return DWARF_CB_OK;
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  for (int i = 1; i < argc; ++i)
+    {
+      int fd = open (argv[i], O_RDONLY);
+      if (fd < 0)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", argv[i]);
+      Elf *core = elf_begin (fd, ELF_C_READ_MMAP, NULL);
+      if (core == NULL)
+	error (EXIT_FAILURE, 0, "elf_begin %s: %s", argv[i], elf_errmsg (-1));
+
+      Dwfl *dwfl = dwfl_begin (&cb);
+      if (dwfl_core_file_report (dwfl, core, NULL) < 0)
+	error (EXIT_FAILURE, 0, "dwfl_core_file_report %s: %s", argv[i],
+	       dwfl_errmsg (-1));
+      dwfl_report_end (dwfl, NULL, NULL);
+      dwfl_getmodules (dwfl, print_module, NULL, 0);
+
+      /* The images don't keep references to the core file past this.  */
+      dwfl_end (dwfl);
+      if (elf_end (core) != 0)
+	error (EXIT_FAILURE, 0, "%s: core file still referenced", argv[i]);
+      close (fd);
+    }
+
+  return 0;
+}
@@ -0,0 +1,279 @@
+/* Test sharing modules between Dwfl sessions.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+#include "system.h"
+
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_build_id_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+  };
+
+#define NSESSIONS 3
+
+static Dwfl_Module *
+report (Dwfl *dwfl, const char *file, GElf_Addr base)
+{
+  dwfl_report_begin (dwfl);
+  Dwfl_Module *mod = dwfl_report_elf (dwfl, "test", file, -1, base, false);
+  if (mod == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_report_elf: %s", dwfl_errmsg (-1));
+  assert (dwfl_report_end (dwfl, NULL, NULL) == 0);
+  return mod;
+}
+
+static int
+count_cus (Dwfl_Module *mod)
+{
+  Dwarf_Addr bias;
+  Dwarf_Die *cu = NULL;
+  int n = 0;
+  while ((cu = dwfl_module_nextcu (mod, cu, &bias)) != NULL)
+    ++n;
+  return n;
+}
+
+static void
+test_sessions (const char *file)
+{
+  Dwfl_Module_Cache *cache = dwfl_module_cache_begin ();
+  assert (cache != NULL);
+
+  Dwfl *dwfl[NSESSIONS];
+  Dwfl_Module *mod[NSESSIONS];
+  Dwarf *dw[NSESSIONS];
+  for (int s = 0; s < NSESSIONS; ++s)
+    {
+      dwfl[s] = dwfl_begin (&callbacks);
+      assert (dwfl[s] != NULL);
+      /* The last session does not share.  */
+      if (s < NSESSIONS - 1)
+	dwfl_set_module_cache (dwfl[s], cache);
+      /* Load the module at different addresses.  */
+      mod[s] = report (dwfl[s], file, s * 0x1000000);
+
+      Dwarf_Addr bias;
+      dw[s] = dwfl_module_getdwarf (mod[s], &bias);
+      if (dw[s] == NULL)
+	error (EXIT_FAILURE, 0, "dwfl_module_getdwarf: %s",
+	       dwfl_errmsg (-1));
+    }
+
+  /* The sessions keep the cache alive.  */
+  dwfl_module_cache_end (cache);
+
+  printf ("%s: shared %d, unshared %d\n", file,
+	  dw[0] == dw[1], dw[0] == dw[2]);
+
+  GElf_Addr bias0, bias1;
+  assert (dwfl_module_getelf (mod[0], &bias0)
+	  == dwfl_module_getelf (mod[1], &bias1));
+  /* Only an ET_DYN module moves with its base address.  */
+  printf ("%s: bias difference %#" PRIx64 "\n", file, bias1 - bias0);
+
+  int ncus = count_cus (mod[2]);
+  assert (count_cus (mod[0]) == ncus);
+
+  /* The other module keeps using what is shared.  */
+  dwfl_end (dwfl[0]);
+  assert (count_cus (mod[1]) == ncus);
+  printf ("%s: %d CUs\n", file, ncus);
+
+  Dwarf_Addr cfi_bias;
+  Dwarf_CFI *cfi = dwfl_module_dwarf_cfi (mod[1], &cfi_bias);
+  Dwarf_CFI *cfi2 = dwfl_module_dwarf_cfi (mod[2], &cfi_bias);
+  assert ((cfi == NULL) == (cfi2 == NULL));
+
+  dwfl_end (dwfl[1]);
+  dwfl_end (dwfl[2]);
+}
+
+/* A stripped file has the same build ID as its original, but must not
+   take its place.  */
+static void
+test_stripped (const char *orig, const char *stripped)
+{
+  Dwfl_Module_Cache *cache = dwfl_module_cache_begin ();
+  assert (cache != NULL);
+
+  Dwfl *dwfl[2];
+  Dwfl_Module *mod[2];
+  const char *file[2] = { stripped, orig };
+  for (int s = 0; s < 2; ++s)
+    {
+      dwfl[s] = dwfl_begin (&callbacks);
+      assert (dwfl[s] != NULL);
+      dwfl_set_module_cache (dwfl[s], cache);
+      mod[s] = report (dwfl[s], file[s], 0);
+      /* Joins the cache, and would take over the file found there.  */
+      Dwarf_Addr bias;
+      dwfl_module_getdwarf (mod[s], &bias);
+    }
+  dwfl_module_cache_end (cache);
+
+  GElf_Addr bias0, bias1;
+  assert (dwfl_module_getelf (mod[0], &bias0)
+	  != dwfl_module_getelf (mod[1], &bias1));
+  printf ("%s: %d symbols\n", stripped, dwfl_module_getsymtab (mod[0]));
+  printf ("%s: %d symbols\n", orig, dwfl_module_getsymtab (mod[1]));
+
+  dwfl_end (dwfl[0]);
+  dwfl_end (dwfl[1]);
+}
+
+#define NTHREADS 8
+#define NROUNDS 10
+
+struct thread_session
+{
+  Dwfl_Module_Cache *cache;
+  const char *file;
+  pthread_barrier_t *barrier;
+  int ncus;
+  int nsyms;
+  int ndies;
+  int nlines;
+  int nscopes;
+  int nframes;
+  bool cfi;
+};
+
+/* Use FILE in a session of its own, while other threads do the same
+   with the same cache.  */
+static void *
+thread_session (void *arg)
+{
+  struct thread_session *t = arg;
+
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+  dwfl_set_module_cache (dwfl, t->cache);
+  Dwfl_Module *mod = report (dwfl, t->file, 0);
+
+  Dwarf_Addr bias;
+  if (dwfl_module_getdwarf (mod, &bias) == NULL)
+    error (EXIT_FAILURE, 0, "dwfl_module_getdwarf: %s", dwfl_errmsg (-1));
+  t->ncus = count_cus (mod);
+  Dwarf_Addr cfi_bias;
+  Dwarf_CFI *cfi = dwfl_module_dwarf_cfi (mod, &cfi_bias);
+  t->cfi = cfi != NULL;
+
+  /* The lines, scopes and frames are read as they are first needed,
+     by whichever thread comes first.  */
+  t->nsyms = dwfl_module_getsymtab (mod);
+  for (int i = 0; i < t->nsyms; ++i)
+    {
+      GElf_Sym sym;
+      GElf_Addr addr;
+      Dwarf_Die *cudie;
+      if (dwfl_module_getsym_info (mod, i, &sym, &addr, NULL, NULL, NULL)
+	  == NULL || sym.st_shndx == SHN_UNDEF
+	  || (cudie = dwfl_module_addrdie (mod, addr, &bias)) == NULL)
+	continue;
+      ++t->ndies;
+
+      if (dwfl_module_getsrc (mod, addr) != NULL)
+	++t->nlines;
+
+      Dwarf_Die *scopes;
+      int nscopes = dwarf_getscopes (cudie, addr - bias, &scopes);
+      if (nscopes > 0)
+	{
+	  t->nscopes += nscopes;
+	  free (scopes);
+	}
+
+      Dwarf_Frame *frame;
+      if (cfi != NULL && dwarf_cfi_addrframe (cfi, addr - cfi_bias,
+					      &frame) == 0)
+	{
+	  Dwarf_Op *ops;
+	  size_t nops;
+	  if (dwarf_frame_cfa (frame, &ops, &nops) == 0)
+	    ++t->nframes;
+	  free (frame);
+	}
+    }
+
+  /* Keep everything shared alive until all sessions have used it.  */
+  pthread_barrier_wait (t->barrier);
+  dwfl_end (dwfl);
+  return NULL;
+}
+
+static void
+test_threads (const char *file)
+{
+  for (int round = 0; round < NROUNDS; ++round)
+    {
+      Dwfl_Module_Cache *cache = dwfl_module_cache_begin ();
+      assert (cache != NULL);
+
+      pthread_barrier_t barrier;
+      pthread_barrier_init (&barrier, NULL, NTHREADS);
+      pthread_t threads[NTHREADS];
+      struct thread_session t[NTHREADS];
+      for (int i = 0; i < NTHREADS; ++i)
+	{
+	  t[i] = (struct thread_session) { .cache = cache, .file = file,
+					   .barrier = &barrier };
+	  int err = pthread_create (&threads[i], NULL, thread_session, &t[i]);
+	  if (err != 0)
+	    error (EXIT_FAILURE, err, "pthread_create");
+	}
+      for (int i = 0; i < NTHREADS; ++i)
+	pthread_join (threads[i], NULL);
+      pthread_barrier_destroy (&barrier);
+      dwfl_module_cache_end (cache);
+
+      for (int i = 1; i < NTHREADS; ++i)
+	if (t[i].ncus != t[0].ncus || t[i].nsyms != t[0].nsyms
+	    || t[i].ndies != t[0].ndies || t[i].nlines != t[0].nlines
+	    || t[i].nscopes != t[0].nscopes || t[i].nframes != t[0].nframes
+	    || t[i].cfi != t[0].cfi)
+	  error (EXIT_FAILURE, 0, "%s: sessions differ", file);
+      if (round == 0)
+	printf ("%s: %d CUs, %d symbols, %d in CUs, %d with lines,"
+		" %d scopes, CFI %d, %d frames\n", file,
+		t[0].ncus, t[0].nsyms, t[0].ndies, t[0].nlines,
+		t[0].nscopes, t[0].cfi, t[0].nframes);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  if (argc == 4 && strcmp (argv[1], "--stripped") == 0)
+    test_stripped (argv[2], argv[3]);
+  else if (argc > 1 && strcmp (argv[1], "--threads") == 0)
+    for (int i = 2; i < argc; ++i)
+      test_threads (argv[i]);
+  else
+    for (int i = 1; i < argc; ++i)
+      test_sessions (argv[i]);
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+/* Test reporting changes to the modules of a Dwfl.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <assert.h>
+#include <string.h>
+#include ELFUTILS_HEADER(dwfl)
+
+
+static const Dwfl_Callbacks callbacks =
+  {
+    .find_elf = dwfl_linux_proc_find_elf,
+    .find_debuginfo = dwfl_standard_find_debuginfo,
+  };
+
+static int nremoved;
+
+static int
+removed (Dwfl_Module *mod __attribute__ ((unused)),
+	 void *userdata __attribute__ ((unused)),
+	 const char *name, Dwarf_Addr base __attribute__ ((unused)),
+	 void *arg)
+{
+  assert (arg == NULL || strcmp (name, arg) == 0);
+  ++nremoved;
+  return 0;
+}
+
+static int
+count_module (Dwfl_Module *mod __attribute__ ((unused)),
+	      void **userdata __attribute__ ((unused)),
+	      const char *name __attribute__ ((unused)),
+	      Dwarf_Addr base __attribute__ ((unused)),
+	      void *arg)
+{
+  ++*(int *) arg;
+  return DWARF_CB_OK;
+}
+
+static int
+count_modules (Dwfl *dwfl)
+{
+  int n = 0;
+  assert (dwfl_getmodules (dwfl, count_module, &n, 0) == 0);
+  return n;
+}
+
+#define NMODS 5
+
+static const struct
+{
+  const char *name;
+  Dwarf_Addr start, end;
+} mods[NMODS] =
+  {
+    { "a", 0x10000, 0x12000 },
+    { "b", 0x20000, 0x23000 },
+    { "c", 0x30000, 0x31000 },
+    { "d", 0x40000, 0x48000 },
+    { "e", 0x50000, 0x51000 },
+  };
+
+int
+main (void)
+{
+  Dwfl *dwfl = dwfl_begin (&callbacks);
+  assert (dwfl != NULL);
+
+  Dwfl_Module *handle[NMODS];
+  dwfl_report_begin (dwfl);
+  for (int i = 0; i < NMODS; ++i)
+    {
+      handle[i] = dwfl_report_module (dwfl, mods[i].name,
+				      mods[i].start, mods[i].end);
+      assert (handle[i] != NULL);
+    }
+  assert (dwfl_report_end (dwfl, removed, NULL) == 0);
+  assert (nremoved == 0);
+  for (int i = 0; i < NMODS; ++i)
+    assert (dwfl_addrmodule (dwfl, mods[i].start + 0x100) == handle[i]);
+
+  /* Reporting the same modules again keeps all of them.  */
+  dwfl_report_begin (dwfl);
+  for (int i = 0; i < NMODS; ++i)
+    assert (dwfl_report_module (dwfl, mods[i].name,
+				mods[i].start, mods[i].end) == handle[i]);
+  assert (dwfl_report_end (dwfl, removed, NULL) == 0);
+  assert (nremoved == 0);
+  for (int i = 0; i < NMODS; ++i)
+    assert (dwfl_addrmodule (dwfl, mods[i].start + 0x100) == handle[i]);
+
+  /* Leave out one module, and report the others in another order.  */
+  dwfl_report_begin (dwfl);
+  for (int i = NMODS; i-- > 0; )
+    if (i != 2)
+      assert (dwfl_report_module (dwfl, mods[i].name,
+				  mods[i].start, mods[i].end) == handle[i]);
+  assert (dwfl_report_end (dwfl, removed, (void *) "c") == 0);
+  assert (nremoved == 1);
+  assert (count_modules (dwfl) == NMODS - 1);
+  assert (dwfl_addrmodule (dwfl, mods[2].start + 0x100) == NULL);
+  for (int i = 0; i < NMODS; ++i)
+    if (i != 2)
+      assert (dwfl_addrmodule (dwfl, mods[i].start + 0x100) == handle[i]);
+
+  /* Apply single changes on top of the existing modules.  */
+  dwfl_report_begin_add (dwfl);
+  handle[2] = dwfl_report_module (dwfl, "f", 0x60000, 0x61000);
+  assert (handle[2] != NULL);
+  dwfl_report_remove_module (handle[1]);
+  assert (dwfl_report_end (dwfl, removed, (void *) "b") == 0);
+  assert (nremoved == 2);
+  assert (count_modules (dwfl) == NMODS - 1);
+  assert (dwfl_addrmodule (dwfl, mods[1].start + 0x100) == NULL);
+  assert (dwfl_addrmodule (dwfl, 0x60100) == handle[2]);
+  assert (dwfl_addrmodule (dwfl, mods[0].start + 0x100) == handle[0]);
+  assert (dwfl_addrmodule (dwfl, mods[3].start + 0x100) == handle[3]);
+  assert (dwfl_addrmodule (dwfl, mods[4].start + 0x100) == handle[4]);
+
+  dwfl_report_begin_add (dwfl);
+  assert (dwfl_report_module (dwfl, mods[1].name,
+			      mods[1].start, mods[1].end) != NULL);
+  assert (dwfl_report_end (dwfl, removed, NULL) == 0);
+  assert (nremoved == 2);
+  assert (count_modules (dwfl) == NMODS);
+  assert (dwfl_addrmodule (dwfl, mods[1].start + 0x100) != NULL);
+  assert (dwfl_addrmodule (dwfl, mods[3].start + 0x100) == handle[3]);
+
+  dwfl_end (dwfl);
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+/* Test writing section data copied from another file.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+#include "system.h"
+
+
+/* Bigger than the buffer used when the data has to be copied through
+   memory.  */
+#define SRCSIZE ((1 << 21) + 1000)
+#define OFFSET 4321
+#define SIZE (SRCSIZE - OFFSET - 17)
+
+static const char shstrtab[] = "\0.copied\0.memory\0.shstrtab";
+
+static Elf_Scn *
+new_section (Elf *elf, size_t name, GElf_Word type)
+{
+  Elf_Scn *scn = elf_newscn (elf);
+  GElf_Shdr shdr_mem;
+  GElf_Shdr *shdr = gelf_getshdr (scn, &shdr_mem);
+  if (shdr == NULL)
+    error (EXIT_FAILURE, 0, "gelf_getshdr: %s", elf_errmsg (-1));
+  shdr->sh_name = name;
+  shdr->sh_type = type;
+  if (gelf_update_shdr (scn, shdr) == 0)
+    error (EXIT_FAILURE, 0, "gelf_update_shdr: %s", elf_errmsg (-1));
+  return scn;
+}
+
+static void
+check_section (Elf *elf, size_t ndx, const void *expect, size_t size)
+{
+  Elf_Data *data = elf_getdata (elf_getscn (elf, ndx), NULL);
+  if (data == NULL)
+    error (EXIT_FAILURE, 0, "elf_getdata: %s", elf_errmsg (-1));
+  if (data->d_size != size || memcmp (data->d_buf, expect, size) != 0)
+    error (EXIT_FAILURE, 0, "section %zu differs", ndx);
+}
+
+static void
+check (int srcfd, const unsigned char *src, Elf_Cmd cmd, int class)
+{
+  char name[] = "elf-setdata-file.XXXXXX";
+  int fd = mkstemp (name);
+  if (fd < 0)
+    error (EXIT_FAILURE, errno, "mkstemp");
+  unlink (name);
+
+  Elf *elf = elf_begin (fd, cmd, NULL);
+  if (elf == NULL || gelf_newehdr (elf, class) == 0)
+    error (EXIT_FAILURE, 0, "cannot create ELF file: %s", elf_errmsg (-1));
+  GElf_Ehdr ehdr_mem;
+  GElf_Ehdr *ehdr = gelf_getehdr (elf, &ehdr_mem);
+  ehdr->e_ident[EI_DATA] = ELFDATA2LSB;
+  ehdr->e_type = ET_REL;
+  ehdr->e_machine = EM_X86_64;
+  ehdr->e_version = EV_CURRENT;
+  ehdr->e_shstrndx = 3;
+  gelf_update_ehdr (elf, ehdr);
+
+  /* Two blocks of a section come from the file, with one in memory in
+     between.  */
+  Elf_Scn *scn = new_section (elf, 1, SHT_PROGBITS);
+  Elf_Data *data = elf_newdata (scn);
+  data->d_size = SIZE / 2;
+  data->d_align = 8;
+  if (elf_setdata_file (data, srcfd, OFFSET) != 0)
+    error (EXIT_FAILURE, 0, "elf_setdata_file: %s", elf_errmsg (-1));
+  data = elf_newdata (scn);
+  data->d_buf = (void *) "hello";
+  data->d_size = 5;
+  data->d_align = 1;
+  data = elf_newdata (scn);
+  data->d_size = SIZE - SIZE / 2;
+  data->d_align = 1;
+  if (elf_setdata_file (data, srcfd, OFFSET + SIZE / 2) != 0)
+    error (EXIT_FAILURE, 0, "elf_setdata_file: %s", elf_errmsg (-1));
+
+  /* The file data can be replaced by the buffer again.  */
+  scn = new_section (elf, 9, SHT_PROGBITS);
+  data = elf_newdata (scn);
+  data->d_buf = (void *) src;
+  data->d_size = 1000;
+  data->d_align = 1;
+  if (elf_setdata_file (data, srcfd, 1) != 0
+      || elf_setdata_file (data, -1, 0) != 0)
+    error (EXIT_FAILURE, 0, "elf_setdata_file: %s", elf_errmsg (-1));
+
+  scn = new_section (elf, 17, SHT_STRTAB);
+  data = elf_newdata (scn);
+  data->d_buf = (void *) shstrtab;
+  data->d_size = sizeof shstrtab;
+  data->d_align = 1;
+
+  if (elf_update (elf, ELF_C_WRITE) < 0)
+    error (EXIT_FAILURE, 0, "elf_update: %s", elf_errmsg (-1));
+  elf_end (elf);
+
+  elf = elf_begin (fd, ELF_C_READ, NULL);
+  if (elf == NULL)
+    error (EXIT_FAILURE, 0, "elf_begin: %s", elf_errmsg (-1));
+  unsigned char *expect = malloc (SIZE + 5);
+  memcpy (expect, src + OFFSET, SIZE / 2);
+  memcpy (expect + SIZE / 2, "hello", 5);
+  memcpy (expect + SIZE / 2 + 5, src + OFFSET + SIZE / 2, SIZE - SIZE / 2);
+  check_section (elf, 1, expect, SIZE + 5);
+  check_section (elf, 2, src, 1000);
+  check_section (elf, 3, shstrtab, sizeof shstrtab);
+  free (expect);
+  elf_end (elf);
+  close (fd);
+}
+
+int
+main (void)
+{
+  elf_version (EV_CURRENT);
+
+  unsigned char *src = malloc (SRCSIZE);
+  for (size_t i = 0; i < SRCSIZE; ++i)
+    src[i] = i * 7 + (i >> 8);
+  char name[] = "elf-setdata-src.XXXXXX";
+  int srcfd = mkstemp (name);
+  if (srcfd < 0)
+    error (EXIT_FAILURE, errno, "mkstemp");
+  unlink (name);
+  if (write (srcfd, src, SRCSIZE) != SRCSIZE)
+    error (EXIT_FAILURE, errno, "write");
+
+  check (srcfd, src, ELF_C_WRITE, ELFCLASS32);
+  check (srcfd, src, ELF_C_WRITE, ELFCLASS64);
+  check (srcfd, src, ELF_C_WRITE_MMAP, ELFCLASS32);
+  check (srcfd, src, ELF_C_WRITE_MMAP, ELFCLASS64);
+
+  if (elf_setdata_file (NULL, srcfd, 0) != -1)
+    error (EXIT_FAILURE, 0, "elf_setdata_file accepted no data");
+
+  free (src);
+  close (srcfd);
+  return 0;
+}
@@ -402,6 +402,8 @@ main (int argc, char **argv)
     fail_elf ("Couldn't get ehdr", fnew);
 
   newehdr.e_ident[EI_DATA] = ehdr.e_ident[EI_DATA];
+  newehdr.e_ident[EI_OSABI] = ehdr.e_ident[EI_OSABI];
+  newehdr.e_ident[EI_ABIVERSION] = ehdr.e_ident[EI_ABIVERSION];
   newehdr.e_type = ehdr.e_type;
   newehdr.e_machine = ehdr.e_machine;
   newehdr.e_version = ehdr.e_version;
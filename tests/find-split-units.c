@@ -0,0 +1,117 @@
+/* Test dwarf_find_split_units against looking up split units one by one.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include "system.h"
+
+
+static Dwarf *
+open_dwarf (const char *fname, int *fdp)
+{
+  *fdp = open (fname, O_RDONLY);
+  if (*fdp < 0)
+    error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+  Dwarf *dbg = dwarf_begin (*fdp, DWARF_C_READ);
+  if (dbg == NULL)
+    error (EXIT_FAILURE, 0, "dwarf_begin %s: %s", fname, dwarf_errmsg (-1));
+  return dbg;
+}
+
+int
+main (int argc, char *argv[])
+{
+  int errors = 0;
+
+  if (dwarf_find_split_units (NULL, 1) != -1)
+    error (EXIT_FAILURE, 0, "dwarf_find_split_units accepted NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      const char *fname = argv[i];
+      int fd, lazy_fd;
+      Dwarf *dbg = open_dwarf (fname, &fd);
+      Dwarf *lazy_dbg = open_dwarf (fname, &lazy_fd);
+
+      int found = dwarf_find_split_units (dbg, 4);
+      printf ("%s: %d split units\n", fname, found);
+      /* Zero jobs means one per CPU.  */
+      if (dwarf_find_split_units (dbg, 0) != found)
+	{
+	  printf ("%s: different result the second time\n", fname);
+	  ++errors;
+	}
+
+      /* Walk both in the same order, DBG has all split units linked
+	 already and LAZY_DBG looks them up now.  */
+      Dwarf_CU *cu = NULL;
+      Dwarf_CU *lazy_cu = NULL;
+      Dwarf_Die subdie, lazy_subdie;
+      uint8_t unit_type;
+      int nskel = 0;
+      int nsplit = 0;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, &unit_type,
+			      NULL, NULL) == 0)
+	{
+	  if (dwarf_get_units (lazy_dbg, lazy_cu, &lazy_cu, NULL, NULL,
+			       NULL, NULL) != 0)
+	    error (EXIT_FAILURE, 0, "%s: fewer units", fname);
+	  if (unit_type != DW_UT_skeleton)
+	    continue;
+
+	  ++nskel;
+	  dwarf_cu_info (cu, NULL, NULL, NULL, &subdie, NULL, NULL, NULL);
+	  dwarf_cu_info (lazy_cu, NULL, NULL, NULL, &lazy_subdie,
+			 NULL, NULL, NULL);
+	  bool has = dwarf_tag (&subdie) == DW_TAG_compile_unit;
+	  bool lazy_has = dwarf_tag (&lazy_subdie) == DW_TAG_compile_unit;
+	  nsplit += has;
+	  if (has != lazy_has
+	      || (has && (dwarf_dieoffset (&subdie)
+			  != dwarf_dieoffset (&lazy_subdie)
+			  || strcmp (dwarf_diename (&subdie),
+				     dwarf_diename (&lazy_subdie)) != 0)))
+	    {
+	      printf ("%s: different split unit for skeleton %d\n",
+		      fname, nskel);
+	      ++errors;
+	    }
+	  else
+	    printf ("skeleton %d: %s\n", nskel,
+		    has ? dwarf_diename (&subdie) : "no split unit");
+	}
+      if (nsplit != found)
+	{
+	  printf ("%s: %d split units linked\n", fname, nsplit);
+	  ++errors;
+	}
+
+      dwarf_end (lazy_dbg);
+      dwarf_end (dbg);
+      close (lazy_fd);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
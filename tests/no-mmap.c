@@ -0,0 +1,39 @@
+/* Preloaded to make mapping files fail, so libelf reads them instead.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <dlfcn.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+/* Anonymous mappings, as for thread stacks, still work.  The C
+   library's own calls, as from malloc, don't come here.  */
+void *
+mmap (void *addr, size_t len, int prot, int flags, int fd, off_t offset)
+{
+  static void *(*real_mmap) (void *, size_t, int, int, int, off_t);
+
+  if ((flags & MAP_ANONYMOUS) == 0)
+    {
+      errno = ENODEV;
+      return MAP_FAILED;
+    }
+
+  if (real_mmap == NULL)
+    real_mmap = dlsym (RTLD_NEXT, "mmap");
+  return real_mmap (addr, len, prot, flags, fd, offset);
+}
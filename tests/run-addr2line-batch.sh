@@ -0,0 +1,132 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-addr2line-i-test.sh.
+testfiles testfile-inlines
+tempfiles addrs.in addrs.out addrs.bin addrs.bin.out batch.out
+tempfiles self.in self.out self.batch.out
+
+# Addresses out of order, repeated and one that cannot be found.
+cat > addrs.in <<\EOF
+0x5f1
+0x5a0
+0x5e1
+0x5f1
+bogus
+0x5c0
+0x5b1
+EOF
+
+cat > addrs.out <<\EOF
+0x00000000000005f1
+fubar inlined at /tmp/x.cpp:32 in _Z2fuv
+/tmp/x.cpp:10
+_Z2fuv
+/tmp/x.cpp:32
+0x00000000000005a0
+foobar
+/tmp/x.cpp:5
+0x00000000000005e1
+fubar inlined at /tmp/x.cpp:20 in _Z3foov
+/tmp/x.cpp:10
+baz
+/tmp/x.cpp:20
+_Z3foov
+/tmp/x.cpp:26
+0x00000000000005f1
+fubar inlined at /tmp/x.cpp:32 in _Z2fuv
+/tmp/x.cpp:10
+_Z2fuv
+/tmp/x.cpp:32
+0x00000000000005c0
+foobar inlined at /tmp/x.cpp:15 in _Z3barv
+/tmp/x.cpp:5
+bar
+/tmp/x.cpp:15
+0x00000000000005b1
+fubar
+/tmp/x.cpp:11
+EOF
+
+for opts in "" --batch --batch=3 --jobs=2 "--batch=2 --jobs=3"; do
+  testrun ${abs_top_builddir}/src/addr2line $opts -a -f -i \
+    -e testfile-inlines < addrs.in > batch.out || exit 1
+  cmp addrs.out batch.out || exit 1
+done
+
+# The same addresses in binary, without the one that cannot be found.
+# Each result ends with a NUL character.
+if test "`printf '\001\000' | od -An -tu2 | tr -d ' '`" = 1; then
+  printf '\361\005\0\0\0\0\0\0\240\005\0\0\0\0\0\0\341\005\0\0\0\0\0\0\361\005\0\0\0\0\0\0\300\005\0\0\0\0\0\0\261\005\0\0\0\0\0\0' > addrs.bin
+else
+  printf '\0\0\0\0\0\0\005\361\0\0\0\0\0\0\005\240\0\0\0\0\0\0\005\341\0\0\0\0\0\0\005\361\0\0\0\0\0\0\005\300\0\0\0\0\0\0\005\261' > addrs.bin
+fi
+
+cat > addrs.bin.out <<\EOF
+0x00000000000005f1
+fubar inlined at /tmp/x.cpp:32 in _Z2fuv
+/tmp/x.cpp:10
+_Z2fuv
+/tmp/x.cpp:32
+#0x00000000000005a0
+foobar
+/tmp/x.cpp:5
+#0x00000000000005e1
+fubar inlined at /tmp/x.cpp:20 in _Z3foov
+/tmp/x.cpp:10
+baz
+/tmp/x.cpp:20
+_Z3foov
+/tmp/x.cpp:26
+#0x00000000000005f1
+fubar inlined at /tmp/x.cpp:32 in _Z2fuv
+/tmp/x.cpp:10
+_Z2fuv
+/tmp/x.cpp:32
+#0x00000000000005c0
+foobar inlined at /tmp/x.cpp:15 in _Z3barv
+/tmp/x.cpp:5
+bar
+/tmp/x.cpp:15
+#0x00000000000005b1
+fubar
+/tmp/x.cpp:11
+#
+EOF
+
+for opts in "" --jobs=2; do
+  testrun ${abs_top_builddir}/src/addr2line --binary $opts -a -f -i \
+    -e testfile-inlines < addrs.bin | tr '\0' '#' > batch.out
+  echo >> batch.out
+  cmp addrs.bin.out batch.out || exit 1
+done
+
+# Self test, only checks that looking up the functions in batches on
+# several threads gives the same as looking them up one by one.
+for file in $self_test_files_exe; do
+  testrun ${abs_top_builddir}/src/nm -P --defined-only $file \
+    | awk '$2 ~ /^[tT]$/ { print $3 }' > self.in
+  testrun ${abs_top_builddir}/src/addr2line -a -f -i -e $file \
+    < self.in > self.out
+  testrun ${abs_top_builddir}/src/addr2line --batch=100 --jobs=3 -a -f -i \
+    -e $file < self.in > self.batch.out
+  cmp self.out self.batch.out || exit 1
+done
+
+exit 0
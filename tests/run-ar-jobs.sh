@@ -0,0 +1,88 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Reading or extracting the archive members on several threads gives
+# the same archives and files as doing it one by one.  Only use the
+# objects whose names fit into the member header.
+objs=
+for o in $(echo ${abs_top_builddir}/src/*.o | sort); do
+  test $(basename $o | wc -c) -le 16 && objs="$objs $o"
+done
+test -n "$objs" || exit 77
+
+tempfiles plain.a test.a test-j.a ranlib.a ranlib-j.a
+
+echo Create archives with a symbol table.
+testrun ${abs_top_builddir}/src/ar -D -rcs test.a $objs
+testrun ${abs_top_builddir}/src/ar -D -j 4 -rcs test-j.a $objs
+cmp test.a test-j.a
+
+echo Add a symbol table to an archive without one.
+testrun ${abs_top_builddir}/src/ar -D -rc plain.a $objs
+cp plain.a ranlib.a
+cp plain.a ranlib-j.a
+testrun ${abs_top_builddir}/src/ranlib -D ranlib.a
+testrun ${abs_top_builddir}/src/ranlib -D -j 3 ranlib-j.a
+cmp ranlib.a ranlib-j.a
+cmp test.a ranlib-j.a
+
+echo Replace and delete members.
+first=$(echo $objs | cut -d' ' -f1)
+last=$(echo $objs | tr ' ' '\n' | tail -1)
+testrun ${abs_top_builddir}/src/ar -D -rs test.a $last
+testrun ${abs_top_builddir}/src/ar -D -j 2 -rs test-j.a $last
+cmp test.a test-j.a
+testrun ${abs_top_builddir}/src/ar -D -d test.a $(basename $first)
+testrun ${abs_top_builddir}/src/ar -D -j 2 -d test-j.a $(basename $first)
+cmp test.a test-j.a
+
+echo Extract all members.
+rm -rf extract extract-j
+mkdir extract extract-j
+(cd extract && testrun ${abs_top_builddir}/src/ar -x ../test.a)
+(cd extract-j && testrun ${abs_top_builddir}/src/ar -j 4 -x ../test-j.a)
+for o in $objs; do
+  o=$(basename $o)
+  test $o = $(basename $first) && continue
+  cmp extract/$o extract-j/$o
+done
+rm -rf extract extract-j
+
+# Again when the archives cannot be mmapped and libelf reads them.
+# Freed memory is overwritten, so reading a member's content after
+# it was ended shows.
+echo Without mmap.
+tempfiles ranlib-nommap.a
+cp plain.a ranlib-nommap.a
+LD_PRELOAD=${abs_builddir}/no-mmap.so MALLOC_PERTURB_=165 \
+  testrun ${abs_top_builddir}/src/ranlib -D -j 3 ranlib-nommap.a
+cmp ranlib.a ranlib-nommap.a
+rm -rf extract extract-j
+mkdir extract extract-j
+(cd extract && testrun ${abs_top_builddir}/src/ar -x ../test.a)
+(cd extract-j && LD_PRELOAD=${abs_builddir}/no-mmap.so MALLOC_PERTURB_=165 \
+  testrun ${abs_top_builddir}/src/ar -j 4 -x ../test.a)
+for o in $objs; do
+  o=$(basename $o)
+  test $o = $(basename $first) && continue
+  cmp extract/$o extract-j/$o
+done
+rm -rf extract extract-j
+
+exit 0
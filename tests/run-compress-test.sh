@@ -127,4 +127,13 @@ testrun_elfcompress testfile-zgnu32be
 testrun_elfcompress testfile-zgabi32
 testrun_elfcompress testfile-zgabi32be
 
+# The OSABI is kept, the STB_GNU_UNIQUE symbol in this object (see
+# run-nm-syms.sh) is only valid with ELFOSABI_GNU.
+testfiles testfilesyms64
+tempfiles testfilesyms64.gabi
+testrun ${abs_top_builddir}/src/elfcompress -q -f -n '*' -t zlib \
+  -o testfilesyms64.gabi testfilesyms64
+testrun ${abs_top_builddir}/src/elfcmp testfilesyms64 testfilesyms64.gabi
+testrun ${abs_top_builddir}/src/elflint --gnu-ld testfilesyms64.gabi
+
 exit 0
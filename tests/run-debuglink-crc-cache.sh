@@ -0,0 +1,77 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# testfile36 has no build ID, so its debuglink CRC is checked.
+testfiles testfile36 testfile36.debug
+tempfiles crc-cache
+
+ELFUTILS_CRC32_CACHE=$(pwd)/crc-cache
+export ELFUTILS_CRC32_CACHE
+
+found()
+{
+  testrun_compare ${abs_top_builddir}/src/addr2line -f -j .text \
+    -e testfile36 0x0 <<\EOF
+init_kzalloc_test
+/home/wcohen/minimal_mod/minimal_mod.c:9
+EOF
+}
+
+# The CRC gets stored, only once.
+found
+found
+test $(grep -c ' 8c5c20a3$' crc-cache) -eq 1 || exit 1
+
+# A stored CRC is used instead of checking the file again, so now
+# only the symbols of the main file are found.
+sed 's/ 8c5c20a3$/ 00000000/' crc-cache > crc-cache.new
+mv crc-cache.new crc-cache
+chmod 600 crc-cache
+testrun_compare ${abs_top_builddir}/src/addr2line -f -j .text \
+  -e testfile36 0x0 <<\EOF
+init_module
+??:0
+EOF
+
+# Until the file changes.
+touch -m -d '2000-01-01 00:00' testfile36.debug
+found
+test $(grep -c ' 8c5c20a3$' crc-cache) -eq 1 || exit 1
+
+# Only the user can read and write the file made.
+rm -f crc-cache
+found
+test "$(stat -c %a crc-cache)" = 600 || exit 1
+
+# A file others can write is not used at all.
+sed 's/ 8c5c20a3$/ 00000000/' crc-cache > crc-cache.new
+mv crc-cache.new crc-cache
+chmod 620 crc-cache
+found
+test $(grep -c ' 8c5c20a3$' crc-cache) -eq 0 || exit 1
+
+# A full file is started over.
+awk 'BEGIN { for (i = 0; i < 50000; ++i) printf "0 %x 0 0 0 00000000\n", i }' \
+  > crc-cache
+chmod 600 crc-cache
+found
+test $(wc -l < crc-cache) -eq 1 || exit 1
+test $(grep -c ' 8c5c20a3$' crc-cache) -eq 1 || exit 1
+
+exit 0
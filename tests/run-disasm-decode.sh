@@ -0,0 +1,48 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# disasm_decode agrees with the text disassembler on the instruction
+# boundaries, mnemonics and branch targets.
+testfiles testfile-bpf-dis1.o testfile-riscv64-dis1.o
+
+testrun_compare ${abs_builddir}/disasm-decode \
+  testfile-bpf-dis1.o testfile-riscv64-dis1.o <<\EOF
+testfile-bpf-dis1.o .text: 256 instructions, 23 jumps, 1 calls, 1 returns, 158 invalid
+testfile-bpf-dis1.o .text+1: 256 instructions, 0 jumps, 0 calls, 0 returns, 256 invalid
+testfile-riscv64-dis1.o .text: 501 instructions, 38 jumps, 24 calls, 0 returns, 0 invalid
+testfile-riscv64-dis1.o .text+1: 693 instructions, 8 jumps, 4 calls, 0 returns, 102 invalid
+EOF
+
+case "`uname -m`" in
+  x86_64)
+    tempfiles testfile44.o testfile45.o
+    testfiles testfile44.S testfile45.S
+    ${CC} -m32 -c -o testfile44.o testfile44.S
+    ${CC} -m64 -c -o testfile45.o testfile45.S
+    testrun_compare ${abs_builddir}/disasm-decode \
+      testfile44.o testfile45.o <<\EOF
+testfile44.o .text: 7522 instructions, 71 jumps, 10 calls, 7 returns, 0 invalid
+testfile44.o .text+1: 7522 instructions, 71 jumps, 10 calls, 7 returns, 0 invalid
+testfile45.o .text: 11422 instructions, 69 jumps, 9 calls, 7 returns, 0 invalid
+testfile45.o .text+1: 11421 instructions, 69 jumps, 9 calls, 7 returns, 0 invalid
+EOF
+    ;;
+esac
+
+exit 0
@@ -0,0 +1,59 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Disassemble a .text section made of several copies of the x86-64
+# disassembler test input.  Each size is four times the one before,
+# the time taken should grow about the same.  Set DISASM_BENCH to try
+# other sizes.
+case "`uname -m`" in
+  x86_64) ;;
+  *) exit 77 ;;
+esac
+
+copies=${DISASM_BENCH:-"1 4 16"}
+
+testfiles testfile45.S testfile45.expect
+tempfiles bench.S bench.o bench.out bench.first
+
+nlines=$(( $(wc -l < testfile45.expect) - 1 ))
+ninstr=$(grep -c '^ *[0-9a-f]*:' testfile45.expect)
+
+for n in $copies; do
+  : > bench.S
+  i=0
+  while test $i -lt $n; do
+    cat testfile45.S >> bench.S
+    i=$(( i + 1 ))
+  done
+  ${CC} -m64 -c -o bench.o bench.S ||
+    { echo "cannot assemble"; exit 77; }
+
+  start=$(date +%s%N)
+  testrun ${abs_top_builddir}/src/objdump -d bench.o > bench.out
+  end=$(date +%s%N)
+  echo "$n copies: $(( (end - start) / 1000000 )) ms"
+
+  # The first copy disassembles as expected, the others to as many
+  # instructions.
+  sed 1d bench.out | head -n $nlines > bench.first
+  sed 1d testfile45.expect | cmp - bench.first
+  test $(grep -c '^ *[0-9a-f]*:' bench.out) -eq $(( n * ninstr ))
+done
+
+exit 0
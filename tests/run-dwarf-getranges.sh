@@ -0,0 +1,59 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-all-dwarf-ranges.sh and run-dwarf-ranges.sh.
+testfiles testfilesplitranges4.debug
+testfiles testfile-ranges-hello.dwo testfile-ranges-world.dwo
+testfiles testfilesplitranges5.debug
+testfiles testfile-ranges-hello5.dwo testfile-ranges-world5.dwo
+testfiles testfileranges4.debug testfileranges5.debug
+
+testrun_compare ${abs_builddir}/dwarf-getranges \
+  testfilesplitranges4.debug testfilesplitranges5.debug \
+  testfileranges4.debug testfileranges5.debug << \EOF
+testfilesplitranges4.debug: 12 dies with 16 ranges, 13 location lists, 0 broken
+testfilesplitranges5.debug: 12 dies with 16 ranges, 13 location lists, 0 broken
+testfileranges4.debug: 13 dies with 16 ranges, 14 location lists, 0 broken
+testfileranges5.debug: 12 dies with 16 ranges, 13 location lists, 0 broken
+EOF
+
+# See testfile-dwp.source and run-varlocs.sh.
+testfiles testfile-dwp-5 testfile-dwp-5.dwp
+testfiles testfile-dwp-4 testfile-dwp-4.dwp
+testfiles testfileloc
+
+testrun_compare ${abs_builddir}/dwarf-getranges \
+  testfile-dwp-5 testfile-dwp-4 testfileloc << \EOF
+testfile-dwp-5: 15 dies with 23 ranges, 12 location lists, 0 broken
+testfile-dwp-4: 14 dies with 22 ranges, 12 location lists, 0 broken
+testfileloc: 6 dies with 8 ranges, 3 location lists, 0 broken
+EOF
+
+# Read on its own, a split unit has no addresses for its location
+# lists, so none of them can be decoded.
+testrun_compare ${abs_builddir}/dwarf-getranges \
+  testfile-ranges-hello.dwo << \EOF
+testfile-ranges-hello.dwo: 0 dies with 0 ranges, 0 location lists, 5 broken
+EOF
+
+# Self test, only checks that nothing differs.
+testrun_on_self_exe ${abs_builddir}/dwarf-getranges
+testrun_on_self_lib ${abs_builddir}/dwarf-getranges
+
+exit 0
@@ -0,0 +1,39 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-find-split-units.sh and run-get-units-split.sh.
+testfiles testfile-dwarf-5 testfile-debug-types
+testfiles testfile-splitdwarf-4 testfile-hello4.dwo testfile-world4.dwo
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+testfiles testfile-dwp-5 testfile-dwp-5.dwp
+
+testrun_compare ${abs_builddir}/dwarf-preload testfile-dwarf-5 \
+  testfile-debug-types testfile-splitdwarf-4 testfile-splitdwarf-5 \
+  testfile-dwp-5 << \EOF
+testfile-dwarf-5: 2 units, 57 lines, 3 ranges, 3 aranges
+testfile-debug-types: 3 units, 9 lines, 1 ranges, 1 aranges
+testfile-splitdwarf-4: 4 units, 114 lines, 6 ranges, 3 aranges
+testfile-splitdwarf-5: 4 units, 114 lines, 6 ranges, 3 aranges
+testfile-dwp-5: 6 units, 222 lines, 6 ranges, 3 aranges
+EOF
+
+# Self test, only checks that nothing differs.
+testrun_on_self_exe ${abs_builddir}/dwarf-preload
+
+exit 0
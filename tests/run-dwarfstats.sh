@@ -0,0 +1,120 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-varlocs.sh.
+testfiles testfileloc
+
+testrun_compare ${abs_top_builddir}/src/dwarfstats testfileloc << \EOF
+testfileloc: 2 units, 28 DIEs, 124 attributes
+  line tables: 2, 13 rows, 4 files
+  variables and parameters in code: 7, 6 with location, 3 location lists
+  location coverage: 88 of 128 bytes (68.8%)
+  malformed: 0
+  tags:
+    DW_TAG_formal_parameter                      10
+    DW_TAG_subprogram                             5
+    DW_TAG_base_type                              4
+    DW_TAG_pointer_type                           3
+    DW_TAG_compile_unit                           2
+    DW_TAG_inlined_subroutine                     2
+    DW_TAG_const_type                             1
+    DW_TAG_variable                               1
+  attributes:
+    DW_AT_name                                   19
+    DW_AT_type                                   17
+    DW_AT_decl_file                              13
+    DW_AT_decl_line                              13
+    DW_AT_byte_size                               7
+    DW_AT_location                                6
+    DW_AT_prototyped                              5
+    DW_AT_abstract_origin                         5
+    DW_AT_sibling                                 4
+    DW_AT_low_pc                                  4
+    DW_AT_high_pc                                 4
+    DW_AT_encoding                                4
+    DW_AT_inline                                  3
+    DW_AT_stmt_list                               2
+    DW_AT_language                                2
+    DW_AT_comp_dir                                2
+    DW_AT_producer                                2
+    DW_AT_external                                2
+    DW_AT_frame_base                              2
+    DW_AT_entry_pc                                2
+    DW_AT_ranges                                  2
+    DW_AT_call_file                               2
+    DW_AT_call_line                               2
+  forms:
+    DW_FORM_data1                                46
+    DW_FORM_ref4                                 26
+    DW_FORM_strp                                 17
+    DW_FORM_addr                                 10
+    DW_FORM_data4                                 7
+    DW_FORM_flag                                  7
+    DW_FORM_string                                6
+    DW_FORM_block1                                5
+EOF
+
+# Split units through their skeleton and in a DWARF package file.
+# See run-get-units-split.sh and testfile-dwp.source.
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+testfiles testfile-dwp-5 testfile-dwp-5.dwp
+
+testrun_compare ${abs_top_builddir}/src/dwarfstats -s \
+  testfile-splitdwarf-5 testfile-dwp-5 << \EOF
+testfile-splitdwarf-5: 4 units, 76 DIEs, 328 attributes
+  line tables: 2, 57 rows, 8 files
+  variables and parameters in code: 16, 16 with location, 16 location lists
+  location coverage: 282 of 344 bytes (82.0%)
+  malformed: 0
+testfile-dwp-5: 6 units, 74 DIEs, 315 attributes
+  line tables: 3, 111 rows, 12 files
+  variables and parameters in code: 17, 16 with location, 12 location lists
+  location coverage: 937 of 1051 bytes (89.2%)
+  malformed: 0
+EOF
+
+# The CU DIE has an invalid abbrev, see run-rerequest_tag.sh.
+testfiles testfile56
+
+testrun_compare ${abs_top_builddir}/src/dwarfstats -s -v testfile56 << \EOF
+testfile56: [b] invalid DWARF
+testfile56: 1 units, 0 DIEs, 0 attributes
+  line tables: 0, 0 rows, 0 files
+  variables and parameters in code: 0, 0 with location, 0 location lists
+  malformed: 1
+EOF
+
+if testrun ${abs_top_builddir}/src/dwarfstats -s testfile56 > /dev/null; then
+  echo "malformed DWARF not reported in exit status"
+  exit 1
+fi
+
+# The same statistics no matter how many units are scanned at once.
+# References to other units use DW_FORM_ref_addr in the LTO file and
+# DW_FORM_ref_sig8 in the one with type units.
+# See run-allfcts.sh and run-typeiter.sh.
+testfiles testfile-lto-gcc10 testfile-debug-types
+for file in testfile-lto-gcc10 testfile-debug-types $self_test_files_exe; do
+  testrun ${abs_top_builddir}/src/dwarfstats $file > serial.out
+  testrun ${abs_top_builddir}/src/dwarfstats -j 3 $file > parallel.out
+  cmp serial.out parallel.out
+done
+rm -f serial.out parallel.out
+
+exit 0
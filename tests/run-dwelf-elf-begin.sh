@@ -0,0 +1,100 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Compressed files are read the same as the uncompressed ones, whether
+# decompressed in full ("in memory") or in parts as they are read.
+
+# See run-strip-reloc.sh and run-readelf-mixed-corenote.sh.
+testfiles hello_i386.ko testfile66.core
+
+tempfiles hello_i386.ko.gz testfile66.core.gz
+
+# A gzip file is read in parts when there are checkpoints far enough
+# apart, which needs more than 1MiB of output and deflate blocks which
+# are not too large.
+gzip -c hello_i386.ko > hello_i386.ko.gz
+gzip -c --rsyncable testfile66.core > testfile66.core.gz
+
+testrun_compare ${abs_builddir}/dwelf-elf-begin hello_i386.ko \
+  hello_i386.ko.gz testfile66.core testfile66.core.gz << \EOF
+hello_i386.ko: 76a233f8
+hello_i386.ko.gz: 76a233f8 in memory
+testfile66.core: 87b8e9e3
+testfile66.core.gz: 87b8e9e3
+EOF
+
+if type xz > /dev/null 2>&1 \
+   && grep -q -F '#define USE_LZMA' ${abs_top_builddir}/config.h; then
+  tempfiles hello_i386.ko.xz
+  xz -c --block-size=4KiB hello_i386.ko > hello_i386.ko.xz
+  testrun_compare ${abs_builddir}/dwelf-elf-begin hello_i386.ko.xz << \EOF
+hello_i386.ko.xz: 76a233f8
+EOF
+fi
+
+if ! type zstd > /dev/null 2>&1 \
+   || ! grep -q -F '#define USE_ZSTD' ${abs_top_builddir}/config.h; then
+  exit 0
+fi
+
+le32 ()
+{
+  printf "\\$(printf %o $(($1 & 255)))\\$(printf %o $(($1 >> 8 & 255)))"
+  printf "\\$(printf %o $(($1 >> 16 & 255)))\\$(printf %o $(($1 >> 24)))"
+}
+
+# A zstd file of a single frame, one of several frames and the same
+# with the seek table of the zstd seekable format after them.
+tempfiles hello_i386.ko.zst frames.zst seekable.zst seektable
+zstd -q -c hello_i386.ko > hello_i386.ko.zst
+split -b 8192 hello_i386.ko part.
+nframes=0
+: > frames.zst
+: > seektable
+for part in part.*; do
+  tempfiles $part $part.zst
+  zstd -q -c $part > $part.zst
+  cat $part.zst >> frames.zst
+  le32 $(wc -c < $part.zst) >> seektable
+  le32 $(wc -c < $part) >> seektable
+  nframes=$((nframes + 1))
+done
+{
+  cat frames.zst
+  printf '\136\052\115\030'
+  le32 $((nframes * 8 + 9))
+  cat seektable
+  le32 $nframes
+  printf '\000\261\352\222\217'
+} > seekable.zst
+
+testrun_compare ${abs_builddir}/dwelf-elf-begin hello_i386.ko.zst \
+  frames.zst seekable.zst << \EOF
+hello_i386.ko.zst: 76a233f8 in memory
+frames.zst: 76a233f8
+seekable.zst: 76a233f8
+EOF
+
+# Without mmap the frames are only found from the seek table.
+LD_PRELOAD=${abs_builddir}/no-mmap.so \
+testrun_compare ${abs_builddir}/dwelf-elf-begin seekable.zst << \EOF
+seekable.zst: 76a233f8
+EOF
+
+exit 0
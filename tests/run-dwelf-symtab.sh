@@ -0,0 +1,57 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Symbol tables of both classes and byte orders, dynamic symbol tables
+# with and without .gnu.hash, and an object file with an extended
+# section index table.
+files="testfile testfile2 testfile11 testfile12 testfile23 testfile52-32.so \
+       testfile52-64.so testfile69.so testfile-s390x-hash-both \
+       testfile-inlines"
+testfiles $files
+
+testrun ${abs_builddir}/dwelf-symtab $files \
+  ${abs_top_builddir}/src/nm ${abs_top_builddir}/src/readelf > /dev/null
+
+# A .gnu.hash section without buckets is ignored, the names are still
+# all found.
+tempfiles nobuckets.so
+cp testfile69.so nobuckets.so
+off=$(testrun ${abs_top_builddir}/src/readelf -W -S nobuckets.so \
+      | sed -n 's/.* \.gnu\.hash *GNU_HASH *[0-9a-f]* \([0-9a-f]*\) .*/\1/p')
+test -n "$off" || exit 1
+dd if=/dev/zero of=nobuckets.so bs=1 seek=$((0x$off)) count=4 \
+   conv=notrunc 2> /dev/null
+testrun_compare ${abs_builddir}/dwelf-symtab nobuckets.so <<\EOF
+nobuckets.so: 2 symbol tables
+EOF
+
+tempfiles shndx.s shndx.o
+i=0
+while test $i -lt 66000; do
+  echo ".section .t$i,\"ax\""
+  echo "s$i: .byte $((i % 256))"
+  i=$((i + 1))
+done > shndx.s
+${CC} -c -xassembler -o shndx.o shndx.s || { echo "cannot assemble"; exit 77; }
+
+testrun_compare ${abs_builddir}/dwelf-symtab shndx.o <<\EOF
+shndx.o: 1 symbol tables
+EOF
+
+exit 0
@@ -0,0 +1,81 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Module images read from the mapped core file as they are used.
+# test-core-lib.so is not contiguous in the dump, see run-unstrip-n.sh.
+# Its read-only sections [1] to [13] have the same contents as in
+# test-core-lib.so on disk, the writable ones were changed at run time.
+testfiles test-core.core
+
+testrun_compare ${abs_builddir}/dwfl-core-lazy test-core.core << \EOF
+0x7f67f2caf000 /home/jkratoch/redhat/elfutils-libregr/test-core-lib.so:
+  [1] a60d4890
+  [2] 39d38c3f
+  [3] 96c87220
+  [4] 294d23b8
+  [5] 8afa51d5
+  [6] b5987fc2
+  [7] fd4c3931
+  [8] 85ca978b
+  [9] 9d690092
+  [10] 230877fd
+  [11] b1939dad
+  [12] ddb31c29
+  [13] 978eedf2
+  [14] b4f8b8d5
+  [15] bcad8115
+  [16] 00000000
+  [17] 60b76cce
+  [18] 956a566e
+  [19] 48b4ba86
+  [20] 6a9975ab
+  [21] 00000000
+  [22] 877c05b4
+  [23] 1a9b5904
+  [24] invalid section header
+  [25] invalid section header
+0x7fff1596c000 linux-vdso.so.1:
+  [1] 67e079bc
+  [2] e1d18e2b
+  [3] 793fe24a
+  [4] db26342e
+  [5] 6969670d
+  [6] 65218704
+  [7] e98c5964
+  [8] 7929f913
+  [9] fc6ee13b
+  [10] fe0152c4
+  [11] b48142ea
+  [12] c1a4f7a0
+  [13] e63461d1
+  [14] cb1c5108
+  [15] 5e702456
+  [16] a9e48056
+  [17] a2c98e68
+EOF
+
+# A core file cut short within the module, whose headers then cannot
+# all be read.
+tempfiles short.core
+head -c 86272 test-core.core > short.core
+testrun_compare ${abs_builddir}/dwfl-core-lazy short.core << \EOF
+0x7f67f2caf000 /home/jkratoch/redhat/elfutils-libregr/test-core-lib.so: no image
+EOF
+
+exit 0
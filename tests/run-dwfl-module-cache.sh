@@ -0,0 +1,62 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# A shared object and executables, all with build ID and DWARF.
+# testfile51 also has .debug_frame.
+testfiles testfile-inlines testfile_nested_funcs testfile51
+
+testrun_compare ${abs_builddir}/dwfl-module-cache \
+  testfile-inlines testfile_nested_funcs testfile51 <<\EOF
+testfile-inlines: shared 1, unshared 0
+testfile-inlines: bias difference 0x1000000
+testfile-inlines: 1 CUs
+testfile_nested_funcs: shared 1, unshared 0
+testfile_nested_funcs: bias difference 0
+testfile_nested_funcs: 1 CUs
+testfile51: shared 1, unshared 0
+testfile51: bias difference 0
+testfile51: 2 CUs
+EOF
+
+# A stripped file has the same build ID, but is kept apart.
+tempfiles testfile-inlines.stripped
+testrun ${abs_top_builddir}/src/strip -o testfile-inlines.stripped \
+  testfile-inlines
+testrun_compare ${abs_builddir}/dwfl-module-cache --stripped \
+  testfile-inlines testfile-inlines.stripped <<\EOF
+testfile-inlines.stripped: 11 symbols
+testfile-inlines: 66 symbols
+EOF
+
+# Sessions in several threads sharing the same files need locking.
+if ! grep -q -F '#define USE_LOCKS' ${abs_top_builddir}/config.h; then
+  exit 0
+fi
+
+testrun_compare ${abs_builddir}/dwfl-module-cache --threads \
+  testfile-inlines testfile_nested_funcs testfile51 <<\EOF
+testfile-inlines: 1 CUs, 66 symbols, 6 in CUs, 6 with lines, 12 scopes, CFI 0, 0 frames
+testfile_nested_funcs: 1 CUs, 71 symbols, 3 in CUs, 3 with lines, 4 scopes, CFI 0, 0 frames
+testfile51: 2 CUs, 75 symbols, 3 in CUs, 3 with lines, 6 scopes, CFI 1, 3 frames
+EOF
+
+# Larger files with many units, only checks the threads agree.
+testrun_on_self_exe ${abs_builddir}/dwfl-module-cache --threads
+
+exit 0
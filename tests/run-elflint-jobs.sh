@@ -0,0 +1,58 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Checking files, or the sections of one file, in parallel gives the
+# same messages in the same order as checking them one by one.
+# Some of these files have errors.
+files="testfile testfile11 testfile19 testfile23 testfile46 testfile50 \
+       testfile52-32.so testfile54-64.so testfile69.so testfile-inlines \
+       testfile-s390x-hash-both"
+testfiles $files
+tempfiles elflint.out elflint.jout
+
+for f in $files; do
+  for opt in "" --gnu --strict; do
+    testrun ${abs_top_builddir}/src/elflint $opt $f > elflint.out ||
+      echo "failed" >> elflint.out
+    testrun ${abs_top_builddir}/src/elflint -j 4 $opt $f > elflint.jout ||
+      echo "failed" >> elflint.jout
+    cmp elflint.out elflint.jout
+  done
+done
+
+testrun ${abs_top_builddir}/src/elflint $files > elflint.out ||
+  echo "failed" >> elflint.out
+testrun ${abs_top_builddir}/src/elflint -j 0 $files > elflint.jout ||
+  echo "failed" >> elflint.jout
+grep -q failed elflint.out
+cmp elflint.out elflint.jout
+
+# Files which can't be opened are reported on stderr in order too.
+tempfiles elflint.expect
+{
+  echo "elflint: cannot open input file 'nonexistent1': No such file or directory"
+  testrun ${abs_top_builddir}/src/elflint testfile testfile11 || :
+  echo "elflint: cannot open input file 'nonexistent2': No such file or directory"
+} > elflint.expect
+testrun ${abs_top_builddir}/src/elflint -j 2 nonexistent1 testfile testfile11 \
+  nonexistent2 > elflint.jout 2>&1 || :
+sed -i 's/^.*elflint: /elflint: /' elflint.jout
+cmp elflint.expect elflint.jout
+
+exit 0
@@ -0,0 +1,64 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-get-units-split.sh and tests/testfile-dwarf-45.source.
+testfiles testfile-dwarf-5
+testfiles testfile-splitdwarf-4 testfile-hello4.dwo testfile-world4.dwo
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+
+testrun_compare ${abs_builddir}/find-split-units testfile-dwarf-5 \
+  testfile-splitdwarf-4 testfile-splitdwarf-5 << \EOF
+testfile-dwarf-5: 0 split units
+testfile-splitdwarf-4: 2 split units
+skeleton 1: hello.c
+skeleton 2: world.c
+testfile-splitdwarf-5: 2 split units
+skeleton 1: hello.c
+skeleton 2: world.c
+EOF
+
+# See testfile-dwp.source.
+testfiles testfile-dwp-5 testfile-dwp-5.dwp
+testfiles testfile-dwp-4 testfile-dwp-4.dwp
+
+testrun_compare ${abs_builddir}/find-split-units testfile-dwp-5 \
+  testfile-dwp-4 << \EOF
+testfile-dwp-5: 3 split units
+skeleton 1: foo.cc
+skeleton 2: bar.cc
+skeleton 3: main.cc
+testfile-dwp-4: 3 split units
+skeleton 1: foo.cc
+skeleton 2: bar.cc
+skeleton 3: main.cc
+EOF
+
+# A missing dwo file leaves its skeleton without a split unit.
+mkdir missing
+cp testfile-splitdwarf-4 testfile-hello4.dwo missing/
+cd missing
+testrun_compare ${abs_builddir}/find-split-units testfile-splitdwarf-4 << \EOF
+testfile-splitdwarf-4: 1 split units
+skeleton 1: hello.c
+skeleton 2: no split unit
+EOF
+cd ..
+rm -r missing
+
+exit 0
@@ -0,0 +1,52 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Sorting, demangling and reading the debug information on several
+# threads gives the same output as doing it on one.  The generated
+# object has enough symbols to be sorted in parts, with the same names
+# and the same values used more than once.
+tempfiles syms.s syms1.o syms2.o syms.o syms.a nm.out nm.jout
+
+i=0
+while test $i -lt 10000; do
+  echo ".section .t$((i % 5)),\"ax\""
+  echo "_ZN1N1fILi${i}EEEvv:"
+  echo "l$i:"
+  echo ".byte 0"
+  i=$((i + 1))
+done > syms.s
+${CC} -c -xassembler -o syms1.o syms.s || { echo "cannot assemble"; exit 77; }
+${CC} -c -xassembler -o syms2.o syms.s || { echo "cannot assemble"; exit 77; }
+${CC} -r -nostdlib -o syms.o syms1.o syms2.o 2>/dev/null ||
+  { echo "cannot link"; exit 77; }
+testrun ${abs_top_builddir}/src/ar rc syms.a syms1.o syms2.o
+
+testfiles testfile-inlines testfile-backtrace-demangle testarchive64.a
+files="syms.o syms.a testfile-inlines testfile-backtrace-demangle \
+       testarchive64.a ${abs_top_builddir}/src/nm"
+
+for f in $files; do
+  for opt in "" -C "-C -n" "-C -r" "-n -r" "-B -C" "-P -C" "-f sysv -C"; do
+    testrun ${abs_top_builddir}/src/nm $opt $f > nm.out
+    testrun ${abs_top_builddir}/src/nm -j 4 $opt $f > nm.jout
+    cmp nm.out nm.jout
+  done
+done
+
+exit 0
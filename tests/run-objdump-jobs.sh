@@ -0,0 +1,70 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Disassembling a section in parts on several threads gives the same
+# listing as disassembling it at once.  The generated code is large
+# enough to be split at its functions.  Some of the functions start in
+# the middle of an instruction, the parts after those have to be
+# disassembled again from where the one before stopped.
+case "`uname -m`" in
+  x86_64) ;;
+  *) exit 77 ;;
+esac
+
+testfiles testfile44.S testfile45.S
+tempfiles funcs.S funcs.o objdump.out objdump.jout
+
+gen ()
+{
+  i=0
+  while test $i -lt 8; do
+    cat $1
+    i=$((i + 1))
+  done | awk '
+    /^\t.byte/ && NR % 40 == 0 {
+      n++
+      if (n % 7 == 0 && index ($0, ",") != 0) {
+        print substr ($0, 1, index ($0, ",") - 1)
+        sub (/^[^,]*, */, "\t.byte\t")
+      }
+      print ".type f" n ",@function"
+      print "f" n ":"
+    }
+    { print }'
+}
+
+for t in "testfile44.S -m32" "testfile45.S -m64"; do
+  set -- $t
+  gen $1 > funcs.S
+  ${CC} $2 -c -o funcs.o funcs.S || { echo "cannot assemble"; exit 77; }
+
+  testrun ${abs_top_builddir}/src/objdump -d funcs.o > objdump.out
+  for j in 2 4 0; do
+    testrun ${abs_top_builddir}/src/objdump --jobs=$j -d funcs.o \
+      > objdump.jout
+    cmp objdump.out objdump.jout
+  done
+  testrun ${abs_top_builddir}/src/objdump --jobs=3 --color=always -d \
+    funcs.o > objdump.jout
+  testrun ${abs_top_builddir}/src/objdump --color=always -d funcs.o \
+    > objdump.out
+  cmp objdump.out objdump.jout
+done
+
+exit 0
@@ -0,0 +1,39 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+type xz 2>/dev/null || (echo "need xz"; exit 77) || exit 77
+
+# See run-strip-reloc.sh
+testfiles hello_i386.ko
+
+tempfiles hello_i386.ko.xz readelf.out.1 readelf.out.2
+
+testrun ${abs_top_builddir}/src/readelf -a -w hello_i386.ko > readelf.out.1
+
+# A single block, decompressed as a whole.
+xz -c hello_i386.ko > hello_i386.ko.xz
+testrun ${abs_top_builddir}/src/readelf -a -w hello_i386.ko.xz > readelf.out.2
+diff -u readelf.out.1 readelf.out.2
+
+# Many small blocks, which are decompressed on demand.
+xz -c --block-size=4KiB hello_i386.ko > hello_i386.ko.xz
+testrun ${abs_top_builddir}/src/readelf -a -w hello_i386.ko.xz > readelf.out.2
+diff -u readelf.out.1 readelf.out.2
+
+exit 0
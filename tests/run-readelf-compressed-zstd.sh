@@ -36,4 +36,14 @@ if [ $? != 0 ]; then
   exit 1;
 fi
 
+# Several frames, which are decompressed on demand.
+tempfiles frames.zst
+split -b 4096 hello_i386.ko part.
+for part in part.*; do
+  tempfiles $part
+  zstd -q -c $part
+done > frames.zst
+testrun ${abs_top_builddir}/src/readelf -a frames.zst > readelf.out.2
+diff -u readelf.out.1 readelf.out.2
+
 exit 0
@@ -32,6 +32,15 @@ SRC_NAME="srcfiles.cxx"
 # Ensure the output contains the expected source file srcfiles.cxx
 testrun $ET_EXEC -e $ET_EXEC | grep $SRC_NAME > /dev/null
 
+# Searching the CUs on several threads gives the same list.
+testrun $ET_EXEC -e $ET_EXEC > srcfiles.out
+testrun $ET_EXEC -j 3 -e $ET_EXEC > srcfiles-jobs.out
+tempfiles srcfiles.out srcfiles-jobs.out
+cmp srcfiles.out srcfiles-jobs.out
+testrun $ET_EXEC -c -e $ET_EXEC > srcfiles.out
+testrun $ET_EXEC -c -j 3 -e $ET_EXEC > srcfiles-jobs.out
+cmp srcfiles.out srcfiles-jobs.out
+
 # Check if zip option is available (only available if libarchive is available.
 #   Debuginfod optional to fetch source files from debuginfod federation.)
 $ET_EXEC --help | grep -q zip && command -v unzip >/dev/null 2>&1 && zip=true || zip=false
@@ -67,7 +76,17 @@ for null_arg in --null ""; do
         # Ensure unzipped srcfiles.cxx and its contents are the same as the original source file
         unzip -j test.zip "*/$SRC_NAME"
         diff "$SRC_NAME" $abs_srcdir/../src/$SRC_NAME
-        rm -f test.zip $SRC_NAME
+        rm -f $SRC_NAME
+
+        # Fetching the files on several threads adds them in a
+        # different order, but the same files.
+        testrun $ET_EXEC $verbose_arg -j 3 -z -e $ET_EXEC > test-jobs.zip
+        tempfiles test-jobs.zip
+        unzip -t test-jobs.zip
+        unzip -Z1 test.zip | sort > srcfiles.out
+        unzip -Z1 test-jobs.zip | sort > srcfiles-jobs.out
+        cmp srcfiles.out srcfiles-jobs.out
+        rm -f test.zip test-jobs.zip
     fi
   done
 done
@@ -108,6 +127,13 @@ if [ -x ${abs_builddir}/../debuginfod/debuginfod ] && $zip; then
 
   rm -rf extracted
 
+  testrun $ET_EXEC -j 4 -z -b -e $ET_EXEC > test-jobs.zip
+  tempfiles test-jobs.zip
+  unzip -t test-jobs.zip
+  unzip -Z1 test.zip | sort > srcfiles.out
+  unzip -Z1 test-jobs.zip | sort > srcfiles-jobs.out
+  cmp srcfiles.out srcfiles-jobs.out
+
   kill $PID1
   wait
   PID1=0
@@ -0,0 +1,45 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# A file large enough to be split into parts with -j gives the same
+# strings at the same offsets, in all encodings.
+files="testfile testfile11 testfile19 testfile-inlines"
+testfiles $files
+tempfiles strings.in strings.out strings.jout
+
+cat $files > strings.in
+size=$(wc -c < strings.in)
+n=0
+while test $(( n * size )) -lt 24000000; do
+  cat strings.in
+  n=$(( n + 1 ))
+done > strings.big
+mv strings.big strings.in
+
+for e in s S b l B L; do
+  for n in 1 4 7; do
+    testrun ${abs_top_builddir}/src/strings -a -e $e -n $n -td strings.in \
+      > strings.out
+    testrun ${abs_top_builddir}/src/strings -j 3 -a -e $e -n $n -td \
+      strings.in > strings.jout
+    cmp strings.out strings.jout
+  done
+done
+
+exit 0
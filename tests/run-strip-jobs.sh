@@ -0,0 +1,86 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Strip several files at once, each with its own outputs, and check
+# the results are the same as when they are stripped one by one.
+files="testfile testfile11 testfile12 testfile7 testfile69.so testfile-inlines"
+testfiles $files
+
+args=
+for f in $files; do
+  tempfiles $f.strip $f.debug $f.jstrip $f.jdebug
+  testrun ${abs_top_builddir}/src/strip -o $f.strip -f $f.debug $f
+  args="$args -o $f.jstrip -f $f.jdebug -F $f.debug $f"
+done
+
+testrun ${abs_top_builddir}/src/strip -j 4 $args
+
+for f in $files; do
+  cmp $f.strip $f.jstrip
+  # Without anything to remove there is no debug file.
+  if test -f $f.debug; then
+    cmp $f.debug $f.jdebug
+  else
+    test ! -f $f.jdebug
+  fi
+done
+
+# Errors are reported per file, the other files are still stripped.
+tempfiles notelf strip.err
+echo "not an ELF file" > notelf
+rm -f testfile.jstrip testfile.jdebug testfile7.jstrip
+testrun ${abs_top_builddir}/src/strip -j 0 \
+  -o testfile.jstrip -f testfile.jdebug -F testfile.debug testfile \
+  -o notelf.jstrip -f notelf.jdebug -F notelf.debug notelf \
+  -o testfile7.jstrip -f testfile7.jdebug -F testfile7.debug testfile7 \
+  2> strip.err && exit 1
+cat strip.err
+grep -q "notelf: File format not recognized" strip.err
+test $(wc -l < strip.err) -eq 1
+cmp testfile.strip testfile.jstrip
+cmp testfile.debug testfile.jdebug
+cmp testfile7.strip testfile7.jstrip
+
+# A file that makes strip give up entirely only stops that file.
+tempfiles truncated truncated.jstrip truncated.jdebug
+head -c 200 testfile > truncated
+rm -f testfile.jstrip testfile.jdebug testfile7.jstrip
+testrun ${abs_top_builddir}/src/strip -j 3 \
+  -o testfile.jstrip -f testfile.jdebug -F testfile.debug testfile \
+  -o truncated.jstrip -f truncated.jdebug -F truncated.debug truncated \
+  -o testfile7.jstrip -f testfile7.jdebug -F testfile7.debug testfile7 \
+  2> strip.err && exit 1
+cat strip.err
+grep -q "truncated: INTERNAL ERROR" strip.err
+cmp testfile.strip testfile.jstrip
+cmp testfile.debug testfile.jdebug
+cmp testfile7.strip testfile7.jstrip
+
+# Names that would only apply to some of several files are rejected.
+for args in "-f x.debug testfile testfile7" "-o x testfile testfile7" \
+	    "-F x.debug testfile testfile7" "testfile testfile7 -o x" \
+	    "-j 2 -o x testfile testfile7"; do
+  testrun ${abs_top_builddir}/src/strip $args 2> strip.err && exit 1
+  cat strip.err
+  grep -q "Only one input file allowed together with '-o' and '-f'" strip.err
+done
+test ! -f x
+test ! -f x.debug
+
+exit 0
@@ -0,0 +1,45 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# See run-aggregate-size.sh and run-peel-type.sh.
+testfiles testfile-sizes1.o testfile-sizes2.o testfile-sizes3.o testfile-sizes4.o
+
+testrun_compare ${abs_builddir}/type-info \
+  testfile-sizes1.o testfile-sizes2.o testfile-sizes3.o \
+  testfile-sizes4.o << \EOF
+testfile-sizes1.o: 27 dies peeled, 15 with size
+testfile-sizes2.o: 27 dies peeled, 15 with size
+testfile-sizes3.o: 52 dies peeled, 37 with size
+testfile-sizes4.o: 5 dies peeled, 2 with size
+EOF
+
+# Type units and split units, see run-get-units-split.sh.
+testfiles testfile-debug-types
+testfiles testfile-splitdwarf-5 testfile-hello5.dwo testfile-world5.dwo
+
+testrun_compare ${abs_builddir}/type-info \
+  testfile-debug-types testfile-splitdwarf-5 << \EOF
+testfile-debug-types: 13 dies peeled, 3 with size
+testfile-splitdwarf-5: 76 dies peeled, 20 with size
+EOF
+
+# Self test, only checks that nothing differs.
+testrun_on_self_exe ${abs_builddir}/type-info
+
+exit 0
@@ -0,0 +1,82 @@
+#! /bin/sh
+# Copyright (C) 2026 Red Hat, Inc.
+# This file is part of elfutils.
+#
+# This file is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# elfutils is distributed in the hope that it will be useful, but
+# WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+. $srcdir/test-subr.sh
+
+# Put an object file with one section (and one relocation section)
+# per function back together from a stripped file and a debug file
+# which has its sections in the same or in the opposite order.  The
+# symbols and relocations must come out as in the debug file.  Each
+# size is four times the one before, the time taken, which is only
+# printed, should grow about the same.  Set UNSTRIP_MANY to try other
+# sizes.
+sizes=${UNSTRIP_MANY:-"500 2000 8000"}
+
+tempfiles many.s many.o many-rev.o many.strip many.unstrip
+tempfiles expected.txt result.txt
+
+gen ()
+{
+  left=$1
+  i=$2
+  while test $left -gt 0; do
+    echo ".section .text.f$i"
+    echo ".globl f$i"
+    echo "f$i: .long f$(( (i + 1) % $1 ))"
+    i=$(( i + $3 ))
+    left=$(( left - 1 ))
+  done
+}
+
+# The symbol table and relocations of FILE, without file offsets.
+listing ()
+{
+  testrun ${abs_top_builddir}/src/readelf -s -r $1 \
+    | sed -e 1,2d -e 's/ at offset 0x[0-9a-f]*//'
+}
+
+unstrip_and_compare ()
+{
+  start=$(date +%s%N)
+  testrun ${abs_top_builddir}/src/unstrip -o many.unstrip many.strip $1
+  end=$(date +%s%N)
+  echo "$n sections, $1: $(( (end - start) / 1000000 )) ms"
+
+  listing $1 > expected.txt
+  listing many.unstrip > result.txt
+  cmp -s expected.txt result.txt ||
+    { echo "unstrip of $n sections with $1 differs"
+      diff -u expected.txt result.txt | head -20; exit 1; }
+  testrun ${abs_top_builddir}/src/elfcmp $1 many.unstrip
+  testrun ${abs_top_builddir}/src/elflint --gnu -q many.unstrip
+}
+
+for n in $sizes; do
+  gen $n 0 1 > many.s
+  ${CC} -c -xassembler -o many.o many.s ||
+    { echo "cannot assemble"; exit 77; }
+  gen $n $(( n - 1 )) -1 > many.s
+  ${CC} -c -xassembler -o many-rev.o many.s ||
+    { echo "cannot assemble"; exit 77; }
+
+  testrun ${abs_top_builddir}/src/strip -g -o many.strip many.o
+
+  unstrip_and_compare many.o
+  unstrip_and_compare many-rev.o
+done
+
+exit 0
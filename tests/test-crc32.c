@@ -0,0 +1,83 @@
+/* Test the CRC32 implementation against a bit at a time reference.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "system.h"
+#include "libeu.h"
+
+
+static uint32_t
+reference (uint32_t crc, const unsigned char *buf, size_t len)
+{
+  crc = ~crc;
+  while (len-- > 0)
+    {
+      crc ^= *buf++;
+      for (int i = 0; i < 8; ++i)
+	crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+  return ~crc;
+}
+
+int
+main (void)
+{
+  unsigned char check[] = "123456789";
+  if (crc32 (0, check, 9) != 0xcbf43926)
+    error (EXIT_FAILURE, 0, "wrong CRC of the check string: %08x",
+	   crc32 (0, check, 9));
+
+  const size_t size = (1 << 20) + 64;
+  unsigned char *buf = malloc (size);
+  if (buf == NULL)
+    error (EXIT_FAILURE, errno, "malloc");
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = random ();
+
+  /* Every small length at every alignment, starting from any CRC.  */
+  for (size_t off = 0; off < 16; ++off)
+    for (size_t len = 0; len < 600; ++len)
+      {
+	uint32_t start = random ();
+	uint32_t expect = reference (start, buf + off, len);
+	uint32_t crc = crc32 (start, buf + off, len);
+	if (crc != expect)
+	  error (EXIT_FAILURE, 0, "length %zu at offset %zu: %08x != %08x",
+		 len, off, crc, expect);
+      }
+
+  /* A large buffer at once, and in uneven pieces.  */
+  uint32_t expect = reference (0, buf, size);
+  if (crc32 (0, buf, size) != expect)
+    error (EXIT_FAILURE, 0, "wrong CRC of %zu bytes", size);
+  uint32_t crc = 0;
+  for (size_t pos = 0, piece = 1; pos < size; pos += piece, piece *= 3)
+    {
+      if (piece > size - pos)
+	piece = size - pos;
+      crc = crc32 (crc, buf + pos, piece);
+    }
+  if (crc != expect)
+    error (EXIT_FAILURE, 0, "wrong CRC of %zu bytes in pieces", size);
+
+  free (buf);
+  return 0;
+}
@@ -0,0 +1,157 @@
+/* Test dwarf_type_info against dwarf_peel_type and dwarf_aggregate_size.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dwarf.h>
+#include ELFUTILS_HEADER(dw)
+#include "system.h"
+
+
+static const char *fname;
+static int errors;
+static size_t ntypes;
+static size_t nsizes;
+
+#define fail(die, fmt, ...) \
+  (printf ("%s [%" PRIx64 "]: " fmt "\n", fname, dwarf_dieoffset (die), \
+	   ##__VA_ARGS__), ++errors)
+
+static void
+check_die (Dwarf_Die *die, Dwarf_Type_Info *info)
+{
+  Dwarf_Die peeled;
+  int res = dwarf_peel_type (die, &peeled);
+  if (res != info->peeled)
+    fail (die, "peeled %d instead of %d", info->peeled, res);
+  else if (res >= 0
+	   && dwarf_dieoffset (&peeled) != dwarf_dieoffset (&info->type))
+    fail (die, "peeled to [%" PRIx64 "] instead of [%" PRIx64 "]",
+	  dwarf_dieoffset (&info->type), dwarf_dieoffset (&peeled));
+
+  Dwarf_Word size;
+  bool has_size = dwarf_aggregate_size (die, &size) == 0;
+  if (has_size != info->has_size || (has_size && size != info->size))
+    fail (die, "size %s%" PRIu64 " instead of %s%" PRIu64,
+	  info->has_size ? "" : "unknown ", info->size,
+	  has_size ? "" : "unknown ", has_size ? size : 0);
+  if (info->has_size && dwarf_tag (&info->type) != DW_TAG_array_type
+      && info->stride != info->size)
+    fail (die, "stride %" PRIu64 " of non-array", info->stride);
+
+  Dwarf_Type_Info again;
+  if (dwarf_type_info (die, &again) != info->peeled
+      || again.has_size != info->has_size || again.size != info->size
+      || again.stride != info->stride)
+    fail (die, "different info the second time");
+
+  ntypes += info->peeled == 0;
+  nsizes += info->has_size;
+}
+
+/* Collect all DIEs of the unit, look them up at once, then check
+   each one.  */
+static void
+check_unit (Dwarf_Die *cudie)
+{
+  size_t ndies = 0;
+  size_t nalloc = 64;
+  Dwarf_Die *dies = malloc (nalloc * sizeof *dies);
+  Dwarf_Die stack[64];
+  int level = 0;
+  if (dies == NULL)
+    error (EXIT_FAILURE, errno, "malloc");
+  stack[0] = *cudie;
+  while (level >= 0)
+    {
+      if (ndies == nalloc)
+	{
+	  nalloc *= 2;
+	  dies = realloc (dies, nalloc * sizeof *dies);
+	  if (dies == NULL)
+	    error (EXIT_FAILURE, errno, "realloc");
+	}
+      dies[ndies++] = stack[level];
+
+      if (level + 1 < 64
+	  && dwarf_child (&stack[level], &stack[level + 1]) == 0)
+	++level;
+      else
+	while (level >= 0
+	       && dwarf_siblingof (&stack[level], &stack[level]) != 0)
+	  --level;
+    }
+
+  Dwarf_Type_Info *infos = malloc (ndies * sizeof *infos);
+  if (infos == NULL)
+    error (EXIT_FAILURE, errno, "malloc");
+  int res = dwarf_type_infos (dies, ndies, infos);
+  bool any_failed = false;
+  for (size_t i = 0; i < ndies; ++i)
+    {
+      check_die (&dies[i], &infos[i]);
+      any_failed |= infos[i].peeled < 0;
+    }
+  if (res != (any_failed ? -1 : 0))
+    fail (cudie, "dwarf_type_infos returned %d", res);
+
+  free (infos);
+  free (dies);
+}
+
+int
+main (int argc, char *argv[])
+{
+  Dwarf_Type_Info info;
+  if (dwarf_type_info (NULL, &info) != -1 || info.peeled != -1)
+    error (EXIT_FAILURE, 0, "dwarf_type_info accepted NULL");
+
+  for (int i = 1; i < argc; ++i)
+    {
+      fname = argv[i];
+      int fd = open (fname, O_RDONLY);
+      if (fd < 0)
+	error (EXIT_FAILURE, errno, "cannot open '%s'", fname);
+      Dwarf *dbg = dwarf_begin (fd, DWARF_C_READ);
+      if (dbg == NULL)
+	error (EXIT_FAILURE, 0, "dwarf_begin %s: %s", fname,
+	       dwarf_errmsg (-1));
+
+      ntypes = nsizes = 0;
+      Dwarf_CU *cu = NULL;
+      Dwarf_Die cudie, subdie;
+      uint8_t unit_type;
+      while (dwarf_get_units (dbg, cu, &cu, NULL, &unit_type,
+			      &cudie, &subdie) == 0)
+	{
+	  check_unit (&cudie);
+	  if (unit_type == DW_UT_skeleton
+	      && dwarf_tag (&subdie) != DW_TAG_invalid)
+	    check_unit (&subdie);
+	}
+      printf ("%s: %zu dies peeled, %zu with size\n", fname, ntypes, nsizes);
+
+      dwarf_end (dbg);
+      close (fd);
+    }
+
+  return errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+/* Test (and time) byte swapping of ELF record arrays.
+   Copyright (C) 2026 Red Hat, Inc.
+   This file is part of elfutils.
+
+   This file is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   elfutils is distributed in the hope that it will be useful, but
+   WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <endian.h>
+#include ELFUTILS_HEADER(elf)
+#include <gelf.h>
+#include "system.h"
+
+
+/* The field sizes of one record, in order, ending with zero.  */
+static const struct
+{
+  const char *name;
+  int class;
+  Elf_Type type;
+  unsigned char fields[8];
+} types[] =
+  {
+    { "Half", ELFCLASS32, ELF_T_HALF, { 2 } },
+    { "Word", ELFCLASS32, ELF_T_WORD, { 4 } },
+    { "Xword", ELFCLASS64, ELF_T_XWORD, { 8 } },
+    { "Addr32", ELFCLASS32, ELF_T_ADDR, { 4 } },
+    { "Addr64", ELFCLASS64, ELF_T_ADDR, { 8 } },
+    { "Rel32", ELFCLASS32, ELF_T_REL, { 4, 4 } },
+    { "Rela32", ELFCLASS32, ELF_T_RELA, { 4, 4, 4 } },
+    { "Rel64", ELFCLASS64, ELF_T_REL, { 8, 8 } },
+    { "Rela64", ELFCLASS64, ELF_T_RELA, { 8, 8, 8 } },
+    { "Sym32", ELFCLASS32, ELF_T_SYM, { 4, 4, 4, 1, 1, 2 } },
+    { "Sym64", ELFCLASS64, ELF_T_SYM, { 4, 1, 1, 2, 8, 8 } },
+  };
+#define NTYPES (sizeof types / sizeof types[0])
+
+static size_t
+record_size (size_t t)
+{
+  size_t size = 0;
+  for (const unsigned char *f = types[t].fields; *f != 0; ++f)
+    size += *f;
+  return size;
+}
+
+/* Reverse every field of the N records at SRC into DEST.  */
+static void
+reference (size_t t, unsigned char *dest, const unsigned char *src, size_t n)
+{
+  while (n-- > 0)
+    for (const unsigned char *f = types[t].fields; *f != 0; ++f)
+      {
+	for (size_t i = 0; i < *f; ++i)
+	  dest[i] = src[*f - 1 - i];
+	dest += *f;
+	src += *f;
+      }
+}
+
+static Elf_Data *
+xlate (size_t t, void *dest, const void *src, size_t size)
+{
+  Elf_Data dst =
+    {
+      .d_buf = dest, .d_size = size, .d_version = EV_CURRENT
+    };
+  Elf_Data sdata =
+    {
+      .d_buf = (void *) src, .d_size = size,
+      .d_type = types[t].type, .d_version = EV_CURRENT
+    };
+  /* Translate from the other byte order.  */
+  unsigned int encode = (BYTE_ORDER == LITTLE_ENDIAN
+			 ? ELFDATA2MSB : ELFDATA2LSB);
+  return (types[t].class == ELFCLASS32
+	  ? elf32_xlatetom (&dst, &sdata, encode)
+	  : elf64_xlatetom (&dst, &sdata, encode));
+}
+
+static void
+check (size_t t, size_t n)
+{
+  size_t size = n * record_size (t);
+  /* One more byte to check the conversion of unaligned data.  */
+  unsigned char *src = malloc (size + 1);
+  unsigned char *dest = malloc (size + 1);
+  unsigned char *expect = malloc (size + 1);
+  if (src == NULL || dest == NULL || expect == NULL)
+    error (EXIT_FAILURE, errno, "malloc");
+
+  for (size_t i = 0; i < size + 1; ++i)
+    src[i] = random ();
+  reference (t, expect, src, n);
+
+  if (xlate (t, dest, src, size) == NULL)
+    error (EXIT_FAILURE, 0, "%s: %s", types[t].name, elf_errmsg (-1));
+  if (memcmp (dest, expect, size) != 0)
+    error (EXIT_FAILURE, 0, "%s: %zu records differ", types[t].name, n);
+
+  /* Unaligned source and destination.  */
+  memmove (src + 1, src, size);
+  if (xlate (t, dest + 1, src + 1, size) == NULL
+      || memcmp (dest + 1, expect, size) != 0)
+    error (EXIT_FAILURE, 0, "%s: %zu unaligned records differ",
+	   types[t].name, n);
+
+  /* In place.  */
+  if (xlate (t, src + 1, src + 1, size) == NULL
+      || memcmp (src + 1, expect, size) != 0)
+    error (EXIT_FAILURE, 0, "%s: %zu records differ in place",
+	   types[t].name, n);
+
+  free (src);
+  free (dest);
+  free (expect);
+}
+
+/* Print how fast records get converted out of place.  */
+static void
+bench (size_t t, unsigned int rounds)
+{
+  const size_t size = 1 << 20;
+  size_t n = size / record_size (t);
+  unsigned char *src = calloc (1, size);
+  unsigned char *dest = calloc (1, size);
+  if (src == NULL || dest == NULL)
+    error (EXIT_FAILURE, errno, "calloc");
+
+  struct timespec start, end;
+  clock_gettime (CLOCK_MONOTONIC, &start);
+  for (unsigned int i = 0; i < rounds; ++i)
+    xlate (t, dest, src, n * record_size (t));
+  clock_gettime (CLOCK_MONOTONIC, &end);
+
+  double secs = ((end.tv_sec - start.tv_sec)
+		 + (end.tv_nsec - start.tv_nsec) / 1e9);
+  printf ("%-8s %8.0f MB/s\n", types[t].name,
+	  (double) n * record_size (t) * rounds / secs / 1e6);
+
+  free (src);
+  free (dest);
+}
+
+int
+main (int argc, char *argv[])
+{
+  elf_version (EV_CURRENT);
+
+  /* With an argument, time that many rounds of each conversion.  */
+  if (argc > 1)
+    {
+      unsigned int rounds = atoi (argv[1]);
+      for (size_t t = 0; t < NTYPES; ++t)
+	bench (t, rounds);
+      return 0;
+    }
+
+  static const size_t counts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 15, 16, 17,
+				   31, 33, 64, 127, 1000, 4099 };
+  for (size_t t = 0; t < NTYPES; ++t)
+    for (size_t c = 0; c < sizeof counts / sizeof counts[0]; ++c)
+      check (t, counts[c]);
+
+  return 0;
+}